@@ -45,6 +45,8 @@ STAT_MEMORY_COUNTER("Memory/BVH tree", treeBytes);
 STAT_RATIO("BVH/Primitives per leaf node", totalPrimitives, totalLeafNodes);
 STAT_COUNTER("BVH/Interior nodes", interiorNodes);
 STAT_COUNTER("BVH/Leaf nodes", leafNodes);
+STAT_COUNTER("BVH/Alpha tests skipped by opaque occluders",
+             nDeferredAlphaTestsSkipped);
 
 // BVHAccel Local Declarations
 struct BVHPrimitiveInfo {
@@ -100,7 +102,7 @@ struct LinearBVHNode {
     };
     uint16_t nPrimitives;  // 0 -> interior node
     uint8_t axis;          // interior node: xyz
-    uint8_t pad[1];        // ensure 32 byte total size
+    uint8_t alphaMasked;   // leaf node: some primitive has an alpha mask
 };
 
 // BVHAccel Utility Functions
@@ -646,10 +648,16 @@ int BVHAccel::flattenBVHTree(BVHBuildNode *node, int *offset) {
         CHECK_LT(node->nPrimitives, 65536);
         linearNode->primitivesOffset = node->firstPrimOffset;
         linearNode->nPrimitives = node->nPrimitives;
+        linearNode->alphaMasked = 0;
+        for (int i = 0; i < node->nPrimitives; ++i)
+            if (primitives[node->firstPrimOffset + i]->HasAlphaMask())
+                linearNode->alphaMasked = 1;
+        hasAlphaMask |= linearNode->alphaMasked;
     } else {
         // Create interior flattened BVH node
         linearNode->axis = node->splitAxis;
         linearNode->nPrimitives = 0;
+        linearNode->alphaMasked = 0;
         flattenBVHTree(node->children[0], offset);
         linearNode->secondChildOffset =
             flattenBVHTree(node->children[1], offset);
@@ -699,22 +707,38 @@ bool BVHAccel::Intersect(const Ray &ray, SurfaceInteraction *isect) const {
     return hit;
 }
 
-bool BVHAccel::IntersectP(const Ray &ray) const {
-    if (!nodes) return false;
+bool BVHAccel::IntersectP(const Ray &ray, bool testAlphaTexture) const {
+    return Occluder(ray, testAlphaTexture) != nullptr;
+}
+
+const Primitive *BVHAccel::Occluder(const Ray &ray,
+                                    bool testAlphaTexture) const {
+    if (!nodes) return nullptr;
     ProfilePhase p(Prof::AccelIntersectP);
     Vector3f invDir(1.f / ray.d.x, 1.f / ray.d.y, 1.f / ray.d.z);
     int dirIsNeg[3] = {invDir.x < 0, invDir.y < 0, invDir.z < 0};
     int nodesToVisit[64];
     int toVisitOffset = 0, currentNodeIndex = 0;
+    // Alpha-masked primitives that the ray hits are only tested against
+    // their alpha textures once no opaque occluder has been found
+    PBRT_CONSTEXPR int maxDeferred = 16;
+    int deferred[maxDeferred];
+    int nDeferred = 0;
     while (true) {
         const LinearBVHNode *node = &nodes[currentNodeIndex];
         if (node->bounds.IntersectP(ray, invDir, dirIsNeg)) {
             // Process BVH node _node_ for traversal
             if (node->nPrimitives > 0) {
                 for (int i = 0; i < node->nPrimitives; ++i) {
-                    if (primitives[node->primitivesOffset + i]->IntersectP(
-                            ray)) {
-                        return true;
+                    int index = node->primitivesOffset + i;
+                    const Primitive *prim = primitives[index].get();
+                    if (testAlphaTexture && node->alphaMasked &&
+                        nDeferred < maxDeferred && prim->HasAlphaMask()) {
+                        if (prim->IntersectP(ray, false))
+                            deferred[nDeferred++] = index;
+                    } else if (prim->IntersectP(ray, testAlphaTexture)) {
+                        nDeferredAlphaTestsSkipped += nDeferred;
+                        return prim;
                     }
                 }
                 if (toVisitOffset == 0) break;
@@ -734,7 +758,12 @@ bool BVHAccel::IntersectP(const Ray &ray) const {
             currentNodeIndex = nodesToVisit[--toVisitOffset];
         }
     }
-    return false;
+
+    // Test deferred primitives against their alpha textures
+    for (int i = 0; i < nDeferred; ++i)
+        if (primitives[deferred[i]]->IntersectP(ray))
+            return primitives[deferred[i]].get();
+    return nullptr;
 }
 
 std::shared_ptr<BVHAccel> CreateBVHAccelerator(
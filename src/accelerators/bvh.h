@@ -64,7 +64,10 @@ class BVHAccel : public Aggregate {
     Bounds3f WorldBound() const;
     ~BVHAccel();
     bool Intersect(const Ray &ray, SurfaceInteraction *isect) const;
-    bool IntersectP(const Ray &ray) const;
+    bool IntersectP(const Ray &ray, bool testAlphaTexture = true) const;
+    const Primitive *Occluder(const Ray &ray,
+                              bool testAlphaTexture = true) const;
+    bool HasAlphaMask() const { return hasAlphaMask; }
 
   private:
     // BVHAccel Private Methods
@@ -92,6 +95,7 @@ class BVHAccel : public Aggregate {
     const SplitMethod splitMethod;
     std::vector<std::shared_ptr<Primitive>> primitives;
     LinearBVHNode *nodes = nullptr;
+    bool hasAlphaMask = false;
 };
 
 std::shared_ptr<BVHAccel> CreateBVHAccelerator(
@@ -102,6 +102,7 @@ KdTreeAccel::KdTreeAccel(std::vector<std::shared_ptr<Primitive>> p,
         Bounds3f b = prim->WorldBound();
         bounds = Union(bounds, b);
         primBounds.push_back(b);
+        hasAlphaMask |= prim->HasAlphaMask();
     }
 
     // Allocate working memory for kd-tree construction
@@ -347,12 +348,17 @@ bool KdTreeAccel::Intersect(const Ray &ray, SurfaceInteraction *isect) const {
     return hit;
 }
 
-bool KdTreeAccel::IntersectP(const Ray &ray) const {
+bool KdTreeAccel::IntersectP(const Ray &ray, bool testAlphaTexture) const {
+    return Occluder(ray, testAlphaTexture) != nullptr;
+}
+
+const Primitive *KdTreeAccel::Occluder(const Ray &ray,
+                                       bool testAlphaTexture) const {
     ProfilePhase p(Prof::AccelIntersectP);
     // Compute initial parametric range of ray inside kd-tree extent
     Float tMin, tMax;
     if (!bounds.IntersectP(ray, &tMin, &tMax)) {
-        return false;
+        return nullptr;
     }
 
     // Prepare to traverse kd-tree for ray
@@ -368,8 +374,8 @@ bool KdTreeAccel::IntersectP(const Ray &ray) const {
             if (nPrimitives == 1) {
                 const std::shared_ptr<Primitive> &p =
                     primitives[node->onePrimitive];
-                if (p->IntersectP(ray)) {
-                    return true;
+                if (p->IntersectP(ray, testAlphaTexture)) {
+                    return p.get();
                 }
             } else {
                 for (int i = 0; i < nPrimitives; ++i) {
@@ -377,8 +383,8 @@ bool KdTreeAccel::IntersectP(const Ray &ray) const {
                         primitiveIndices[node->primitiveIndicesOffset + i];
                     const std::shared_ptr<Primitive> &prim =
                         primitives[primitiveIndex];
-                    if (prim->IntersectP(ray)) {
-                        return true;
+                    if (prim->IntersectP(ray, testAlphaTexture)) {
+                        return prim.get();
                     }
                 }
             }
@@ -427,7 +433,7 @@ bool KdTreeAccel::IntersectP(const Ray &ray) const {
             }
         }
     }
-    return false;
+    return nullptr;
 }
 
 std::shared_ptr<KdTreeAccel> CreateKdTreeAccelerator(
@@ -56,7 +56,10 @@ class KdTreeAccel : public Aggregate {
     Bounds3f WorldBound() const { return bounds; }
     ~KdTreeAccel();
     bool Intersect(const Ray &ray, SurfaceInteraction *isect) const;
-    bool IntersectP(const Ray &ray) const;
+    bool IntersectP(const Ray &ray, bool testAlphaTexture = true) const;
+    const Primitive *Occluder(const Ray &ray,
+                              bool testAlphaTexture = true) const;
+    bool HasAlphaMask() const { return hasAlphaMask; }
 
   private:
     // KdTreeAccel Private Methods
@@ -74,6 +77,7 @@ class KdTreeAccel : public Aggregate {
     KdAccelNode *nodes;
     int nAllocedNodes, nextFreeNode;
     Bounds3f bounds;
+    bool hasAlphaMask = false;
 };
 
 struct KdToDo {
@@ -54,9 +54,13 @@
 #include "filters/triangle.h"
 #include "integrators/bdpt.h"
 #include "integrators/directlighting.h"
+#include "integrators/guidedpath.h"
+#include "integrators/igi.h"
+#include "integrators/irradiancecache.h"
 #include "integrators/mlt.h"
 #include "integrators/ao.h"
 #include "integrators/path.h"
+#include "integrators/restir.h"
 #include "integrators/sppm.h"
 #include "integrators/volpath.h"
 #include "integrators/whitted.h"
@@ -81,8 +85,10 @@
 #include "materials/subsurface.h"
 #include "materials/translucent.h"
 #include "materials/uber.h"
+#include "samplers/bluenoise.h"
 #include "samplers/halton.h"
 #include "samplers/maxmin.h"
+#include "samplers/paddedsobol.h"
 #include "samplers/random.h"
 #include "samplers/sobol.h"
 #include "samplers/stratified.h"
@@ -686,8 +692,8 @@ namespace pbrt {
                                        const Transform &medium2world) {
         Float sig_a_rgb[3] = {.0011f, .0024f, .014f},
                 sig_s_rgb[3] = {2.55f, 3.21f, 3.77f};
-        Spectrum sig_a = Spectrum::FromRGB(sig_a_rgb),
-                sig_s = Spectrum::FromRGB(sig_s_rgb);
+        SceneSpectrum sig_a = SceneSpectrum::FromRGB(sig_a_rgb),
+                sig_s = SceneSpectrum::FromRGB(sig_s_rgb);
         std::string preset = paramSet.FindOneString("preset", "");
         bool found = GetMediumScatteringProperties(preset, &sig_a, &sig_s);
         if (preset != "" && !found)
@@ -828,6 +834,10 @@ namespace pbrt {
             sampler = CreateHaltonSampler(paramSet, film->GetSampleBounds());
         else if (name == "sobol")
             sampler = CreateSobolSampler(paramSet, film->GetSampleBounds());
+        else if (name == "paddedsobol")
+            sampler = CreatePaddedSobolSampler(paramSet);
+        else if (name == "bluenoise")
+            sampler = CreateBlueNoiseSampler(paramSet);
         else if (name == "random")
             sampler = CreateRandomSampler(paramSet);
         else if (name == "stratified")
@@ -1798,6 +1808,9 @@ namespace pbrt {
                     CreateDirectLightingIntegrator(IntegratorParams, sampler, camera);
         else if (IntegratorName == "path")
             integrator = CreatePathIntegrator(IntegratorParams, sampler, camera);
+        else if (IntegratorName == "guidedpath")
+            integrator =
+                    CreateGuidedPathIntegrator(IntegratorParams, sampler, camera);
         else if (IntegratorName == "volpath")
             integrator = CreateVolPathIntegrator(IntegratorParams, sampler, camera);
         else if (IntegratorName == "bdpt") {
@@ -1808,11 +1821,66 @@ namespace pbrt {
             integrator = CreateAOIntegrator(IntegratorParams, sampler, camera);
         } else if (IntegratorName == "sppm") {
             integrator = CreateSPPMIntegrator(IntegratorParams, camera);
+        } else if (IntegratorName == "irradiancecache") {
+            integrator = CreateIrradianceCacheIntegrator(IntegratorParams,
+                                                         sampler, camera);
+        } else if (IntegratorName == "igi") {
+            integrator = CreateIGIIntegrator(IntegratorParams, sampler, camera);
+        } else if (IntegratorName == "restir") {
+            integrator =
+                CreateReSTIRIntegrator(IntegratorParams, sampler, camera);
         } else {
             Error("Integrator \"%s\" unknown.", IntegratorName.c_str());
             return nullptr;
         }
 
+        if (PbrtOptions.nodeCount > 1 &&
+            (IntegratorName == "mlt" || IntegratorName == "sppm" ||
+             IntegratorName == "restir")) {
+            Error("\"%s\" integrator doesn't render by image tiles and can't "
+                  "be distributed across nodes.", IntegratorName.c_str());
+            delete integrator;
+            return nullptr;
+        }
+        if (camera->film->streaming &&
+            (IntegratorName == "bdpt" || IntegratorName == "mlt" ||
+             IntegratorName == "sppm" || IntegratorName == "restir")) {
+            Error("\"%s\" integrator updates arbitrary pixels and can't be "
+                  "used with a streaming film.", IntegratorName.c_str());
+            delete integrator;
+            return nullptr;
+        }
+#ifdef PBRT_HERO_SPECTRUM
+        if (IntegratorName == "sppm") {
+            Error("\"sppm\" integrator accumulates photons traced at "
+                  "different wavelengths and can't be used with hero "
+                  "wavelength spectra.");
+            delete integrator;
+            return nullptr;
+        }
+        if (IntegratorName == "irradiancecache") {
+            Error("\"irradiancecache\" integrator interpolates irradiance "
+                  "records computed at different wavelengths and can't be "
+                  "used with hero wavelength spectra.");
+            delete integrator;
+            return nullptr;
+        }
+        if (IntegratorName == "igi") {
+            Error("\"igi\" integrator stores virtual lights traced at "
+                  "different wavelengths than the camera paths that use "
+                  "them and can't be used with hero wavelength spectra.");
+            delete integrator;
+            return nullptr;
+        }
+        if (IntegratorName == "restir") {
+            Error("\"restir\" integrator reuses light samples between pixels "
+                  "traced at different wavelengths and can't be used with "
+                  "hero wavelength spectra.");
+            delete integrator;
+            return nullptr;
+        }
+#endif
+
         if (renderOptions->haveScatteringMedia && IntegratorName != "volpath" &&
             IntegratorName != "bdpt" && IntegratorName != "mlt") {
             Warning(
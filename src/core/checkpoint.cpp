@@ -0,0 +1,258 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// core/checkpoint.cpp*
+#include "checkpoint.h"
+#include "film.h"
+#include "parallel.h"
+#include "stats.h"
+#include <stdio.h>
+
+namespace pbrt {
+
+STAT_COUNTER("Checkpoint/Checkpoints written", nCheckpointsWritten);
+STAT_MEMORY_COUNTER("Memory/Checkpoint buffers", checkpointBytes);
+
+// Checkpoint Local Definitions
+static const char checkpointMagic[8] = {'P', 'B', 'R', 'T', 'C', 'K', 'P', 'T'};
+static PBRT_CONSTEXPR uint32_t checkpointVersion = 1;
+
+// Checkpoint Function Definitions
+std::string CheckpointFilename(const std::string &imageFilename) {
+    if (PbrtOptions.nodeCount > 1)
+        return StringPrintf("%s.%d-of-%d.checkpoint", imageFilename.c_str(),
+                            PbrtOptions.nodeIndex, PbrtOptions.nodeCount);
+    return imageFilename + ".checkpoint";
+}
+
+// CheckpointWriter Method Definitions
+CheckpointWriter::CheckpointWriter(const std::string &filename,
+                                   const std::string &config,
+                                   Float intervalSeconds)
+    : filename(filename),
+      config(config),
+      interval(intervalSeconds),
+      lastWrite(std::chrono::steady_clock::now()) {
+    if (intervalSeconds > 0)
+        thread = std::thread(&CheckpointWriter::WriterThread, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    // Let the writer thread finish any checkpoint that's still pending
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            shutdown = true;
+        }
+        cv.notify_one();
+        thread.join();
+    }
+}
+
+bool CheckpointWriter::Due() const {
+    return thread.joinable() &&
+           std::chrono::steady_clock::now() - lastWrite >= interval;
+}
+
+std::vector<char> CheckpointWriter::StartCheckpoint() const {
+    std::vector<char> data;
+    CheckpointAppend(&data, checkpointMagic, sizeof(checkpointMagic));
+    CheckpointAppend(&data, &checkpointVersion);
+    uint32_t configLength = config.size();
+    CheckpointAppend(&data, &configLength);
+    CheckpointAppend(&data, config.data(), config.size());
+    return data;
+}
+
+void CheckpointWriter::Write(std::vector<char> data) {
+    CHECK(thread.joinable());
+    {
+        // Replace any checkpoint that the writer thread hasn't started on
+        // yet; only the most recent one is useful.
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = std::move(data);
+        hasPending = true;
+    }
+    cv.notify_one();
+    lastWrite = std::chrono::steady_clock::now();
+}
+
+void CheckpointWriter::Finish() {
+    // Discard pending work, stop the writer thread, and remove the
+    // checkpoint now that the render has completed
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            hasPending = false;
+            shutdown = true;
+        }
+        cv.notify_one();
+        thread.join();
+    }
+    remove(filename.c_str());
+}
+
+void CheckpointWriter::WriterThread() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this]() { return hasPending || shutdown; });
+        if (!hasPending) return;
+        std::vector<char> data = std::move(pending);
+        hasPending = false;
+        lock.unlock();
+
+        // Write checkpoint to a temporary file and rename it so that an
+        // interrupted write never clobbers the previous checkpoint
+        checkpointBytes = std::max<int64_t>(checkpointBytes, data.size());
+        std::string tempName = filename + ".tmp";
+        FILE *f = fopen(tempName.c_str(), "wb");
+        bool ok = f && fwrite(&data[0], 1, data.size(), f) == data.size();
+        if (f && fclose(f) != 0) ok = false;
+        if (ok && rename(tempName.c_str(), filename.c_str()) == 0) {
+            LOG(INFO) << "Wrote checkpoint " << filename << " ("
+                      << data.size() << " bytes)";
+            ++nCheckpointsWritten;
+        } else
+            Warning("%s: unable to write checkpoint", filename.c_str());
+        lock.lock();
+    }
+}
+
+// CheckpointReader Method Definitions
+bool CheckpointReader::Open(const std::string &filename,
+                            const std::string &config) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) {
+        Warning("%s: no checkpoint to resume from; starting from the "
+                "beginning", filename.c_str());
+        return false;
+    }
+    char buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        data.insert(data.end(), buf, buf + n);
+    fclose(f);
+
+    // Check that the checkpoint is from the same render
+    char magic[sizeof(checkpointMagic)];
+    uint32_t version, configLength;
+    if (!Read(magic, sizeof(magic)) ||
+        memcmp(magic, checkpointMagic, sizeof(magic)) != 0 ||
+        !Read(&version) || version != checkpointVersion ||
+        !Read(&configLength) || offset + configLength > data.size()) {
+        Warning("%s: not a valid checkpoint; starting from the beginning",
+                filename.c_str());
+        return false;
+    }
+    std::string savedConfig(&data[offset], configLength);
+    offset += configLength;
+    if (savedConfig != config) {
+        Warning("%s: checkpoint was written with different render settings "
+                "(\"%s\" vs. \"%s\"); starting from the beginning",
+                filename.c_str(), savedConfig.c_str(), config.c_str());
+        return false;
+    }
+    return true;
+}
+
+// TileCheckpoint Method Definitions
+TileCheckpoint::TileCheckpoint(Film *film, int nTiles,
+                               const std::string &config)
+    : film(film), tileDone(nTiles, 0) {
+    if (PbrtOptions.checkpointInterval == 0 && !PbrtOptions.resume) return;
+    if (film->streaming) {
+        Warning("Checkpointing isn't supported with streaming films");
+        return;
+    }
+    std::string filename = CheckpointFilename(film->filename);
+    std::string fullConfig = StringPrintf(
+        "%s film %d %d %d %d %d %d", config.c_str(), film->fullResolution.x,
+        film->fullResolution.y, film->croppedPixelBounds.pMin.x,
+        film->croppedPixelBounds.pMin.y, film->croppedPixelBounds.pMax.x,
+        film->croppedPixelBounds.pMax.y);
+
+    CheckpointReader reader;
+    if (PbrtOptions.resume && reader.Open(filename, fullConfig)) {
+        // Restore finished tiles and film sums from checkpoint
+        std::vector<char> savedDone(nTiles);
+        uint64_t nSums;
+        std::vector<Float> sums;
+        bool ok = reader.Read(&savedDone[0], nTiles) && reader.Read(&nSums);
+        if (ok) {
+            sums.resize(nSums);
+            ok = reader.Read(&sums[0], nSums) && reader.AtEnd() &&
+                 film->SetPixelSums(sums);
+        }
+        if (ok) {
+            tileDone = savedDone;
+            int nDone = std::count(tileDone.begin(), tileDone.end(), 1);
+            LOG(INFO) << "Resuming from " << filename << " with " << nDone
+                      << " of " << nTiles << " tiles done";
+            if (!PbrtOptions.quiet)
+                printf("Resuming render: %d of %d tiles already done\n", nDone,
+                       nTiles);
+        } else
+            Warning("%s: truncated checkpoint; starting from the beginning",
+                    filename.c_str());
+    }
+    writer.reset(new CheckpointWriter(filename, fullConfig,
+                                      PbrtOptions.checkpointInterval));
+}
+
+int TileCheckpoint::BatchSize(int nTiles) const {
+    // Render all tiles at once unless checkpoints are written; otherwise
+    // use batches large enough to keep all threads busy
+    if (!writer || PbrtOptions.checkpointInterval == 0) return nTiles;
+    return std::max(16, 4 * MaxThreadIndex());
+}
+
+void TileCheckpoint::EndBatch() {
+    if (writer && writer->Due()) Save();
+}
+
+void TileCheckpoint::Finish() {
+    if (writer) writer->Finish();
+}
+
+void TileCheckpoint::Save() {
+    std::vector<char> data = writer->StartCheckpoint();
+    CheckpointAppend(&data, &tileDone[0], tileDone.size());
+    std::vector<Float> sums;
+    film->GetPixelSums(&sums);
+    uint64_t nSums = sums.size();
+    CheckpointAppend(&data, &nSums);
+    CheckpointAppend(&data, &sums[0], sums.size());
+    writer->Write(std::move(data));
+}
+
+}  // namespace pbrt
@@ -0,0 +1,137 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_CORE_CHECKPOINT_H
+#define PBRT_CORE_CHECKPOINT_H
+
+// core/checkpoint.h*
+#include "pbrt.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace pbrt {
+
+// Checkpoint Declarations
+std::string CheckpointFilename(const std::string &imageFilename);
+
+// CheckpointWriter saves render state to disk from a background thread so
+// that rendering only pays for copying the state into a buffer. Each
+// checkpoint starts with a header that records _config_, a description of
+// the render settings that must match for the checkpoint to be resumed.
+class CheckpointWriter {
+  public:
+    // CheckpointWriter Public Methods
+    CheckpointWriter(const std::string &filename, const std::string &config,
+                     Float intervalSeconds);
+    ~CheckpointWriter();
+    bool Due() const;
+    std::vector<char> StartCheckpoint() const;
+    void Write(std::vector<char> data);
+    void Finish();
+
+  private:
+    // CheckpointWriter Private Methods
+    void WriterThread();
+
+    // CheckpointWriter Private Data
+    const std::string filename, config;
+    const std::chrono::duration<double> interval;
+    std::chrono::steady_clock::time_point lastWrite;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<char> pending;
+    bool hasPending = false, shutdown = false;
+    std::thread thread;
+};
+
+// CheckpointReader reads back the values written to a checkpoint in the
+// order that they were appended with _CheckpointAppend()_.
+class CheckpointReader {
+  public:
+    // CheckpointReader Public Methods
+    bool Open(const std::string &filename, const std::string &config);
+    template <typename T>
+    bool Read(T *v, size_t count = 1) {
+        size_t size = count * sizeof(T);
+        if (offset + size > data.size()) return false;
+        memcpy(v, &data[offset], size);
+        offset += size;
+        return true;
+    }
+    bool AtEnd() const { return offset == data.size(); }
+
+  private:
+    // CheckpointReader Private Data
+    std::vector<char> data;
+    size_t offset = 0;
+};
+
+template <typename T>
+void CheckpointAppend(std::vector<char> *data, const T *v, size_t count = 1) {
+    size_t offset = data->size(), size = count * sizeof(T);
+    data->resize(offset + size);
+    memcpy(&(*data)[offset], v, size);
+}
+
+// TileCheckpoint records which image tiles a tile-based integrator has
+// finished; tiles are rendered in batches, and between batches the set of
+// finished tiles is saved along with the film's pixel sums.
+class TileCheckpoint {
+  public:
+    // TileCheckpoint Public Methods
+    TileCheckpoint(Film *film, int nTiles, const std::string &config);
+    int BatchSize(int nTiles) const;
+    bool IsTileDone(int tile) const { return tileDone[tile] != 0; }
+    void TileDone(int tile) { tileDone[tile] = 1; }
+    void EndBatch();
+    void Finish();
+
+  private:
+    // TileCheckpoint Private Methods
+    void Save();
+
+    // TileCheckpoint Private Data
+    Film *film;
+    std::vector<char> tileDone;
+    std::unique_ptr<CheckpointWriter> writer;
+};
+
+}  // namespace pbrt
+
+#endif  // PBRT_CORE_CHECKPOINT_H
@@ -35,20 +35,24 @@
 #include "film.h"
 #include "paramset.h"
 #include "imageio.h"
+#include "fileutil.h"
 #include "stats.h"
 
 namespace pbrt {
 
 STAT_MEMORY_COUNTER("Memory/Film pixels", filmPixelMemory);
+STAT_INT_DISTRIBUTION("Film/Resident streaming film rows", residentFilmRows);
 
 // Film Method Definitions
 Film::Film(const Point2i &resolution, const Bounds2f &cropWindow,
            std::unique_ptr<Filter> filt, Float diagonal,
-           const std::string &filename, Float scale, Float maxSampleLuminance)
+           const std::string &filename, Float scale, Float maxSampleLuminance,
+           bool threadSplats, bool streaming)
     : fullResolution(resolution),
       diagonal(diagonal * .001),
       filter(std::move(filt)),
       filename(filename),
+      streaming(streaming),
       scale(scale),
       maxSampleLuminance(maxSampleLuminance) {
     // Compute film image bounds
@@ -62,8 +66,27 @@ Film::Film(const Point2i &resolution, const Bounds2f &cropWindow,
         croppedPixelBounds;
 
     // Allocate film image storage
-    pixels = std::unique_ptr<Pixel[]>(new Pixel[croppedPixelBounds.Area()]);
-    filmPixelMemory += croppedPixelBounds.Area() * sizeof(Pixel);
+    if (streaming) {
+        // Rows are allocated on demand; start the output file now
+        Bounds2i sampleBounds = GetSampleBounds();
+        sampleRowWidthMerged.resize(
+            std::max(0, sampleBounds.pMax.y - sampleBounds.pMin.y), 0);
+        nextRowToWrite = croppedPixelBounds.pMin.y;
+        streamWriter.reset(new ScanlineEXRWriter(filename, croppedPixelBounds,
+                                                 fullResolution));
+    } else {
+        pixels =
+            std::unique_ptr<Pixel[]>(new Pixel[croppedPixelBounds.Area()]);
+        filmPixelMemory += croppedPixelBounds.Area() * sizeof(Pixel);
+    }
+
+    // Allocate locks for tile merging and slots for per-thread splats
+    Vector2i extent = croppedPixelBounds.Diagonal();
+    nMergeCells = Point2i((extent.x + mergeCellSize - 1) / mergeCellSize,
+                          (extent.y + mergeCellSize - 1) / mergeCellSize);
+    mergeMutexes = std::unique_ptr<std::mutex[]>(
+        new std::mutex[std::max(1, nMergeCells.x * nMergeCells.y)]);
+    if (threadSplats && !streaming) threadSplatXYZ.resize(MaxThreadIndex());
 
     // Precompute filter weight table
     int offset = 0;
@@ -77,6 +100,8 @@ Film::Film(const Point2i &resolution, const Bounds2f &cropWindow,
     }
 }
 
+Film::~Film() {}
+
 Bounds2i Film::GetSampleBounds() const {
     Bounds2f floatBounds(Floor(Point2f(croppedPixelBounds.pMin) +
                                Vector2f(0.5f, 0.5f) - filter->radius),
@@ -100,24 +125,76 @@ std::unique_ptr<FilmTile> Film::GetFilmTile(const Bounds2i &sampleBounds) {
     Point2i p1 = (Point2i)Floor(floatBounds.pMax - halfPixel + filter->radius) +
                  Point2i(1, 1);
     Bounds2i tilePixelBounds = Intersect(Bounds2i(p0, p1), croppedPixelBounds);
-    return std::unique_ptr<FilmTile>(new FilmTile(
+    std::unique_ptr<FilmTile> tile(new FilmTile(
         tilePixelBounds, filter->radius, filterTable, filterTableWidth,
         maxSampleLuminance));
+    tile->sampleBounds = Intersect(sampleBounds, GetSampleBounds());
+    return tile;
 }
 
 void Film::Clear() {
+    CHECK(!streaming) << "Streaming films can't be cleared";
     for (Point2i p : croppedPixelBounds) {
         Pixel &pixel = GetPixel(p);
         for (int c = 0; c < 3; ++c)
             pixel.splatXYZ[c] = pixel.xyz[c] = 0;
         pixel.filterWeightSum = 0;
     }
+    for (std::unique_ptr<Float[]> &splatXYZ : threadSplatXYZ)
+        splatXYZ.reset();
 }
 
 void Film::MergeFilmTile(std::unique_ptr<FilmTile> tile) {
     ProfilePhase p(Prof::MergeFilmTile);
     VLOG(1) << "Merging film tile " << tile->pixelBounds;
-    std::lock_guard<std::mutex> lock(mutex);
+    const Bounds2i &bounds = tile->pixelBounds;
+    if (streaming) {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        for (int y = bounds.pMin.y; y < bounds.pMax.y; ++y) {
+            Pixel *row = GetStreamRow(y);
+            for (int x = bounds.pMin.x; x < bounds.pMax.x; ++x) {
+                // Merge tile pixel into its resident film row
+                const FilmTilePixel &tilePixel = tile->GetPixel(Point2i(x, y));
+                Pixel &mergePixel = row[x - croppedPixelBounds.pMin.x];
+                Float xyz[3];
+                tilePixel.contribSum.ToXYZ(xyz);
+                for (int i = 0; i < 3; ++i) mergePixel.xyz[i] += xyz[i];
+                mergePixel.filterWeightSum += tilePixel.filterWeightSum;
+            }
+        }
+        ReportValue(residentFilmRows, residentRows.size());
+
+        // Record the sample rows covered by _tile_ and write finished rows;
+        // rows are only complete if the merged tiles partition the sample
+        // bounds, so catch tiles that overlap or are merged more than once
+        Bounds2i sampleBounds = GetSampleBounds();
+        int sampleWidth = sampleBounds.pMax.x - sampleBounds.pMin.x;
+        const Bounds2i &sb = tile->sampleBounds;
+        for (int y = sb.pMin.y; y < sb.pMax.y; ++y) {
+            int &merged = sampleRowWidthMerged[y - sampleBounds.pMin.y];
+            merged += sb.pMax.x - sb.pMin.x;
+            CHECK_LE(merged, sampleWidth)
+                << "Streaming film merged sample row " << y
+                << " more than once; tiles must partition the sample bounds "
+                   "and each be merged once";
+        }
+        RetireStreamRows(false);
+        return;
+    }
+    if (bounds.pMin.x >= bounds.pMax.x || bounds.pMin.y >= bounds.pMax.y)
+        return;
+
+    // Lock the merge cells that the tile overlaps, in scanline order
+    int cx0 = (bounds.pMin.x - croppedPixelBounds.pMin.x) / mergeCellSize;
+    int cx1 = (bounds.pMax.x - 1 - croppedPixelBounds.pMin.x) / mergeCellSize;
+    int cy0 = (bounds.pMin.y - croppedPixelBounds.pMin.y) / mergeCellSize;
+    int cy1 = (bounds.pMax.y - 1 - croppedPixelBounds.pMin.y) / mergeCellSize;
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve((cx1 - cx0 + 1) * (cy1 - cy0 + 1));
+    for (int cy = cy0; cy <= cy1; ++cy)
+        for (int cx = cx0; cx <= cx1; ++cx)
+            locks.emplace_back(mergeMutexes[cy * nMergeCells.x + cx]);
+
     for (Point2i pixel : tile->GetPixelBounds()) {
         // Merge _pixel_ into _Film::pixels_
         const FilmTilePixel &tilePixel = tile->GetPixel(pixel);
@@ -129,7 +206,42 @@ void Film::MergeFilmTile(std::unique_ptr<FilmTile> tile) {
     }
 }
 
+Film::Pixel *Film::GetStreamRow(int y) {
+    std::unique_ptr<Pixel[]> &row = residentRows[y];
+    if (!row)
+        row.reset(
+            new Pixel[croppedPixelBounds.pMax.x - croppedPixelBounds.pMin.x]);
+    return row.get();
+}
+
+void Film::RetireStreamRows(bool flush) {
+    // Find the number of leading sample rows whose tiles have all merged
+    Bounds2i sampleBounds = GetSampleBounds();
+    int sampleWidth = sampleBounds.pMax.x - sampleBounds.pMin.x;
+    while (completeSampleRows < (int)sampleRowWidthMerged.size() &&
+           sampleRowWidthMerged[completeSampleRows] == sampleWidth)
+        ++completeSampleRows;
+
+    // Write pixel rows that no pending sample can contribute to
+    int width = croppedPixelBounds.pMax.x - croppedPixelBounds.pMin.x;
+    std::unique_ptr<Float[]> rgb;
+    while (nextRowToWrite < croppedPixelBounds.pMax.y) {
+        int lastSampleRow =
+            std::min((int)std::floor(nextRowToWrite + 0.5f + filter->radius.y),
+                     sampleBounds.pMax.y - 1);
+        if (!flush && lastSampleRow >= sampleBounds.pMin.y + completeSampleRows)
+            break;
+        if (!rgb) rgb.reset(new Float[3 * width]);
+        const Pixel *row = GetStreamRow(nextRowToWrite);
+        for (int x = 0; x < width; ++x) ComputeRGB(row[x], 1, &rgb[3 * x]);
+        streamWriter->WriteScanline(rgb.get());
+        residentRows.erase(nextRowToWrite);
+        ++nextRowToWrite;
+    }
+}
+
 void Film::SetImage(const Spectrum *img) const {
+    CHECK(!streaming) << "Streaming films don't support SetImage()";
     int nPixels = croppedPixelBounds.Area();
     for (int i = 0; i < nPixels; ++i) {
         Pixel &p = pixels[i];
@@ -137,10 +249,17 @@ void Film::SetImage(const Spectrum *img) const {
         p.filterWeightSum = 1;
         p.splatXYZ[0] = p.splatXYZ[1] = p.splatXYZ[2] = 0;
     }
+    for (const std::unique_ptr<Float[]> &splatXYZ : threadSplatXYZ)
+        if (splatXYZ)
+            for (int i = 0; i < 3 * nPixels; ++i) splatXYZ[i] = 0;
 }
 
 void Film::AddSplat(const Point2f &p, Spectrum v) {
     ProfilePhase pp(Prof::SplatFilm);
+    if (streaming) {
+        LOG_FIRST_N(ERROR, 1) << "Ignoring splats on streaming film";
+        return;
+    }
 
     if (v.HasNaNs()) {
         LOG(ERROR) << StringPrintf("Ignoring splatted spectrum with NaN values "
@@ -162,45 +281,199 @@ void Film::AddSplat(const Point2f &p, Spectrum v) {
         v *= maxSampleLuminance / v.y();
     Float xyz[3];
     v.ToXYZ(xyz);
-    Pixel &pixel = GetPixel(pi);
-    for (int i = 0; i < 3; ++i) pixel.splatXYZ[i].Add(xyz[i]);
+    if (ThreadIndex < (int)threadSplatXYZ.size()) {
+        // Accumulate splat in the calling thread's private buffer
+        std::unique_ptr<Float[]> &splatXYZ = threadSplatXYZ[ThreadIndex];
+        if (!splatXYZ) {
+            int nPixels = croppedPixelBounds.Area();
+            splatXYZ.reset(new Float[3 * nPixels]());
+            filmPixelMemory += 3 * nPixels * sizeof(Float);
+        }
+        Float *s = &splatXYZ[3 * PixelOffset(pi)];
+        for (int i = 0; i < 3; ++i) s[i] += xyz[i];
+    } else {
+        Pixel &pixel = GetPixel(pi);
+        for (int i = 0; i < 3; ++i) pixel.splatXYZ[i].Add(xyz[i]);
+    }
+}
+
+void Film::MergeSplats() {
+    // Reduce per-thread splat buffers into _Film::pixels_
+    int nPixels = croppedPixelBounds.Area();
+    for (std::unique_ptr<Float[]> &splatXYZ : threadSplatXYZ) {
+        if (!splatXYZ) continue;
+        for (int i = 0; i < nPixels; ++i) {
+            Pixel &pixel = pixels[i];
+            for (int c = 0; c < 3; ++c) {
+                pixel.splatXYZ[c].Add(splatXYZ[3 * i + c]);
+                splatXYZ[3 * i + c] = 0;
+            }
+        }
+    }
+}
+
+// Film Local Definitions
+static void PixelToRGB(const Float xyz[3], Float filterWeightSum,
+                       const Float splatXYZ[3], Float splatScale, Float scale,
+                       Float rgb[3]) {
+    // Convert pixel XYZ color to RGB
+    XYZToRGB(xyz, rgb);
+
+    // Normalize pixel with weight sum
+    if (filterWeightSum != 0) {
+        Float invWt = (Float)1 / filterWeightSum;
+        rgb[0] = std::max((Float)0, rgb[0] * invWt);
+        rgb[1] = std::max((Float)0, rgb[1] * invWt);
+        rgb[2] = std::max((Float)0, rgb[2] * invWt);
+    }
+
+    // Add splat value at pixel
+    Float splatRGB[3];
+    XYZToRGB(splatXYZ, splatRGB);
+    rgb[0] += splatScale * splatRGB[0];
+    rgb[1] += splatScale * splatRGB[1];
+    rgb[2] += splatScale * splatRGB[2];
+
+    // Scale pixel value by _scale_
+    rgb[0] *= scale;
+    rgb[1] *= scale;
+    rgb[2] *= scale;
+}
+
+// Partial films hold the raw pixel sums computed by one node of a
+// distributed render; they are combined by _MergePartialFilms()_.
+static const char partialFilmMagic[8] = {'P', 'B', 'R', 'T', 'F', 'I', 'L', 'M'};
+static PBRT_CONSTEXPR uint32_t partialFilmVersion = 2;
+static PBRT_CONSTEXPR int partialFilmPixelValues = 7;
+
+struct PartialFilmHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t nodeIndex, nodeCount;
+    int32_t fullResolution[2];
+    int32_t pixelBounds[4];
+    double scale, splatScale;
+    uint32_t filenameLength;
+};
+
+void Film::ComputeRGB(const Pixel &pixel, Float splatScale,
+                      Float rgb[3]) const {
+    Float splatXYZ[3] = {pixel.splatXYZ[0], pixel.splatXYZ[1],
+                         pixel.splatXYZ[2]};
+    PixelToRGB(pixel.xyz, pixel.filterWeightSum, splatXYZ, splatScale, scale,
+               rgb);
+}
+
+void Film::WritePartialImage(Float splatScale) {
+    std::string partialName =
+        StringPrintf("%s.%d-of-%d.film", filename.c_str(),
+                     PbrtOptions.nodeIndex, PbrtOptions.nodeCount);
+    LOG(INFO) << "Writing partial film " << partialName;
+    FILE *f = fopen(partialName.c_str(), "wb");
+    if (!f) {
+        Error("%s: unable to open partial film for writing",
+              partialName.c_str());
+        return;
+    }
+
+    // Write partial film header and final image filename
+    PartialFilmHeader header;
+    memcpy(header.magic, partialFilmMagic, sizeof(header.magic));
+    header.version = partialFilmVersion;
+    header.nodeIndex = PbrtOptions.nodeIndex;
+    header.nodeCount = PbrtOptions.nodeCount;
+    header.fullResolution[0] = fullResolution.x;
+    header.fullResolution[1] = fullResolution.y;
+    header.pixelBounds[0] = croppedPixelBounds.pMin.x;
+    header.pixelBounds[1] = croppedPixelBounds.pMin.y;
+    header.pixelBounds[2] = croppedPixelBounds.pMax.x;
+    header.pixelBounds[3] = croppedPixelBounds.pMax.y;
+    header.scale = scale;
+    header.splatScale = splatScale;
+    header.filenameLength = filename.size();
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+              fwrite(filename.data(), 1, filename.size(), f) == filename.size();
+
+    // Write raw pixel sums in scanline order
+    int width = croppedPixelBounds.pMax.x - croppedPixelBounds.pMin.x;
+    std::vector<double> row(partialFilmPixelValues * width);
+    for (int y = croppedPixelBounds.pMin.y; ok && y < croppedPixelBounds.pMax.y;
+         ++y) {
+        for (int x = 0; x < width; ++x) {
+            const Pixel &pixel =
+                GetPixel(Point2i(croppedPixelBounds.pMin.x + x, y));
+            double *v = &row[partialFilmPixelValues * x];
+            for (int c = 0; c < 3; ++c) {
+                v[c] = pixel.xyz[c];
+                v[4 + c] = pixel.splatXYZ[c];
+            }
+            v[3] = pixel.filterWeightSum;
+        }
+        ok = fwrite(&row[0], sizeof(double), row.size(), f) == row.size();
+    }
+    if (fclose(f) != 0 || !ok)
+        Error("%s: error writing partial film", partialName.c_str());
+}
+
+// Returns the film's accumulated XYZ, filter weight and splat sums,
+// _partialFilmPixelValues_ per pixel in scanline order; used to checkpoint
+// renders that are still in progress.
+void Film::GetPixelSums(std::vector<Float> *sums) {
+    CHECK(!streaming) << "Streaming films don't keep all pixels";
+    MergeSplats();
+    int nPixels = croppedPixelBounds.Area();
+    sums->resize(partialFilmPixelValues * nPixels);
+    for (int i = 0; i < nPixels; ++i) {
+        const Pixel &pixel = pixels[i];
+        Float *v = &(*sums)[partialFilmPixelValues * i];
+        for (int c = 0; c < 3; ++c) {
+            v[c] = pixel.xyz[c];
+            v[4 + c] = pixel.splatXYZ[c];
+        }
+        v[3] = pixel.filterWeightSum;
+    }
+}
+
+bool Film::SetPixelSums(const std::vector<Float> &sums) {
+    CHECK(!streaming) << "Streaming films don't keep all pixels";
+    int nPixels = croppedPixelBounds.Area();
+    if (sums.size() != (size_t)partialFilmPixelValues * nPixels) return false;
+    Clear();
+    for (int i = 0; i < nPixels; ++i) {
+        Pixel &pixel = pixels[i];
+        const Float *v = &sums[partialFilmPixelValues * i];
+        for (int c = 0; c < 3; ++c) {
+            pixel.xyz[c] = v[c];
+            pixel.splatXYZ[c] = v[4 + c];
+        }
+        pixel.filterWeightSum = v[3];
+    }
+    return true;
 }
 
 void Film::WriteImage(Float splatScale) {
+    if (streaming) {
+        // Flush any rows that haven't been written yet and close the file
+        std::lock_guard<std::mutex> lock(streamMutex);
+        if (!streamWriter) return;
+        LOG(INFO) << "Finishing streamed image " << filename;
+        RetireStreamRows(true);
+        streamWriter.reset();
+        return;
+    }
+    MergeSplats();
+    if (PbrtOptions.nodeCount > 1) {
+        WritePartialImage(splatScale);
+        return;
+    }
+
     // Convert image to RGB and compute final pixel values
     LOG(INFO) <<
         "Converting image to RGB and computing final weighted pixel values";
     std::unique_ptr<Float[]> rgb(new Float[3 * croppedPixelBounds.Area()]);
     int offset = 0;
     for (Point2i p : croppedPixelBounds) {
-        // Convert pixel XYZ color to RGB
-        Pixel &pixel = GetPixel(p);
-        XYZToRGB(pixel.xyz, &rgb[3 * offset]);
-
-        // Normalize pixel with weight sum
-        Float filterWeightSum = pixel.filterWeightSum;
-        if (filterWeightSum != 0) {
-            Float invWt = (Float)1 / filterWeightSum;
-            rgb[3 * offset] = std::max((Float)0, rgb[3 * offset] * invWt);
-            rgb[3 * offset + 1] =
-                std::max((Float)0, rgb[3 * offset + 1] * invWt);
-            rgb[3 * offset + 2] =
-                std::max((Float)0, rgb[3 * offset + 2] * invWt);
-        }
-
-        // Add splat value at pixel
-        Float splatRGB[3];
-        Float splatXYZ[3] = {pixel.splatXYZ[0], pixel.splatXYZ[1],
-                             pixel.splatXYZ[2]};
-        XYZToRGB(splatXYZ, splatRGB);
-        rgb[3 * offset] += splatScale * splatRGB[0];
-        rgb[3 * offset + 1] += splatScale * splatRGB[1];
-        rgb[3 * offset + 2] += splatScale * splatRGB[2];
-
-        // Scale pixel value by _scale_
-        rgb[3 * offset] *= scale;
-        rgb[3 * offset + 1] *= scale;
-        rgb[3 * offset + 2] *= scale;
+        ComputeRGB(GetPixel(p), splatScale, &rgb[3 * offset]);
         ++offset;
     }
 
@@ -247,8 +520,132 @@ Film *CreateFilm(const ParamSet &params, std::unique_ptr<Filter> filter) {
     Float diagonal = params.FindOneFloat("diagonal", 35.);
     Float maxSampleLuminance = params.FindOneFloat("maxsampleluminance",
                                                    Infinity);
+    bool threadSplats = params.FindOneBool("threadsplats", true);
+    bool streaming = params.FindOneBool("streaming", false);
+    if (streaming && PbrtOptions.nodeCount > 1) {
+        Warning("Streaming film output is disabled for distributed renders.");
+        streaming = false;
+    }
+    if (streaming && !HasExtension(filename, ".exr")) {
+        Warning("Streaming film output is only supported for OpenEXR "
+                "images; \"%s\" will be written at the end of rendering.",
+                filename.c_str());
+        streaming = false;
+    }
     return new Film(Point2i(xres, yres), crop, std::move(filter), diagonal,
-                    filename, scale, maxSampleLuminance);
+                    filename, scale, maxSampleLuminance, threadSplats,
+                    streaming);
+}
+
+bool MergePartialFilms(const std::vector<std::string> &filenames,
+                       const std::string &outFilename) {
+    if (filenames.empty()) return false;
+    PartialFilmHeader first;
+    std::string filename;
+    Bounds2i pixelBounds;
+    std::vector<double> sums;
+    std::vector<std::string> nodeFilenames;
+    for (size_t i = 0; i < filenames.size(); ++i) {
+        const char *name = filenames[i].c_str();
+        FILE *f = fopen(name, "rb");
+        if (!f) {
+            Error("%s: unable to open partial film", name);
+            return false;
+        }
+        // Read and validate partial film header
+        PartialFilmHeader header;
+        bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+                  memcmp(header.magic, partialFilmMagic,
+                         sizeof(header.magic)) == 0;
+        if (!ok || header.version != partialFilmVersion) {
+            Error("%s: not a pbrt partial film, or unsupported version", name);
+            fclose(f);
+            return false;
+        }
+        std::string headerFilename(header.filenameLength, ' ');
+        if (header.filenameLength > 0 &&
+            fread(&headerFilename[0], 1, header.filenameLength, f) !=
+                header.filenameLength) {
+            Error("%s: premature end of file", name);
+            fclose(f);
+            return false;
+        }
+        if (header.nodeCount < 1 || header.nodeIndex < 0 ||
+            header.nodeIndex >= header.nodeCount) {
+            Error("%s: invalid node %d of %d", name, header.nodeIndex,
+                  header.nodeCount);
+            fclose(f);
+            return false;
+        }
+        if (i == 0) {
+            first = header;
+            nodeFilenames.resize(header.nodeCount);
+            filename = headerFilename;
+            pixelBounds = Bounds2i(
+                Point2i(header.pixelBounds[0], header.pixelBounds[1]),
+                Point2i(header.pixelBounds[2], header.pixelBounds[3]));
+            sums.resize(partialFilmPixelValues * pixelBounds.Area(), 0.);
+        } else if (header.nodeCount != first.nodeCount) {
+            Error("%s: film is from a render split across %d nodes, but "
+                  "\"%s\" is from one split across %d", name,
+                  header.nodeCount, filenames[0].c_str(), first.nodeCount);
+            fclose(f);
+            return false;
+        } else if (memcmp(header.fullResolution, first.fullResolution,
+                          sizeof(header.fullResolution)) != 0 ||
+                   memcmp(header.pixelBounds, first.pixelBounds,
+                          sizeof(header.pixelBounds)) != 0 ||
+                   header.scale != first.scale ||
+                   header.splatScale != first.splatScale) {
+            Error("%s: film resolution, bounds or scale doesn't match \"%s\"",
+                  name, filenames[0].c_str());
+            fclose(f);
+            return false;
+        }
+
+        if (!nodeFilenames[header.nodeIndex].empty()) {
+            Error("%s: film is for node %d, as is \"%s\"", name,
+                  header.nodeIndex, nodeFilenames[header.nodeIndex].c_str());
+            fclose(f);
+            return false;
+        }
+        nodeFilenames[header.nodeIndex] = filenames[i];
+
+        // Accumulate this node's raw pixel sums
+        std::vector<double> values(sums.size());
+        if (fread(values.data(), sizeof(double), values.size(), f) !=
+            values.size()) {
+            Error("%s: premature end of file", name);
+            fclose(f);
+            return false;
+        }
+        fclose(f);
+        for (size_t j = 0; j < sums.size(); ++j) sums[j] += values[j];
+    }
+
+    // Make sure that every node's film was provided
+    for (int node = 0; node < first.nodeCount; ++node)
+        if (nodeFilenames[node].empty()) {
+            Error("Partial film for node %d of %d is missing", node,
+                  first.nodeCount);
+            return false;
+        }
+
+    // Compute final pixel values and write the merged image
+    std::unique_ptr<Float[]> rgb(new Float[3 * pixelBounds.Area()]);
+    for (int i = 0; i < pixelBounds.Area(); ++i) {
+        const double *v = &sums[partialFilmPixelValues * i];
+        Float xyz[3] = {(Float)v[0], (Float)v[1], (Float)v[2]};
+        Float splatXYZ[3] = {(Float)v[4], (Float)v[5], (Float)v[6]};
+        PixelToRGB(xyz, v[3], splatXYZ, first.splatScale, first.scale,
+                   &rgb[3 * i]);
+    }
+    std::string out = outFilename.empty() ? filename : outFilename;
+    LOG(INFO) << "Writing merged image " << out << " with bounds " <<
+        pixelBounds;
+    pbrt::WriteImage(out, &rgb[0], pixelBounds,
+                     Point2i(first.fullResolution[0], first.fullResolution[1]));
+    return true;
 }
 
 }  // namespace pbrt
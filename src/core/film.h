@@ -45,12 +45,21 @@
 #include "filter.h"
 #include "stats.h"
 #include "parallel.h"
+#include <map>
 
 namespace pbrt {
 
+class ScanlineEXRWriter;
+
 // FilmTilePixel Declarations
 struct FilmTilePixel {
+#ifdef PBRT_HERO_SPECTRUM
+    // Samples are traced at different wavelengths, so their contributions
+    // can only be summed once they're converted to RGB
+    RGBSpectrum contribSum = 0.f;
+#else
     Spectrum contribSum = 0.f;
+#endif
     Float filterWeightSum = 0.f;
 };
 
@@ -61,13 +70,18 @@ class Film {
     Film(const Point2i &resolution, const Bounds2f &cropWindow,
          std::unique_ptr<Filter> filter, Float diagonal,
          const std::string &filename, Float scale,
-         Float maxSampleLuminance = Infinity);
+         Float maxSampleLuminance = Infinity, bool threadSplats = true,
+         bool streaming = false);
+    ~Film();
     Bounds2i GetSampleBounds() const;
     Bounds2f GetPhysicalExtent() const;
     std::unique_ptr<FilmTile> GetFilmTile(const Bounds2i &sampleBounds);
     void MergeFilmTile(std::unique_ptr<FilmTile> tile);
     void SetImage(const Spectrum *img) const;
     void AddSplat(const Point2f &p, Spectrum v);
+    void MergeSplats();
+    void GetPixelSums(std::vector<Float> *sums);
+    bool SetPixelSums(const std::vector<Float> &sums);
     void WriteImage(Float splatScale = 1);
     void Clear();
 
@@ -77,6 +91,10 @@ class Film {
     std::unique_ptr<Filter> filter;
     const std::string filename;
     Bounds2i croppedPixelBounds;
+    // In streaming mode only a window of pixel rows is kept in memory;
+    // rows are written to _filename_ once all tiles that contribute to
+    // them have been merged, and splats aren't supported.
+    const bool streaming;
 
   private:
     // Film Private Data
@@ -90,18 +108,38 @@ class Film {
     std::unique_ptr<Pixel[]> pixels;
     static PBRT_CONSTEXPR int filterTableWidth = 16;
     Float filterTable[filterTableWidth * filterTableWidth];
-    std::mutex mutex;
+    // Tiles are merged holding only the locks of the _mergeCellSize_^2
+    // pixel cells they overlap, so that disjoint tiles never contend.
+    static PBRT_CONSTEXPR int mergeCellSize = 32;
+    Point2i nMergeCells;
+    std::unique_ptr<std::mutex[]> mergeMutexes;
+    // Splats are accumulated into lazily-allocated per-thread XYZ buffers
+    // (indexed by _ThreadIndex_) and reduced by _MergeSplats()_.
+    std::vector<std::unique_ptr<Float[]>> threadSplatXYZ;
     const Float scale;
     const Float maxSampleLuminance;
+    // Streaming-mode state, protected by _streamMutex_
+    std::mutex streamMutex;
+    std::map<int, std::unique_ptr<Pixel[]>> residentRows;
+    // Width of each sample row covered by merged tiles; a row is complete
+    // once it reaches the sample bounds' width, which relies on each tile
+    // being merged exactly once
+    std::vector<int> sampleRowWidthMerged;
+    int completeSampleRows = 0, nextRowToWrite;
+    std::unique_ptr<ScanlineEXRWriter> streamWriter;
 
     // Film Private Methods
-    Pixel &GetPixel(const Point2i &p) {
+    int PixelOffset(const Point2i &p) const {
         CHECK(InsideExclusive(p, croppedPixelBounds));
         int width = croppedPixelBounds.pMax.x - croppedPixelBounds.pMin.x;
-        int offset = (p.x - croppedPixelBounds.pMin.x) +
-                     (p.y - croppedPixelBounds.pMin.y) * width;
-        return pixels[offset];
+        return (p.x - croppedPixelBounds.pMin.x) +
+               (p.y - croppedPixelBounds.pMin.y) * width;
     }
+    Pixel &GetPixel(const Point2i &p) { return pixels[PixelOffset(p)]; }
+    void ComputeRGB(const Pixel &pixel, Float splatScale, Float rgb[3]) const;
+    Pixel *GetStreamRow(int y);
+    void RetireStreamRows(bool flush);
+    void WritePartialImage(Float splatScale);
 };
 
 class FilmTile {
@@ -123,6 +161,11 @@ class FilmTile {
         ProfilePhase _(Prof::AddFilmSample);
         if (L.y() > maxSampleLuminance)
             L *= maxSampleLuminance / L.y();
+#ifdef PBRT_HERO_SPECTRUM
+        RGBSpectrum contrib = L.ToRGBSpectrum() * sampleWeight;
+#else
+        Spectrum contrib = L * sampleWeight;
+#endif
         // Compute sample's raster bounds
         Point2f pFilmDiscrete = pFilm - Vector2f(0.5f, 0.5f);
         Point2i p0 = (Point2i)Ceil(pFilmDiscrete - filterRadius);
@@ -154,7 +197,7 @@ class FilmTile {
 
                 // Update pixel values with filtered sample contribution
                 FilmTilePixel &pixel = GetPixel(Point2i(x, y));
-                pixel.contribSum += L * sampleWeight * filterWeight;
+                pixel.contribSum += contrib * filterWeight;
                 pixel.filterWeightSum += filterWeight;
             }
         }
@@ -178,6 +221,7 @@ class FilmTile {
   private:
     // FilmTile Private Data
     const Bounds2i pixelBounds;
+    Bounds2i sampleBounds;
     const Vector2f filterRadius, invFilterRadius;
     const Float *filterTable;
     const int filterTableSize;
@@ -187,6 +231,8 @@ class FilmTile {
 };
 
 Film *CreateFilm(const ParamSet &params, std::unique_ptr<Filter> filter);
+bool MergePartialFilms(const std::vector<std::string> &filenames,
+                       const std::string &outFilename);
 
 }  // namespace pbrt
 
@@ -188,6 +188,63 @@ static void WriteImageEXR(const std::string &name, const Float *pixels,
     delete[] hrgba;
 }
 
+// ScanlineEXRWriter Method Definitions
+struct ScanlineEXRWriter::EXRFile {
+    EXRFile(const std::string &name, const Imath::Box2i &displayWindow,
+            const Imath::Box2i &dataWindow, int width)
+        : file(name.c_str(), displayWindow, dataWindow, Imf::WRITE_RGB),
+          scanline(width) {}
+    Imf::RgbaOutputFile file;
+    std::vector<Imf::Rgba> scanline;
+};
+
+ScanlineEXRWriter::ScanlineEXRWriter(const std::string &name,
+                                     const Bounds2i &outputBounds,
+                                     const Point2i &totalResolution)
+    : name(name), outputBounds(outputBounds) {
+    using namespace Imath;
+    // OpenEXR uses inclusive pixel bounds.
+    Box2i displayWindow(V2i(0, 0),
+                        V2i(totalResolution.x - 1, totalResolution.y - 1));
+    Box2i dataWindow(V2i(outputBounds.pMin.x, outputBounds.pMin.y),
+                     V2i(outputBounds.pMax.x - 1, outputBounds.pMax.y - 1));
+    try {
+        file.reset(new EXRFile(name, displayWindow, dataWindow,
+                               outputBounds.pMax.x - outputBounds.pMin.x));
+    } catch (const std::exception &exc) {
+        Error("Error opening \"%s\" for writing: %s", name.c_str(),
+              exc.what());
+    }
+}
+
+ScanlineEXRWriter::~ScanlineEXRWriter() {
+    int height = outputBounds.pMax.y - outputBounds.pMin.y;
+    if (file && nWritten < height)
+        Warning("Only %d of %d scanlines of \"%s\" were written.", nWritten,
+                height, name.c_str());
+}
+
+bool ScanlineEXRWriter::WriteScanline(const Float *rgb) {
+    if (!file) return false;
+    int width = outputBounds.pMax.x - outputBounds.pMin.x;
+    int y = outputBounds.pMin.y + nWritten;
+    CHECK_LT(y, outputBounds.pMax.y);
+    for (int x = 0; x < width; ++x)
+        file->scanline[x] =
+            Imf::Rgba(rgb[3 * x], rgb[3 * x + 1], rgb[3 * x + 2]);
+    try {
+        file->file.setFrameBuffer(
+            &file->scanline[0] - outputBounds.pMin.x - y * width, 1, width);
+        file->file.writePixels(1);
+    } catch (const std::exception &exc) {
+        Error("Error writing \"%s\": %s", name.c_str(), exc.what());
+        file.reset();
+        return false;
+    }
+    ++nWritten;
+    return true;
+}
+
 // TGA Function Definitions
 void WriteImageTGA(const std::string &name, const uint8_t *pixels, int xRes,
                    int yRes, int totalXRes, int totalYRes, int xOffset,
@@ -55,6 +55,26 @@ RGBSpectrum *ReadImageEXR(const std::string &name, int *width,
 void WriteImage(const std::string &name, const Float *rgb,
                 const Bounds2i &outputBounds, const Point2i &totalResolution);
 
+// Writes an OpenEXR image incrementally, one scanline at a time in
+// increasing $y$ order, so that the full image never needs to be resident.
+class ScanlineEXRWriter {
+  public:
+    // ScanlineEXRWriter Public Methods
+    ScanlineEXRWriter(const std::string &name, const Bounds2i &outputBounds,
+                      const Point2i &totalResolution);
+    ~ScanlineEXRWriter();
+    bool WriteScanline(const Float *rgb);
+    int ScanlinesWritten() const { return nWritten; }
+
+  private:
+    // ScanlineEXRWriter Private Data
+    struct EXRFile;
+    std::unique_ptr<EXRFile> file;
+    const std::string name;
+    const Bounds2i outputBounds;
+    int nWritten = 0;
+};
+
 }  // namespace pbrt
 
 #endif  // PBRT_CORE_IMAGEIO_H
@@ -33,11 +33,13 @@
 // core/integrator.cpp*
 #include <fstream>
 #include "integrator.h"
+#include "lightdistrib.h"
 #include "scene.h"
 #include "interaction.h"
 #include "sampling.h"
 #include "parallel.h"
 #include "film.h"
+#include "checkpoint.h"
 #include "sampler.h"
 #include "integrator.h"
 #include "progressreporter.h"
@@ -67,10 +69,10 @@ Spectrum UniformSampleAllLights(const Interaction &it, const Scene &scene,
         const Point2f *uScatteringArray = sampler.Get2DArray(nSamples);
         if (!uLightArray || !uScatteringArray) {
             // Use a single sample for illumination from _light_
-            Point2f uLight = sampler.Get2D();
-            Point2f uScattering = sampler.Get2D();
-            L += EstimateDirect(it, uScattering, *light, uLight, scene, sampler,
-                                arena, handleMedia);
+            Point2f u[2];
+            sampler.Get2DBatch(2, u);
+            L += EstimateDirect(it, u[1], *light, u[0], scene, sampler, arena,
+                                handleMedia);
         } else {
             // Estimate direct lighting using sample arrays
             Spectrum Ld(0.f);
@@ -101,10 +103,30 @@ Spectrum UniformSampleOneLight(const Interaction &it, const Scene &scene,
         lightPdf = Float(1) / nLights;
     }
     const std::shared_ptr<Light> &light = scene.lights[lightNum];
-    Point2f uLight = sampler.Get2D();
-    Point2f uScattering = sampler.Get2D();
-    return EstimateDirect(it, uScattering, *light, uLight,
-                          scene, sampler, arena, handleMedia) / lightPdf;
+    // Get the light and scattering samples together
+    Point2f u[2];
+    sampler.Get2DBatch(2, u);
+    return EstimateDirect(it, u[1], *light, u[0], scene, sampler, arena,
+                          handleMedia) / lightPdf;
+}
+
+Spectrum UniformSampleOneLight(const Interaction &it, const Scene &scene,
+                               MemoryArena &arena, Sampler &sampler,
+                               bool handleMedia,
+                               const LightDistribution &lightDistrib) {
+    ProfilePhase p(Prof::DirectLighting);
+    // Choose a single light to sample for the point, _light_
+    if (scene.lights.empty()) return Spectrum(0.f);
+    Float lightPdf;
+    int lightNum =
+        lightDistrib.Sample(it.p, it.n, sampler.Get1D(), &lightPdf);
+    if (lightNum < 0 || lightPdf == 0) return Spectrum(0.f);
+    const std::shared_ptr<Light> &light = scene.lights[lightNum];
+    // Get the light and scattering samples together
+    Point2f u[2];
+    sampler.Get2DBatch(2, u);
+    return EstimateDirect(it, u[1], *light, u[0], scene, sampler, arena,
+                          handleMedia) / lightPdf;
 }
 
 Spectrum EstimateDirect(const Interaction &it, const Point2f &uScattering,
@@ -216,14 +238,98 @@ Spectrum EstimateDirect(const Interaction &it, const Point2f &uScattering,
     return Ld;
 }
 
+Spectrum LightSampleContribution(const Interaction &it, const Scene &scene,
+                                 int lightIndex, const Point2f &uLight,
+                                 VisibilityTester *vis) {
+    // Return the unshadowed contribution of the light sample divided by
+    // its density
+    const Light &light = *scene.lights[lightIndex];
+    Vector3f wi;
+    Float lightPdf = 0;
+    Spectrum Li = light.Sample_Li(it, uLight, &wi, &lightPdf, vis);
+    if (lightPdf == 0 || Li.IsBlack()) return Spectrum(0.f);
+    Spectrum f;
+    if (it.IsSurfaceInteraction()) {
+        const SurfaceInteraction &isect = (const SurfaceInteraction &)it;
+        f = isect.bsdf->f(isect.wo, wi, BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) *
+            AbsDot(wi, isect.shading.n);
+    } else {
+        const MediumInteraction &mi = (const MediumInteraction &)it;
+        f = Spectrum(mi.phase->p(mi.wo, wi));
+    }
+    return f * Li / lightPdf;
+}
+
+void SampleLightCandidates(const Interaction &it, const Scene &scene,
+                           Sampler &sampler, int nCandidates,
+                           const Distribution1D *lightDistrib,
+                           LightReservoir *reservoir) {
+    // Choose among light samples in proportion to their unshadowed
+    // contributions, without tracing any rays
+    int nLights = int(scene.lights.size());
+    if (nLights == 0) return;
+    for (int i = 0; i < nCandidates; ++i) {
+        int lightNum;
+        Float lightPdf;
+        if (lightDistrib)
+            lightNum = lightDistrib->SampleDiscrete(sampler.Get1D(), &lightPdf);
+        else {
+            lightNum = std::min((int)(sampler.Get1D() * nLights), nLights - 1);
+            lightPdf = Float(1) / nLights;
+        }
+        Point2f uLight = sampler.Get2D();
+        Float pHat = 0;
+        if (lightPdf > 0) {
+            VisibilityTester vis;
+            pHat = std::max((Float)0, LightSampleContribution(
+                                          it, scene, lightNum, uLight, &vis)
+                                          .y());
+        }
+        reservoir->Add(lightNum, uLight, pHat,
+                       lightPdf > 0 ? pHat / lightPdf : 0, sampler.Get1D());
+    }
+}
+
+Spectrum ResampleOneLight(const Interaction &it, const Scene &scene,
+                          Sampler &sampler, int nCandidates, bool handleMedia,
+                          const Distribution1D *lightDistrib) {
+    ProfilePhase p(Prof::DirectLighting);
+    // Resample the candidates and trace a single shadow ray for the chosen
+    // one
+    LightReservoir reservoir;
+    SampleLightCandidates(it, scene, sampler, nCandidates, lightDistrib,
+                          &reservoir);
+    Float W = reservoir.Weight();
+    if (W == 0) return Spectrum(0.f);
+    VisibilityTester vis;
+    Spectrum Ld = LightSampleContribution(it, scene, reservoir.lightIndex,
+                                          reservoir.uLight, &vis);
+    if (Ld.IsBlack()) return Spectrum(0.f);
+    if (handleMedia)
+        Ld *= vis.Tr(scene, sampler);
+    else if (!vis.Unoccluded(scene))
+        return Spectrum(0.f);
+    return Ld * W;
+}
+
 std::unique_ptr<Distribution1D> ComputeLightPowerDistribution(
-    const Scene &scene) {
+    const Scene &scene, bool parallelBuild) {
     if (scene.lights.empty()) return nullptr;
     std::vector<Float> lightPower;
     for (const auto &light : scene.lights)
         lightPower.push_back(light->Power().y());
     return std::unique_ptr<Distribution1D>(
-        new Distribution1D(&lightPower[0], lightPower.size()));
+        new Distribution1D(&lightPower[0], lightPower.size(),
+                           PbrtOptions.aliasSampling, parallelBuild));
+}
+
+// Returns the range of tile indices [*begin, *end) rendered by this process;
+// all tiles unless the render is distributed over multiple nodes.
+void NodeTileRange(int nTiles, int *begin, int *end) {
+    int64_t nodeIndex = PbrtOptions.nodeIndex,
+            nodeCount = PbrtOptions.nodeCount;
+    *begin = nodeIndex * nTiles / nodeCount;
+    *end = (nodeIndex + 1) * nTiles / nodeCount;
 }
 
 // SamplerIntegrator Method Definitions
@@ -237,16 +343,30 @@ void SamplerIntegrator::Render(const Scene &scene) {
     const int tileSize = 16;
     Point2i nTiles((sampleExtent.x + tileSize - 1) / tileSize,
                    (sampleExtent.y + tileSize - 1) / tileSize);
-    ProgressReporter reporter(nTiles.x * nTiles.y, "Rendering");
-    {
-        ParallelFor2D([&](Point2i tile) {
+    int tileBegin, tileEnd;
+    NodeTileRange(nTiles.x * nTiles.y, &tileBegin, &tileEnd);
+    TileCheckpoint checkpoint(
+        camera->film, nTiles.x * nTiles.y,
+        StringPrintf("sampler spp %d", (int)sampler->samplesPerPixel));
+    ProgressReporter reporter(tileEnd - tileBegin, "Rendering");
+    ThreadArenaPool arenas;
+    // Render tiles in batches, checkpointing between them when requested
+    int batchSize = checkpoint.BatchSize(tileEnd - tileBegin);
+    for (int batchBegin = tileBegin; batchBegin < tileEnd;
+         batchBegin += batchSize) {
+        ParallelFor([&](int64_t i) {
             // Render section of image corresponding to _tile_
+            int seed = batchBegin + i;
+            if (checkpoint.IsTileDone(seed)) {
+                reporter.Update();
+                return;
+            }
+            Point2i tile(seed % nTiles.x, seed / nTiles.x);
 
-            // Allocate _MemoryArena_ for tile
-            MemoryArena arena;
+            // Get this thread's _MemoryArena_ for tile
+            MemoryArena &arena = arenas.Get();
 
             // Get sampler instance for tile
-            int seed = tile.y * nTiles.x + tile.x;
             std::unique_ptr<Sampler> tileSampler = sampler->Clone(seed);
 
             // Compute sample bounds for tile
@@ -279,6 +399,7 @@ void SamplerIntegrator::Render(const Scene &scene) {
                     // Initialize _CameraSample_ for current sample
                     CameraSample cameraSample =
                         tileSampler->GetCameraSample(pixel);
+                    SampleWavelengths(*tileSampler);
 
                     // Generate camera ray for current sample
                     RayDifferential ray;
@@ -341,14 +462,17 @@ void SamplerIntegrator::Render(const Scene &scene) {
 
             // Merge image tile into _Film_
             camera->film->MergeFilmTile(std::move(filmTile));
+            checkpoint.TileDone(seed);
             reporter.Update();
-        }, nTiles);
-        reporter.Done();
+        }, std::min(batchSize, tileEnd - batchBegin));
+        checkpoint.EndBatch();
     }
+    reporter.Done();
     LOG(INFO) << "Rendering finished";
 
     // Save final image after rendering
     camera->film->WriteImage();
+    checkpoint.Finish();
 }
 
 Spectrum SamplerIntegrator::SpecularReflect(
@@ -65,13 +65,82 @@ Spectrum UniformSampleOneLight(const Interaction &it, const Scene &scene,
                                MemoryArena &arena, Sampler &sampler,
                                bool handleMedia = false,
                                const Distribution1D *lightDistrib = nullptr);
+Spectrum UniformSampleOneLight(const Interaction &it, const Scene &scene,
+                               MemoryArena &arena, Sampler &sampler,
+                               bool handleMedia,
+                               const LightDistribution &lightDistrib);
 Spectrum EstimateDirect(const Interaction &it, const Point2f &uShading,
                         const Light &light, const Point2f &uLight,
                         const Scene &scene, Sampler &sampler,
                         MemoryArena &arena, bool handleMedia = false,
                         bool specular = false);
+
+// LightReservoir Declarations
+
+// LightReservoir performs weighted reservoir sampling of light samples for
+// resampled importance sampling (Talbot et al., "Importance Resampling for
+// Global Illumination"; Bitterli et al., "Spatiotemporal Reservoir
+// Resampling for Real-Time Ray Tracing with Dynamic Direct Lighting"). A
+// light sample is stored as the light's index and the sample values passed
+// to its Sample_Li() method, which lets it be reevaluated at other points
+// to reuse it there.
+struct LightReservoir {
+    // LightReservoir Public Methods
+    bool Add(int light, const Point2f &u, Float pHat, Float weight,
+             Float sample) {
+        weightSum += weight;
+        ++M;
+        if (weight > 0 && sample * weightSum < weight) {
+            lightIndex = light;
+            uLight = u;
+            targetPdf = pHat;
+            return true;
+        }
+        return false;
+    }
+    // Merges _r_ into the reservoir, where _pHat_ is the target density of
+    // _r_'s sample at this reservoir's point
+    bool Merge(const LightReservoir &r, Float pHat, Float sample) {
+        int M0 = M;
+        bool chosen =
+            Add(r.lightIndex, r.uLight, pHat, pHat * r.Weight() * r.M, sample);
+        M = M0 + r.M;
+        return chosen;
+    }
+    // Limits the number of samples the reservoir represents without
+    // changing its weight
+    void ClampHistory(int maxM) {
+        if (M <= maxM) return;
+        weightSum *= Float(maxM) / M;
+        M = maxM;
+    }
+    Float Weight() const {
+        return (targetPdf > 0 && M > 0) ? weightSum / (M * targetPdf) : 0;
+    }
+
+    // LightReservoir Public Data
+    int lightIndex = -1;
+    Point2f uLight;
+    Float targetPdf = 0, weightSum = 0;
+    int M = 0;
+};
+
+Spectrum LightSampleContribution(const Interaction &it, const Scene &scene,
+                                 int lightIndex, const Point2f &uLight,
+                                 VisibilityTester *vis);
+void SampleLightCandidates(const Interaction &it, const Scene &scene,
+                           Sampler &sampler, int nCandidates,
+                           const Distribution1D *lightDistrib,
+                           LightReservoir *reservoir);
+Spectrum ResampleOneLight(const Interaction &it, const Scene &scene,
+                          Sampler &sampler, int nCandidates,
+                          bool handleMedia = false,
+                          const Distribution1D *lightDistrib = nullptr);
+// Distributions built with _parallelBuild_ may use multiple threads, so it
+// should only be set by code that isn't itself running in a parallel loop.
 std::unique_ptr<Distribution1D> ComputeLightPowerDistribution(
-    const Scene &scene);
+    const Scene &scene, bool parallelBuild = false);
+void NodeTileRange(int nTiles, int *begin, int *end);
 
 // SamplerIntegrator Declarations
 class SamplerIntegrator : public Integrator {
@@ -58,6 +58,36 @@ inline bool IsDeltaLight(int flags) {
            flags & (int)LightFlags::DeltaDirection;
 }
 
+// LightBounds Declarations
+// LightBounds conservatively bounds where a light emits from, the directions
+// it emits in and how much it emits; they are used to estimate a light's
+// contribution at a point without evaluating it.
+struct LightBounds {
+    LightBounds() = default;
+    LightBounds(const Bounds3f &bounds, const Vector3f &w, Float phi,
+                Float cosTheta_o, Float cosTheta_e, bool twoSided)
+        : bounds(bounds),
+          w(Normalize(w)),
+          phi(phi),
+          cosTheta_o(cosTheta_o),
+          cosTheta_e(cosTheta_e),
+          twoSided(twoSided) {}
+    Float Importance(const Point3f &p, const Normal3f &n) const;
+
+    // Emitters are inside _bounds_ and their normals are within the cone
+    // of directions around _w_ with angle $\theta_o$; they emit light up to
+    // $\theta_e$ away from their normals, on both sides if _twoSided_.
+    // _phi_ is their radiant intensity or the product of their radiance
+    // and area.
+    Bounds3f bounds;
+    Vector3f w;
+    Float phi = 0;
+    Float cosTheta_o = 1, cosTheta_e = 1;
+    bool twoSided = false;
+};
+
+LightBounds Union(const LightBounds &a, const LightBounds &b);
+
 // Light Declarations
 class Light {
   public:
@@ -77,6 +107,9 @@ class Light {
                                Float *pdfDir) const = 0;
     virtual void Pdf_Le(const Ray &ray, const Normal3f &nLight, Float *pdfPos,
                         Float *pdfDir) const = 0;
+    // Lights at infinity can't be bounded and return false
+    virtual bool Bounds(LightBounds *bounds) const { return false; }
+    const Transform &GetLightToWorld() const { return LightToWorld; }
 
     // Light Public Data
     const int flags;
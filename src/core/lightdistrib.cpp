@@ -34,17 +34,34 @@
 // low res image first?
 
 #include "lightdistrib.h"
+#include "camera.h"
+#include "checkpoint.h"
+#include "film.h"
 #include "lowdiscrepancy.h"
 #include "parallel.h"
+#include "rng.h"
 #include "scene.h"
 #include "stats.h"
 #include "integrator.h"
+#include <algorithm>
+#include <cstring>
 #include <numeric>
 
 namespace pbrt {
 
 LightDistribution::~LightDistribution() {}
 
+int LightDistribution::Sample(const Point3f &p, const Normal3f &n, Float u,
+                              Float *pmf) const {
+    int lightIndex = Lookup(p)->SampleDiscrete(u, pmf);
+    return *pmf > 0 ? lightIndex : -1;
+}
+
+Float LightDistribution::PMF(const Point3f &p, const Normal3f &n,
+                             int lightIndex) const {
+    return Lookup(p)->DiscretePDF(lightIndex);
+}
+
 std::unique_ptr<LightDistribution> CreateLightSampleDistribution(
     const std::string &name, const Scene &scene) {
     if (name == "uniform" || scene.lights.size() == 1)
@@ -56,6 +73,9 @@ std::unique_ptr<LightDistribution> CreateLightSampleDistribution(
     else if (name == "spatial")
         return std::unique_ptr<LightDistribution>{
             new SpatialLightDistribution(scene)};
+    else if (name == "bvh")
+        return std::unique_ptr<LightDistribution>{
+            new BVHLightDistribution(scene)};
     else {
         Error(
             "Light sample distribution type \"%s\" unknown. Using \"spatial\".",
@@ -75,7 +95,7 @@ const Distribution1D *UniformLightDistribution::Lookup(const Point3f &p) const {
 }
 
 PowerLightDistribution::PowerLightDistribution(const Scene &scene)
-    : distrib(ComputeLightPowerDistribution(scene)) {}
+    : distrib(ComputeLightPowerDistribution(scene, true)) {}
 
 const Distribution1D *PowerLightDistribution::Lookup(const Point3f &p) const {
     return distrib.get();
@@ -87,6 +107,8 @@ const Distribution1D *PowerLightDistribution::Lookup(const Point3f &p) const {
 STAT_COUNTER("SpatialLightDistribution/Distributions created", nCreated);
 STAT_RATIO("SpatialLightDistribution/Lookups per distribution", nLookups, nDistributions);
 STAT_INT_DISTRIBUTION("SpatialLightDistribution/Hash probes per lookup", nProbesPerLookup);
+STAT_COUNTER("SpatialLightDistribution/Voxels precomputed", nPrecomputed);
+STAT_COUNTER("SpatialLightDistribution/Distributions read", nRead);
 
 // Voxel coordinates are packed into a uint64_t for hash table lookups;
 // 10 bits are allocated to each coordinate.  invalidPackedPos is an impossible
@@ -135,9 +157,12 @@ SpatialLightDistribution::~SpatialLightDistribution() {
 const Distribution1D *SpatialLightDistribution::Lookup(const Point3f &p) const {
     ProfilePhase _(Prof::LightDistribLookup);
     ++nLookups;
+    return lookupVoxel(voxel(p));
+}
 
-    // First, compute integer voxel coordinates for the given point |p|
-    // with respect to the overall voxel grid.
+Point3i SpatialLightDistribution::voxel(const Point3f &p) const {
+    // Compute integer voxel coordinates for the given point |p| with
+    // respect to the overall voxel grid.
     Vector3f offset = scene.WorldBound().Offset(p);  // offset in [0,1].
     Point3i pi;
     for (int i = 0; i < 3; ++i)
@@ -145,11 +170,10 @@ const Distribution1D *SpatialLightDistribution::Lookup(const Point3f &p) const {
         // robust to computed intersection points being slightly outside
         // the scene bounds due to floating-point roundoff error.
         pi[i] = Clamp(int(offset[i] * nVoxels[i]), 0, nVoxels[i] - 1);
+    return pi;
+}
 
-    // Pack the 3D integer voxel coordinates into a single 64-bit value.
-    uint64_t packedPos = (uint64_t(pi[0]) << 40) | (uint64_t(pi[1]) << 20) | pi[2];
-    CHECK_NE(packedPos, invalidPackedPos);
-
+size_t SpatialLightDistribution::hash(uint64_t packedPos) const {
     // Compute a hash value from the packed voxel coordinates.  We could
     // just take packedPos mod the hash table size, but since packedPos
     // isn't necessarily well distributed on its own, it's worthwhile to do
@@ -162,8 +186,14 @@ const Distribution1D *SpatialLightDistribution::Lookup(const Point3f &p) const {
     hash ^= (hash >> 27);
     hash *= 0x81dadef4bc2dd44d;
     hash ^= (hash >> 33);
-    hash %= hashTableSize;
-    CHECK_GE(hash, 0);
+    return hash % hashTableSize;
+}
+
+const Distribution1D *SpatialLightDistribution::lookupVoxel(Point3i pi) const {
+    // Pack the 3D integer voxel coordinates into a single 64-bit value.
+    uint64_t packedPos = (uint64_t(pi[0]) << 40) | (uint64_t(pi[1]) << 20) | pi[2];
+    CHECK_NE(packedPos, invalidPackedPos);
+    size_t hash = this->hash(packedPos);
 
     // Now, see if the hash table already has an entry for the voxel. We'll
     // use quadratic probing when the hash table entry is already used for
@@ -299,4 +329,547 @@ SpatialLightDistribution::ComputeDistribution(Point3i pi) const {
     return new Distribution1D(&lightContrib[0], int(lightContrib.size()));
 }
 
+void SpatialLightDistribution::Precompute(const std::vector<Point3f> &points,
+                                          const std::vector<Bounds3f> &bounds) {
+    // Find the distinct voxels containing the points or overlapping the
+    // bounds
+    std::vector<uint64_t> voxels;
+    auto addVoxel = [&](const Point3i &pi) {
+        voxels.push_back((uint64_t(pi[0]) << 40) | (uint64_t(pi[1]) << 20) |
+                         pi[2]);
+    };
+    for (const Point3f &p : points) addVoxel(voxel(p));
+    for (const Bounds3f &b : bounds) {
+        if (!Overlaps(b, scene.WorldBound())) continue;
+        Point3i p0 = voxel(b.pMin), p1 = voxel(b.pMax);
+        for (int x = p0.x; x <= p1.x; ++x)
+            for (int y = p0.y; y <= p1.y; ++y)
+                for (int z = p0.z; z <= p1.z; ++z) addVoxel(Point3i(x, y, z));
+    }
+    std::sort(voxels.begin(), voxels.end());
+    voxels.erase(std::unique(voxels.begin(), voxels.end()), voxels.end());
+
+    // Compute their distributions; voxels whose distributions already
+    // exist are skipped by lookupVoxel()
+    ParallelFor([&](int64_t i) {
+        uint64_t packedPos = voxels[i];
+        lookupVoxel(Point3i(int(packedPos >> 40),
+                            int((packedPos >> 20) & 0xfffff),
+                            int(packedPos & 0xfffff)));
+    }, voxels.size(), 8);
+    nPrecomputed += voxels.size();
+}
+
+std::vector<Point3f> SpatialLightDistribution::SurfacePoints() const {
+    // Start the rays just outside the scene's bounds, so that surfaces on
+    // its faces are found too
+    Bounds3f b = scene.WorldBound();
+    b = Expand(b, 1e-3f * b.Diagonal().Length());
+    std::vector<Point3f> points;
+    for (int axis = 0; axis < 3; ++axis) {
+        int a0 = (axis + 1) % 3, a1 = (axis + 2) % 3;
+        Vector3f d(0, 0, 0);
+        d[axis] = 1;
+        for (int i = 0; i < nVoxels[a0]; ++i)
+            for (int j = 0; j < nVoxels[a1]; ++j) {
+                // Trace a ray through the centers of a row of voxels,
+                // continuing it past each surface that it hits
+                Point3f o;
+                o[axis] = b.pMin[axis];
+                o[a0] = Lerp((i + 0.5f) / nVoxels[a0], b.pMin[a0], b.pMax[a0]);
+                o[a1] = Lerp((j + 0.5f) / nVoxels[a1], b.pMin[a1], b.pMax[a1]);
+                Ray ray(o, d);
+                SurfaceInteraction isect;
+                while (scene.Intersect(ray, &isect)) {
+                    points.push_back(isect.p);
+                    ray = isect.SpawnRay(d);
+                }
+            }
+    }
+    return points;
+}
+
+std::string SpatialLightDistribution::config() const {
+    // Summarize the lights with a hash of everything about them that the
+    // _Light_ interface exposes: their flags, transformations, powers and
+    // bounds, as well as the radiance they deliver to a few points around
+    // the scene, which accounts for parameters such as emission profiles
+    // that don't show up in the others.
+    const Bounds3f &b = scene.WorldBound();
+    Point3f probes[9];
+    for (int i = 0; i < 8; ++i) probes[i] = b.Corner(i);
+    probes[8] = b.Lerp(Point3f(.5, .5, .5));
+    uint64_t lightHash = 14695981039346656037ull;
+    auto hash = [&](const void *v, size_t size) {
+        const unsigned char *bytes = (const unsigned char *)v;
+        for (size_t i = 0; i < size; ++i)
+            lightHash = (lightHash ^ bytes[i]) * 1099511628211ull;
+    };
+    for (const auto &light : scene.lights) {
+        hash(&light->flags, sizeof(light->flags));
+        hash(&light->nSamples, sizeof(light->nSamples));
+        hash(&light->GetLightToWorld().GetMatrix().m[0][0],
+             sizeof(Matrix4x4::m));
+        Float power[3];
+        light->Power().ToRGB(power);
+        hash(power, sizeof(power));
+        LightBounds lb;
+        if (light->Bounds(&lb)) {
+            Float values[10] = {lb.bounds.pMin.x, lb.bounds.pMin.y,
+                                lb.bounds.pMin.z, lb.bounds.pMax.x,
+                                lb.bounds.pMax.y, lb.bounds.pMax.z,
+                                lb.w.x,           lb.w.y,
+                                lb.w.z,           lb.phi};
+            hash(values, sizeof(values));
+            Float cosThetas[2] = {lb.cosTheta_o, lb.cosTheta_e};
+            hash(cosThetas, sizeof(cosThetas));
+            hash(&lb.twoSided, sizeof(lb.twoSided));
+        }
+        for (const Point3f &p : probes) {
+            Vector3f wi;
+            Float pdf;
+            VisibilityTester vis;
+            Float Li[3];
+            light->Sample_Li(Interaction(p, 0, MediumInterface()),
+                             Point2f(.25, .75), &wi, &pdf, &vis)
+                .ToRGB(Li);
+            Float values[7] = {Li[0], Li[1], Li[2], wi.x, wi.y, wi.z, pdf};
+            hash(values, sizeof(values));
+        }
+    }
+    return StringPrintf("float %d bounds [ %f %f %f - %f %f %f ] voxels %d %d "
+                        "%d lights %d %016llx", int(sizeof(Float)), b.pMin.x,
+                        b.pMin.y, b.pMin.z, b.pMax.x, b.pMax.y, b.pMax.z,
+                        nVoxels[0], nVoxels[1], nVoxels[2],
+                        int(scene.lights.size()),
+                        (unsigned long long)lightHash);
+}
+
+// Light distribution files start with this tag, followed by the length of
+// the configuration string and the string. Then come the number of voxels
+// and, for each, its packed coordinates, the number of lights and the
+// distribution's function values.
+static const char lightDistribMagic[8] = {'P', 'B', 'R', 'T', 'L', 'D', 'S', 'T'};
+
+bool SpatialLightDistribution::Write(const std::string &filename) const {
+    std::vector<char> data;
+    CheckpointAppend(&data, lightDistribMagic, sizeof(lightDistribMagic));
+    std::string cfg = config();
+    uint32_t configLength = cfg.size();
+    CheckpointAppend(&data, &configLength);
+    CheckpointAppend(&data, cfg.data(), cfg.size());
+    uint64_t nEntries = 0;
+    for (size_t i = 0; i < hashTableSize; ++i)
+        if (hashTable[i].distribution.load()) ++nEntries;
+    CheckpointAppend(&data, &nEntries);
+    for (size_t i = 0; i < hashTableSize; ++i) {
+        const Distribution1D *dist = hashTable[i].distribution.load();
+        if (!dist) continue;
+        uint64_t packedPos = hashTable[i].packedPos.load();
+        uint32_t count = dist->Count();
+        CheckpointAppend(&data, &packedPos);
+        CheckpointAppend(&data, &count);
+        CheckpointAppend(&data, &dist->func[0], count);
+    }
+
+    // As with checkpoints, write to a temporary file and rename it so that
+    // an interrupted write never leaves a truncated file behind
+    std::string tempName = filename + ".tmp";
+    FILE *f = fopen(tempName.c_str(), "wb");
+    bool ok = f && fwrite(&data[0], 1, data.size(), f) == data.size();
+    if (f && fclose(f) != 0) ok = false;
+    if (!ok || rename(tempName.c_str(), filename.c_str()) != 0) {
+        if (f) remove(tempName.c_str());
+        Warning("%s: unable to write light distributions", filename.c_str());
+        return false;
+    }
+    LOG(INFO) << "Wrote " << nEntries << " light distributions to "
+              << filename;
+    return true;
+}
+
+bool SpatialLightDistribution::Read(const std::string &filename) {
+    FILE *f = fopen(filename.c_str(), "rb");
+    if (!f) return false;
+    std::vector<char> data;
+    char buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        data.insert(data.end(), buf, buf + n);
+    fclose(f);
+    size_t offset = 0;
+    auto read = [&](void *v, size_t size) {
+        if (offset + size > data.size()) return false;
+        memcpy(v, &data[offset], size);
+        offset += size;
+        return true;
+    };
+
+    // Check that the distributions are for this scene
+    char magic[sizeof(lightDistribMagic)];
+    uint32_t configLength;
+    if (!read(magic, sizeof(magic)) ||
+        memcmp(magic, lightDistribMagic, sizeof(magic)) != 0 ||
+        !read(&configLength, sizeof(configLength)) ||
+        offset + configLength > data.size()) {
+        Warning("%s: not a light distribution file", filename.c_str());
+        return false;
+    }
+    std::string savedConfig(data.data() + offset, configLength);
+    offset += configLength;
+    if (savedConfig != config()) {
+        Warning("%s: light distributions were computed for a different "
+                "scene; recomputing them", filename.c_str());
+        return false;
+    }
+    uint64_t nEntries;
+    if (!read(&nEntries, sizeof(nEntries))) return false;
+
+    // Read all of the distributions before adding any of them, so that a
+    // truncated file leaves the table unchanged
+    std::vector<std::pair<uint64_t, std::unique_ptr<Distribution1D>>> entries;
+    for (uint64_t e = 0; e < nEntries; ++e) {
+        uint64_t packedPos;
+        uint32_t count;
+        if (!read(&packedPos, sizeof(packedPos)) ||
+            !read(&count, sizeof(count)) || count != scene.lights.size() ||
+            packedPos == invalidPackedPos)
+            return false;
+        std::vector<Float> func(count);
+        if (!read(&func[0], count * sizeof(Float))) return false;
+        entries.push_back(std::make_pair(
+            packedPos, std::unique_ptr<Distribution1D>(
+                           new Distribution1D(&func[0], int(count)))));
+    }
+    if (offset != data.size()) return false;
+
+    for (auto &entry : entries) {
+        // Find the voxel's entry in the hash table or an empty one for it
+        size_t h = hash(entry.first);
+        int step = 1;
+        while (true) {
+            uint64_t entryPackedPos = hashTable[h].packedPos.load();
+            if (entryPackedPos == entry.first) break;
+            if (entryPackedPos == invalidPackedPos) {
+                hashTable[h].packedPos.store(entry.first);
+                hashTable[h].distribution.store(entry.second.release());
+                ++nRead;
+                break;
+            }
+            h = (h + step * step) % hashTableSize;
+            ++step;
+        }
+    }
+    LOG(INFO) << "Read " << nEntries << " light distributions from "
+              << filename;
+    return true;
+}
+
+void PrecomputeLightDistribution(LightDistribution *distrib,
+                                 const Scene &scene, const Camera &camera,
+                                 int maxDepth) {
+    // Only the spatial distribution computes distributions lazily
+    SpatialLightDistribution *spatial =
+        dynamic_cast<SpatialLightDistribution *>(distrib);
+    if (!spatial) return;
+
+    // Find points that are visible to the camera at a coarse grid of pixels
+    // and the vertices of a few cosine-distributed paths leaving each of
+    // them; these cover most of the voxels that rendering looks up.
+    PBRT_CONSTEXPR int pixelStride = 2;
+    PBRT_CONSTEXPR int pathsPerPixel = 4;
+    Bounds2i sampleBounds = camera.film->GetSampleBounds();
+    Vector2i extent = sampleBounds.Diagonal();
+    int nx = (extent.x + pixelStride - 1) / pixelStride;
+    int ny = (extent.y + pixelStride - 1) / pixelStride;
+    std::vector<std::vector<Point3f>> rowPoints(ny);
+    ParallelFor([&](int64_t y) {
+        RNG rng(y);
+        for (int x = 0; x < nx; ++x) {
+            CameraSample cs;
+            cs.pFilm = Point2f(sampleBounds.pMin.x + x * pixelStride + 0.5f,
+                               sampleBounds.pMin.y + y * pixelStride + 0.5f);
+            cs.pLens = Point2f(0.5f, 0.5f);
+            cs.time = 0.5f;
+            Ray ray;
+            SurfaceInteraction cameraIsect;
+            if (camera.GenerateRay(cs, &ray) == 0 ||
+                !scene.Intersect(ray, &cameraIsect))
+                continue;
+            rowPoints[y].push_back(cameraIsect.p);
+
+            for (int path = 0; path < pathsPerPixel; ++path) {
+                SurfaceInteraction isect = cameraIsect;
+                for (int depth = 1; depth < maxDepth; ++depth) {
+                    Vector3f n(Faceforward(isect.n, isect.wo)), s, t;
+                    CoordinateSystem(n, &s, &t);
+                    Vector3f w = CosineSampleHemisphere(
+                        Point2f(rng.UniformFloat(), rng.UniformFloat()));
+                    Ray bounce = isect.SpawnRay(w.x * s + w.y * t + w.z * n);
+                    if (!scene.Intersect(bounce, &isect)) break;
+                    rowPoints[y].push_back(isect.p);
+                }
+            }
+        }
+    }, ny);
+    std::vector<Point3f> points;
+    for (const std::vector<Point3f> &row : rowPoints)
+        points.insert(points.end(), row.begin(), row.end());
+
+    // Surfaces that are smaller than the sampled pixels, like those near
+    // the horizon, are often missed by the paths; also add the voxels that
+    // rays through the whole of the scene's aggregate find surfaces in and
+    // those that overlap the lights, whose emitters may be too small for
+    // those rays to hit.
+    std::vector<Point3f> surfacePoints = spatial->SurfacePoints();
+    points.insert(points.end(), surfacePoints.begin(), surfacePoints.end());
+    std::vector<Bounds3f> lightBounds;
+    for (const auto &light : scene.lights) {
+        LightBounds lb;
+        if (light->Bounds(&lb)) lightBounds.push_back(lb.bounds);
+    }
+
+    spatial->Precompute(points, lightBounds);
+}
+
+bool ReadLightDistribution(LightDistribution *distrib,
+                           const std::string &filename) {
+    SpatialLightDistribution *spatial =
+        dynamic_cast<SpatialLightDistribution *>(distrib);
+    return spatial && spatial->Read(filename);
+}
+
+void WriteLightDistribution(const LightDistribution *distrib,
+                            const std::string &filename) {
+    const SpatialLightDistribution *spatial =
+        dynamic_cast<const SpatialLightDistribution *>(distrib);
+    if (spatial) spatial->Write(filename);
+}
+
+///////////////////////////////////////////////////////////////////////////
+// BVHLightDistribution
+
+STAT_COUNTER("BVHLightDistribution/Lights in BVH", nBVHLights);
+STAT_COUNTER("BVHLightDistribution/Unbounded lights", nUnboundedLights);
+STAT_MEMORY_COUNTER("Memory/Light BVH", lightBVHBytes);
+STAT_INT_DISTRIBUTION("BVHLightDistribution/Nodes visited per sample",
+                      nNodesVisited);
+
+// Returns the surface area heuristic-like cost of a node with the given
+// bounds, accounting for the solid angle of its emission directions; _dim_
+// is the axis being split in _centroidBounds_.
+static Float EvaluateCost(const LightBounds &b, const Bounds3f &centroidBounds,
+                          int dim) {
+    Float theta_o = SafeACos(b.cosTheta_o), theta_e = SafeACos(b.cosTheta_e);
+    Float theta_w = std::min(theta_o + theta_e, Pi);
+    Float sinTheta_o = SafeSqrt(1 - b.cosTheta_o * b.cosTheta_o);
+    Float M_omega = 2 * Pi * (1 - b.cosTheta_o) +
+                    Pi / 2 *
+                        (2 * theta_w * sinTheta_o -
+                         std::cos(theta_o - 2 * theta_w) -
+                         2 * theta_o * sinTheta_o + b.cosTheta_o);
+    // Penalize splits along short axes so nodes stay roughly cube-shaped
+    Vector3f d = centroidBounds.Diagonal();
+    Float Kr = std::max(d.x, std::max(d.y, d.z)) / d[dim];
+    return b.phi * M_omega * Kr * b.bounds.SurfaceArea();
+}
+
+BVHLightDistribution::BVHLightDistribution(const Scene &scene)
+    : bitTrails(scene.lights.size(), uint64_t(ZeroPowerLight)),
+      powerDistrib(ComputeLightPowerDistribution(scene, true)) {
+    // Gather the bounds of the lights, setting aside ones that can't be
+    // bounded and skipping ones that don't emit
+    std::vector<std::pair<int, LightBounds>> bvhLights;
+    for (size_t i = 0; i < scene.lights.size(); ++i) {
+        LightBounds bounds;
+        if (!scene.lights[i]->Bounds(&bounds)) {
+            bitTrails[i] = UnboundedLight;
+            unboundedLights.push_back(int(i));
+        } else if (bounds.phi > 0)
+            bvhLights.push_back(std::make_pair(int(i), bounds));
+    }
+    nBVHLights += bvhLights.size();
+    nUnboundedLights += unboundedLights.size();
+
+    if (!bvhLights.empty()) {
+        nodes.reserve(2 * bvhLights.size() - 1);
+        buildBVH(bvhLights, 0, int(bvhLights.size()), 0, 0);
+    }
+    lightBVHBytes += nodes.size() * sizeof(LightBVHNode) +
+                     bitTrails.size() * sizeof(uint64_t);
+    LOG(INFO) << "BVHLightDistribution: " << bvhLights.size() <<
+        " lights in BVH with " << nodes.size() << " nodes, " <<
+        unboundedLights.size() << " unbounded lights";
+}
+
+std::pair<int, LightBounds> BVHLightDistribution::buildBVH(
+    std::vector<std::pair<int, LightBounds>> &lights, int start, int end,
+    uint64_t bitTrail, int depth) {
+    CHECK_LT(start, end);
+    // Create a leaf node for a single light
+    if (end - start == 1) {
+        int nodeIndex = int(nodes.size());
+        const std::pair<int, LightBounds> &light = lights[start];
+        nodes.push_back({light.second, light.first, true});
+        bitTrails[light.first] = bitTrail;
+        return std::make_pair(nodeIndex, light.second);
+    }
+
+    // Compute bounds of the lights and of their centroids
+    Bounds3f bounds, centroidBounds;
+    for (int i = start; i < end; ++i) {
+        const LightBounds &lb = lights[i].second;
+        bounds = Union(bounds, lb.bounds);
+        centroidBounds =
+            Union(centroidBounds, (lb.bounds.pMin + lb.bounds.pMax) / 2);
+    }
+
+    // Find the lowest-cost split over buckets along each axis
+    Float minCost = Infinity;
+    int minCostSplitBucket = -1, minCostSplitDim = -1;
+    PBRT_CONSTEXPR int nBuckets = 12;
+    for (int dim = 0; dim < 3; ++dim) {
+        if (centroidBounds.pMax[dim] == centroidBounds.pMin[dim]) continue;
+        LightBounds bucketLightBounds[nBuckets];
+        for (int i = start; i < end; ++i) {
+            const LightBounds &lb = lights[i].second;
+            Point3f pc = (lb.bounds.pMin + lb.bounds.pMax) / 2;
+            int b = nBuckets * centroidBounds.Offset(pc)[dim];
+            if (b == nBuckets) b = nBuckets - 1;
+            bucketLightBounds[b] = Union(bucketLightBounds[b], lb);
+        }
+
+        for (int i = 0; i < nBuckets - 1; ++i) {
+            LightBounds b0, b1;
+            for (int j = 0; j <= i; ++j)
+                b0 = Union(b0, bucketLightBounds[j]);
+            for (int j = i + 1; j < nBuckets; ++j)
+                b1 = Union(b1, bucketLightBounds[j]);
+            if (b0.phi == 0 || b1.phi == 0) continue;
+            Float cost = EvaluateCost(b0, centroidBounds, dim) +
+                         EvaluateCost(b1, centroidBounds, dim);
+            if (cost > 0 && cost < minCost) {
+                minCost = cost;
+                minCostSplitBucket = i;
+                minCostSplitDim = dim;
+            }
+        }
+    }
+
+    // Partition the lights at the split, or into equal halves if there's
+    // no useful split or the tree is getting too deep for _bitTrails_
+    int mid;
+    if (minCostSplitDim != -1 && depth < 32) {
+        auto pmid = std::partition(
+            &lights[start], &lights[end - 1] + 1,
+            [=](const std::pair<int, LightBounds> &l) {
+                Point3f pc = (l.second.bounds.pMin + l.second.bounds.pMax) / 2;
+                int b = nBuckets * centroidBounds.Offset(pc)[minCostSplitDim];
+                if (b == nBuckets) b = nBuckets - 1;
+                return b <= minCostSplitBucket;
+            });
+        mid = int(pmid - &lights[0]);
+    } else {
+        mid = (start + end) / 2;
+        int dim = centroidBounds.MaximumExtent();
+        std::nth_element(
+            &lights[start], &lights[mid], &lights[end - 1] + 1,
+            [dim](const std::pair<int, LightBounds> &a,
+                  const std::pair<int, LightBounds> &b) {
+                return a.second.bounds.pMin[dim] + a.second.bounds.pMax[dim] <
+                       b.second.bounds.pMin[dim] + b.second.bounds.pMax[dim];
+            });
+    }
+    if (mid == start || mid == end) mid = (start + end) / 2;
+
+    // Recursively build the children; the first immediately follows the
+    // interior node
+    int nodeIndex = int(nodes.size());
+    nodes.push_back({LightBounds(), -1, false});
+    CHECK_LT(depth, 64);
+    std::pair<int, LightBounds> child0 =
+        buildBVH(lights, start, mid, bitTrail, depth + 1);
+    CHECK_EQ(nodeIndex + 1, child0.first);
+    std::pair<int, LightBounds> child1 = buildBVH(
+        lights, mid, end, bitTrail | (uint64_t(1) << depth), depth + 1);
+    LightBounds lb = Union(child0.second, child1.second);
+    nodes[nodeIndex] = {lb, child1.first, false};
+    return std::make_pair(nodeIndex, lb);
+}
+
+const Distribution1D *BVHLightDistribution::Lookup(const Point3f &p) const {
+    return powerDistrib.get();
+}
+
+int BVHLightDistribution::Sample(const Point3f &p, const Normal3f &n, Float u,
+                                 Float *pmf) const {
+    ProfilePhase _(Prof::LightDistribLookup);
+    // Choose between the unbounded lights and the BVH
+    *pmf = 0;
+    Float pInfinite = pUnbounded();
+    if (u < pInfinite) {
+        int nUnbounded = int(unboundedLights.size());
+        int index = std::min(int(u / pInfinite * nUnbounded), nUnbounded - 1);
+        *pmf = pInfinite / nUnbounded;
+        return unboundedLights[index];
+    }
+    if (nodes.empty()) return -1;
+    u = std::min((u - pInfinite) / (1 - pInfinite), OneMinusEpsilon);
+
+    // Traverse the BVH, choosing children according to their importance
+    Float nodePMF = 1 - pInfinite;
+    int nodeIndex = 0, nVisited = 1;
+    while (!nodes[nodeIndex].isLeaf) {
+        const LightBVHNode &node = nodes[nodeIndex];
+        Float ci[2] = {nodes[nodeIndex + 1].bounds.Importance(p, n),
+                       nodes[node.childOrLightIndex].bounds.Importance(p, n)};
+        if (ci[0] == 0 && ci[1] == 0) {
+            ReportValue(nNodesVisited, nVisited);
+            return -1;
+        }
+        ++nVisited;
+        Float p0 = ci[0] / (ci[0] + ci[1]);
+        if (u < p0) {
+            u = std::min(u / p0, OneMinusEpsilon);
+            nodePMF *= p0;
+            nodeIndex = nodeIndex + 1;
+        } else {
+            u = std::min((u - p0) / (1 - p0), OneMinusEpsilon);
+            nodePMF *= 1 - p0;
+            nodeIndex = node.childOrLightIndex;
+        }
+    }
+    ReportValue(nNodesVisited, nVisited);
+    // A lone light at the root must still be able to illuminate the point
+    if (nodeIndex == 0 && nodes[0].bounds.Importance(p, n) == 0) return -1;
+    *pmf = nodePMF;
+    return nodes[nodeIndex].childOrLightIndex;
+}
+
+Float BVHLightDistribution::PMF(const Point3f &p, const Normal3f &n,
+                                int lightIndex) const {
+    uint64_t bitTrail = bitTrails[lightIndex];
+    if (bitTrail == UnboundedLight)
+        return pUnbounded() / unboundedLights.size();
+    if (bitTrail == ZeroPowerLight) return 0;
+
+    // Follow the path to the light's leaf, accumulating the probability of
+    // each choice made by Sample()
+    Float pmf = 1 - pUnbounded();
+    int nodeIndex = 0;
+    if (nodes[0].isLeaf && nodes[0].bounds.Importance(p, n) == 0) return 0;
+    while (!nodes[nodeIndex].isLeaf) {
+        const LightBVHNode &node = nodes[nodeIndex];
+        Float ci[2] = {nodes[nodeIndex + 1].bounds.Importance(p, n),
+                       nodes[node.childOrLightIndex].bounds.Importance(p, n)};
+        int child = bitTrail & 1;
+        if (ci[child] == 0) return 0;
+        pmf *= ci[child] / (ci[0] + ci[1]);
+        nodeIndex = child ? node.childOrLightIndex : nodeIndex + 1;
+        bitTrail >>= 1;
+    }
+    DCHECK_EQ(lightIndex, nodes[nodeIndex].childOrLightIndex);
+    return pmf;
+}
+
 }  // namespace pbrt
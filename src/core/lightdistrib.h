@@ -35,6 +35,7 @@
 
 #include "pbrt.h"
 #include "geometry.h"
+#include "light.h"
 #include "sampling.h"
 #include <atomic>
 #include <functional>
@@ -54,11 +55,36 @@ class LightDistribution {
     // Given a point |p| in space, this method returns a (hopefully
     // effective) sampling distribution for light sources at that point.
     virtual const Distribution1D *Lookup(const Point3f &p) const = 0;
+
+    // Chooses a light to sample at the point |p| with surface normal |n|,
+    // which is zero for points in participating media. Returns its index
+    // in Scene::lights and the probability of choosing it in |*pmf|, or -1
+    // if no light is chosen. PMF() returns the probability of choosing the
+    // given light. The default implementations use Lookup()'s
+    // distribution.
+    virtual int Sample(const Point3f &p, const Normal3f &n, Float u,
+                       Float *pmf) const;
+    virtual Float PMF(const Point3f &p, const Normal3f &n,
+                      int lightIndex) const;
 };
 
 std::unique_ptr<LightDistribution> CreateLightSampleDistribution(
     const std::string &name, const Scene &scene);
 
+// Computes, before rendering starts, the light sampling distributions that
+// rendering with |camera| and paths of up to |maxDepth| bounces is likely
+// to need, as well as those of all voxels with surfaces or lights in them,
+// for distributions that otherwise compute them lazily.
+void PrecomputeLightDistribution(LightDistribution *distrib,
+                                 const Scene &scene, const Camera &camera,
+                                 int maxDepth);
+// Restores distributions saved by WriteLightDistribution(), returning
+// false if there's no file or it's for a different scene.
+bool ReadLightDistribution(LightDistribution *distrib,
+                           const std::string &filename);
+void WriteLightDistribution(const LightDistribution *distrib,
+                            const std::string &filename);
+
 // The simplest possible implementation of LightDistribution: this returns
 // a uniform distribution over all light sources, ignoring the provided
 // point. This approach works well for very simple scenes, but is quite
@@ -103,10 +129,29 @@ class SpatialLightDistribution : public LightDistribution {
     ~SpatialLightDistribution();
     const Distribution1D *Lookup(const Point3f &p) const;
 
+    // Computes the distributions of all voxels that contain one of the
+    // given points or overlap one of the given bounds, in parallel.
+    void Precompute(const std::vector<Point3f> &points,
+                    const std::vector<Bounds3f> &bounds =
+                        std::vector<Bounds3f>());
+    // Returns the points where rays along each of the voxel grid's rows,
+    // in each axis direction, intersect the scene's geometry.
+    std::vector<Point3f> SurfacePoints() const;
+    // Read() adds the distributions stored in a file written by Write(),
+    // returning false if it doesn't exist or is for a different scene.
+    bool Read(const std::string &filename);
+    bool Write(const std::string &filename) const;
+
   private:
     // Compute the sampling distribution for the voxel with integer
     // coordiantes given by "pi".
     Distribution1D *ComputeDistribution(Point3i pi) const;
+    Point3i voxel(const Point3f &p) const;
+    const Distribution1D *lookupVoxel(Point3i pi) const;
+    size_t hash(uint64_t packedPos) const;
+    // Returns a description of the scene's lights and the voxel grid that
+    // distributions that are written to files must match.
+    std::string config() const;
 
     const Scene &scene;
     int nVoxels[3];
@@ -124,6 +169,54 @@ class SpatialLightDistribution : public LightDistribution {
     size_t hashTableSize;
 };
 
+// BVHLightDistribution chooses lights by stochastically traversing a
+// bounding volume hierarchy built over their LightBounds. At each node, a
+// child is chosen with probability proportional to an estimate of its
+// lights' contribution at the point, based on their power, distance and
+// the orientation of their emitters and the receiving surface. Lights
+// that can't be bounded, like infinite area lights, are chosen uniformly.
+// Sampling cost is logarithmic in the number of lights and there's no
+// per-point precomputation, which makes this approach suitable for scenes
+// with many thousands of emitters. Lookup() returns a power distribution
+// for callers that need one that doesn't depend on the point.
+class BVHLightDistribution : public LightDistribution {
+  public:
+    BVHLightDistribution(const Scene &scene);
+    const Distribution1D *Lookup(const Point3f &p) const;
+    int Sample(const Point3f &p, const Normal3f &n, Float u,
+               Float *pmf) const;
+    Float PMF(const Point3f &p, const Normal3f &n, int lightIndex) const;
+
+  private:
+    // BVHLightDistribution Private Methods
+    std::pair<int, LightBounds> buildBVH(
+        std::vector<std::pair<int, LightBounds>> &lights, int start, int end,
+        uint64_t bitTrail, int depth);
+    Float pUnbounded() const {
+        if (unboundedLights.empty()) return 0;
+        return Float(unboundedLights.size()) /
+               Float(unboundedLights.size() + (nodes.empty() ? 0 : 1));
+    }
+
+    // BVHLightDistribution Private Data
+    // The second child of an interior node is at _childOrLightIndex_ and
+    // the first immediately follows the node
+    struct LightBVHNode {
+        LightBounds bounds;
+        int childOrLightIndex;
+        bool isLeaf;
+    };
+    std::vector<LightBVHNode> nodes;
+    std::vector<int> unboundedLights;
+    // For each light in the BVH, the bits give the child taken at each
+    // level on the path from the root to its leaf, starting with the low
+    // bit; other lights have one of these values
+    static PBRT_CONSTEXPR uint64_t UnboundedLight = ~uint64_t(0);
+    static PBRT_CONSTEXPR uint64_t ZeroPowerLight = ~uint64_t(0) - 1;
+    std::vector<uint64_t> bitTrails;
+    std::unique_ptr<Distribution1D> powerDistrib;
+};
+
 }  // namespace pbrt
 
 #endif  // PBRT_CORE_LIGHTDISTRIB_H
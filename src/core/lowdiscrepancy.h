@@ -62,6 +62,8 @@ inline float SobolSampleFloat(int64_t index, int dimension,
                               uint32_t scramble = 0);
 inline double SobolSampleDouble(int64_t index, int dimension,
                                 uint64_t scramble = 0);
+inline void SobolSampleDimensions(int64_t index, int dimension, int n,
+                                  Float *samples);
 
 // Low Discrepancy Inline Functions
 inline uint32_t ReverseBits32(uint32_t n) {
@@ -79,6 +81,75 @@ inline uint64_t ReverseBits64(uint64_t n) {
     return (n0 << 32) | n1;
 }
 
+// Returns a well-mixed 64-bit hash of _v_.
+inline uint64_t MixBits(uint64_t v) {
+    v ^= (v >> 31);
+    v *= 0x7fb5d329728ea185ull;
+    v ^= (v >> 27);
+    v *= 0x81dadef4bc2dd44dull;
+    v ^= (v >> 33);
+    return v;
+}
+
+// Applies a hash-based Owen scramble to the bit-reversed base-2 fixed-point
+// value _v_: each bit is flipped based on a hash of _seed_ and the bits
+// below it, which are the more significant digits of the unreversed value.
+inline uint32_t OwenScrambleReversed(uint32_t v, uint32_t seed) {
+    v ^= v * 0x3d20adea;
+    v += seed;
+    v *= (seed >> 16) | 1;
+    v ^= v * 0x05526c56;
+    v ^= v * 0x53a22864;
+    return v;
+}
+
+// Converts the 32-bit fixed-point sample value _v_ to a _Float_ in [0,1).
+inline Float SobolToFloat(uint32_t v) {
+#ifndef PBRT_HAVE_HEX_FP_CONSTANTS
+    return std::min(v * Float(2.3283064365386963e-10), OneMinusEpsilon);
+#else
+    return std::min(v * Float(0x1p-32), OneMinusEpsilon);
+#endif
+}
+
+// Samplers that scramble each dimension with a hash of its number use
+// dimension numbers starting here for the samples of requested arrays, so
+// that they're scrambled independently of the _Get1D()_/_Get2D()_
+// dimensions.
+static PBRT_CONSTEXPR uint32_t ArrayDimensionBase = 0x80000000u;
+
+// Returns the _i_th element of the pseudo-random permutation of [0, n)
+// selected by _seed_, without storing the permutation.
+inline int PermutationElement(uint32_t i, uint32_t n, uint32_t seed) {
+    uint32_t w = n - 1;
+    w |= w >> 1;
+    w |= w >> 2;
+    w |= w >> 4;
+    w |= w >> 8;
+    w |= w >> 16;
+    do {
+        i ^= seed;
+        i *= 0xe170893d;
+        i ^= seed >> 16;
+        i ^= (i & w) >> 4;
+        i ^= seed >> 8;
+        i *= 0x0929eb3f;
+        i ^= seed >> 23;
+        i ^= (i & w) >> 1;
+        i *= 1 | seed >> 27;
+        i *= 0x6935fa69;
+        i ^= (i & w) >> 11;
+        i *= 0x74dcb303;
+        i ^= (i & w) >> 2;
+        i *= 0x9e501cc3;
+        i ^= (i & w) >> 2;
+        i *= 0xc860a3df;
+        i &= w;
+        i ^= i >> 5;
+    } while (i >= n);
+    return (i + seed) % n;
+}
+
 template <int base>
 inline uint64_t InverseRadicalInverse(uint64_t inverse, int nDigits) {
     uint64_t index = 0;
@@ -92,8 +163,9 @@ inline uint64_t InverseRadicalInverse(uint64_t inverse, int nDigits) {
 
 inline uint32_t MultiplyGenerator(const uint32_t *C, uint32_t a) {
     uint32_t v = 0;
-    for (int i = 0; a != 0; ++i, a >>= 1)
-        if (a & 1) v ^= C[i];
+    // Mask rather than branch on each bit; the bits of scrambled or
+    // permuted indices are unpredictable
+    for (int i = 0; a != 0; ++i, a >>= 1) v ^= C[i] & (0u - (a & 1));
     return v;
 }
 
@@ -285,6 +357,37 @@ inline double SobolSampleDouble(int64_t a, int dimension, uint64_t scramble) {
                     DoubleOneMinusEpsilon);
 }
 
+inline void SobolSampleDimensions(int64_t a, int dimension, int n,
+                                  Float *samples) {
+    CHECK_LE(dimension + n, NumSobolDimensions) <<
+        "Integrator has consumed too many Sobol' dimensions; you "
+        "may want to use a Sampler without a dimension limit like "
+        "\"02sequence\".";
+#ifdef PBRT_FLOAT_AS_DOUBLE
+    typedef uint64_t Bits;
+    const Bits *matrices = SobolMatrices64;
+    const Float scale = 1.0 / (1ULL << SobolMatrixSize);
+#else
+    typedef uint32_t Bits;
+    const Bits *matrices = SobolMatrices32;
+    const Float scale = 1.f / (1ULL << 32);
+#endif
+    // Process the dimensions in chunks, visiting each bit of _a_ once per
+    // chunk so that the test of each bit is shared by all of the chunk's
+    // dimensions
+    static PBRT_CONSTEXPR int chunkSize = 16;
+    for (int d0 = 0; d0 < n; d0 += chunkSize) {
+        int nd = std::min(chunkSize, n - d0);
+        Bits v[chunkSize] = {};
+        const Bits *c = &matrices[(dimension + d0) * SobolMatrixSize];
+        for (uint64_t b = a; b != 0; b >>= 1, ++c)
+            if (b & 1)
+                for (int d = 0; d < nd; ++d) v[d] ^= c[d * SobolMatrixSize];
+        for (int d = 0; d < nd; ++d)
+            samples[d0 + d] = std::min(v[d] * scale, OneMinusEpsilon);
+    }
+}
+
 }  // namespace pbrt
 
 #endif  // PBRT_CORE_LOWDISCREPANCY_H
@@ -178,12 +178,13 @@ static MeasuredSS SubsurfaceParameterTable[] = {
 // Media Definitions
 PhaseFunction::~PhaseFunction() { }
 
-bool GetMediumScatteringProperties(const std::string &name, Spectrum *sigma_a,
-                                   Spectrum *sigma_prime_s) {
+bool GetMediumScatteringProperties(const std::string &name,
+                                   SceneSpectrum *sigma_a,
+                                   SceneSpectrum *sigma_prime_s) {
     for (MeasuredSS &mss : SubsurfaceParameterTable) {
         if (name == mss.name) {
-            *sigma_a = Spectrum::FromRGB(mss.sigma_a);
-            *sigma_prime_s = Spectrum::FromRGB(mss.sigma_prime_s);
+            *sigma_a = SceneSpectrum::FromRGB(mss.sigma_a);
+            *sigma_prime_s = SceneSpectrum::FromRGB(mss.sigma_prime_s);
             return true;
         }
     }
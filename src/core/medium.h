@@ -62,8 +62,9 @@ inline std::ostream &operator<<(std::ostream &os, const PhaseFunction &p) {
     return os;
 }
 
-bool GetMediumScatteringProperties(const std::string &name, Spectrum *sigma_a,
-                                   Spectrum *sigma_s);
+bool GetMediumScatteringProperties(const std::string &name,
+                                   SceneSpectrum *sigma_a,
+                                   SceneSpectrum *sigma_s);
 
 // Media Inline Functions
 inline Float PhaseHG(Float cosTheta, Float g) {
@@ -33,9 +33,19 @@
 
 // core/memory.cpp*
 #include "memory.h"
+#include "parallel.h"
+#include "stats.h"
+#ifdef PBRT_HAVE_MMAP
+#include <sys/mman.h>
+#endif
 
 namespace pbrt {
 
+STAT_COUNTER("Memory/Thread arenas created", threadArenasCreated);
+STAT_MEMORY_COUNTER("Memory/Thread arenas", threadArenaBytes);
+STAT_INT_DISTRIBUTION("Memory/Thread arena high-water mark (KB)",
+                      threadArenaHighWaterKB);
+
 // Memory Allocation Functions
 void *AllocAligned(size_t size) {
 #if defined(PBRT_HAVE__ALIGNED_MALLOC)
@@ -49,6 +59,22 @@ void *AllocAligned(size_t size) {
 #endif
 }
 
+// Allocates memory aligned to the 2MB huge page size and asks the OS to back
+// it with transparent huge pages where that's supported; memory returned by
+// this function is also released with _FreeAligned()_.
+void *AllocAlignedHugePages(size_t size) {
+#if defined(PBRT_HAVE_POSIX_MEMALIGN) && defined(MADV_HUGEPAGE)
+    const size_t hugePageSize = 2 * 1024 * 1024;
+    size = (size + hugePageSize - 1) & ~(hugePageSize - 1);
+    void *ptr;
+    if (posix_memalign(&ptr, hugePageSize, size) != 0) return nullptr;
+    madvise(ptr, size, MADV_HUGEPAGE);
+    return ptr;
+#else
+    return AllocAligned(size);
+#endif
+}
+
 void FreeAligned(void *ptr) {
     if (!ptr) return;
 #if defined(PBRT_HAVE__ALIGNED_MALLOC)
@@ -58,4 +84,38 @@ void FreeAligned(void *ptr) {
 #endif
 }
 
+// ThreadArenaPool Method Definitions
+ThreadArenaPool::ThreadArenaPool() : arenas(MaxThreadIndex()) {}
+
+ThreadArenaPool::~ThreadArenaPool() {
+    // Record each thread's arena high-water mark; arenas never release
+    // their blocks, so the total allocated is the peak usage
+    for (const std::unique_ptr<MemoryArena> &arena : arenas) {
+        if (!arena) continue;
+        size_t allocated = arena->TotalAllocated();
+        threadArenaBytes += allocated;
+        ReportValue(threadArenaHighWaterKB, allocated / 1024);
+    }
+}
+
+MemoryArena &ThreadArenaPool::Get() {
+    // Only the thread with index _ThreadIndex_ accesses its slot, so
+    // arenas can be allocated lazily without locking
+    CHECK_LT(ThreadIndex, (int)arenas.size());
+    std::unique_ptr<MemoryArena> &arena = arenas[ThreadIndex];
+    if (!arena) {
+        const size_t hugePageSize = 2 * 1024 * 1024;
+        arena.reset(PbrtOptions.hugePages
+                        ? new MemoryArena(hugePageSize, true)
+                        : new MemoryArena);
+        ++threadArenasCreated;
+    }
+    return *arena;
+}
+
+void ThreadArenaPool::ResetAll() {
+    for (std::unique_ptr<MemoryArena> &arena : arenas)
+        if (arena) arena->Reset();
+}
+
 }  // namespace pbrt
@@ -42,6 +42,7 @@
 #include "pbrt.h"
 #include <list>
 #include <cstddef>
+#include <vector>
 
 namespace pbrt {
 
@@ -53,6 +54,7 @@ T *AllocAligned(size_t count) {
     return (T *)AllocAligned(count * sizeof(T));
 }
 
+void *AllocAlignedHugePages(size_t size);
 void FreeAligned(void *);
 class
 #ifdef PBRT_HAVE_ALIGNAS
@@ -61,7 +63,8 @@ alignas(PBRT_L1_CACHE_LINE_SIZE)
     MemoryArena {
   public:
     // MemoryArena Public Methods
-    MemoryArena(size_t blockSize = 262144) : blockSize(blockSize) {}
+    MemoryArena(size_t blockSize = 262144, bool hugePages = false)
+        : blockSize(blockSize), hugePages(hugePages) {}
     ~MemoryArena() {
         FreeAligned(currentBlock);
         for (auto &block : usedBlocks) FreeAligned(block.second);
@@ -104,7 +107,10 @@ alignas(PBRT_L1_CACHE_LINE_SIZE)
             }
             if (!currentBlock) {
                 currentAllocSize = std::max(nBytes, blockSize);
-                currentBlock = AllocAligned<uint8_t>(currentAllocSize);
+                currentBlock =
+                    hugePages
+                        ? (uint8_t *)AllocAlignedHugePages(currentAllocSize)
+                        : AllocAligned<uint8_t>(currentAllocSize);
             }
             currentBlockPos = 0;
         }
@@ -135,11 +141,30 @@ alignas(PBRT_L1_CACHE_LINE_SIZE)
     MemoryArena &operator=(const MemoryArena &) = delete;
     // MemoryArena Private Data
     const size_t blockSize;
+    const bool hugePages;
     size_t currentBlockPos = 0, currentAllocSize = 0;
     uint8_t *currentBlock = nullptr;
     std::list<std::pair<size_t, uint8_t *>> usedBlocks, availableBlocks;
 };
 
+// ThreadArenaPool holds one _MemoryArena_ per thread, indexed by
+// _ThreadIndex_, so that a render's tiles and passes reuse each thread's
+// arena blocks rather than allocating and freeing new ones every time.
+class ThreadArenaPool {
+  public:
+    // ThreadArenaPool Public Methods
+    ThreadArenaPool();
+    ~ThreadArenaPool();
+    MemoryArena &Get();
+    void ResetAll();
+
+  private:
+    ThreadArenaPool(const ThreadArenaPool &) = delete;
+    ThreadArenaPool &operator=(const ThreadArenaPool &) = delete;
+    // ThreadArenaPool Private Data
+    std::vector<std::unique_ptr<MemoryArena>> arenas;
+};
+
 template <typename T, int logBlockSize>
 class BlockedArray {
   public:
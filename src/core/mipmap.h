@@ -44,6 +44,8 @@
 #include "texture.h"
 #include "stats.h"
 #include "parallel.h"
+#include "texcache.h"
+#include <functional>
 
 namespace pbrt {
 
@@ -53,22 +55,43 @@ STAT_MEMORY_COUNTER("Memory/Texture MIP maps", mipMapMemory);
 
 // MIPMap Helper Declarations
 enum class ImageWrap { Repeat, Black, Clamp };
+enum class TexelFormat { Float, Half, SRGB8, BC };
 struct ResampleWeight {
     int firstTexel;
     Float weight[4];
 };
 
+// TexelChannels gives access to the components of a _MIPMap_ texel type
+template <typename T>
+struct TexelChannels {
+    static PBRT_CONSTEXPR int n = T::nSamples;
+    static Float Get(const T &v, int c) { return v[c]; }
+    static void Set(T *v, int c, Float x) { (*v)[c] = x; }
+};
+
+template <>
+struct TexelChannels<Float> {
+    static PBRT_CONSTEXPR int n = 1;
+    static Float Get(Float v, int c) { return v; }
+    static void Set(Float *v, int c, Float x) { *v = x; }
+};
+
 // MIPMap Declarations
 template <typename T>
 class MIPMap {
   public:
     // MIPMap Public Methods
     MIPMap(const Point2i &resolution, const T *data, bool doTri = false,
+           Float maxAniso = 8.f, ImageWrap wrapMode = ImageWrap::Repeat,
+           TexelFormat format = TexelFormat::Float);
+    MIPMap(TextureCache *cache, int texture,
+           std::function<T(const RGBSpectrum &)> convert, bool doTri = false,
            Float maxAniso = 8.f, ImageWrap wrapMode = ImageWrap::Repeat);
     int Width() const { return resolution[0]; }
     int Height() const { return resolution[1]; }
-    int Levels() const { return pyramid.size(); }
-    const T &Texel(int level, int s, int t) const;
+    int Levels() const { return levelResolution.size(); }
+    TexelFormat Format() const { return format; }
+    T Texel(int level, int s, int t) const;
     T Lookup(const Point2f &st, Float width = 0.f) const;
     T Lookup(const Point2f &st, Vector2f dstdx, Vector2f dstdy) const;
 
@@ -101,25 +124,51 @@ class MIPMap {
     }
     T triangle(int level, const Point2f &st) const;
     T EWA(int level, Point2f st, Vector2f dst0, Vector2f dst1) const;
+    std::unique_ptr<uint16_t[]> encodeLevel(const BlockedArray<T> &texels,
+                                            TexelFormat fmt) const;
+    T decodeTexel(int level, int s, int t) const;
+    static int blockSize(TexelFormat fmt) {
+        // Return the number of 16-bit words in an encoded block of texels
+        const int n = TexelChannels<T>::n;
+        switch (fmt) {
+        case TexelFormat::Half: return 16 * n;
+        case TexelFormat::SRGB8: return 8 * n;
+        // Two endpoints and 16 2-bit indices
+        case TexelFormat::BC: return 2 * n + 2;
+        default: return 0;
+        }
+    }
 
     // MIPMap Private Data
     const bool doTrilinear;
     const Float maxAnisotropy;
     const ImageWrap wrapMode;
     Point2i resolution;
+    TexelFormat format;
+    std::vector<Point2i> levelResolution;
     std::vector<std::unique_ptr<BlockedArray<T>>> pyramid;
-    static PBRT_CONSTEXPR int WeightLUTSize = 128;
-    static Float weightLut[WeightLUTSize];
+    // Texels stored in a format other than _TexelFormat::Float_ are
+    // encoded in 4x4 blocks, row by row
+    std::vector<std::unique_ptr<uint16_t[]>> encodedPyramid;
+    std::vector<TexelFormat> levelFormat;
+    // Texels of MIP maps stored in tiled files are paged in by _cache_
+    TextureCache *cache = nullptr;
+    int cacheTexture = -1;
+    std::function<T(const RGBSpectrum &)> convertCached;
+    static const Float weightCoeffs[8];
+    static Float srgb8ToLinear[256];
 };
 
 // MIPMap Method Definitions
 template <typename T>
 MIPMap<T>::MIPMap(const Point2i &res, const T *img, bool doTrilinear,
-                  Float maxAnisotropy, ImageWrap wrapMode)
+                  Float maxAnisotropy, ImageWrap wrapMode,
+                  TexelFormat storageFormat)
     : doTrilinear(doTrilinear),
       maxAnisotropy(maxAnisotropy),
       wrapMode(wrapMode),
-      resolution(res) {
+      resolution(res),
+      format(TexelFormat::Float) {
     ProfilePhase _(Prof::MIPMapCreation);
 
     std::unique_ptr<T[]> resampledImage = nullptr;
@@ -184,16 +233,53 @@ MIPMap<T>::MIPMap(const Point2i &res, const T *img, bool doTrilinear,
     // Initialize levels of MIPMap from image
     int nLevels = 1 + Log2Int(std::max(resolution[0], resolution[1]));
     pyramid.resize(nLevels);
+    levelResolution.reserve(nLevels);
+    const T *level0 = resampledImage ? resampledImage.get() : img;
+    const int n = TexelChannels<T>::n;
+    if (storageFormat == TexelFormat::SRGB8) {
+        // Fall back to half floats for images that 8-bit sRGB can't
+        // encode; any overshoot from resampling is clamped
+        Float maxValue = 0;
+        for (int i = 0; i < res[0] * res[1]; ++i)
+            for (int c = 0; c < n; ++c)
+                maxValue = std::max(maxValue, TexelChannels<T>::Get(img[i], c));
+        if (maxValue > 1) {
+            Warning("Texel values greater than one can't be stored as 8-bit "
+                    "sRGB. Using half-float storage.");
+            storageFormat = TexelFormat::Half;
+        } else if (srgb8ToLinear[255] == 0)
+            for (int i = 0; i < 256; ++i)
+                srgb8ToLinear[i] = InverseGammaCorrect(i / 255.f);
+    }
+    if (storageFormat != TexelFormat::Float) {
+        encodedPyramid.resize(nLevels);
+        levelFormat.resize(nLevels);
+    }
 
     // Initialize most detailed level of MIPMap
-    pyramid[0].reset(
-        new BlockedArray<T>(resolution[0], resolution[1],
-                            resampledImage ? resampledImage.get() : img));
+    pyramid[0].reset(new BlockedArray<T>(resolution[0], resolution[1], level0));
+    levelResolution.push_back(resolution);
+    size_t nEncodedWords = 0;
+    auto encode = [&](int i) {
+        // Replace the $i$th level's texels with their encoding; block
+        // compression can't represent the large color variations within
+        // the blocks of the coarsest levels, which are stored as half
+        // floats instead
+        const Point2i &res = levelResolution[i];
+        levelFormat[i] = storageFormat;
+        if (storageFormat == TexelFormat::BC && res[0] * res[1] < 256)
+            levelFormat[i] = TexelFormat::Half;
+        encodedPyramid[i] = encodeLevel(*pyramid[i], levelFormat[i]);
+        pyramid[i].reset();
+        int nBlocks = ((res[0] + 3) / 4) * ((res[1] + 3) / 4);
+        nEncodedWords += size_t(nBlocks) * blockSize(levelFormat[i]);
+    };
     for (int i = 1; i < nLevels; ++i) {
         // Initialize $i$th MIPMap level from $i-1$st level
         int sRes = std::max(1, pyramid[i - 1]->uSize() / 2);
         int tRes = std::max(1, pyramid[i - 1]->vSize() / 2);
         pyramid[i].reset(new BlockedArray<T>(sRes, tRes));
+        levelResolution.push_back(Point2i(sRes, tRes));
 
         // Filter four texels from finer level of pyramid
         ParallelFor([&](int t) {
@@ -204,41 +290,228 @@ MIPMap<T>::MIPMap(const Point2i &res, const T *img, bool doTrilinear,
                             Texel(i - 1, 2 * s, 2 * t + 1) +
                             Texel(i - 1, 2 * s + 1, 2 * t + 1));
         }, tRes, 16);
+        if (storageFormat != TexelFormat::Float) encode(i - 1);
     }
-
-    // Initialize EWA filter weights if needed
-    if (weightLut[0] == 0.) {
-        for (int i = 0; i < WeightLUTSize; ++i) {
-            Float alpha = 2;
-            Float r2 = Float(i) / Float(WeightLUTSize - 1);
-            weightLut[i] = std::exp(-alpha * r2) - std::exp(-alpha);
-        }
+    if (storageFormat != TexelFormat::Float) {
+        encode(nLevels - 1);
+        pyramid.clear();
+        format = storageFormat;
     }
-    mipMapMemory += (4 * resolution[0] * resolution[1] * sizeof(T)) / 3;
+
+    if (format == TexelFormat::Float)
+        mipMapMemory += (4 * resolution[0] * resolution[1] * sizeof(T)) / 3;
+    else
+        mipMapMemory += nEncodedWords * sizeof(uint16_t);
+}
+
+template <typename T>
+MIPMap<T>::MIPMap(TextureCache *cache, int texture,
+                  std::function<T(const RGBSpectrum &)> convert,
+                  bool doTrilinear, Float maxAnisotropy, ImageWrap wrapMode)
+    : doTrilinear(doTrilinear),
+      maxAnisotropy(maxAnisotropy),
+      wrapMode(wrapMode),
+      resolution(cache->LevelResolution(texture, 0)),
+      format(TexelFormat::Float),
+      cache(cache),
+      cacheTexture(texture),
+      convertCached(std::move(convert)) {
+    for (int level = 0; level < cache->Levels(texture); ++level)
+        levelResolution.push_back(cache->LevelResolution(texture, level));
 }
 
 template <typename T>
-const T &MIPMap<T>::Texel(int level, int s, int t) const {
-    CHECK_LT(level, pyramid.size());
-    const BlockedArray<T> &l = *pyramid[level];
+T MIPMap<T>::Texel(int level, int s, int t) const {
+    CHECK_LT(level, Levels());
+    const Point2i &res = levelResolution[level];
     // Compute texel $(s,t)$ accounting for boundary conditions
     switch (wrapMode) {
     case ImageWrap::Repeat:
-        s = Mod(s, l.uSize());
-        t = Mod(t, l.vSize());
+        s = Mod(s, res[0]);
+        t = Mod(t, res[1]);
         break;
     case ImageWrap::Clamp:
-        s = Clamp(s, 0, l.uSize() - 1);
-        t = Clamp(t, 0, l.vSize() - 1);
+        s = Clamp(s, 0, res[0] - 1);
+        t = Clamp(t, 0, res[1] - 1);
         break;
     case ImageWrap::Black: {
-        static const T black = 0.f;
-        if (s < 0 || s >= (int)l.uSize() || t < 0 || t >= (int)l.vSize())
-            return black;
+        if (s < 0 || s >= res[0] || t < 0 || t >= res[1]) return T(0.f);
         break;
     }
     }
-    return l(s, t);
+    if (cache) return convertCached(cache->Texel(cacheTexture, level, s, t));
+    if (format == TexelFormat::Float) return (*pyramid[level])(s, t);
+    return decodeTexel(level, s, t);
+}
+
+template <typename T>
+T MIPMap<T>::decodeTexel(int level, int s, int t) const {
+    const int n = TexelChannels<T>::n;
+    int nBlocksU = (levelResolution[level][0] + 3) >> 2;
+    const uint16_t *block =
+        encodedPyramid[level].get() +
+        blockSize(levelFormat[level]) * ((t >> 2) * nBlocksU + (s >> 2));
+    int i = 4 * (t & 3) + (s & 3);
+    T v;
+    switch (levelFormat[level]) {
+    case TexelFormat::Half:
+        for (int c = 0; c < n; ++c)
+            TexelChannels<T>::Set(&v, c, HalfToFloat(block[n * i + c]));
+        break;
+    case TexelFormat::SRGB8: {
+        const uint8_t *bytes = (const uint8_t *)block + n * i;
+        for (int c = 0; c < n; ++c)
+            TexelChannels<T>::Set(&v, c, srgb8ToLinear[bytes[c]]);
+        break;
+    }
+    case TexelFormat::BC: {
+        // Interpolate between the block's endpoints with the texel's index
+        uint32_t indices = block[2 * n] | (uint32_t(block[2 * n + 1]) << 16);
+        Float w = ((indices >> (2 * i)) & 3) * (1.f / 3.f);
+        for (int c = 0; c < n; ++c)
+            TexelChannels<T>::Set(&v, c, Lerp(w, HalfToFloat(block[c]),
+                                              HalfToFloat(block[n + c])));
+        break;
+    }
+    default:
+        LOG(FATAL) << "Unexpected texel format";
+    }
+    return v;
+}
+
+template <typename T>
+std::unique_ptr<uint16_t[]> MIPMap<T>::encodeLevel(
+    const BlockedArray<T> &texels, TexelFormat fmt) const {
+    const int n = TexelChannels<T>::n;
+    int nBlocksU = (texels.uSize() + 3) / 4, nBlocksV = (texels.vSize() + 3) / 4;
+    std::unique_ptr<uint16_t[]> encoded(
+        new uint16_t[size_t(nBlocksU) * nBlocksV * blockSize(fmt)]);
+    auto toHalf = [](Float v) { return FloatToHalf(std::min<Float>(v, 65504)); };
+    ParallelFor([&](int bv) {
+        std::vector<Float> x(16 * n), q(2 * n), e(2 * n);
+        for (int bu = 0; bu < nBlocksU; ++bu) {
+            // Gather the block's texels, replicating edge texels of levels
+            // smaller than a block
+            for (int i = 0; i < 16; ++i) {
+                int s = std::min(4 * bu + (i & 3), texels.uSize() - 1);
+                int t = std::min(4 * bv + (i >> 2), texels.vSize() - 1);
+                for (int c = 0; c < n; ++c)
+                    x[n * i + c] = TexelChannels<T>::Get(texels(s, t), c);
+            }
+            uint16_t *block =
+                encoded.get() + size_t(blockSize(fmt)) * (bv * nBlocksU + bu);
+            if (fmt == TexelFormat::Half) {
+                for (int i = 0; i < 16 * n; ++i) block[i] = toHalf(x[i]);
+                continue;
+            } else if (fmt == TexelFormat::SRGB8) {
+                uint8_t *bytes = (uint8_t *)block;
+                for (int i = 0; i < 16 * n; ++i)
+                    bytes[i] = (uint8_t)Clamp(
+                        255.f * GammaCorrect(x[i]) + 0.5f, 0.f, 255.f);
+                continue;
+            }
+
+            // Compute the block's principal axis with power iteration
+            CHECK(fmt == TexelFormat::BC);
+            std::vector<Float> mean(n, 0.f), axis(n), lo(n), hi(n);
+            for (int c = 0; c < n; ++c) lo[c] = hi[c] = x[c];
+            for (int i = 0; i < 16; ++i)
+                for (int c = 0; c < n; ++c) {
+                    mean[c] += x[n * i + c] / 16;
+                    lo[c] = std::min(lo[c], x[n * i + c]);
+                    hi[c] = std::max(hi[c], x[n * i + c]);
+                }
+            for (int c = 0; c < n; ++c) axis[c] = hi[c] - lo[c];
+            for (int iter = 0; iter < 4; ++iter) {
+                std::vector<Float> next(n, 0.f);
+                for (int i = 0; i < 16; ++i) {
+                    Float d = 0;
+                    for (int c = 0; c < n; ++c)
+                        d += (x[n * i + c] - mean[c]) * axis[c];
+                    for (int c = 0; c < n; ++c)
+                        next[c] += d * (x[n * i + c] - mean[c]);
+                }
+                Float maxComponent = 0;
+                for (int c = 0; c < n; ++c)
+                    maxComponent = std::max(maxComponent, std::abs(next[c]));
+                if (maxComponent == 0) break;
+                for (int c = 0; c < n; ++c) axis[c] = next[c] / maxComponent;
+            }
+
+            // Set the endpoints to the extent of the texels along the axis
+            Float axisLength2 = 0, pMin = 0, pMax = 0;
+            for (int c = 0; c < n; ++c) axisLength2 += axis[c] * axis[c];
+            if (axisLength2 > 0)
+                for (int i = 0; i < 16; ++i) {
+                    Float p = 0;
+                    for (int c = 0; c < n; ++c)
+                        p += (x[n * i + c] - mean[c]) * axis[c];
+                    pMin = std::min(pMin, p / axisLength2);
+                    pMax = std::max(pMax, p / axisLength2);
+                }
+            for (int c = 0; c < n; ++c) {
+                e[c] = mean[c] + pMin * axis[c];
+                e[n + c] = mean[c] + pMax * axis[c];
+            }
+
+            // Quantize the endpoints and choose each texel's index; refit
+            // the endpoints to the indices by least squares and keep the
+            // refit if it reduces the error
+            uint32_t indices = 0;
+            Float bestErr = Infinity;
+            for (int pass = 0; pass < 2; ++pass) {
+                for (int c = 0; c < 2 * n; ++c)
+                    q[c] = HalfToFloat(toHalf(std::max<Float>(0, e[c])));
+                Float len2 = 0;
+                for (int c = 0; c < n; ++c)
+                    len2 += (q[n + c] - q[c]) * (q[n + c] - q[c]);
+                uint32_t passIndices = 0;
+                Float err = 0;
+                for (int i = 0; i < 16; ++i) {
+                    Float p = 0;
+                    for (int c = 0; c < n; ++c)
+                        p += (x[n * i + c] - q[c]) * (q[n + c] - q[c]);
+                    int k = len2 > 0 ? Clamp((int)std::round(3 * p / len2),
+                                             0, 3)
+                                     : 0;
+                    passIndices |= uint32_t(k) << (2 * i);
+                    for (int c = 0; c < n; ++c) {
+                        Float d = x[n * i + c] - Lerp(k / 3.f, q[c], q[n + c]);
+                        err += d * d;
+                    }
+                }
+                if (err < bestErr) {
+                    bestErr = err;
+                    indices = passIndices;
+                    for (int c = 0; c < 2 * n; ++c) block[c] = toHalf(q[c]);
+                }
+                if (pass == 1) break;
+
+                Float a00 = 0, a01 = 0, a11 = 0;
+                for (int c = 0; c < 2 * n; ++c) e[c] = 0;
+                for (int i = 0; i < 16; ++i) {
+                    Float w = ((passIndices >> (2 * i)) & 3) / 3.f;
+                    a00 += (1 - w) * (1 - w);
+                    a01 += (1 - w) * w;
+                    a11 += w * w;
+                    for (int c = 0; c < n; ++c) {
+                        e[c] += (1 - w) * x[n * i + c];
+                        e[n + c] += w * x[n * i + c];
+                    }
+                }
+                Float det = a00 * a11 - a01 * a01;
+                if (det == 0) break;
+                for (int c = 0; c < n; ++c) {
+                    Float b0 = e[c], b1 = e[n + c];
+                    e[c] = (a11 * b0 - a01 * b1) / det;
+                    e[n + c] = (a00 * b1 - a01 * b0) / det;
+                }
+            }
+            block[2 * n] = indices & 0xffff;
+            block[2 * n + 1] = indices >> 16;
+        }
+    }, nBlocksV);
+    return encoded;
 }
 
 template <typename T>
@@ -263,8 +536,8 @@ T MIPMap<T>::Lookup(const Point2f &st, Float width) const {
 template <typename T>
 T MIPMap<T>::triangle(int level, const Point2f &st) const {
     level = Clamp(level, 0, Levels() - 1);
-    Float s = st[0] * pyramid[level]->uSize() - 0.5f;
-    Float t = st[1] * pyramid[level]->vSize() - 0.5f;
+    Float s = st[0] * levelResolution[level][0] - 0.5f;
+    Float t = st[1] * levelResolution[level][1] - 0.5f;
     int s0 = std::floor(s), t0 = std::floor(t);
     Float ds = s - s0, dt = t - t0;
     return (1 - ds) * (1 - dt) * Texel(level, s0, t0) +
@@ -306,12 +579,12 @@ template <typename T>
 T MIPMap<T>::EWA(int level, Point2f st, Vector2f dst0, Vector2f dst1) const {
     if (level >= Levels()) return Texel(Levels() - 1, 0, 0);
     // Convert EWA coordinates to appropriate scale for level
-    st[0] = st[0] * pyramid[level]->uSize() - 0.5f;
-    st[1] = st[1] * pyramid[level]->vSize() - 0.5f;
-    dst0[0] *= pyramid[level]->uSize();
-    dst0[1] *= pyramid[level]->vSize();
-    dst1[0] *= pyramid[level]->uSize();
-    dst1[1] *= pyramid[level]->vSize();
+    st[0] = st[0] * levelResolution[level][0] - 0.5f;
+    st[1] = st[1] * levelResolution[level][1] - 0.5f;
+    dst0[0] *= levelResolution[level][0];
+    dst0[1] *= levelResolution[level][1];
+    dst1[0] *= levelResolution[level][0];
+    dst1[1] *= levelResolution[level][1];
 
     // Compute ellipse coefficients to bound EWA filter region
     Float A = dst0[1] * dst0[1] + dst1[1] * dst1[1] + 1;
@@ -331,29 +604,96 @@ T MIPMap<T>::EWA(int level, Point2f st, Vector2f dst0, Vector2f dst1) const {
     int t0 = std::ceil(st[1] - 2 * invDet * vSqrt);
     int t1 = std::floor(st[1] + 2 * invDet * vSqrt);
 
-    // Scan over ellipse bound and compute quadratic equation
+    // Texels can be read directly if the bound is inside the level
+    const Point2i &res = levelResolution[level];
+    bool direct = format == TexelFormat::Float && !cache && s0 >= 0 &&
+                  s1 < res[0] && t0 >= 0 && t1 < res[1];
+
+    // Scan over ellipse bound four texels at a time, computing the
+    // quadratic equation and Gaussian filter weights in SIMD lanes and
+    // skipping groups entirely outside the ellipse. Groups start at
+    // multiples of four so that their texels are contiguous in the level's
+    // blocks; when the texels can be read directly, their weighted sum is
+    // accumulated in SIMD lanes too and only gathered into a _T_ at the end.
+    static const Float laneOffsets[4] = {0, 1, 2, 3};
+    static PBRT_CONSTEXPR int n = TexelChannels<T>::n;
+    static_assert(sizeof(T) == n * sizeof(Float),
+                  "Texel channels must be stored contiguously");
+    const Float4 A4(A), one(1.f), zero(0.f);
+    Float4 sumWts(0.f), sums[n];
+    for (int k = 0; k < n; ++k) sums[k] = zero;
     T sum(0.f);
-    Float sumWts = 0;
     for (int it = t0; it <= t1; ++it) {
         Float tt = it - st[1];
-        for (int is = s0; is <= s1; ++is) {
-            Float ss = is - st[0];
-            // Compute squared radius and filter texel if inside ellipse
-            Float r2 = A * ss * ss + B * ss * tt + C * tt * tt;
-            if (r2 < 1) {
-                int index =
-                    std::min((int)(r2 * WeightLUTSize), WeightLUTSize - 1);
-                Float weight = weightLut[index];
-                sum += Texel(level, is, it) * weight;
-                sumWts += weight;
-            }
+        Float4 Btt(B * tt), Ctt2(C * tt * tt);
+        for (int is = s0 & ~3; is <= s1; is += 4) {
+            Float4 ss = Float4(is - st[0]) + Float4::Load(laneOffsets);
+            Float4 r2 = (A4 * ss + Btt) * ss + Ctt2;
+            // Evaluate the Gaussian weights $e^{-\alpha r^2} - e^{-\alpha}$,
+            // with $\alpha = 2$, using their Taylor series in $y = 1 - r^2$,
+            // which is exactly zero at the ellipse's boundary
+            Float4 y = Max(one - r2, zero);
+            if (AllZero(y)) continue;
+            Float4 weights(weightCoeffs[7]);
+            for (int k = 6; k >= 0; --k)
+                weights = weights * y + Float4(weightCoeffs[k]);
+            weights = weights * y;
+            sumWts = sumWts + weights;
+            Float wts[4];
+            weights.Store(wts);
+            if (direct) {
+                // Repeat each texel's weight for its interleaved channels
+                const T &first = (*pyramid[level])(is, it);
+                const Float *texels = reinterpret_cast<const Float *>(&first);
+                if (n == 1)
+                    sums[0] = sums[0] + weights * Float4::Load(texels);
+                else if (n == 3) {
+                    sums[0] = sums[0] + weights.Shuffle<0, 0, 0, 1>() *
+                                            Float4::Load(&texels[0]);
+                    sums[1] = sums[1] + weights.Shuffle<1, 1, 2, 2>() *
+                                            Float4::Load(&texels[4]);
+                    sums[2] = sums[2] + weights.Shuffle<2, 3, 3, 3>() *
+                                            Float4::Load(&texels[8]);
+                } else if (n % 4 == 0) {
+                    for (int i = 0; i < 4; ++i) {
+                        Float4 wt(wts[i]);
+                        for (int k = i * n / 4; k < (i + 1) * n / 4; ++k)
+                            sums[k] =
+                                sums[k] + wt * Float4::Load(&texels[4 * k]);
+                    }
+                } else {
+                    Float channelWts[4 * n];
+                    for (int j = 0; j < 4 * n; ++j) channelWts[j] = wts[j / n];
+                    for (int k = 0; k < n; ++k)
+                        sums[k] = sums[k] + Float4::Load(&channelWts[4 * k]) *
+                                                Float4::Load(&texels[4 * k]);
+                }
+            } else
+                for (int i = 0; i < 4; ++i)
+                    if (wts[i] > 0) sum += wts[i] * Texel(level, is + i, it);
         }
     }
-    return sum / sumWts;
+    if (direct) {
+        // Add up the lanes' sums for each channel
+        Float lanes[4 * n];
+        for (int k = 0; k < n; ++k) sums[k].Store(&lanes[4 * k]);
+        for (int j = 0; j < 4 * n; ++j)
+            TexelChannels<T>::Set(&sum, j % n,
+                                  TexelChannels<T>::Get(sum, j % n) + lanes[j]);
+    }
+    return sum / HorizontalSum(sumWts);
 }
 
+// Coefficients of $y$ in the Taylor series of $e^{-2 (1 - y)} - e^{-2}$,
+// divided by $y$; the truncated series is within $2.5 \times 10^{-4}$ of it
+// for $y \in [0,1]$
+template <typename T>
+const Float MIPMap<T>::weightCoeffs[8] = {
+    0.270670566f,  0.270670566f, 0.180447044f,  0.0902235222f,
+    0.0360894089f, 0.012029803f, 0.00343708656f, 0.00085927164f};
+
 template <typename T>
-Float MIPMap<T>::weightLut[WeightLUTSize];
+Float MIPMap<T>::srgb8ToLinear[256];
 
 }  // namespace pbrt
 
@@ -112,10 +112,11 @@ void ParamSet::AddRGBSpectrum(const std::string &name,
     EraseSpectrum(name);
     CHECK_EQ(nValues % 3, 0);
     nValues /= 3;
-    std::unique_ptr<Spectrum[]> s(new Spectrum[nValues]);
-    for (int i = 0; i < nValues; ++i) s[i] = Spectrum::FromRGB(&values[3 * i]);
-    std::shared_ptr<ParamSetItem<Spectrum>> psi(
-        new ParamSetItem<Spectrum>(name, std::move(s), nValues));
+    std::unique_ptr<SceneSpectrum[]> s(new SceneSpectrum[nValues]);
+    for (int i = 0; i < nValues; ++i)
+        s[i] = SceneSpectrum::FromRGB(&values[3 * i]);
+    std::shared_ptr<ParamSetItem<SceneSpectrum>> psi(
+        new ParamSetItem<SceneSpectrum>(name, std::move(s), nValues));
     spectra.push_back(psi);
 }
 
@@ -124,10 +125,11 @@ void ParamSet::AddXYZSpectrum(const std::string &name,
     EraseSpectrum(name);
     CHECK_EQ(nValues % 3, 0);
     nValues /= 3;
-    std::unique_ptr<Spectrum[]> s(new Spectrum[nValues]);
-    for (int i = 0; i < nValues; ++i) s[i] = Spectrum::FromXYZ(&values[3 * i]);
-    std::shared_ptr<ParamSetItem<Spectrum>> psi(
-        new ParamSetItem<Spectrum>(name, std::move(s), nValues));
+    std::unique_ptr<SceneSpectrum[]> s(new SceneSpectrum[nValues]);
+    for (int i = 0; i < nValues; ++i)
+        s[i] = SceneSpectrum::FromXYZ(&values[3 * i]);
+    std::shared_ptr<ParamSetItem<SceneSpectrum>> psi(
+        new ParamSetItem<SceneSpectrum>(name, std::move(s), nValues));
     spectra.push_back(psi);
 }
 
@@ -137,15 +139,15 @@ void ParamSet::AddBlackbodySpectrum(const std::string &name,
     EraseSpectrum(name);
     CHECK_EQ(nValues % 2, 0);  // temperature (K), scale, ...
     nValues /= 2;
-    std::unique_ptr<Spectrum[]> s(new Spectrum[nValues]);
+    std::unique_ptr<SceneSpectrum[]> s(new SceneSpectrum[nValues]);
     std::unique_ptr<Float[]> v(new Float[nCIESamples]);
     for (int i = 0; i < nValues; ++i) {
         BlackbodyNormalized(CIE_lambda, nCIESamples, values[2 * i], v.get());
         s[i] = values[2 * i + 1] *
-               Spectrum::FromSampled(CIE_lambda, v.get(), nCIESamples);
+               SceneSpectrum::FromSampled(CIE_lambda, v.get(), nCIESamples);
     }
-    std::shared_ptr<ParamSetItem<Spectrum>> psi(
-        new ParamSetItem<Spectrum>(name, std::move(s), nValues));
+    std::shared_ptr<ParamSetItem<SceneSpectrum>> psi(
+        new ParamSetItem<SceneSpectrum>(name, std::move(s), nValues));
     spectra.push_back(psi);
 }
 
@@ -161,17 +163,17 @@ void ParamSet::AddSampledSpectrum(const std::string &name,
         wl[i] = values[2 * i];
         v[i] = values[2 * i + 1];
     }
-    std::unique_ptr<Spectrum[]> s(new Spectrum[1]);
-    s[0] = Spectrum::FromSampled(wl.get(), v.get(), nValues);
-    std::shared_ptr<ParamSetItem<Spectrum>> psi(
-        new ParamSetItem<Spectrum>(name, std::move(s), 1));
+    std::unique_ptr<SceneSpectrum[]> s(new SceneSpectrum[1]);
+    s[0] = SceneSpectrum::FromSampled(wl.get(), v.get(), nValues);
+    std::shared_ptr<ParamSetItem<SceneSpectrum>> psi(
+        new ParamSetItem<SceneSpectrum>(name, std::move(s), 1));
     spectra.push_back(psi);
 }
 
 void ParamSet::AddSampledSpectrumFiles(const std::string &name,
                                        const char **names, int nValues) {
     EraseSpectrum(name);
-    std::unique_ptr<Spectrum[]> s(new Spectrum[nValues]);
+    std::unique_ptr<SceneSpectrum[]> s(new SceneSpectrum[nValues]);
     for (int i = 0; i < nValues; ++i) {
         std::string fn = AbsolutePath(ResolveFilename(names[i]));
         if (cachedSpectra.find(fn) != cachedSpectra.end()) {
@@ -184,7 +186,7 @@ void ParamSet::AddSampledSpectrumFiles(const std::string &name,
             Warning(
                 "Unable to read SPD file \"%s\".  Using black distribution.",
                 fn.c_str());
-            s[i] = Spectrum(0.);
+            s[i] = SceneSpectrum(0.);
         } else {
             if (vals.size() % 2) {
                 Warning(
@@ -197,17 +199,17 @@ void ParamSet::AddSampledSpectrumFiles(const std::string &name,
                 wls.push_back(vals[2 * j]);
                 v.push_back(vals[2 * j + 1]);
             }
-            s[i] = Spectrum::FromSampled(&wls[0], &v[0], wls.size());
+            s[i] = SceneSpectrum::FromSampled(&wls[0], &v[0], wls.size());
         }
         cachedSpectra[fn] = s[i];
     }
 
-    std::shared_ptr<ParamSetItem<Spectrum>> psi(
-        new ParamSetItem<Spectrum>(name, std::move(s), nValues));
+    std::shared_ptr<ParamSetItem<SceneSpectrum>> psi(
+        new ParamSetItem<SceneSpectrum>(name, std::move(s), nValues));
     spectra.push_back(psi);
 }
 
-std::map<std::string, Spectrum> ParamSet::cachedSpectra;
+std::map<std::string, SceneSpectrum> ParamSet::cachedSpectra;
 void ParamSet::AddString(const std::string &name,
                          std::unique_ptr<std::string[]> values, int nValues) {
     EraseString(name);
@@ -407,13 +409,13 @@ Normal3f ParamSet::FindOneNormal3f(const std::string &name,
     LOOKUP_ONE(normals);
 }
 
-const Spectrum *ParamSet::FindSpectrum(const std::string &name,
+const SceneSpectrum *ParamSet::FindSpectrum(const std::string &name,
                                        int *nValues) const {
     LOOKUP_PTR(spectra);
 }
 
-Spectrum ParamSet::FindOneSpectrum(const std::string &name,
-                                   const Spectrum &d) const {
+SceneSpectrum ParamSet::FindOneSpectrum(const std::string &name,
+                                   const SceneSpectrum &d) const {
     LOOKUP_ONE(spectra);
 }
 
@@ -625,7 +627,7 @@ std::string ParamSet::ToString() const {
         ret += std::string("] ");
     }
     for (i = 0; i < spectra.size(); ++i) {
-        const std::shared_ptr<ParamSetItem<Spectrum>> &item = spectra[i];
+        const std::shared_ptr<ParamSetItem<SceneSpectrum>> &item = spectra[i];
         typeString = "color ";
         // Print _ParamSetItem_ declaration, determine how many to print
         int nPrint = item->nValues;
@@ -678,7 +680,7 @@ static int print(const Normal3f &n) {
     return np + print(n.z);
 }
 static int print(const std::string &s) { return printf("\"%s\" ", s.c_str()); }
-static int print(const Spectrum &s) {
+static int print(const SceneSpectrum &s) {
     Float rgb[3];
     s.ToRGB(rgb);
     int np = print(rgb[0]);
@@ -718,7 +720,7 @@ void ParamSet::Print(int indent) const {
 
 // TextureParams Method Definitions
 std::shared_ptr<Texture<Spectrum>> TextureParams::GetSpectrumTexture(
-    const std::string &n, const Spectrum &def) const {
+    const std::string &n, const SceneSpectrum &def) const {
     std::shared_ptr<Texture<Spectrum>> tex = GetSpectrumTextureOrNull(n);
     if (tex)
         return tex;
@@ -732,7 +734,7 @@ std::shared_ptr<Texture<Spectrum>> TextureParams::GetSpectrumTextureOrNull(
     std::string name = geomParams.FindTexture(n);
     if (name.empty()) {
         int count;
-        const Spectrum *s = geomParams.FindSpectrum(n, &count);
+        const SceneSpectrum *s = geomParams.FindSpectrum(n, &count);
         if (s) {
             if (count > 1)
                 Warning("Ignoring excess values provided with parameter \"%s\"",
@@ -743,7 +745,7 @@ std::shared_ptr<Texture<Spectrum>> TextureParams::GetSpectrumTextureOrNull(
         name = materialParams.FindTexture(n);
         if (name.empty()) {
             int count;
-            const Spectrum *s = materialParams.FindSpectrum(n, &count);
+            const SceneSpectrum *s = materialParams.FindSpectrum(n, &count);
             if (s) {
                 if (count > 1)
                     Warning("Ignoring excess values provided with parameter \"%s\"",
@@ -100,7 +100,8 @@ class ParamSet {
     Point3f FindOnePoint3f(const std::string &, const Point3f &d) const;
     Vector3f FindOneVector3f(const std::string &, const Vector3f &d) const;
     Normal3f FindOneNormal3f(const std::string &, const Normal3f &d) const;
-    Spectrum FindOneSpectrum(const std::string &, const Spectrum &d) const;
+    SceneSpectrum FindOneSpectrum(const std::string &,
+                                  const SceneSpectrum &d) const;
     std::string FindOneString(const std::string &, const std::string &d) const;
     std::string FindOneFilename(const std::string &,
                                 const std::string &d) const;
@@ -113,7 +114,7 @@ class ParamSet {
     const Point3f *FindPoint3f(const std::string &, int *nValues) const;
     const Vector3f *FindVector3f(const std::string &, int *nValues) const;
     const Normal3f *FindNormal3f(const std::string &, int *nValues) const;
-    const Spectrum *FindSpectrum(const std::string &, int *nValues) const;
+    const SceneSpectrum *FindSpectrum(const std::string &, int *nValues) const;
     const std::string *FindString(const std::string &, int *nValues) const;
     void ReportUnused() const;
     void Clear();
@@ -133,10 +134,10 @@ class ParamSet {
     std::vector<std::shared_ptr<ParamSetItem<Point3f>>> point3fs;
     std::vector<std::shared_ptr<ParamSetItem<Vector3f>>> vector3fs;
     std::vector<std::shared_ptr<ParamSetItem<Normal3f>>> normals;
-    std::vector<std::shared_ptr<ParamSetItem<Spectrum>>> spectra;
+    std::vector<std::shared_ptr<ParamSetItem<SceneSpectrum>>> spectra;
     std::vector<std::shared_ptr<ParamSetItem<std::string>>> strings;
     std::vector<std::shared_ptr<ParamSetItem<std::string>>> textures;
-    static std::map<std::string, Spectrum> cachedSpectra;
+    static std::map<std::string, SceneSpectrum> cachedSpectra;
 };
 
 template <typename T>
@@ -171,7 +172,7 @@ class TextureParams {
           geomParams(geomParams),
           materialParams(materialParams) {}
     std::shared_ptr<Texture<Spectrum>> GetSpectrumTexture(
-        const std::string &name, const Spectrum &def) const;
+        const std::string &name, const SceneSpectrum &def) const;
     std::shared_ptr<Texture<Spectrum>> GetSpectrumTextureOrNull(
         const std::string &name) const;
     std::shared_ptr<Texture<Float>> GetFloatTexture(const std::string &name,
@@ -208,7 +209,8 @@ class TextureParams {
         return geomParams.FindOneNormal3f(n,
                                           materialParams.FindOneNormal3f(n, d));
     }
-    Spectrum FindSpectrum(const std::string &n, const Spectrum &d) const {
+    SceneSpectrum FindSpectrum(const std::string &n,
+                               const SceneSpectrum &d) const {
         return geomParams.FindOneSpectrum(n,
                                           materialParams.FindOneSpectrum(n, d));
     }
@@ -123,10 +123,16 @@ template <int nSpectrumSamples>
 class CoefficientSpectrum;
 class RGBSpectrum;
 class SampledSpectrum;
-#ifdef PBRT_SAMPLED_SPECTRUM
+class HeroSpectrum;
+#if defined(PBRT_HERO_SPECTRUM)
+  typedef HeroSpectrum Spectrum;
+  typedef SampledSpectrum SceneSpectrum;
+#elif defined(PBRT_SAMPLED_SPECTRUM)
   typedef SampledSpectrum Spectrum;
+  typedef SampledSpectrum SceneSpectrum;
 #else
   typedef RGBSpectrum Spectrum;
+  typedef RGBSpectrum SceneSpectrum;
 #endif
 class Camera;
 struct CameraSample;
@@ -152,6 +158,7 @@ struct BSSRDFTable;
 class Light;
 class VisibilityTester;
 class AreaLight;
+class LightDistribution;
 struct Distribution1D;
 class Distribution2D;
 #ifdef PBRT_FLOAT_AS_DOUBLE
@@ -182,6 +189,21 @@ struct Options {
     std::string imageFile;
     // x0, x1, y0, y1
     Float cropWindow[2][2];
+    // Distributed rendering: this process renders the _nodeIndex_th of
+    // _nodeCount_ contiguous ranges of image tiles.
+    int nodeIndex = 0, nodeCount = 1;
+    // Render state is checkpointed every _checkpointInterval_ seconds if
+    // it's positive; _resume_ restarts from an existing checkpoint.
+    Float checkpointInterval = 0;
+    bool resume = false;
+    // Back per-thread rendering arenas with huge pages when available.
+    bool hugePages = false;
+    // Memory available for the tiles of textures stored in tiled files.
+    int textureCacheMB = 512;
+    // Limits of the cache shared by all Ptex textures.
+    int ptexCacheMB = 4096, ptexMaxFiles = 100;
+    // Sample Distribution1Ds with alias tables rather than CDF inversion.
+    bool aliasSampling = false;
 };
 
 extern Options PbrtOptions;
@@ -238,6 +260,43 @@ inline double BitsToFloat(uint64_t ui) {
     return f;
 }
 
+inline uint16_t FloatToHalf(float f) {
+    // Convert to IEEE half precision with round-to-nearest-even, mapping
+    // values too large for a half to infinity and NaNs to a quiet NaN
+    uint32_t ui = FloatToBits(f);
+    uint32_t sign = ui & 0x80000000u;
+    ui ^= sign;
+    uint16_t h;
+    if (ui >= (143u << 23))
+        h = ui > (255u << 23) ? 0x7e00 : 0x7c00;
+    else if (ui < (113u << 23)) {
+        // Let the floating-point adder round the half denormal
+        const uint32_t denormMagic = 126u << 23;
+        h = FloatToBits(BitsToFloat(ui) + BitsToFloat(denormMagic)) -
+            denormMagic;
+    } else {
+        uint32_t mantOdd = (ui >> 13) & 1;
+        ui += 0xc8000fffu + mantOdd;
+        h = ui >> 13;
+    }
+    return h | (sign >> 16);
+}
+
+inline float HalfToFloat(uint16_t h) {
+    uint32_t ui = uint32_t(h & 0x7fff) << 13;
+    uint32_t exp = ui & (0x7c00u << 13);
+    ui += (127 - 15) << 23;
+    if (exp == (0x7c00u << 13))
+        // Infinity or NaN
+        ui += (128 - 16) << 23;
+    else if (exp == 0) {
+        // Zero or denormal; renormalize with a floating-point subtraction
+        ui += 1 << 23;
+        ui = FloatToBits(BitsToFloat(ui) - BitsToFloat(113u << 23));
+    }
+    return BitsToFloat(ui | (uint32_t(h & 0x8000) << 16));
+}
+
 inline float NextFloatUp(float v) {
     // Handle infinity and negative zero for _NextFloatUp()_
     if (std::isinf(v) && v > 0.) return v;
@@ -321,6 +380,21 @@ inline Float Mod(Float a, Float b) {
     return std::fmod(a, b);
 }
 
+inline Float SafeASin(Float x) {
+    CHECK(x >= -1.0001 && x <= 1.0001);
+    return std::asin(Clamp(x, -1, 1));
+}
+
+inline Float SafeACos(Float x) {
+    CHECK(x >= -1.0001 && x <= 1.0001);
+    return std::acos(Clamp(x, -1, 1));
+}
+
+inline Float SafeSqrt(Float x) {
+    CHECK_GE(x, -1e-4);
+    return std::sqrt(std::max(Float(0), x));
+}
+
 inline Float Radians(Float deg) { return (Pi / 180) * deg; }
 
 inline Float Degrees(Float rad) { return (180 / Pi) * rad; }
@@ -88,11 +88,12 @@ bool TransformedPrimitive::Intersect(const Ray &r,
     return true;
 }
 
-bool TransformedPrimitive::IntersectP(const Ray &r) const {
+bool TransformedPrimitive::IntersectP(const Ray &r,
+                                      bool testAlphaTexture) const {
     Transform InterpolatedPrimToWorld;
     PrimitiveToWorld.Interpolate(r.time, &InterpolatedPrimToWorld);
     Transform InterpolatedWorldToPrim = Inverse(InterpolatedPrimToWorld);
-    return primitive->IntersectP(InterpolatedWorldToPrim(r));
+    return primitive->IntersectP(InterpolatedWorldToPrim(r), testAlphaTexture);
 }
 
 // GeometricPrimitive Method Definitions
@@ -109,8 +110,9 @@ GeometricPrimitive::GeometricPrimitive(const std::shared_ptr<Shape> &shape,
 
 Bounds3f GeometricPrimitive::WorldBound() const { return shape->WorldBound(); }
 
-bool GeometricPrimitive::IntersectP(const Ray &r) const {
-    return shape->IntersectP(r);
+bool GeometricPrimitive::IntersectP(const Ray &r,
+                                    bool testAlphaTexture) const {
+    return shape->IntersectP(r, testAlphaTexture);
 }
 
 bool GeometricPrimitive::Intersect(const Ray &r,
@@ -54,7 +54,15 @@ class Primitive {
     virtual ~Primitive();
     virtual Bounds3f WorldBound() const = 0;
     virtual bool Intersect(const Ray &r, SurfaceInteraction *) const = 0;
-    virtual bool IntersectP(const Ray &r) const = 0;
+    virtual bool IntersectP(const Ray &r,
+                            bool testAlphaTexture = true) const = 0;
+    // Returns the primitive that occludes _r_, or _nullptr_ if nothing
+    // does; aggregates return the one of their primitives that was hit
+    virtual const Primitive *Occluder(const Ray &r,
+                                      bool testAlphaTexture = true) const {
+        return IntersectP(r, testAlphaTexture) ? this : nullptr;
+    }
+    virtual bool HasAlphaMask() const { return false; }
     virtual const AreaLight *GetAreaLight() const = 0;
     virtual const Material *GetMaterial() const = 0;
     virtual void ComputeScatteringFunctions(SurfaceInteraction *isect,
@@ -69,7 +77,8 @@ class GeometricPrimitive : public Primitive {
     // GeometricPrimitive Public Methods
     virtual Bounds3f WorldBound() const;
     virtual bool Intersect(const Ray &r, SurfaceInteraction *isect) const;
-    virtual bool IntersectP(const Ray &r) const;
+    virtual bool IntersectP(const Ray &r, bool testAlphaTexture = true) const;
+    bool HasAlphaMask() const { return shape->HasAlphaMask(); }
     GeometricPrimitive(const std::shared_ptr<Shape> &shape,
                        const std::shared_ptr<Material> &material,
                        const std::shared_ptr<AreaLight> &areaLight,
@@ -95,7 +104,8 @@ class TransformedPrimitive : public Primitive {
     TransformedPrimitive(std::shared_ptr<Primitive> &primitive,
                          const AnimatedTransform &PrimitiveToWorld);
     bool Intersect(const Ray &r, SurfaceInteraction *in) const;
-    bool IntersectP(const Ray &r) const;
+    bool IntersectP(const Ray &r, bool testAlphaTexture = true) const;
+    bool HasAlphaMask() const { return primitive->HasAlphaMask(); }
     const AreaLight *GetAreaLight() const { return nullptr; }
     const Material *GetMaterial() const { return nullptr; }
     void ComputeScatteringFunctions(SurfaceInteraction *isect,
@@ -51,6 +51,14 @@ CameraSample Sampler::GetCameraSample(const Point2i &pRaster) {
     return cs;
 }
 
+void Sampler::Get1DBatch(int n, Float *u) {
+    for (int i = 0; i < n; ++i) u[i] = Get1D();
+}
+
+void Sampler::Get2DBatch(int n, Point2f *u) {
+    for (int i = 0; i < n; ++i) u[i] = Get2D();
+}
+
 void Sampler::StartPixel(const Point2i &p) {
     currentPixel = p;
     currentPixelSampleIndex = 0;
@@ -133,6 +141,24 @@ Point2f PixelSampler::Get2D() {
         return Point2f(rng.UniformFloat(), rng.UniformFloat());
 }
 
+void PixelSampler::Get1DBatch(int n, Float *u) {
+    ProfilePhase _(Prof::GetSample);
+    CHECK_LT(currentPixelSampleIndex, samplesPerPixel);
+    int i = 0;
+    for (; i < n && current1DDimension < samples1D.size(); ++i)
+        u[i] = samples1D[current1DDimension++][currentPixelSampleIndex];
+    for (; i < n; ++i) u[i] = rng.UniformFloat();
+}
+
+void PixelSampler::Get2DBatch(int n, Point2f *u) {
+    ProfilePhase _(Prof::GetSample);
+    CHECK_LT(currentPixelSampleIndex, samplesPerPixel);
+    int i = 0;
+    for (; i < n && current2DDimension < samples2D.size(); ++i)
+        u[i] = samples2D[current2DDimension++][currentPixelSampleIndex];
+    for (; i < n; ++i) u[i] = Point2f(rng.UniformFloat(), rng.UniformFloat());
+}
+
 void GlobalSampler::StartPixel(const Point2i &p) {
     ProfilePhase _(Prof::StartPixel);
     Sampler::StartPixel(p);
@@ -157,8 +183,9 @@ void GlobalSampler::StartPixel(const Point2i &p) {
         int nSamples = samples2DArraySizes[i] * samplesPerPixel;
         for (int j = 0; j < nSamples; ++j) {
             int64_t idx = GetIndexForSample(j);
-            sampleArray2D[i][j].x = SampleDimension(idx, dim);
-            sampleArray2D[i][j].y = SampleDimension(idx, dim + 1);
+            Float u[2];
+            SampleDimensions(idx, dim, 2, u);
+            sampleArray2D[i][j] = Point2f(u[0], u[1]);
         }
         dim += 2;
     }
@@ -194,4 +221,61 @@ Point2f GlobalSampler::Get2D() {
     return p;
 }
 
+void GlobalSampler::Get1DBatch(int n, Float *u) {
+    ProfilePhase _(Prof::GetSample);
+    while (n > 0) {
+        // Generate the run of dimensions up to the next array dimension
+        if (dimension >= arrayStartDim && dimension < arrayEndDim)
+            dimension = arrayEndDim;
+        int count = n;
+        if (dimension < arrayStartDim && arrayEndDim > arrayStartDim)
+            count = std::min(n, arrayStartDim - dimension);
+        SampleDimensions(intervalSampleIndex, dimension, count, u);
+        dimension += count;
+        u += count;
+        n -= count;
+    }
+}
+
+void GlobalSampler::Get2DBatch(int n, Point2f *u) {
+    ProfilePhase _(Prof::GetSample);
+    static PBRT_CONSTEXPR int maxChunk = 32;
+    Float v[2 * maxChunk];
+    while (n > 0) {
+        // Generate the run of 2D samples up to the next array dimension
+        if (dimension + 1 >= arrayStartDim && dimension < arrayEndDim)
+            dimension = arrayEndDim;
+        int count = std::min(n, maxChunk);
+        // As in _Get2D()_, a pair can't straddle _arrayStartDim_, even if
+        // there are no arrays
+        if (dimension < arrayStartDim)
+            count = std::min(count, (arrayStartDim - dimension) / 2);
+        SampleDimensions(intervalSampleIndex, dimension, 2 * count, v);
+        for (int i = 0; i < count; ++i) u[i] = Point2f(v[2 * i], v[2 * i + 1]);
+        dimension += 2 * count;
+        u += count;
+        n -= count;
+    }
+}
+
+CameraSample GlobalSampler::GetCameraSample(const Point2i &pRaster) {
+    // Generate all of the camera sample's dimensions in a single call when
+    // they don't overlap the array dimensions
+    if (dimension + 5 > arrayStartDim) return Sampler::GetCameraSample(pRaster);
+    ProfilePhase _(Prof::GetSample);
+    Float u[5];
+    SampleDimensions(intervalSampleIndex, dimension, 5, u);
+    dimension += 5;
+    CameraSample cs;
+    cs.pFilm = (Point2f)pRaster + Point2f(u[0], u[1]);
+    cs.time = u[2];
+    cs.pLens = Point2f(u[3], u[4]);
+    return cs;
+}
+
+void GlobalSampler::SampleDimensions(int64_t index, int dim, int n,
+                                     Float *u) const {
+    for (int i = 0; i < n; ++i) u[i] = SampleDimension(index, dim + i);
+}
+
 }  // namespace pbrt
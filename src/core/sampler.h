@@ -42,6 +42,7 @@
 #include "pbrt.h"
 #include "geometry.h"
 #include "rng.h"
+#include "spectrum.h"
 #include <inttypes.h>
 
 namespace pbrt {
@@ -55,7 +56,9 @@ class Sampler {
     virtual void StartPixel(const Point2i &p);
     virtual Float Get1D() = 0;
     virtual Point2f Get2D() = 0;
-    CameraSample GetCameraSample(const Point2i &pRaster);
+    virtual void Get1DBatch(int n, Float *u);
+    virtual void Get2DBatch(int n, Point2f *u);
+    virtual CameraSample GetCameraSample(const Point2i &pRaster);
     void Request1DArray(int n);
     void Request2DArray(int n);
     virtual int RoundCount(int n) const { return n; }
@@ -94,6 +97,8 @@ class PixelSampler : public Sampler {
     bool SetSampleNumber(int64_t);
     Float Get1D();
     Point2f Get2D();
+    void Get1DBatch(int n, Float *u);
+    void Get2DBatch(int n, Point2f *u);
 
   protected:
     // PixelSampler Protected Data
@@ -111,9 +116,14 @@ class GlobalSampler : public Sampler {
     bool SetSampleNumber(int64_t sampleNum);
     Float Get1D();
     Point2f Get2D();
+    void Get1DBatch(int n, Float *u);
+    void Get2DBatch(int n, Point2f *u);
+    CameraSample GetCameraSample(const Point2i &pRaster);
     GlobalSampler(int64_t samplesPerPixel) : Sampler(samplesPerPixel) {}
     virtual int64_t GetIndexForSample(int64_t sampleNum) const = 0;
     virtual Float SampleDimension(int64_t index, int dimension) const = 0;
+    virtual void SampleDimensions(int64_t index, int dimension, int n,
+                                  Float *u) const;
 
   private:
     // GlobalSampler Private Data
@@ -123,6 +133,14 @@ class GlobalSampler : public Sampler {
     int arrayEndDim;
 };
 
+// Chooses the wavelengths that paths started from the current sample
+// carry when spectra are represented with _HeroSpectrum_
+inline void SampleWavelengths(Sampler &sampler) {
+#ifdef PBRT_HERO_SPECTRUM
+    SampleHeroWavelengths(sampler.Get1D());
+#endif
+}
+
 }  // namespace pbrt
 
 #endif  // PBRT_CORE_SAMPLER_H
@@ -35,6 +35,8 @@
 #include "sampling.h"
 #include "geometry.h"
 #include "shape.h"
+#include "parallel.h"
+#include <functional>
 
 namespace pbrt {
 
@@ -156,6 +158,156 @@ Point2f UniformSampleTriangle(const Point2f &u) {
     return Point2f(1 - su0, u[1] * su0);
 }
 
+// Returns the angle between two normalized vectors, computed in a way
+// that stays accurate for nearly parallel and antiparallel vectors.
+static Float AngleBetween(const Vector3f &v1, const Vector3f &v2) {
+    if (Dot(v1, v2) < 0) return Pi - 2 * SafeASin((v1 + v2).Length() / 2);
+    return 2 * SafeASin((v2 - v1).Length() / 2);
+}
+
+// Returns the component of |v| that's perpendicular to the normalized
+// vector |w|.
+static Vector3f GramSchmidt(const Vector3f &v, const Vector3f &w) {
+    return v - Dot(v, w) * w;
+}
+
+std::array<Float, 3> SampleSphericalTriangle(const std::array<Point3f, 3> &v,
+                                             const Point3f &p,
+                                             const Point2f &u, Float *pdf) {
+    // This follows Arvo's "Stratified Sampling of Spherical Triangles":
+    // the sub-triangle with vertices _a_, _b_ and $c'$ whose area is a
+    // uniformly sampled fraction of the whole is found first and then a
+    // point along the arc from _b_ to $c'$.
+    *pdf = 0;
+    Vector3f a = Normalize(v[0] - p), b = Normalize(v[1] - p),
+             c = Normalize(v[2] - p);
+    Vector3f n_ab = Cross(a, b), n_bc = Cross(b, c), n_ca = Cross(c, a);
+    if (n_ab.LengthSquared() == 0 || n_bc.LengthSquared() == 0 ||
+        n_ca.LengthSquared() == 0)
+        return {{0, 0, 0}};
+    n_ab = Normalize(n_ab);
+    n_bc = Normalize(n_bc);
+    n_ca = Normalize(n_ca);
+
+    // Find the angles at the vertices and the triangle's area
+    Float alpha = AngleBetween(n_ab, -n_ca);
+    Float beta = AngleBetween(n_bc, -n_ab);
+    Float gamma = AngleBetween(n_ca, -n_bc);
+    Float area = alpha + beta + gamma - Pi;
+    if (area <= 0) return {{0, 0, 0}};
+    *pdf = 1 / area;
+
+    // Find $\cos\beta'$ for the point $c'$ along the arc from _a_ to _c_
+    // that gives the sampled area
+    // These are computed in double precision since there's catastrophic
+    // cancellation for small sub-triangles otherwise.
+    double areaPrime_pi = Pi + u[0] * double(area);
+    double cosAlpha = std::cos(double(alpha));
+    double sinAlpha = std::sin(double(alpha));
+    double sinPhi = std::sin(areaPrime_pi) * cosAlpha -
+                    std::cos(areaPrime_pi) * sinAlpha;
+    double cosPhi = std::cos(areaPrime_pi) * cosAlpha +
+                    std::sin(areaPrime_pi) * sinAlpha;
+    double k1 = cosPhi + cosAlpha;
+    double k2 = sinPhi - sinAlpha * Dot(a, b);
+    Float cosBp = (k2 + (k2 * cosPhi - k1 * sinPhi) * cosAlpha) /
+                  ((k2 * sinPhi + k1 * cosPhi) * sinAlpha);
+    if (std::isnan(cosBp)) {
+        *pdf = 0;
+        return {{0, 0, 0}};
+    }
+    cosBp = Clamp(cosBp, -1, 1);
+    Float sinBp = SafeSqrt(1 - cosBp * cosBp);
+    Vector3f cp = cosBp * a + sinBp * Normalize(GramSchmidt(c, a));
+
+    // Sample the arc from _b_ to $c'$ to find the direction _w_
+    Float cosTheta = 1 - u[1] * (1 - Dot(cp, b));
+    Float sinTheta = SafeSqrt(1 - cosTheta * cosTheta);
+    Vector3f w = cosTheta * b + sinTheta * Normalize(GramSchmidt(cp, b));
+
+    // Find the barycentric coordinates of the point _w_ hits
+    Vector3f e1 = v[1] - v[0], e2 = v[2] - v[0];
+    Vector3f s1 = Cross(w, e2);
+    Float divisor = Dot(s1, e1);
+    if (divisor == 0) return {{Float(1) / 3, Float(1) / 3, Float(1) / 3}};
+    Float invDivisor = 1 / divisor;
+    Vector3f s = p - v[0];
+    Float b1 = Clamp(Dot(s, s1) * invDivisor, 0, 1);
+    Float b2 = Clamp(Dot(w, Cross(s, e1)) * invDivisor, 0, 1);
+    if (b1 + b2 > 1) {
+        Float sum = b1 + b2;
+        b1 /= sum;
+        b2 /= sum;
+    }
+    return {{1 - b1 - b2, b1, b2}};
+}
+
+Point2f InvertSphericalTriangleSample(const std::array<Point3f, 3> &v,
+                                      const Point3f &p, const Vector3f &w) {
+    Vector3f a = Normalize(v[0] - p), b = Normalize(v[1] - p),
+             c = Normalize(v[2] - p);
+    Vector3f n_ab = Cross(a, b), n_bc = Cross(b, c), n_ca = Cross(c, a);
+    if (n_ab.LengthSquared() == 0 || n_bc.LengthSquared() == 0 ||
+        n_ca.LengthSquared() == 0)
+        return Point2f(0.5f, 0.5f);
+    n_ab = Normalize(n_ab);
+    n_bc = Normalize(n_bc);
+    n_ca = Normalize(n_ca);
+    Float alpha = AngleBetween(n_ab, -n_ca);
+    Float beta = AngleBetween(n_bc, -n_ab);
+    Float gamma = AngleBetween(n_ca, -n_bc);
+
+    // Find the vertex $c'$ where the arc through _b_ and _w_ meets the arc
+    // from _a_ to _c_
+    Vector3f cp = Cross(Cross(b, w), Cross(c, a));
+    if (cp.LengthSquared() == 0) return Point2f(0.5f, 0.5f);
+    cp = Normalize(cp);
+    if (Dot(cp, a + c) < 0) cp = -cp;
+
+    // The first sample value is the fraction of the area that's in the
+    // sub-triangle with vertices _a_, _b_ and $c'$
+    Float u0 = 0;
+    if (Dot(a, cp) < 0.99999847691f) {
+        Vector3f n_cpb = Cross(cp, b), n_acp = Cross(a, cp);
+        if (n_cpb.LengthSquared() == 0 || n_acp.LengthSquared() == 0)
+            return Point2f(0.5f, 0.5f);
+        n_cpb = Normalize(n_cpb);
+        n_acp = Normalize(n_acp);
+        Float areaPrime = alpha + AngleBetween(n_ab, n_cpb) +
+                          AngleBetween(n_acp, -n_cpb) - Pi;
+        u0 = areaPrime / (alpha + beta + gamma - Pi);
+    }
+    // The second one gives the position along the arc from _b_ to $c'$
+    Float u1 = (1 - Dot(w, b)) / (1 - Dot(cp, b));
+    return Point2f(Clamp(u0, 0, 1), Clamp(u1, 0, 1));
+}
+
+// Samples the linear function over [0,1] with values _a_ and _b_ at its
+// endpoints.
+static Float SampleLinear(Float u, Float a, Float b) {
+    if (u == 0 && a == 0) return 0;
+    Float x = u * (a + b) / (a + std::sqrt(Lerp(u, a * a, b * b)));
+    return std::min(x, OneMinusEpsilon);
+}
+
+Point2f SampleBilinear(const Point2f &u, const Float w[4]) {
+    // Sample the marginal distribution in $y$ and then the conditional
+    // distribution in $x$
+    Point2f p;
+    p.y = SampleLinear(u[1], w[0] + w[1], w[2] + w[3]);
+    p.x = SampleLinear(u[0], Lerp(p.y, w[0], w[2]), Lerp(p.y, w[1], w[3]));
+    return p;
+}
+
+Float BilinearPdf(const Point2f &p, const Float w[4]) {
+    if (p.x < 0 || p.x > 1 || p.y < 0 || p.y > 1) return 0;
+    if (w[0] + w[1] + w[2] + w[3] == 0) return 1;
+    return 4 *
+           ((1 - p[0]) * (1 - p[1]) * w[0] + p[0] * (1 - p[1]) * w[1] +
+            (1 - p[0]) * p[1] * w[2] + p[0] * p[1] * w[3]) /
+           (w[0] + w[1] + w[2] + w[3]);
+}
+
 Distribution2D::Distribution2D(const Float *func, int nu, int nv) {
     pConditionalV.reserve(nv);
     for (int v = 0; v < nv; ++v) {
@@ -170,4 +322,132 @@ Distribution2D::Distribution2D(const Float *func, int nu, int nv) {
     pMarginal.reset(new Distribution1D(&marginalFunc[0], nv));
 }
 
+// Distributions with at least this many values can be built using multiple
+// threads, in blocks of _ParallelBuildBlockSize_ values.
+static PBRT_CONSTEXPR int ParallelBuildCount = 1 << 16;
+static PBRT_CONSTEXPR int ParallelBuildBlockSize = 1 << 14;
+
+// Calls _func_ with the start and end of consecutive blocks of [0, n) and
+// returns the number of blocks. There is a single block unless _parallel_
+// is set and _n_ is large; because _ParallelFor()_ isn't reentrant, worker
+// threads always use a single block as well.
+static int ForEachBlock(int n, bool parallel,
+                        const std::function<void(int, int, int)> &func) {
+    int nBlocks = (!parallel || n < ParallelBuildCount || ThreadIndex != 0)
+                      ? 1
+                      : (n + ParallelBuildBlockSize - 1) / ParallelBuildBlockSize;
+    if (nBlocks == 1)
+        func(0, 0, n);
+    else
+        ParallelFor(
+            [&](int64_t b) {
+                int start = int(b) * ParallelBuildBlockSize;
+                func(int(b), start,
+                     std::min(n, start + ParallelBuildBlockSize));
+            },
+            nBlocks);
+    return nBlocks;
+}
+
+Distribution1D::Distribution1D(const Float *f, int n, bool useAlias,
+                               bool parallelBuild)
+    : func(f, f + n), cdf(n + 1) {
+    // Compute integral of step function at $x_i$; for parallel builds,
+    // first sum each block of values and then offset the blocks by the
+    // sums of their predecessors
+    std::vector<Float> blockSums((n + ParallelBuildBlockSize - 1) /
+                                 ParallelBuildBlockSize + 1);
+    int nBlocks =
+        ForEachBlock(n, parallelBuild, [&](int b, int start, int end) {
+            Float sum = 0;
+            for (int i = start; i < end; ++i) {
+                sum += func[i] / n;
+                cdf[i + 1] = sum;
+            }
+            blockSums[b] = sum;
+        });
+    if (nBlocks > 1) {
+        std::vector<Float> blockOffsets(nBlocks, 0);
+        for (int b = 1; b < nBlocks; ++b)
+            blockOffsets[b] = blockOffsets[b - 1] + blockSums[b - 1];
+        ForEachBlock(n, parallelBuild, [&](int b, int start, int end) {
+            for (int i = start; i < end; ++i) cdf[i + 1] += blockOffsets[b];
+        });
+    }
+    cdf[0] = 0;
+
+    // Transform step function integral into CDF
+    funcInt = cdf[n];
+    ForEachBlock(n, parallelBuild, [&](int b, int start, int end) {
+        for (int i = start; i < end; ++i)
+            cdf[i + 1] = funcInt == 0 ? Float(i + 1) / Float(n)
+                                      : cdf[i + 1] / funcInt;
+    });
+    if (useAlias) alias = AliasTable(f, n, parallelBuild);
+}
+
+AliasTable::AliasTable(const Float *weights, int n, bool parallelBuild)
+    : bins(n) {
+    // Normalize the weights to compute the probability of each value
+    std::vector<double> blockSums((n + ParallelBuildBlockSize - 1) /
+                                  ParallelBuildBlockSize + 1);
+    int nBlocks =
+        ForEachBlock(n, parallelBuild, [&](int b, int start, int end) {
+            double sum = 0;
+            for (int i = start; i < end; ++i) sum += weights[i];
+            blockSums[b] = sum;
+        });
+    double sum = 0;
+    for (int b = 0; b < nBlocks; ++b) sum += blockSums[b];
+    std::vector<double> pScaled(n);
+    std::vector<int> blockUnder(nBlocks);
+    ForEachBlock(n, parallelBuild, [&](int b, int start, int end) {
+        for (int i = start; i < end; ++i) {
+            bins[i].p = sum > 0 ? Float(weights[i] / sum) : Float(1) / n;
+            pScaled[i] = sum > 0 ? weights[i] / sum * n : 1;
+            if (pScaled[i] < 1) ++blockUnder[b];
+        }
+    });
+
+    // Find the bins with less than their share of probability and those
+    // with more, writing each block's indices after its predecessors'
+    int nUnder = 0;
+    for (int b = 0; b < nBlocks; ++b) {
+        int count = blockUnder[b];
+        blockUnder[b] = nUnder;
+        nUnder += count;
+    }
+    std::vector<int> under(nUnder), over(n - nUnder);
+    ForEachBlock(n, parallelBuild, [&](int b, int start, int end) {
+        int u = blockUnder[b], o = start - blockUnder[b];
+        for (int i = start; i < end; ++i) {
+            if (pScaled[i] < 1)
+                under[u++] = i;
+            else
+                over[o++] = i;
+        }
+    });
+
+    // Pair bins with less than their share of probability with ones that
+    // have more, moving the excess into the former's aliases
+    while (!under.empty() && !over.empty()) {
+        int un = under.back(), ov = over.back();
+        under.pop_back();
+        over.pop_back();
+        bins[un].q = Float(pScaled[un]);
+        bins[un].alias = ov;
+        pScaled[ov] += pScaled[un] - 1;
+        if (pScaled[ov] < 1)
+            under.push_back(ov);
+        else
+            over.push_back(ov);
+    }
+    // Remaining bins are full, up to round-off error
+    for (const std::vector<int> *rest : {&under, &over})
+        for (int i : *rest) {
+            bins[i].q = 1;
+            bins[i].alias = i;
+        }
+}
+
 }  // namespace pbrt
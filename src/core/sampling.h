@@ -43,6 +43,7 @@
 #include "geometry.h"
 #include "rng.h"
 #include <algorithm>
+#include <array>
 
 namespace pbrt {
 
@@ -52,23 +53,61 @@ void StratifiedSample1D(Float *samples, int nsamples, RNG &rng,
 void StratifiedSample2D(Point2f *samples, int nx, int ny, RNG &rng,
                         bool jitter = true);
 void LatinHypercube(Float *samples, int nSamples, int nDim, RNG &rng);
-struct Distribution1D {
-    // Distribution1D Public Methods
-    Distribution1D(const Float *f, int n) : func(f, f + n), cdf(n + 1) {
-        // Compute integral of step function at $x_i$
-        cdf[0] = 0;
-        for (int i = 1; i < n + 1; ++i) cdf[i] = cdf[i - 1] + func[i - 1] / n;
-
-        // Transform step function integral into CDF
-        funcInt = cdf[n];
-        if (funcInt == 0) {
-            for (int i = 1; i < n + 1; ++i) cdf[i] = Float(i) / Float(n);
-        } else {
-            for (int i = 1; i < n + 1; ++i) cdf[i] /= funcInt;
+// AliasTable samples from a discrete distribution using Walker's alias
+// method: each of its bins holds the probability of one value and the
+// leftover probability of another, so sampling takes constant time,
+// independent of the number of values. The remapped sample value it
+// returns is uniformly distributed but, unlike with CDF inversion, isn't
+// monotonic in _u_.
+class AliasTable {
+  public:
+    // AliasTable Public Methods
+    AliasTable() {}
+    AliasTable(const Float *weights, int n, bool parallelBuild = false);
+    int Sample(Float u, Float *pmf = nullptr,
+               Float *uRemapped = nullptr) const {
+        // Choose a bin uniformly and then either its value or its alias
+        Float up = u * bins.size();
+        int offset = std::min<int>(int(up), int(bins.size()) - 1);
+        up = std::min(up - offset, OneMinusEpsilon);
+        const Bin &bin = bins[offset];
+        if (up < bin.q) {
+            if (pmf) *pmf = bin.p;
+            if (uRemapped) *uRemapped = std::min(up / bin.q, OneMinusEpsilon);
+            return offset;
         }
+        if (pmf) *pmf = bins[bin.alias].p;
+        if (uRemapped)
+            *uRemapped = std::min((up - bin.q) / (1 - bin.q), OneMinusEpsilon);
+        return bin.alias;
     }
+    Float PMF(int index) const { return bins[index].p; }
+    int Count() const { return (int)bins.size(); }
+
+  private:
+    // AliasTable Private Data
+    struct Bin {
+        Float q, p;
+        int alias;
+    };
+    std::vector<Bin> bins;
+};
+
+struct Distribution1D {
+    // Distribution1D Public Methods
+    Distribution1D(const Float *f, int n,
+                   bool useAlias = PbrtOptions.aliasSampling,
+                   bool parallelBuild = false);
     int Count() const { return (int)func.size(); }
     Float SampleContinuous(Float u, Float *pdf, int *off = nullptr) const {
+        if (alias.Count() > 0) {
+            // Choose _offset_ and the offset along it with the alias table
+            Float du;
+            int offset = alias.Sample(u, nullptr, &du);
+            if (off) *off = offset;
+            if (pdf) *pdf = (funcInt > 0) ? func[offset] / funcInt : 0;
+            return (offset + du) / Count();
+        }
         // Find surrounding CDF segments and _offset_
         int offset = FindInterval((int)cdf.size(),
                                   [&](int index) { return cdf[index] <= u; });
@@ -89,6 +128,12 @@ struct Distribution1D {
     }
     int SampleDiscrete(Float u, Float *pdf = nullptr,
                        Float *uRemapped = nullptr) const {
+        if (alias.Count() > 0) {
+            int offset = alias.Sample(u, nullptr, uRemapped);
+            if (pdf)
+                *pdf = (funcInt > 0) ? func[offset] / (funcInt * Count()) : 0;
+            return offset;
+        }
         // Find surrounding CDF segments and _offset_
         int offset = FindInterval((int)cdf.size(),
                                   [&](int index) { return cdf[index] <= u; });
@@ -106,6 +151,10 @@ struct Distribution1D {
     // Distribution1D Public Data
     std::vector<Float> func, cdf;
     Float funcInt;
+    // If it's not empty, samples are chosen with _alias_ in constant time
+    // rather than by searching _cdf_; continuous samples are then no
+    // longer monotonic in _u_.
+    AliasTable alias;
 };
 
 Point2f RejectionSampleDisk(RNG &rng);
@@ -120,6 +169,20 @@ Float UniformConePdf(Float thetamax);
 Point2f UniformSampleDisk(const Point2f &u);
 Point2f ConcentricSampleDisk(const Point2f &u);
 Point2f UniformSampleTriangle(const Point2f &u);
+// Samples a direction uniformly over the solid angle subtended by the
+// triangle with vertices |v| as seen from |p|, returning the barycentric
+// coordinates of the point it hits and the PDF with respect to solid
+// angle. InvertSphericalTriangleSample() returns the sample value that
+// gives the direction |w|.
+std::array<Float, 3> SampleSphericalTriangle(const std::array<Point3f, 3> &v,
+                                             const Point3f &p,
+                                             const Point2f &u, Float *pdf);
+Point2f InvertSphericalTriangleSample(const std::array<Point3f, 3> &v,
+                                      const Point3f &p, const Vector3f &w);
+// Samples the bilinear function over [0,1]^2 with the given values at
+// (0,0), (1,0), (0,1) and (1,1).
+Point2f SampleBilinear(const Point2f &u, const Float w[4]);
+Float BilinearPdf(const Point2f &p, const Float w[4]);
 class Distribution2D {
   public:
     // Distribution2D Public Methods
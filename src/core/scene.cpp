@@ -33,6 +33,7 @@
 
 // core/scene.cpp*
 #include "scene.h"
+#include "parallel.h"
 #include "stats.h"
 
 namespace pbrt {
@@ -40,8 +41,30 @@ namespace pbrt {
 STAT_COUNTER("Intersections/Regular ray intersection tests",
              nIntersectionTests);
 STAT_COUNTER("Intersections/Shadow ray intersection tests", nShadowTests);
+STAT_PERCENT("Intersections/Occluded shadow rays", nOccludedShadowRays,
+             nShadowRays);
+STAT_PERCENT("Intersections/Shadow ray occluder cache hits",
+             nOccluderCacheHits, nOccluderCacheLookups);
 
 // Scene Method Definitions
+Scene::Scene(std::shared_ptr<Primitive> aggregate,
+             const std::vector<std::shared_ptr<Light>> &lights)
+    : lights(lights), aggregate(aggregate) {
+    // Scene Constructor Implementation
+    worldBound = aggregate->WorldBound();
+    nOccluderCacheEntries = MaxThreadIndex();
+    occluderCache = AllocAligned<CachedOccluder>(nOccluderCacheEntries);
+    for (int i = 0; i < nOccluderCacheEntries; ++i)
+        occluderCache[i].primitive = nullptr;
+    for (const auto &light : lights) {
+        light->Preprocess(*this);
+        if (light->flags & (int)LightFlags::Infinite)
+            infiniteLights.push_back(light);
+    }
+}
+
+Scene::~Scene() { FreeAligned(occluderCache); }
+
 bool Scene::Intersect(const Ray &ray, SurfaceInteraction *isect) const {
     ++nIntersectionTests;
     DCHECK_NE(ray.d, Vector3f(0,0,0));
@@ -50,8 +73,26 @@ bool Scene::Intersect(const Ray &ray, SurfaceInteraction *isect) const {
 
 bool Scene::IntersectP(const Ray &ray) const {
     ++nShadowTests;
+    ++nShadowRays;
     DCHECK_NE(ray.d, Vector3f(0,0,0));
-    return aggregate->IntersectP(ray);
+    // Test the primitive that blocked this thread's previous occluded
+    // shadow ray before traversing the aggregate; nearby shadow rays are
+    // usually blocked by the same primitive
+    DCHECK_LT(ThreadIndex, nOccluderCacheEntries);
+    const Primitive *&lastOccluder = occluderCache[ThreadIndex].primitive;
+    if (lastOccluder) {
+        ++nOccluderCacheLookups;
+        if (lastOccluder->IntersectP(ray)) {
+            ++nOccluderCacheHits;
+            ++nOccludedShadowRays;
+            return true;
+        }
+    }
+    const Primitive *occluder = aggregate->Occluder(ray);
+    if (!occluder) return false;
+    lastOccluder = occluder;
+    ++nOccludedShadowRays;
+    return true;
 }
 
 bool Scene::IntersectTr(Ray ray, Sampler &sampler, SurfaceInteraction *isect,
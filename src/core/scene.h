@@ -51,16 +51,8 @@ class Scene {
   public:
     // Scene Public Methods
     Scene(std::shared_ptr<Primitive> aggregate,
-          const std::vector<std::shared_ptr<Light>> &lights)
-        : lights(lights), aggregate(aggregate) {
-        // Scene Constructor Implementation
-        worldBound = aggregate->WorldBound();
-        for (const auto &light : lights) {
-            light->Preprocess(*this);
-            if (light->flags & (int)LightFlags::Infinite)
-                infiniteLights.push_back(light);
-        }
-    }
+          const std::vector<std::shared_ptr<Light>> &lights);
+    ~Scene();
     const Bounds3f &WorldBound() const { return worldBound; }
     bool Intersect(const Ray &ray, SurfaceInteraction *isect) const;
     bool IntersectP(const Ray &ray) const;
@@ -74,9 +66,22 @@ class Scene {
     std::vector<std::shared_ptr<Light>> infiniteLights;
 
   private:
+    // Scene Private Declarations
+    struct CachedOccluder {
+        const Primitive *primitive;
+        char pad[PBRT_L1_CACHE_LINE_SIZE - sizeof(const Primitive *)];
+    };
+    Scene(const Scene &) = delete;
+    Scene &operator=(const Scene &) = delete;
+
     // Scene Private Data
     std::shared_ptr<Primitive> aggregate;
     Bounds3f worldBound;
+    // The primitive that blocked each thread's most recent occluded shadow
+    // ray, indexed by _ThreadIndex_; each entry fills a cache line so that
+    // threads don't write to shared lines
+    CachedOccluder *occluderCache = nullptr;
+    int nOccluderCacheEntries = 0;
 };
 
 }  // namespace pbrt
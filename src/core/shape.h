@@ -64,6 +64,9 @@ namespace pbrt {
                                 bool testAlphaTexture = true) const {
             return Intersect(ray, nullptr, nullptr, testAlphaTexture);
         }
+        // Returns true if the shape's intersection tests may reject hits
+        // using an alpha texture
+        virtual bool HasAlphaMask() const { return false; }
         virtual Float Area() const = 0;
         // Sample a point on the surface of the shape and return the PDF with
         // respect to area on the surface.
@@ -83,6 +86,14 @@ namespace pbrt {
         // used in this case.
         virtual Float SolidAngle(const Point3f &p, int nSamples = 512) const;
 
+        // Returns the cosine of the spread angle of a cone of directions
+        // around |*w| that bounds the normals of points returned by
+        // Sample(); by default the cone covers all directions.
+        virtual Float NormalBounds(Vector3f *w) const {
+            *w = Vector3f(0, 0, 1);
+            return -1;
+        }
+
         // Shape Public Data
     public:
         const Transform *ObjectToWorld, *WorldToObject;
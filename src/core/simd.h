@@ -0,0 +1,241 @@
+
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_CORE_SIMD_H
+#define PBRT_CORE_SIMD_H
+
+// core/simd.h*
+#include "pbrt.h"
+#if defined(PBRT_HAVE_SSE2) && !defined(PBRT_FLOAT_AS_DOUBLE)
+#define PBRT_FLOAT4_SSE
+#include <emmintrin.h>
+#endif
+
+namespace pbrt {
+
+// Float4 Declarations
+
+// Float4 holds four _Float_ values that are operated on together, using SSE
+// instructions where they're available and loops over the values
+// otherwise. It's used for the inner loops of code that processes arrays of
+// values, such as _CoefficientSpectrum_'s operations.
+#ifdef PBRT_FLOAT4_SSE
+class Float4 {
+  public:
+    // Float4 Public Methods
+    Float4() {}
+    explicit Float4(Float f) : v(_mm_set1_ps(f)) {}
+    static Float4 Load(const Float *p) { return Float4(_mm_loadu_ps(p)); }
+    void Store(Float *p) const { _mm_storeu_ps(p, v); }
+    // Returns the values at the given indices
+    template <int i0, int i1, int i2, int i3>
+    Float4 Shuffle() const {
+        return Float4(_mm_shuffle_ps(v, v, _MM_SHUFFLE(i3, i2, i1, i0)));
+    }
+    Float4 operator+(const Float4 &f) const {
+        return Float4(_mm_add_ps(v, f.v));
+    }
+    Float4 operator-(const Float4 &f) const {
+        return Float4(_mm_sub_ps(v, f.v));
+    }
+    Float4 operator*(const Float4 &f) const {
+        return Float4(_mm_mul_ps(v, f.v));
+    }
+    Float4 operator/(const Float4 &f) const {
+        return Float4(_mm_div_ps(v, f.v));
+    }
+    friend Float4 Min(const Float4 &a, const Float4 &b) {
+        return Float4(_mm_min_ps(a.v, b.v));
+    }
+    friend Float4 Max(const Float4 &a, const Float4 &b) {
+        return Float4(_mm_max_ps(a.v, b.v));
+    }
+    friend Float4 Sqrt(const Float4 &f) { return Float4(_mm_sqrt_ps(f.v)); }
+    friend Float4 ApproxInvSqrt(const Float4 &f) {
+        // The hardware estimate has a relative error of at most $1.5 \cdot
+        // 2^{-12}$
+        return Float4(_mm_rsqrt_ps(f.v));
+    }
+    friend Float4 Exp(const Float4 &f);
+    friend bool AnyZero(const Float4 &f) {
+        return _mm_movemask_ps(_mm_cmpeq_ps(f.v, _mm_setzero_ps())) != 0;
+    }
+    friend bool AllZero(const Float4 &f) {
+        return _mm_movemask_ps(_mm_cmpeq_ps(f.v, _mm_setzero_ps())) == 0xf;
+    }
+    friend Float HorizontalSum(const Float4 &f) {
+        __m128 s = _mm_add_ps(f.v, _mm_movehl_ps(f.v, f.v));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+        return _mm_cvtss_f32(s);
+    }
+    friend Float HorizontalMax(const Float4 &f) {
+        __m128 m = _mm_max_ps(f.v, _mm_movehl_ps(f.v, f.v));
+        m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+        return _mm_cvtss_f32(m);
+    }
+
+  private:
+    // Float4 Private Methods
+    explicit Float4(__m128 v) : v(v) {}
+
+    // Float4 Private Data
+    __m128 v;
+};
+
+inline Float4 Exp(const Float4 &f) {
+    // Use _std::exp()_ for values outside the range where the approximation
+    // below doesn't over- or underflow, including infinities and NaNs
+    __m128 inRange = _mm_and_ps(_mm_cmpge_ps(f.v, _mm_set1_ps(-87.33654f)),
+                                _mm_cmple_ps(f.v, _mm_set1_ps(88.f)));
+    if (_mm_movemask_ps(inRange) != 0xf) {
+        Float e[4];
+        f.Store(e);
+        for (int i = 0; i < 4; ++i) e[i] = std::exp(e[i]);
+        return Float4::Load(e);
+    }
+
+    // Compute $e^x = 2^n e^r$ with $n = \round{x / \ln 2}$, evaluating $e^r$
+    // with the Cephes library's polynomial approximation
+    __m128i n = _mm_cvtps_epi32(_mm_mul_ps(f.v, _mm_set1_ps(1.44269504f)));
+    __m128 fn = _mm_cvtepi32_ps(n);
+    __m128 r = _mm_sub_ps(f.v, _mm_mul_ps(fn, _mm_set1_ps(0.693359375f)));
+    r = _mm_add_ps(r, _mm_mul_ps(fn, _mm_set1_ps(2.12194440e-4f)));
+    __m128 p = _mm_set1_ps(1.9875691500e-4f);
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.3981999507e-3f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(8.3334519073e-3f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(4.1665795894e-2f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.6666665459e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(5.0000001201e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, _mm_mul_ps(r, r)), r);
+    p = _mm_add_ps(p, _mm_set1_ps(1.f));
+    __m128i pow2n = _mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23);
+    return Float4(_mm_mul_ps(p, _mm_castsi128_ps(pow2n)));
+}
+#else
+class Float4 {
+  public:
+    // Float4 Public Methods
+    Float4() {}
+    explicit Float4(Float f) {
+        for (int i = 0; i < 4; ++i) v[i] = f;
+    }
+    static Float4 Load(const Float *p) {
+        Float4 f;
+        for (int i = 0; i < 4; ++i) f.v[i] = p[i];
+        return f;
+    }
+    void Store(Float *p) const {
+        for (int i = 0; i < 4; ++i) p[i] = v[i];
+    }
+    template <int i0, int i1, int i2, int i3>
+    Float4 Shuffle() const {
+        Float4 r;
+        r.v[0] = v[i0];
+        r.v[1] = v[i1];
+        r.v[2] = v[i2];
+        r.v[3] = v[i3];
+        return r;
+    }
+    Float4 operator+(const Float4 &f) const {
+        Float4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = v[i] + f.v[i];
+        return r;
+    }
+    Float4 operator-(const Float4 &f) const {
+        Float4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = v[i] - f.v[i];
+        return r;
+    }
+    Float4 operator*(const Float4 &f) const {
+        Float4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = v[i] * f.v[i];
+        return r;
+    }
+    Float4 operator/(const Float4 &f) const {
+        Float4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = v[i] / f.v[i];
+        return r;
+    }
+    friend Float4 Min(const Float4 &a, const Float4 &b) {
+        Float4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = std::min(a.v[i], b.v[i]);
+        return r;
+    }
+    friend Float4 Max(const Float4 &a, const Float4 &b) {
+        Float4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = std::max(a.v[i], b.v[i]);
+        return r;
+    }
+    friend Float4 Sqrt(const Float4 &f) {
+        Float4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = std::sqrt(f.v[i]);
+        return r;
+    }
+    friend Float4 ApproxInvSqrt(const Float4 &f) {
+        Float4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = 1 / std::sqrt(f.v[i]);
+        return r;
+    }
+    friend Float4 Exp(const Float4 &f) {
+        Float4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = std::exp(f.v[i]);
+        return r;
+    }
+    friend bool AnyZero(const Float4 &f) {
+        return f.v[0] == 0 || f.v[1] == 0 || f.v[2] == 0 || f.v[3] == 0;
+    }
+    friend bool AllZero(const Float4 &f) {
+        return f.v[0] == 0 && f.v[1] == 0 && f.v[2] == 0 && f.v[3] == 0;
+    }
+    friend Float HorizontalSum(const Float4 &f) {
+        return (f.v[0] + f.v[2]) + (f.v[1] + f.v[3]);
+    }
+    friend Float HorizontalMax(const Float4 &f) {
+        return std::max(std::max(f.v[0], f.v[2]), std::max(f.v[1], f.v[3]));
+    }
+
+  private:
+    // Float4 Private Data
+    Float v[4];
+};
+#endif  // PBRT_FLOAT4_SSE
+
+}  // namespace pbrt
+
+#endif  // PBRT_CORE_SIMD_H
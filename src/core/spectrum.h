@@ -40,6 +40,7 @@
 
 // core/spectrum.h*
 #include "pbrt.h"
+#include "simd.h"
 #include "stringprint.h"
 
 namespace pbrt {
@@ -48,6 +49,8 @@ namespace pbrt {
 static const int sampledLambdaStart = 400;
 static const int sampledLambdaEnd = 700;
 static const int nSpectralSamples = 60;
+static_assert(nSpectralSamples % 4 == 0,
+              "SampledSpectrum's XYZ projections process four samples at once");
 extern bool SpectrumSamplesSorted(const Float *lambda, const Float *vals,
                                   int n);
 extern void SortSpectrumSamples(Float *lambda, Float *vals, int n);
@@ -79,22 +82,39 @@ extern const Float CIE_Y[nCIESamples];
 extern const Float CIE_Z[nCIESamples];
 extern const Float CIE_lambda[nCIESamples];
 static const Float CIE_Y_integral = 106.856895;
+// Smits's spectrum for a white illuminant, which rgb2spec uses as the
+// illuminant that RGBToSpectrumTable's reflectances are computed under
 static const int nRGB2SpectSamples = 32;
 extern const Float RGB2SpectLambda[nRGB2SpectSamples];
-extern const Float RGBRefl2SpectWhite[nRGB2SpectSamples];
-extern const Float RGBRefl2SpectCyan[nRGB2SpectSamples];
-extern const Float RGBRefl2SpectMagenta[nRGB2SpectSamples];
-extern const Float RGBRefl2SpectYellow[nRGB2SpectSamples];
-extern const Float RGBRefl2SpectRed[nRGB2SpectSamples];
-extern const Float RGBRefl2SpectGreen[nRGB2SpectSamples];
-extern const Float RGBRefl2SpectBlue[nRGB2SpectSamples];
 extern const Float RGBIllum2SpectWhite[nRGB2SpectSamples];
-extern const Float RGBIllum2SpectCyan[nRGB2SpectSamples];
-extern const Float RGBIllum2SpectMagenta[nRGB2SpectSamples];
-extern const Float RGBIllum2SpectYellow[nRGB2SpectSamples];
-extern const Float RGBIllum2SpectRed[nRGB2SpectSamples];
-extern const Float RGBIllum2SpectGreen[nRGB2SpectSamples];
-extern const Float RGBIllum2SpectBlue[nRGB2SpectSamples];
+static const int rgbToSpectrumRes = 32;
+static const int rgbToSpectrumZStartRes = 256;
+
+// RGBToSpectrumTable holds, for a grid of RGB colors, the coefficients of
+// quadratic polynomials in wavelength whose sigmoids are smooth reflectance
+// spectra with those colors under the RGB white illuminant, following
+// Jakob and Hanika's method. Colors are indexed by their largest component,
+// with brightness levels spaced more densely near black and white, and the
+// ratios of the other two components to it. The table is precomputed by the
+// rgb2spec tool and defined in core/rgbtospectrum.cpp.
+struct RGBToSpectrumTable {
+    // The _SampledSpectrum_ sample wavelengths remapped to $[0,1]$, which
+    // the polynomials are evaluated at, and the RGB white illuminant
+    Float t[nSpectralSamples];
+    Float white[nSpectralSamples];
+    // The brightness levels and, for each range of brightness, the level to
+    // start searching from
+    Float zNodes[rgbToSpectrumRes], invZSpacing[rgbToSpectrumRes - 1];
+    uint8_t zStart[rgbToSpectrumZStartRes];
+    // Three coefficients per grid point, indexed by the largest component,
+    // the brightness level and the two ratios, followed by one value of
+    // padding so that every grid point's coefficients can be loaded as a
+    // _Float4_
+    Float coeffs[3 * rgbToSpectrumRes * rgbToSpectrumRes * rgbToSpectrumRes *
+                     3 +
+                 1];
+};
+extern const RGBToSpectrumTable rgbToSpectrumTable;
 
 // Spectrum Declarations
 template <int nSpectrumSamples>
@@ -144,10 +164,16 @@ class CoefficientSpectrum {
     }
     CoefficientSpectrum operator/(const CoefficientSpectrum &s2) const {
         DCHECK(!s2.HasNaNs());
-        CoefficientSpectrum ret = *this;
-        for (int i = 0; i < nSpectrumSamples; ++i) {
-          CHECK_NE(s2.c[i], 0);
-          ret.c[i] /= s2.c[i];
+        CoefficientSpectrum ret;
+        int i = 0;
+        for (; i + 4 <= nSpectrumSamples; i += 4) {
+            Float4 d = Float4::Load(&s2.c[i]);
+            CHECK(!AnyZero(d));
+            (Float4::Load(&c[i]) / d).Store(&ret.c[i]);
+        }
+        for (; i < nSpectrumSamples; ++i) {
+            CHECK_NE(s2.c[i], 0);
+            ret.c[i] = c[i] / s2.c[i];
         }
         return ret;
     }
@@ -201,13 +227,19 @@ class CoefficientSpectrum {
         return !(*this == sp);
     }
     bool IsBlack() const {
-        for (int i = 0; i < nSpectrumSamples; ++i)
+        int i = 0;
+        for (; i + 4 <= nSpectrumSamples; i += 4)
+            if (!AllZero(Float4::Load(&c[i]))) return false;
+        for (; i < nSpectrumSamples; ++i)
             if (c[i] != 0.) return false;
         return true;
     }
     friend CoefficientSpectrum Sqrt(const CoefficientSpectrum &s) {
         CoefficientSpectrum ret;
-        for (int i = 0; i < nSpectrumSamples; ++i) ret.c[i] = std::sqrt(s.c[i]);
+        int i = 0;
+        for (; i + 4 <= nSpectrumSamples; i += 4)
+            Sqrt(Float4::Load(&s.c[i])).Store(&ret.c[i]);
+        for (; i < nSpectrumSamples; ++i) ret.c[i] = std::sqrt(s.c[i]);
         DCHECK(!ret.HasNaNs());
         return ret;
     }
@@ -221,7 +253,10 @@ class CoefficientSpectrum {
     }
     friend CoefficientSpectrum Exp(const CoefficientSpectrum &s) {
         CoefficientSpectrum ret;
-        for (int i = 0; i < nSpectrumSamples; ++i) ret.c[i] = std::exp(s.c[i]);
+        int i = 0;
+        for (; i + 4 <= nSpectrumSamples; i += 4)
+            Exp(Float4::Load(&s.c[i])).Store(&ret.c[i]);
+        for (; i < nSpectrumSamples; ++i) ret.c[i] = std::exp(s.c[i]);
         DCHECK(!ret.HasNaNs());
         return ret;
     }
@@ -240,15 +275,28 @@ class CoefficientSpectrum {
     }
     CoefficientSpectrum Clamp(Float low = 0, Float high = Infinity) const {
         CoefficientSpectrum ret;
-        for (int i = 0; i < nSpectrumSamples; ++i)
+        int i = 0;
+        Float4 low4(low), high4(high);
+        for (; i + 4 <= nSpectrumSamples; i += 4)
+            Min(Max(Float4::Load(&c[i]), low4), high4).Store(&ret.c[i]);
+        for (; i < nSpectrumSamples; ++i)
             ret.c[i] = pbrt::Clamp(c[i], low, high);
         DCHECK(!ret.HasNaNs());
         return ret;
     }
     Float MaxComponentValue() const {
-        Float m = c[0];
-        for (int i = 1; i < nSpectrumSamples; ++i)
-            m = std::max(m, c[i]);
+        if (nSpectrumSamples < 4) {
+            Float m = c[0];
+            for (int i = 1; i < nSpectrumSamples; ++i)
+                m = std::max(m, c[i]);
+            return m;
+        }
+        Float4 m4 = Float4::Load(&c[0]);
+        int i = 4;
+        for (; i + 4 <= nSpectrumSamples; i += 4)
+            m4 = Max(m4, Float4::Load(&c[i]));
+        Float m = HorizontalMax(m4);
+        for (; i < nSpectrumSamples; ++i) m = std::max(m, c[i]);
         return m;
     }
     bool HasNaNs() const {
@@ -326,64 +374,18 @@ class SampledSpectrum : public CoefficientSpectrum<nSpectralSamples> {
             Z.c[i] = AverageSpectrumSamples(CIE_lambda, CIE_Z, nCIESamples, wl0,
                                             wl1);
         }
-
-        // Compute RGB to spectrum functions for _SampledSpectrum_
-        for (int i = 0; i < nSpectralSamples; ++i) {
-            Float wl0 = Lerp(Float(i) / Float(nSpectralSamples),
-                             sampledLambdaStart, sampledLambdaEnd);
-            Float wl1 = Lerp(Float(i + 1) / Float(nSpectralSamples),
-                             sampledLambdaStart, sampledLambdaEnd);
-            rgbRefl2SpectWhite.c[i] =
-                AverageSpectrumSamples(RGB2SpectLambda, RGBRefl2SpectWhite,
-                                       nRGB2SpectSamples, wl0, wl1);
-            rgbRefl2SpectCyan.c[i] =
-                AverageSpectrumSamples(RGB2SpectLambda, RGBRefl2SpectCyan,
-                                       nRGB2SpectSamples, wl0, wl1);
-            rgbRefl2SpectMagenta.c[i] =
-                AverageSpectrumSamples(RGB2SpectLambda, RGBRefl2SpectMagenta,
-                                       nRGB2SpectSamples, wl0, wl1);
-            rgbRefl2SpectYellow.c[i] =
-                AverageSpectrumSamples(RGB2SpectLambda, RGBRefl2SpectYellow,
-                                       nRGB2SpectSamples, wl0, wl1);
-            rgbRefl2SpectRed.c[i] = AverageSpectrumSamples(
-                RGB2SpectLambda, RGBRefl2SpectRed, nRGB2SpectSamples, wl0, wl1);
-            rgbRefl2SpectGreen.c[i] =
-                AverageSpectrumSamples(RGB2SpectLambda, RGBRefl2SpectGreen,
-                                       nRGB2SpectSamples, wl0, wl1);
-            rgbRefl2SpectBlue.c[i] =
-                AverageSpectrumSamples(RGB2SpectLambda, RGBRefl2SpectBlue,
-                                       nRGB2SpectSamples, wl0, wl1);
-
-            rgbIllum2SpectWhite.c[i] =
-                AverageSpectrumSamples(RGB2SpectLambda, RGBIllum2SpectWhite,
-                                       nRGB2SpectSamples, wl0, wl1);
-            rgbIllum2SpectCyan.c[i] =
-                AverageSpectrumSamples(RGB2SpectLambda, RGBIllum2SpectCyan,
-                                       nRGB2SpectSamples, wl0, wl1);
-            rgbIllum2SpectMagenta.c[i] =
-                AverageSpectrumSamples(RGB2SpectLambda, RGBIllum2SpectMagenta,
-                                       nRGB2SpectSamples, wl0, wl1);
-            rgbIllum2SpectYellow.c[i] =
-                AverageSpectrumSamples(RGB2SpectLambda, RGBIllum2SpectYellow,
-                                       nRGB2SpectSamples, wl0, wl1);
-            rgbIllum2SpectRed.c[i] =
-                AverageSpectrumSamples(RGB2SpectLambda, RGBIllum2SpectRed,
-                                       nRGB2SpectSamples, wl0, wl1);
-            rgbIllum2SpectGreen.c[i] =
-                AverageSpectrumSamples(RGB2SpectLambda, RGBIllum2SpectGreen,
-                                       nRGB2SpectSamples, wl0, wl1);
-            rgbIllum2SpectBlue.c[i] =
-                AverageSpectrumSamples(RGB2SpectLambda, RGBIllum2SpectBlue,
-                                       nRGB2SpectSamples, wl0, wl1);
-        }
     }
     void ToXYZ(Float xyz[3]) const {
-        xyz[0] = xyz[1] = xyz[2] = 0.f;
-        for (int i = 0; i < nSpectralSamples; ++i) {
-            xyz[0] += X.c[i] * c[i];
-            xyz[1] += Y.c[i] * c[i];
-            xyz[2] += Z.c[i] * c[i];
+        Float4 x(0.f), y(0.f), z(0.f);
+        for (int i = 0; i < nSpectralSamples; i += 4) {
+            Float4 v = Float4::Load(&c[i]);
+            x = x + Float4::Load(&X.c[i]) * v;
+            y = y + Float4::Load(&Y.c[i]) * v;
+            z = z + Float4::Load(&Z.c[i]) * v;
         }
+        xyz[0] = HorizontalSum(x);
+        xyz[1] = HorizontalSum(y);
+        xyz[2] = HorizontalSum(z);
         Float scale = Float(sampledLambdaEnd - sampledLambdaStart) /
                       Float(CIE_Y_integral * nSpectralSamples);
         xyz[0] *= scale;
@@ -391,9 +393,10 @@ class SampledSpectrum : public CoefficientSpectrum<nSpectralSamples> {
         xyz[2] *= scale;
     }
     Float y() const {
-        Float yy = 0.f;
-        for (int i = 0; i < nSpectralSamples; ++i) yy += Y.c[i] * c[i];
-        return yy * Float(sampledLambdaEnd - sampledLambdaStart) /
+        Float4 yy(0.f);
+        for (int i = 0; i < nSpectralSamples; i += 4)
+            yy = yy + Float4::Load(&Y.c[i]) * Float4::Load(&c[i]);
+        return HorizontalSum(yy) * Float(sampledLambdaEnd - sampledLambdaStart) /
                Float(CIE_Y_integral * nSpectralSamples);
     }
     void ToRGB(Float rgb[3]) const {
@@ -414,18 +417,96 @@ class SampledSpectrum : public CoefficientSpectrum<nSpectralSamples> {
                     SpectrumType type = SpectrumType::Reflectance);
 
   private:
+    friend class HeroSpectrum;
     // SampledSpectrum Private Data
     static SampledSpectrum X, Y, Z;
-    static SampledSpectrum rgbRefl2SpectWhite, rgbRefl2SpectCyan;
-    static SampledSpectrum rgbRefl2SpectMagenta, rgbRefl2SpectYellow;
-    static SampledSpectrum rgbRefl2SpectRed, rgbRefl2SpectGreen;
-    static SampledSpectrum rgbRefl2SpectBlue;
-    static SampledSpectrum rgbIllum2SpectWhite, rgbIllum2SpectCyan;
-    static SampledSpectrum rgbIllum2SpectMagenta, rgbIllum2SpectYellow;
-    static SampledSpectrum rgbIllum2SpectRed, rgbIllum2SpectGreen;
-    static SampledSpectrum rgbIllum2SpectBlue;
 };
 
+#ifdef PBRT_HERO_SPECTRUM
+// Hero Wavelength Declarations
+static const int nHeroWavelengths = 4;
+struct HeroWavelengths {
+    // Indices of the _SampledSpectrum_ bins that the wavelengths fall in
+    int bin[nHeroWavelengths];
+};
+extern PBRT_THREAD_LOCAL HeroWavelengths heroWavelengths;
+
+// Samples the wavelengths carried by the calling thread's paths: a hero
+// wavelength chosen with _u_ and the ones evenly spaced from it over the
+// visible range.
+inline void SampleHeroWavelengths(Float u) {
+    const int spacing = nSpectralSamples / nHeroWavelengths;
+    int hero = std::min((int)(u * nSpectralSamples), nSpectralSamples - 1);
+    for (int i = 0; i < nHeroWavelengths; ++i)
+        heroWavelengths.bin[i] = (hero + i * spacing) % nSpectralSamples;
+}
+
+// HeroSpectrum holds a spectral distribution's values at the calling
+// thread's current wavelengths, which are set with
+// _SampleHeroWavelengths()_. Spectra from the scene description are stored
+// as _SceneSpectrum_s and only evaluated at those wavelengths when used.
+// Since the wavelengths are sampled uniformly from _SampledSpectrum_'s
+// bins, images converge to the same result as with _SampledSpectrum_.
+class HeroSpectrum : public CoefficientSpectrum<nHeroWavelengths> {
+  public:
+    // HeroSpectrum Public Methods
+    HeroSpectrum(Float v = 0.f) : CoefficientSpectrum(v) {}
+    HeroSpectrum(const CoefficientSpectrum<nHeroWavelengths> &v)
+        : CoefficientSpectrum<nHeroWavelengths>(v) {}
+    explicit HeroSpectrum(const SampledSpectrum &s) {
+        for (int i = 0; i < nHeroWavelengths; ++i)
+            c[i] = s[heroWavelengths.bin[i]];
+    }
+    HeroSpectrum(const RGBSpectrum &r,
+                 SpectrumType type = SpectrumType::Reflectance);
+    static HeroSpectrum FromSampled(const Float *lambda, const Float *v,
+                                    int n) {
+        return HeroSpectrum(SampledSpectrum::FromSampled(lambda, v, n));
+    }
+    static HeroSpectrum FromRGB(const Float rgb[3],
+                                SpectrumType type = SpectrumType::Illuminant);
+    static HeroSpectrum FromXYZ(const Float xyz[3],
+                                SpectrumType type = SpectrumType::Reflectance) {
+        Float rgb[3];
+        XYZToRGB(xyz, rgb);
+        return FromRGB(rgb, type);
+    }
+    void ToXYZ(Float xyz[3]) const {
+        // Compute Monte Carlo estimate of _SampledSpectrum::ToXYZ()_
+        xyz[0] = xyz[1] = xyz[2] = 0.f;
+        for (int i = 0; i < nHeroWavelengths; ++i) {
+            int b = heroWavelengths.bin[i];
+            xyz[0] += SampledSpectrum::X.c[b] * c[i];
+            xyz[1] += SampledSpectrum::Y.c[b] * c[i];
+            xyz[2] += SampledSpectrum::Z.c[b] * c[i];
+        }
+        Float scale = Float(sampledLambdaEnd - sampledLambdaStart) /
+                      Float(CIE_Y_integral * nHeroWavelengths);
+        xyz[0] *= scale;
+        xyz[1] *= scale;
+        xyz[2] *= scale;
+    }
+    Float y() const {
+        // Return the luminance-weighted average of the values so that
+        // luminance is exact for constant spectra, as sampling decisions
+        // based on it expect
+        Float yy = 0.f, yWeight = 0.f;
+        for (int i = 0; i < nHeroWavelengths; ++i) {
+            Float Y = SampledSpectrum::Y.c[heroWavelengths.bin[i]];
+            yy += Y * c[i];
+            yWeight += Y;
+        }
+        return yy / yWeight;
+    }
+    void ToRGB(Float rgb[3]) const {
+        Float xyz[3];
+        ToXYZ(xyz);
+        XYZToRGB(xyz, rgb);
+    }
+    RGBSpectrum ToRGBSpectrum() const;
+};
+#endif  // PBRT_HERO_SPECTRUM
+
 class RGBSpectrum : public CoefficientSpectrum<3> {
     using CoefficientSpectrum<3>::c;
 
@@ -506,6 +587,13 @@ inline SampledSpectrum Lerp(Float t, const SampledSpectrum &s1,
     return (1 - t) * s1 + t * s2;
 }
 
+#ifdef PBRT_HERO_SPECTRUM
+inline HeroSpectrum Lerp(Float t, const HeroSpectrum &s1,
+                         const HeroSpectrum &s2) {
+    return (1 - t) * s1 + t * s2;
+}
+#endif  // PBRT_HERO_SPECTRUM
+
 void ResampleLinearSpectrum(const Float *lambdaIn, const Float *vIn, int nIn,
                             Float lambdaMin, Float lambdaMax, int nOut,
                             Float *vOut);
@@ -0,0 +1,237 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+
+// core/texcache.cpp*
+#include "texcache.h"
+#include "fileutil.h"
+#include "imageio.h"
+#include "mipmap.h"
+#include "parallel.h"
+
+#include <ImfRgbaFile.h>
+#include <ImfTestFile.h>
+#include <ImfTiledRgbaFile.h>
+
+namespace pbrt {
+
+STAT_MEMORY_COUNTER("Memory/Texture cache tiles", textureCacheMemory);
+STAT_COUNTER("Texture cache/Tiles evicted", nCacheTilesEvicted);
+STAT_COUNTER("Texture cache/Textures", nCacheTextures);
+
+// TextureCache::FileReader Definition
+struct TextureCache::FileReader {
+    FileReader(const std::string &filename) : file(filename.c_str()) {}
+    Imf::TiledRgbaInputFile file;
+};
+
+// TextureCache Method Definitions
+TextureCache::TextureCache(size_t maxBytes)
+    : maxTiles(std::max<size_t>(16, maxBytes / sizeof(Tile))) {}
+
+TextureCache::~TextureCache() {}
+
+bool TextureCache::IsTiledTexture(const std::string &filename) {
+    // Only tiled EXR files with a full MIP map can be paged in
+    if (!HasExtension(filename, ".exr")) return false;
+    bool isTiled;
+    if (!Imf::isOpenExrFile(filename.c_str(), isTiled) || !isTiled)
+        return false;
+    try {
+        Imf::TiledRgbaInputFile file(filename.c_str());
+        return file.levelMode() == Imf::MIPMAP_LEVELS &&
+               file.levelRoundingMode() == Imf::ROUND_DOWN &&
+               file.tileXSize() <= MaxTileSize &&
+               file.tileYSize() <= MaxTileSize;
+    } catch (const std::exception &e) {
+        return false;
+    }
+}
+
+int TextureCache::AddTexture(const std::string &filename) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < files.size(); ++i)
+        if (files[i]->filename == filename) return i;
+    std::unique_ptr<TextureFile> file(new TextureFile);
+    file->filename = filename;
+    try {
+        file->reader.reset(new FileReader(filename));
+        Imf::TiledRgbaInputFile &in = file->reader->file;
+        file->tileSize = Point2i(in.tileXSize(), in.tileYSize());
+        for (int level = 0; level < in.numLevels(); ++level) {
+            Point2i res(in.levelWidth(level), in.levelHeight(level));
+            Point2i nTiles(in.numXTiles(level), in.numYTiles(level));
+            file->levelRes.push_back(res);
+            file->levelTiles.push_back(nTiles);
+            int n = nTiles.x * nTiles.y;
+            file->levelTilePtrs.push_back(
+                std::unique_ptr<std::atomic<Tile *>[]>(
+                    new std::atomic<Tile *>[n]));
+            for (int i = 0; i < n; ++i)
+                file->levelTilePtrs.back()[i].store(nullptr);
+        }
+    } catch (const std::exception &e) {
+        Error("Unable to read tiled image file \"%s\": %s", filename.c_str(),
+              e.what());
+        return -1;
+    }
+    LOG(INFO) << "Added tiled texture " << filename << " with "
+              << file->levelRes.size() << " levels";
+    ++nCacheTextures;
+    files.push_back(std::move(file));
+    return files.size() - 1;
+}
+
+RGBSpectrum TextureCache::LoadTexel(int texture, int level, int s, int t) {
+    // Load the tile holding texel $(s,t)$, given in file coordinates,
+    // unless another thread already has
+    std::lock_guard<std::mutex> lock(mutex);
+    const TextureFile &file = *files[texture];
+    int tx = s / file.tileSize.x, ty = t / file.tileSize.y;
+    int tileIndex = ty * file.levelTiles[level].x + tx;
+    uint64_t key = TileKey(texture, level, tileIndex);
+    std::atomic<Tile *> &tilePtr = file.levelTilePtrs[level][tileIndex];
+    Tile *tile = tilePtr.load(std::memory_order_relaxed);
+    if (!tile || tile->key.load(std::memory_order_relaxed) != key) {
+        ProfilePhase _(Prof::TextureLoading);
+        ++nCacheTileMisses;
+        tile = AllocTile();
+        tile->key.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        // Read the tile's texels from the file
+        Point2i res = file.levelRes[level];
+        int x0 = tx * file.tileSize.x, y0 = ty * file.tileSize.y;
+        int width = std::min(file.tileSize.x, res.x - x0);
+        int height = std::min(file.tileSize.y, res.y - y0);
+        std::vector<Imf::Rgba> pixels(file.tileSize.x * file.tileSize.y);
+        try {
+            Imf::TiledRgbaInputFile &in = file.reader->file;
+            Imath::Box2i dw = in.dataWindow();
+            in.setFrameBuffer(&pixels[0] - (dw.min.x + x0) -
+                                  (dw.min.y + y0) * file.tileSize.x,
+                              1, file.tileSize.x);
+            in.readTile(tx, ty, level);
+        } catch (const std::exception &e) {
+            Error("Unable to read tile (%d, %d) of level %d of \"%s\": %s", tx,
+                  ty, level, file.filename.c_str(), e.what());
+        }
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x) {
+                const Imf::Rgba &p = pixels[y * file.tileSize.x + x];
+                float *rgb = &tile->rgb[3 * (y * file.tileSize.x + x)];
+                rgb[0] = p.r;
+                rgb[1] = p.g;
+                rgb[2] = p.b;
+            }
+
+        // Publish the tile to lock-free readers
+        tile->owner = &tilePtr;
+        tile->key.store(key, std::memory_order_release);
+        tilePtr.store(tile, std::memory_order_release);
+    }
+    tile->referenced.store(true, std::memory_order_relaxed);
+    const float *rgb =
+        &tile->rgb[3 * ((t - ty * file.tileSize.y) * file.tileSize.x +
+                        (s - tx * file.tileSize.x))];
+    Float v[3] = {rgb[0], rgb[1], rgb[2]};
+    return RGBSpectrum::FromRGB(v);
+}
+
+TextureCache::Tile *TextureCache::AllocTile() {
+    // Allocate a new tile if the cache isn't full yet
+    if (tiles.size() < maxTiles) {
+        tiles.push_back(std::unique_ptr<Tile>(new Tile));
+        Tile *tile = tiles.back().get();
+        tile->key.store(0, std::memory_order_relaxed);
+        tile->owner = nullptr;
+        textureCacheMemory += sizeof(Tile);
+        return tile;
+    }
+
+    // Evict the first tile the clock hand finds that hasn't been used
+    // since the hand last passed it
+    while (true) {
+        Tile *tile = tiles[clockHand].get();
+        clockHand = (clockHand + 1) % tiles.size();
+        if (!tile->referenced.exchange(false, std::memory_order_relaxed)) {
+            tile->owner->store(nullptr, std::memory_order_relaxed);
+            ++nCacheTilesEvicted;
+            return tile;
+        }
+    }
+}
+
+bool WriteTiledMIPMap(const std::string &inFilename,
+                      const std::string &outFilename) {
+    Point2i res;
+    std::unique_ptr<RGBSpectrum[]> image = ReadImage(inFilename, &res);
+    if (!image) return false;
+    if (HasExtension(inFilename, ".tga") || HasExtension(inFilename, ".png"))
+        // Filter 8-bit images in linear space
+        for (int i = 0; i < res.x * res.y; ++i)
+            for (int c = 0; c < RGBSpectrum::nSamples; ++c)
+                image[i][c] = InverseGammaCorrect(image[i][c]);
+
+    // Write the levels of the image's _MIPMap_ in OpenEXR's tiled format
+    MIPMap<RGBSpectrum> mipmap(res, image.get());
+    Point2i res0(mipmap.Width(), mipmap.Height());
+    try {
+        Imf::TiledRgbaOutputFile out(outFilename.c_str(), res0.x, res0.y,
+                                     TextureCache::MaxTileSize,
+                                     TextureCache::MaxTileSize,
+                                     Imf::MIPMAP_LEVELS, Imf::ROUND_DOWN,
+                                     Imf::WRITE_RGB);
+        CHECK_EQ(out.numLevels(), mipmap.Levels());
+        for (int level = 0; level < out.numLevels(); ++level) {
+            // _mipmap_ has the image's top row first, like the file
+            int width = out.levelWidth(level), height = out.levelHeight(level);
+            std::vector<Imf::Rgba> pixels(width * height);
+            for (int y = 0; y < height; ++y)
+                for (int x = 0; x < width; ++x) {
+                    RGBSpectrum v = mipmap.Texel(level, x, y);
+                    pixels[y * width + x] = Imf::Rgba(v[0], v[1], v[2]);
+                }
+            out.setFrameBuffer(&pixels[0], 1, width);
+            out.writeTiles(0, out.numXTiles(level) - 1, 0,
+                           out.numYTiles(level) - 1, level);
+        }
+    } catch (const std::exception &e) {
+        Error("Unable to write tiled image file \"%s\": %s",
+              outFilename.c_str(), e.what());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace pbrt
@@ -0,0 +1,156 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_CORE_TEXCACHE_H
+#define PBRT_CORE_TEXCACHE_H
+
+// core/texcache.h*
+#include "pbrt.h"
+#include "geometry.h"
+#include "spectrum.h"
+#include "stats.h"
+#include <atomic>
+#include <mutex>
+
+namespace pbrt {
+
+STAT_COUNTER("Texture cache/Texel lookups", nCacheTexelLookups);
+STAT_COUNTER("Texture cache/Tile misses", nCacheTileMisses);
+
+// TextureCache Declarations
+
+// TextureCache pages the tiles of tiled, MIP-mapped OpenEXR files into a
+// fixed amount of memory on demand. Tiles are evicted in approximately
+// least-recently-used order with the CLOCK algorithm. Lookups of resident
+// tiles don't take any locks: each tile carries a version key that readers
+// check before and after reading texels, seqlock-style, so that a tile
+// being reloaded underneath a reader is detected and the lookup retried.
+class TextureCache {
+  public:
+    // TextureCache Public Methods
+    TextureCache(size_t maxBytes);
+    ~TextureCache();
+    static bool IsTiledTexture(const std::string &filename);
+    int AddTexture(const std::string &filename);
+    int Levels(int texture) const;
+    Point2i LevelResolution(int texture, int level) const;
+    RGBSpectrum Texel(int texture, int level, int s, int t);
+
+    // TextureCache Public Data
+    static PBRT_CONSTEXPR int MaxTileSize = 64;
+
+  private:
+    // TextureCache Private Declarations
+    struct Tile {
+        // _key_ identifies the tile's contents; it's zero while the tile is
+        // empty or being loaded
+        std::atomic<uint64_t> key;
+        std::atomic<bool> referenced;
+        std::atomic<Tile *> *owner;
+        float rgb[3 * MaxTileSize * MaxTileSize];
+    };
+    struct FileReader;
+    struct TextureFile;
+
+    // TextureCache Private Methods
+    static uint64_t TileKey(int texture, int level, int tile) {
+        return ((uint64_t(texture) << 40) | (uint64_t(level) << 32) |
+                uint32_t(tile)) + 1;
+    }
+    RGBSpectrum LoadTexel(int texture, int level, int s, int t);
+    Tile *AllocTile();
+
+    // TextureCache Private Data
+    const int maxTiles;
+    std::vector<std::unique_ptr<TextureFile>> files;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Tile>> tiles;
+    int clockHand = 0;
+};
+
+bool WriteTiledMIPMap(const std::string &inFilename,
+                      const std::string &outFilename);
+
+// TextureCache::TextureFile Definition
+struct TextureCache::TextureFile {
+    std::string filename;
+    std::unique_ptr<FileReader> reader;
+    Point2i tileSize;
+    std::vector<Point2i> levelRes, levelTiles;
+    std::vector<std::unique_ptr<std::atomic<Tile *>[]>> levelTilePtrs;
+};
+
+// TextureCache Inline Functions
+inline int TextureCache::Levels(int texture) const {
+    return files[texture]->levelRes.size();
+}
+
+inline Point2i TextureCache::LevelResolution(int texture, int level) const {
+    return files[texture]->levelRes[level];
+}
+
+inline RGBSpectrum TextureCache::Texel(int texture, int level, int s, int t) {
+    ++nCacheTexelLookups;
+    // Find the tile holding texel $(s,t)$; texture space has $t=0$ at the
+    // bottom of the image, while files store the top row first
+    const TextureFile &file = *files[texture];
+    t = file.levelRes[level].y - 1 - t;
+    int tx = s / file.tileSize.x, ty = t / file.tileSize.y;
+    int tileIndex = ty * file.levelTiles[level].x + tx;
+    uint64_t key = TileKey(texture, level, tileIndex);
+    Tile *tile =
+        file.levelTilePtrs[level][tileIndex].load(std::memory_order_acquire);
+    if (tile && tile->key.load(std::memory_order_acquire) == key) {
+        // Read the texel and check that the tile wasn't reloaded meanwhile
+        const float *rgb =
+            &tile->rgb[3 * ((t - ty * file.tileSize.y) * file.tileSize.x +
+                            (s - tx * file.tileSize.x))];
+        Float v[3] = {rgb[0], rgb[1], rgb[2]};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (tile->key.load(std::memory_order_relaxed) == key) {
+            if (!tile->referenced.load(std::memory_order_relaxed))
+                tile->referenced.store(true, std::memory_order_relaxed);
+            return RGBSpectrum::FromRGB(v);
+        }
+    }
+    return LoadTexel(texture, level, s, t);
+}
+
+}  // namespace pbrt
+
+#endif  // PBRT_CORE_TEXCACHE_H
@@ -139,6 +139,20 @@ class Texture {
     virtual ~Texture() {}
 };
 
+// SceneValue<T>::type is the type that textures store values of type _T_
+// from the scene description as
+template <typename T>
+struct SceneValue {
+    typedef T type;
+};
+
+#ifdef PBRT_HERO_SPECTRUM
+template <>
+struct SceneValue<Spectrum> {
+    typedef SceneSpectrum type;
+};
+#endif  // PBRT_HERO_SPECTRUM
+
 Float Lanczos(Float, Float tau = 2);
 Float Noise(Float x, Float y = .5f, Float z = .5f);
 Float Noise(const Point3f &p);
@@ -32,6 +32,7 @@
 
 // integrators/bdpt.cpp*
 #include "integrators/bdpt.h"
+#include "checkpoint.h"
 #include "film.h"
 #include "filters/box.h"
 #include "integrator.h"
@@ -318,7 +319,15 @@ void BDPTIntegrator::Render(const Scene &scene) {
     const int tileSize = 16;
     const int nXTiles = (sampleExtent.x + tileSize - 1) / tileSize;
     const int nYTiles = (sampleExtent.y + tileSize - 1) / tileSize;
-    ProgressReporter reporter(nXTiles * nYTiles, "Rendering");
+    int tileBegin, tileEnd;
+    NodeTileRange(nXTiles * nYTiles, &tileBegin, &tileEnd);
+    // Debug visualization films aren't included in checkpoints.
+    TileCheckpoint checkpoint(
+        film, nXTiles * nYTiles,
+        StringPrintf("bdpt spp %d maxdepth %d",
+                     (int)sampler->samplesPerPixel, maxDepth));
+    ProgressReporter reporter(tileEnd - tileBegin, "Rendering");
+    ThreadArenaPool arenas;
 
     // Allocate buffers for debug visualization
     const int bufferCount = (1 + maxDepth) * (6 + maxDepth) / 2;
@@ -343,95 +352,111 @@ void BDPTIntegrator::Render(const Scene &scene) {
 
     // Render and write the output image to disk
     if (scene.lights.size() > 0) {
-        ParallelFor2D([&](const Point2i tile) {
-            // Render a single tile using BDPT
-            MemoryArena arena;
-            int seed = tile.y * nXTiles + tile.x;
-            std::unique_ptr<Sampler> tileSampler = sampler->Clone(seed);
-            int x0 = sampleBounds.pMin.x + tile.x * tileSize;
-            int x1 = std::min(x0 + tileSize, sampleBounds.pMax.x);
-            int y0 = sampleBounds.pMin.y + tile.y * tileSize;
-            int y1 = std::min(y0 + tileSize, sampleBounds.pMax.y);
-            Bounds2i tileBounds(Point2i(x0, y0), Point2i(x1, y1));
-            LOG(INFO) << "Starting image tile " << tileBounds;
-
-            std::unique_ptr<FilmTile> filmTile =
-                camera->film->GetFilmTile(tileBounds);
-            for (Point2i pPixel : tileBounds) {
-                tileSampler->StartPixel(pPixel);
-                if (!InsideExclusive(pPixel, pixelBounds))
-                    continue;
-                do {
-                    // Generate a single sample using BDPT
-                    Point2f pFilm = (Point2f)pPixel + tileSampler->Get2D();
-
-                    // Trace the camera subpath
-                    Vertex *cameraVertices = arena.Alloc<Vertex>(maxDepth + 2);
-                    Vertex *lightVertices = arena.Alloc<Vertex>(maxDepth + 1);
-                    int nCamera = GenerateCameraSubpath(
-                        scene, *tileSampler, arena, maxDepth + 2, *camera,
-                        pFilm, cameraVertices);
-                    // Get a distribution for sampling the light at the
-                    // start of the light subpath. Because the light path
-                    // follows multiple bounces, basing the sampling
-                    // distribution on any of the vertices of the camera
-                    // path is unlikely to be a good strategy. We use the
-                    // PowerLightDistribution by default here, which
-                    // doesn't use the point passed to it.
-                    const Distribution1D *lightDistr =
-                        lightDistribution->Lookup(cameraVertices[0].p());
-                    // Now trace the light subpath
-                    int nLight = GenerateLightSubpath(
-                        scene, *tileSampler, arena, maxDepth + 1,
-                        cameraVertices[0].time(), *lightDistr, lightToIndex,
-                        lightVertices);
-
-                    // Execute all BDPT connection strategies
-                    Spectrum L(0.f);
-                    for (int t = 1; t <= nCamera; ++t) {
-                        for (int s = 0; s <= nLight; ++s) {
-                            int depth = t + s - 2;
-                            if ((s == 1 && t == 1) || depth < 0 ||
-                                depth > maxDepth)
-                                continue;
-                            // Execute the $(s, t)$ connection strategy and
-                            // update _L_
-                            Point2f pFilmNew = pFilm;
-                            Float misWeight = 0.f;
-                            Spectrum Lpath = ConnectBDPT(
-                                scene, lightVertices, cameraVertices, s, t,
-                                *lightDistr, lightToIndex, *camera, *tileSampler,
-                                &pFilmNew, &misWeight);
-                            VLOG(2) << "Connect bdpt s: " << s <<", t: " << t <<
-                                ", Lpath: " << Lpath << ", misWeight: " << misWeight;
-                            if (visualizeStrategies || visualizeWeights) {
-                                Spectrum value;
-                                if (visualizeStrategies)
-                                    value =
-                                        misWeight == 0 ? 0 : Lpath / misWeight;
-                                if (visualizeWeights) value = Lpath;
-                                weightFilms[BufferIndex(s, t)]->AddSplat(
-                                    pFilmNew, value);
+        // Render tiles in batches so that checkpoints, taken between
+        // batches, include every splat from the finished tiles and none
+        // from unfinished ones
+        int batchSize = checkpoint.BatchSize(tileEnd - tileBegin);
+        for (int batchBegin = tileBegin; batchBegin < tileEnd;
+             batchBegin += batchSize) {
+            ParallelFor([&](int64_t i) {
+                // Render a single tile using BDPT
+                int seed = batchBegin + i;
+                if (checkpoint.IsTileDone(seed)) {
+                    reporter.Update();
+                    return;
+                }
+                Point2i tile(seed % nXTiles, seed / nXTiles);
+                MemoryArena &arena = arenas.Get();
+                std::unique_ptr<Sampler> tileSampler = sampler->Clone(seed);
+                int x0 = sampleBounds.pMin.x + tile.x * tileSize;
+                int x1 = std::min(x0 + tileSize, sampleBounds.pMax.x);
+                int y0 = sampleBounds.pMin.y + tile.y * tileSize;
+                int y1 = std::min(y0 + tileSize, sampleBounds.pMax.y);
+                Bounds2i tileBounds(Point2i(x0, y0), Point2i(x1, y1));
+                LOG(INFO) << "Starting image tile " << tileBounds;
+
+                std::unique_ptr<FilmTile> filmTile =
+                    camera->film->GetFilmTile(tileBounds);
+                for (Point2i pPixel : tileBounds) {
+                    tileSampler->StartPixel(pPixel);
+                    if (!InsideExclusive(pPixel, pixelBounds))
+                        continue;
+                    do {
+                        // Generate a single sample using BDPT
+                        Point2f pFilm = (Point2f)pPixel + tileSampler->Get2D();
+                        SampleWavelengths(*tileSampler);
+
+                        // Trace the camera subpath
+                        Vertex *cameraVertices = arena.Alloc<Vertex>(maxDepth + 2);
+                        Vertex *lightVertices = arena.Alloc<Vertex>(maxDepth + 1);
+                        int nCamera = GenerateCameraSubpath(
+                            scene, *tileSampler, arena, maxDepth + 2, *camera,
+                            pFilm, cameraVertices);
+                        // Get a distribution for sampling the light at the
+                        // start of the light subpath. Because the light path
+                        // follows multiple bounces, basing the sampling
+                        // distribution on any of the vertices of the camera
+                        // path is unlikely to be a good strategy. We use the
+                        // PowerLightDistribution by default here, which
+                        // doesn't use the point passed to it.
+                        const Distribution1D *lightDistr =
+                            lightDistribution->Lookup(cameraVertices[0].p());
+                        // Now trace the light subpath
+                        int nLight = GenerateLightSubpath(
+                            scene, *tileSampler, arena, maxDepth + 1,
+                            cameraVertices[0].time(), *lightDistr, lightToIndex,
+                            lightVertices);
+
+                        // Execute all BDPT connection strategies
+                        Spectrum L(0.f);
+                        for (int t = 1; t <= nCamera; ++t) {
+                            for (int s = 0; s <= nLight; ++s) {
+                                int depth = t + s - 2;
+                                if ((s == 1 && t == 1) || depth < 0 ||
+                                    depth > maxDepth)
+                                    continue;
+                                // Execute the $(s, t)$ connection strategy and
+                                // update _L_
+                                Point2f pFilmNew = pFilm;
+                                Float misWeight = 0.f;
+                                Spectrum Lpath = ConnectBDPT(
+                                    scene, lightVertices, cameraVertices, s, t,
+                                    *lightDistr, lightToIndex, *camera, *tileSampler,
+                                    &pFilmNew, &misWeight);
+                                VLOG(2) << "Connect bdpt s: " << s <<", t: " << t <<
+                                    ", Lpath: " << Lpath << ", misWeight: " << misWeight;
+                                if (visualizeStrategies || visualizeWeights) {
+                                    Spectrum value;
+                                    if (visualizeStrategies)
+                                        value =
+                                            misWeight == 0 ? 0 : Lpath / misWeight;
+                                    if (visualizeWeights) value = Lpath;
+                                    weightFilms[BufferIndex(s, t)]->AddSplat(
+                                        pFilmNew, value);
+                                }
+                                if (t != 1)
+                                    L += Lpath;
+                                else
+                                    film->AddSplat(pFilmNew, Lpath);
                             }
-                            if (t != 1)
-                                L += Lpath;
-                            else
-                                film->AddSplat(pFilmNew, Lpath);
                         }
-                    }
-                    VLOG(2) << "Add film sample pFilm: " << pFilm << ", L: " << L <<
-                        ", (y: " << L.y() << ")";
-                    filmTile->AddSample(pFilm, L);
-                    arena.Reset();
-                } while (tileSampler->StartNextSample());
-            }
-            film->MergeFilmTile(std::move(filmTile));
-            reporter.Update();
-            LOG(INFO) << "Finished image tile " << tileBounds;
-        }, Point2i(nXTiles, nYTiles));
+                        VLOG(2) << "Add film sample pFilm: " << pFilm << ", L: " << L <<
+                            ", (y: " << L.y() << ")";
+                        filmTile->AddSample(pFilm, L);
+                        arena.Reset();
+                    } while (tileSampler->StartNextSample());
+                }
+                film->MergeFilmTile(std::move(filmTile));
+                checkpoint.TileDone(seed);
+                reporter.Update();
+                LOG(INFO) << "Finished image tile " << tileBounds;
+            }, std::min(batchSize, tileEnd - batchBegin));
+            checkpoint.EndBatch();
+        }
         reporter.Done();
     }
     film->WriteImage(1.0f / sampler->samplesPerPixel);
+    checkpoint.Finish();
 
     // Write buffers for debug visualization
     if (visualizeStrategies || visualizeWeights) {
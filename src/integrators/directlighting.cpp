@@ -83,8 +83,10 @@ Spectrum DirectLightingIntegrator::Li(const RayDifferential &ray,
         if (strategy == LightStrategy::UniformSampleAll)
             L += UniformSampleAllLights(isect, scene, arena, sampler,
                                         nLightSamples);
-        else
+        else if (strategy == LightStrategy::UniformSampleOne)
             L += UniformSampleOneLight(isect, scene, arena, sampler);
+        else
+            L += ResampleOneLight(isect, scene, sampler, nLightCandidates);
     }
     if (depth + 1 < maxDepth) {
         // Trace rays for specular reflection and refraction
@@ -104,6 +106,8 @@ DirectLightingIntegrator *CreateDirectLightingIntegrator(
         strategy = LightStrategy::UniformSampleOne;
     else if (st == "all")
         strategy = LightStrategy::UniformSampleAll;
+    else if (st == "resample")
+        strategy = LightStrategy::ResampleOne;
     else {
         Warning(
             "Strategy \"%s\" for direct lighting unknown. "
@@ -125,8 +129,9 @@ DirectLightingIntegrator *CreateDirectLightingIntegrator(
                 Error("Degenerate \"pixelbounds\" specified.");
         }
     }
+    int nLightCandidates = params.FindOneInt("lightcandidates", 32);
     return new DirectLightingIntegrator(strategy, maxDepth, camera, sampler,
-                                        pixelBounds);
+                                        pixelBounds, nLightCandidates);
 }
 
 }  // namespace pbrt
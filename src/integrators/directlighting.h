@@ -46,7 +46,7 @@
 namespace pbrt {
 
 // LightStrategy Declarations
-enum class LightStrategy { UniformSampleAll, UniformSampleOne };
+enum class LightStrategy { UniformSampleAll, UniformSampleOne, ResampleOne };
 
 // DirectLightingIntegrator Declarations
 class DirectLightingIntegrator : public SamplerIntegrator {
@@ -55,10 +55,12 @@ class DirectLightingIntegrator : public SamplerIntegrator {
     DirectLightingIntegrator(LightStrategy strategy, int maxDepth,
                              std::shared_ptr<const Camera> camera,
                              std::shared_ptr<Sampler> sampler,
-                             const Bounds2i &pixelBounds)
+                             const Bounds2i &pixelBounds,
+                             int nLightCandidates = 32)
         : SamplerIntegrator(camera, sampler, pixelBounds),
           strategy(strategy),
-          maxDepth(maxDepth) {}
+          maxDepth(maxDepth),
+          nLightCandidates(nLightCandidates) {}
     Spectrum Li(const RayDifferential &ray, const Scene &scene,
                 Sampler &sampler, MemoryArena &arena, int depth) const;
     void Preprocess(const Scene &scene, Sampler &sampler);
@@ -67,6 +69,7 @@ class DirectLightingIntegrator : public SamplerIntegrator {
     // DirectLightingIntegrator Private Data
     const LightStrategy strategy;
     const int maxDepth;
+    const int nLightCandidates;
     std::vector<int> nLightSamples;
 };
 
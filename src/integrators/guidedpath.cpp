@@ -0,0 +1,553 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// integrators/guidedpath.cpp*
+#include "integrators/guidedpath.h"
+#include "bssrdf.h"
+#include "camera.h"
+#include "film.h"
+#include "interaction.h"
+#include "paramset.h"
+#include "progressreporter.h"
+#include "reflection.h"
+#include "samplers/random.h"
+#include "scene.h"
+#include "stats.h"
+
+namespace pbrt {
+
+STAT_PERCENT("Integrator/Guided path directions", guidedDirections,
+             guidableVertices);
+STAT_COUNTER("Integrator/SD-tree spatial leaves", nSTreeLeaves);
+STAT_MEMORY_COUNTER("Memory/SD-tree", sdTreeBytes);
+
+// Directional quadtrees aren't subdivided further than this
+static PBRT_CONSTEXPR int MaxDTreeDepth = 20;
+
+// Maps directions to the unit square and back, preserving area
+static Point2f DirectionToSquare(const Vector3f &w) {
+    Float cosTheta = Clamp(w.z, -1, 1);
+    Float phi = std::atan2(w.y, w.x);
+    if (phi < 0) phi += 2 * Pi;
+    return Point2f((cosTheta + 1) / 2, phi * Inv2Pi);
+}
+
+static Vector3f SquareToDirection(const Point2f &p) {
+    Float cosTheta = 2 * p[0] - 1;
+    Float sinTheta = SafeSqrt(1 - cosTheta * cosTheta);
+    Float phi = 2 * Pi * p[1];
+    return Vector3f(sinTheta * std::cos(phi), sinTheta * std::sin(phi),
+                    cosTheta);
+}
+
+// DTree Method Definitions
+DTree::DTree() : nodes(1) {}
+
+void DTree::Record(const Vector3f &w, Float radiance) {
+    // Only the leaf's sum is updated here; Build() computes the others
+    Point2f p = DirectionToSquare(w);
+    int n = 0;
+    while (true) {
+        int x = p[0] >= .5f, y = p[1] >= .5f, q = x + 2 * y;
+        int child = nodes[n].child[q];
+        if (child == 0) {
+            nodes[n].sum[q].Add(radiance);
+            return;
+        }
+        p = Point2f(2 * p[0] - x, 2 * p[1] - y);
+        n = child;
+    }
+}
+
+void DTree::Build() {
+    for (int n = int(nodes.size()) - 1; n >= 0; --n)
+        for (int q = 0; q < 4; ++q)
+            if (nodes[n].child[q]) {
+                const Node &child = nodes[nodes[n].child[q]];
+                nodes[n].sum[q] =
+                    child.sum[0] + child.sum[1] + child.sum[2] + child.sum[3];
+            }
+}
+
+DTree DTree::Refined(Float threshold, int maxDepth) const {
+    Float total = Total();
+    if (!(total > 0)) {
+        // Keep the current subdivision if no radiance was recorded
+        DTree tree(*this);
+        for (Node &node : tree.nodes)
+            for (int q = 0; q < 4; ++q) node.sum[q] = 0;
+        return tree;
+    }
+
+    // Each entry gives a node of the new tree, the corresponding node of
+    // this one or -1 if there isn't one, in which case the radiance in the
+    // node's square is taken to be uniform, and the node's fraction of the
+    // total radiance.
+    struct Entry {
+        int node, oldNode;
+        Float fraction;
+        int depth;
+    };
+    DTree tree;
+    std::vector<Entry> todo = {{0, 0, 1, 1}};
+    while (!todo.empty()) {
+        Entry e = todo.back();
+        todo.pop_back();
+        for (int q = 0; q < 4; ++q) {
+            Float fraction = e.oldNode >= 0
+                                 ? nodes[e.oldNode].sum[q] / total
+                                 : e.fraction / 4;
+            if (fraction <= threshold || e.depth >= maxDepth) continue;
+            int child = int(tree.nodes.size());
+            tree.nodes.push_back(Node());
+            tree.nodes[e.node].child[q] = child;
+            int oldChild = e.oldNode >= 0 && nodes[e.oldNode].child[q]
+                               ? nodes[e.oldNode].child[q]
+                               : -1;
+            todo.push_back({child, oldChild, fraction, e.depth + 1});
+        }
+    }
+    return tree;
+}
+
+Float DTree::Total() const {
+    return nodes[0].sum[0] + nodes[0].sum[1] + nodes[0].sum[2] +
+           nodes[0].sum[3];
+}
+
+Vector3f DTree::Sample(const Point2f &uSample, Float *pdf) const {
+    if (!(Total() > 0)) {
+        *pdf = UniformSpherePdf();
+        return SquareToDirection(uSample);
+    }
+    // Descend the tree choosing quadrants in proportion to their radiance
+    // and sample the leaf's square uniformly
+    Point2f u = uSample, pMin(0, 0);
+    Float size = 1, squarePdf = 1;
+    int n = 0;
+    while (true) {
+        const Node &node = nodes[n];
+        Float s[4] = {node.sum[0], node.sum[1], node.sum[2], node.sum[3]};
+        Float total = s[0] + s[1] + s[2] + s[3];
+        if (!(total > 0)) break;
+
+        // Choose a column of quadrants with _u[0]_ and a quadrant in it
+        // with _u[1]_
+        Float pLeft = (s[0] + s[2]) / total;
+        int x = u[0] >= pLeft;
+        u[0] = x == 0 ? u[0] / pLeft : (u[0] - pLeft) / (1 - pLeft);
+        Float pBottom = s[x] / (s[x] + s[x + 2]);
+        int y = u[1] >= pBottom;
+        u[1] = y == 0 ? u[1] / pBottom : (u[1] - pBottom) / (1 - pBottom);
+        u = Point2f(std::min(u[0], OneMinusEpsilon),
+                    std::min(u[1], OneMinusEpsilon));
+        int q = x + 2 * y;
+
+        squarePdf *= 4 * s[q] / total;
+        size /= 2;
+        pMin += Vector2f(x * size, y * size);
+        if (node.child[q] == 0) break;
+        n = node.child[q];
+    }
+    *pdf = squarePdf * Inv4Pi;
+    return SquareToDirection(pMin + Vector2f(u[0] * size, u[1] * size));
+}
+
+Float DTree::Pdf(const Vector3f &w) const {
+    if (!(Total() > 0)) return UniformSpherePdf();
+    Point2f p = DirectionToSquare(w);
+    Float squarePdf = 1;
+    int n = 0;
+    while (true) {
+        const Node &node = nodes[n];
+        Float total = node.sum[0] + node.sum[1] + node.sum[2] + node.sum[3];
+        if (!(total > 0)) break;
+        int x = p[0] >= .5f, y = p[1] >= .5f, q = x + 2 * y;
+        if (node.sum[q] == 0) return 0;
+        squarePdf *= 4 * node.sum[q] / total;
+        if (node.child[q] == 0) break;
+        p = Point2f(2 * p[0] - x, 2 * p[1] - y);
+        n = node.child[q];
+    }
+    return squarePdf * Inv4Pi;
+}
+
+// STree Method Definitions
+STree::STree(const Bounds3f &b) : bounds(b) {
+    // Use a cube around the scene so that voxels are roughly cubical
+    Vector3f d = bounds.Diagonal();
+    Float size = std::max(d.x, std::max(d.y, d.z)) * 1.001f;
+    bounds.pMax = bounds.pMin + Vector3f(size, size, size);
+    Node root;
+    root.axis = 0;
+    root.child[0] = root.child[1] = 0;
+    root.dTree.reset(new DTreeWrapper);
+    nodes.push_back(std::move(root));
+}
+
+DTreeWrapper *STree::Lookup(const Point3f &p) const {
+    Vector3f o = bounds.Offset(p);
+    int n = 0;
+    while (nodes[n].child[0]) {
+        int axis = nodes[n].axis;
+        if (o[axis] < .5f) {
+            o[axis] *= 2;
+            n = nodes[n].child[0];
+        } else {
+            o[axis] = 2 * o[axis] - 1;
+            n = nodes[n].child[1];
+        }
+    }
+    return nodes[n].dTree.get();
+}
+
+void STree::Refine(Float splitThreshold) {
+    // Split nodes until each leaf has fewer records than the threshold;
+    // the children each start with a copy of the parent's distributions.
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        if (nodes[n].child[0] || nodes[n].dTree->weight <= splitThreshold)
+            continue;
+        std::unique_ptr<DTreeWrapper> dTree = std::move(nodes[n].dTree);
+        dTree->weight = dTree->weight / 2;
+        for (int c = 0; c < 2; ++c) {
+            Node child;
+            child.axis = (nodes[n].axis + 1) % 3;
+            child.child[0] = child.child[1] = 0;
+            child.dTree.reset(new DTreeWrapper(*dTree));
+            nodes[n].child[c] = int(nodes.size());
+            nodes.push_back(std::move(child));
+        }
+    }
+}
+
+void STree::BuildDTrees(Float threshold, int maxDepth) {
+    ParallelFor([&](int64_t n) {
+        DTreeWrapper *dTree = nodes[n].dTree.get();
+        if (!dTree) return;
+        dTree->building.Build();
+        dTree->sampling = dTree->building;
+        dTree->building = dTree->sampling.Refined(threshold, maxDepth);
+        dTree->weight = 0;
+    }, nodes.size(), 16);
+}
+
+int STree::LeafCount() const {
+    int count = 0;
+    for (const Node &node : nodes)
+        if (node.dTree) ++count;
+    return count;
+}
+
+size_t STree::Bytes() const {
+    size_t bytes = sizeof(*this) + nodes.size() * sizeof(Node);
+    for (const Node &node : nodes)
+        if (node.dTree)
+            bytes += sizeof(DTreeWrapper) + node.dTree->sampling.Bytes() +
+                     node.dTree->building.Bytes();
+    return bytes;
+}
+
+// GuidedPathIntegrator Method Definitions
+GuidedPathIntegrator::GuidedPathIntegrator(
+    int maxDepth, std::shared_ptr<const Camera> camera,
+    std::shared_ptr<Sampler> sampler, const Bounds2i &pixelBounds,
+    Float rrThreshold, const std::string &lightSampleStrategy,
+    int trainingPasses, Float bsdfSamplingFraction, Float spatialThreshold,
+    Float directionalThreshold)
+    : SamplerIntegrator(camera, sampler, pixelBounds),
+      maxDepth(maxDepth),
+      rrThreshold(rrThreshold),
+      lightSampleStrategy(lightSampleStrategy),
+      trainingBounds(pixelBounds),
+      trainingPasses(trainingPasses),
+      bsdfSamplingFraction(bsdfSamplingFraction),
+      spatialThreshold(spatialThreshold),
+      directionalThreshold(directionalThreshold) {}
+
+void GuidedPathIntegrator::Preprocess(const Scene &scene, Sampler &sampler) {
+    lightDistribution =
+        CreateLightSampleDistribution(lightSampleStrategy, scene);
+    sdTree.reset(new STree(scene.WorldBound()));
+
+    // Train the SD-tree with passes that each take twice as many samples
+    // as the one before, refining it after each one
+    ProgressReporter reporter(
+        int64_t(trainingBounds.Area()) * ((int64_t(1) << trainingPasses) - 1),
+        "Training");
+    for (int pass = 0; pass < trainingPasses; ++pass) {
+        int spp = 1 << pass;
+        TrainingPass(scene, spp, pass, reporter);
+        sdTree->Refine(spatialThreshold * std::sqrt(Float(spp)));
+        sdTree->BuildDTrees(directionalThreshold, MaxDTreeDepth);
+    }
+    reporter.Done();
+    nSTreeLeaves = sdTree->LeafCount();
+    sdTreeBytes = sdTree->Bytes();
+}
+
+void GuidedPathIntegrator::TrainingPass(const Scene &scene, int spp, int pass,
+                                        ProgressReporter &reporter) {
+    const int tileSize = 16;
+    Vector2i extent = trainingBounds.Diagonal();
+    Point2i nTiles((extent.x + tileSize - 1) / tileSize,
+                   (extent.y + tileSize - 1) / tileSize);
+    ThreadArenaPool arenas;
+    ParallelFor([&](int64_t t) {
+        MemoryArena &arena = arenas.Get();
+        RandomSampler tileSampler(spp, int(pass * nTiles.x * nTiles.y + t));
+        Point2i tile(int(t % nTiles.x), int(t / nTiles.x));
+        int x0 = trainingBounds.pMin.x + tile.x * tileSize;
+        int x1 = std::min(x0 + tileSize, trainingBounds.pMax.x);
+        int y0 = trainingBounds.pMin.y + tile.y * tileSize;
+        int y1 = std::min(y0 + tileSize, trainingBounds.pMax.y);
+        Bounds2i tileBounds(Point2i(x0, y0), Point2i(x1, y1));
+        for (Point2i pixel : tileBounds) {
+            tileSampler.StartPixel(pixel);
+            do {
+                // Trace a path to record the radiance along it; the image
+                // contribution is discarded
+                CameraSample cameraSample = tileSampler.GetCameraSample(pixel);
+                SampleWavelengths(tileSampler);
+                RayDifferential ray;
+                Float rayWeight =
+                    camera->GenerateRayDifferential(cameraSample, &ray);
+                if (rayWeight > 0)
+                    LiGuided(ray, scene, tileSampler, arena, true);
+                arena.Reset();
+            } while (tileSampler.StartNextSample());
+        }
+        reporter.Update(int64_t(spp) * tileBounds.Area());
+    }, nTiles.x * nTiles.y);
+}
+
+Spectrum GuidedPathIntegrator::Li(const RayDifferential &ray,
+                                  const Scene &scene, Sampler &sampler,
+                                  MemoryArena &arena, int depth) const {
+    return LiGuided(ray, scene, sampler, arena, false);
+}
+
+// Path vertices whose incident radiance is recorded in the SD-tree: the
+// radiance found along _wi_ is _radiance_ divided by _throughput_, the
+// path throughput up to and including the vertex's scattering.
+struct GuidingVertex {
+    DTreeWrapper *dTree;
+    Vector3f wi;
+    Spectrum throughput, radiance;
+    Float pdf;
+};
+
+static PBRT_CONSTEXPR int MaxGuidingVertices = 32;
+
+Spectrum GuidedPathIntegrator::LiGuided(const RayDifferential &r,
+                                        const Scene &scene, Sampler &sampler,
+                                        MemoryArena &arena, bool train) const {
+    ProfilePhase p(Prof::SamplerIntegratorLi);
+    Spectrum L(0.f), beta(1.f);
+    RayDifferential ray(r);
+    bool specularBounce = false;
+    Float etaScale = 1;
+    GuidingVertex vertices[MaxGuidingVertices];
+    int nVertices = 0;
+    // Adds a contribution to the path's radiance and, when training, to the
+    // radiance that arrives at the recorded vertices
+    auto addRadiance = [&](const Spectrum &c) {
+        L += c;
+        if (train)
+            for (int i = 0; i < nVertices; ++i) vertices[i].radiance += c;
+    };
+
+    for (int bounces = 0;; ++bounces) {
+        // Intersect _ray_ with scene and store intersection in _isect_
+        SurfaceInteraction isect;
+        bool foundIntersection = scene.Intersect(ray, &isect);
+
+        // Possibly add emitted light at intersection
+        if (bounces == 0 || specularBounce) {
+            if (foundIntersection)
+                addRadiance(beta * isect.Le(-ray.d));
+            else
+                for (const auto &light : scene.infiniteLights)
+                    addRadiance(beta * light->Le(ray));
+        }
+
+        // Terminate path if ray escaped or _maxDepth_ was reached
+        if (!foundIntersection || bounces >= maxDepth) break;
+
+        // Compute scattering functions and skip over medium boundaries
+        isect.ComputeScatteringFunctions(ray, arena, true);
+        if (!isect.bsdf) {
+            ray = isect.SpawnRay(ray.d);
+            bounces--;
+            continue;
+        }
+        const BSDF &bsdf = *isect.bsdf;
+
+        // Sample illumination from lights to find path contribution.
+        // (But skip this for perfectly specular BSDFs.)
+        bool nonSpecular =
+            bsdf.NumComponents(BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) > 0;
+        if (nonSpecular)
+            addRadiance(beta * UniformSampleOneLight(isect, scene, arena,
+                                                     sampler, false,
+                                                     *lightDistribution));
+
+        // Sample the new path direction from the BSDF or the SD-tree
+        DTreeWrapper *dTree = nonSpecular ? sdTree->Lookup(isect.p) : nullptr;
+        Vector3f wo = -ray.d, wi;
+        Float pdf;
+        BxDFType flags;
+        Spectrum f;
+        if (!dTree || bsdfSamplingFraction == 1 ||
+            !(dTree->sampling.Total() > 0))
+            f = bsdf.Sample_f(wo, &wi, sampler.Get2D(), &pdf, BSDF_ALL,
+                              &flags);
+        else {
+            ++guidableVertices;
+            Float uStrategy = sampler.Get1D();
+            Point2f u = sampler.Get2D();
+            if (uStrategy < bsdfSamplingFraction) {
+                f = bsdf.Sample_f(wo, &wi, u, &pdf, BSDF_ALL, &flags);
+                // Only BSDF sampling generates specular directions
+                if (pdf > 0 && !(flags & BSDF_SPECULAR))
+                    pdf = bsdfSamplingFraction * pdf +
+                          (1 - bsdfSamplingFraction) * dTree->sampling.Pdf(wi);
+                else
+                    pdf *= bsdfSamplingFraction;
+            } else {
+                ++guidedDirections;
+                Float guidePdf;
+                wi = dTree->sampling.Sample(u, &guidePdf);
+                f = bsdf.f(wo, wi);
+                pdf = bsdfSamplingFraction * bsdf.Pdf(wo, wi) +
+                      (1 - bsdfSamplingFraction) * guidePdf;
+                flags = Dot(wo, isect.n) * Dot(wi, isect.n) > 0
+                            ? BSDF_REFLECTION
+                            : BSDF_TRANSMISSION;
+            }
+        }
+        if (f.IsBlack() || pdf == 0.f) break;
+        beta *= f * AbsDot(wi, isect.shading.n) / pdf;
+        DCHECK(!std::isinf(beta.y()));
+        specularBounce = (flags & BSDF_SPECULAR) != 0;
+        if ((flags & BSDF_SPECULAR) && (flags & BSDF_TRANSMISSION)) {
+            Float eta = bsdf.eta;
+            etaScale *= (Dot(wo, isect.n) > 0) ? (eta * eta) : 1 / (eta * eta);
+        }
+        ray = isect.SpawnRay(wi);
+
+        if (isect.bssrdf && (flags & BSDF_TRANSMISSION)) {
+            // Importance sample the BSSRDF; the path continues from another
+            // point, so this vertex isn't recorded
+            SurfaceInteraction pi;
+            Spectrum S = isect.bssrdf->Sample_S(
+                scene, sampler.Get1D(), sampler.Get2D(), arena, &pi, &pdf);
+            if (S.IsBlack() || pdf == 0) break;
+            beta *= S / pdf;
+            addRadiance(beta * UniformSampleOneLight(pi, scene, arena, sampler,
+                                                     false,
+                                                     *lightDistribution));
+            Spectrum f = pi.bsdf->Sample_f(pi.wo, &wi, sampler.Get2D(), &pdf,
+                                           BSDF_ALL, &flags);
+            if (f.IsBlack() || pdf == 0) break;
+            beta *= f * AbsDot(wi, pi.shading.n) / pdf;
+            specularBounce = (flags & BSDF_SPECULAR) != 0;
+            ray = pi.SpawnRay(wi);
+        } else if (train && dTree && !specularBounce &&
+                   nVertices < MaxGuidingVertices)
+            vertices[nVertices++] = {dTree, wi, beta, Spectrum(0.f), pdf};
+
+        // Possibly terminate the path with Russian roulette
+        Spectrum rrBeta = beta * etaScale;
+        if (rrBeta.MaxComponentValue() < rrThreshold && bounces > 3) {
+            Float q = std::max((Float).05, 1 - rrBeta.MaxComponentValue());
+            if (sampler.Get1D() < q) break;
+            beta /= 1 - q;
+        }
+    }
+
+    // Record the radiance that arrived at the path's vertices, divided by
+    // the pdf of its direction, so that the sums in the SD-tree's cells
+    // estimate the cells' incident radiance
+    for (int i = 0; i < nVertices; ++i) {
+        const GuidingVertex &v = vertices[i];
+        Float radiance = 0;
+        for (int c = 0; c < Spectrum::nSamples; ++c)
+            if (v.throughput[c] > 0) radiance += v.radiance[c] / v.throughput[c];
+        v.dTree->Record(v.wi, radiance / (Spectrum::nSamples * v.pdf));
+    }
+    return L;
+}
+
+GuidedPathIntegrator *CreateGuidedPathIntegrator(
+    const ParamSet &params, std::shared_ptr<Sampler> sampler,
+    std::shared_ptr<const Camera> camera) {
+    int maxDepth = params.FindOneInt("maxdepth", 5);
+    int np;
+    const int *pb = params.FindInt("pixelbounds", &np);
+    Bounds2i pixelBounds = camera->film->GetSampleBounds();
+    if (pb) {
+        if (np != 4)
+            Error("Expected four values for \"pixelbounds\" parameter. Got %d.",
+                  np);
+        else {
+            pixelBounds = Intersect(pixelBounds,
+                                    Bounds2i{{pb[0], pb[2]}, {pb[1], pb[3]}});
+            if (pixelBounds.Area() == 0)
+                Error("Degenerate \"pixelbounds\" specified.");
+        }
+    }
+    Float rrThreshold = params.FindOneFloat("rrthreshold", 1.);
+    std::string lightStrategy =
+        params.FindOneString("lightsamplestrategy", "spatial");
+    int trainingPasses = params.FindOneInt("trainingpasses", 6);
+    if (trainingPasses < 0 || trainingPasses > 16) {
+        Warning("\"trainingpasses\" must be between 0 and 16. Clamping.");
+        trainingPasses = Clamp(trainingPasses, 0, 16);
+    }
+    // Some BSDF sampling is needed to find specular directions
+    Float bsdfSamplingFraction = params.FindOneFloat("bsdfsamplingfraction", .5);
+    if (bsdfSamplingFraction <= 0 || bsdfSamplingFraction > 1) {
+        Warning("\"bsdfsamplingfraction\" must be in (0,1]. Clamping.");
+        bsdfSamplingFraction = Clamp(bsdfSamplingFraction, .01f, 1);
+    }
+    Float spatialThreshold =
+        std::max<Float>(1, params.FindOneFloat("spatialthreshold", 1000));
+    Float directionalThreshold =
+        params.FindOneFloat("directionalthreshold", .01f);
+    return new GuidedPathIntegrator(maxDepth, camera, sampler, pixelBounds,
+                                    rrThreshold, lightStrategy, trainingPasses,
+                                    bsdfSamplingFraction, spatialThreshold,
+                                    directionalThreshold);
+}
+
+}  // namespace pbrt
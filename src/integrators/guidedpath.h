@@ -0,0 +1,182 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_INTEGRATORS_GUIDEDPATH_H
+#define PBRT_INTEGRATORS_GUIDEDPATH_H
+
+// integrators/guidedpath.h*
+#include "pbrt.h"
+#include "integrator.h"
+#include "lightdistrib.h"
+#include "parallel.h"
+
+namespace pbrt {
+
+// DTree represents the distribution of incident radiance over the sphere
+// of directions at a region of space. Directions are mapped to the unit
+// square with the area-preserving cylindrical mapping and a quadtree over
+// the square stores the radiance arriving in each of its cells. Record()
+// may be called concurrently from multiple threads.
+class DTree {
+  public:
+    // DTree Public Methods
+    DTree();
+    void Record(const Vector3f &w, Float radiance);
+    // Sums up the radiance recorded in the leaves so that the tree can be
+    // sampled.
+    void Build();
+    // Returns an empty tree with cells subdivided where this one's cells
+    // hold more than _threshold_ of the total radiance.
+    DTree Refined(Float threshold, int maxDepth) const;
+    Float Total() const;
+    Vector3f Sample(const Point2f &u, Float *pdf) const;
+    Float Pdf(const Vector3f &w) const;
+    size_t Bytes() const { return sizeof(*this) + nodes.size() * sizeof(Node); }
+
+  private:
+    // DTree Private Data
+    // Quadrants are indexed by _x + 2 * y_; children are always after
+    // their parent in _nodes_ and an index of zero denotes a leaf.
+    struct Node {
+        Node() {
+            for (int i = 0; i < 4; ++i) child[i] = 0;
+        }
+        Node(const Node &n) { *this = n; }
+        Node &operator=(const Node &n) {
+            for (int i = 0; i < 4; ++i) {
+                sum[i] = Float(n.sum[i]);
+                child[i] = n.child[i];
+            }
+            return *this;
+        }
+        AtomicFloat sum[4];
+        int child[4];
+    };
+    std::vector<Node> nodes;
+};
+
+// DTreeWrapper holds the directional distributions for a leaf of the
+// spatial tree: _sampling_ was learned in the previous training pass and
+// is used for sampling while _building_ records the current pass's
+// radiance.
+struct DTreeWrapper {
+    DTreeWrapper() = default;
+    DTreeWrapper(const DTreeWrapper &w)
+        : sampling(w.sampling), building(w.building), weight(Float(w.weight)) {}
+    void Record(const Vector3f &w, Float radiance) {
+        if (radiance > 0) building.Record(w, radiance);
+        weight.Add(1);
+    }
+    DTree sampling, building;
+    // Number of radiance records in _building_
+    AtomicFloat weight;
+};
+
+// STree is a binary tree that subdivides the scene bounds at the midpoint
+// of one axis per level, cycling through them. Each of its leaves has a
+// DTreeWrapper.
+class STree {
+  public:
+    // STree Public Methods
+    STree(const Bounds3f &bounds);
+    DTreeWrapper *Lookup(const Point3f &p) const;
+    // Splits leaves where more than _splitThreshold_ radiance records were
+    // made in the last pass.
+    void Refine(Float splitThreshold);
+    // Makes the radiance recorded in the last pass available for sampling
+    // and starts recording with refined directional trees.
+    void BuildDTrees(Float threshold, int maxDepth);
+    int LeafCount() const;
+    size_t Bytes() const;
+
+  private:
+    // STree Private Data
+    struct Node {
+        int axis;
+        int child[2];
+        std::unique_ptr<DTreeWrapper> dTree;
+    };
+    Bounds3f bounds;
+    std::vector<Node> nodes;
+};
+
+// GuidedPathIntegrator is a path tracer that learns the distribution of
+// indirect incident radiance in the scene with a spatial-directional tree
+// (Muller et al., "Practical Path Guiding for Efficient Light-Transport
+// Simulation") over progressively longer training passes before
+// rendering. Path directions are chosen from a one-sample mixture of BSDF
+// sampling and the learned distribution.
+class GuidedPathIntegrator : public SamplerIntegrator {
+  public:
+    // GuidedPathIntegrator Public Methods
+    GuidedPathIntegrator(int maxDepth, std::shared_ptr<const Camera> camera,
+                         std::shared_ptr<Sampler> sampler,
+                         const Bounds2i &pixelBounds, Float rrThreshold,
+                         const std::string &lightSampleStrategy,
+                         int trainingPasses, Float bsdfSamplingFraction,
+                         Float spatialThreshold, Float directionalThreshold);
+
+    void Preprocess(const Scene &scene, Sampler &sampler);
+    Spectrum Li(const RayDifferential &ray, const Scene &scene,
+                Sampler &sampler, MemoryArena &arena, int depth) const;
+
+  private:
+    // GuidedPathIntegrator Private Methods
+    Spectrum LiGuided(const RayDifferential &ray, const Scene &scene,
+                      Sampler &sampler, MemoryArena &arena, bool train) const;
+    void TrainingPass(const Scene &scene, int spp, int pass,
+                      ProgressReporter &reporter);
+
+    // GuidedPathIntegrator Private Data
+    const int maxDepth;
+    const Float rrThreshold;
+    const std::string lightSampleStrategy;
+    const Bounds2i trainingBounds;
+    const int trainingPasses;
+    const Float bsdfSamplingFraction;
+    const Float spatialThreshold, directionalThreshold;
+    std::unique_ptr<LightDistribution> lightDistribution;
+    std::unique_ptr<STree> sdTree;
+};
+
+GuidedPathIntegrator *CreateGuidedPathIntegrator(
+    const ParamSet &params, std::shared_ptr<Sampler> sampler,
+    std::shared_ptr<const Camera> camera);
+
+}  // namespace pbrt
+
+#endif  // PBRT_INTEGRATORS_GUIDEDPATH_H
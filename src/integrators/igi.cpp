@@ -0,0 +1,467 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+// integrators/igi.cpp*
+#include "integrators/igi.h"
+#include "camera.h"
+#include "film.h"
+#include "interaction.h"
+#include "paramset.h"
+#include "parallel.h"
+#include "progressreporter.h"
+#include "reflection.h"
+#include "rng.h"
+#include "samplers/halton.h"
+#include "scene.h"
+#include "stats.h"
+#include <queue>
+
+namespace pbrt {
+
+STAT_COUNTER("Integrator/Virtual point lights", nVirtualLights);
+STAT_INT_DISTRIBUTION("Integrator/Virtual lights used per lookup",
+                      lightsPerLookup);
+STAT_MEMORY_COUNTER("Memory/Virtual point lights", virtualLightBytes);
+
+// IGI Local Definitions
+static Spectrum BoundBSDF(const SurfaceInteraction &isect, const Normal3f &n,
+                          bool twoSided) {
+    // Evaluate the BSDF along the normal and the mirror direction; this is
+    // exact for diffuse surfaces and a reasonable estimate for glossy ones
+    const Vector3f &wo = isect.wo;
+    Spectrum f = isect.bsdf->f(wo, Vector3f(n));
+    Spectrum fr = isect.bsdf->f(wo, Reflect(wo, Vector3f(n)));
+    if (fr.y() > f.y()) f = fr;
+    if (twoSided) {
+        Spectrum ft = isect.bsdf->f(wo, -Vector3f(n));
+        if (ft.y() > f.y()) f = ft;
+    }
+    return f;
+}
+
+static bool IsTwoSided(const BSDF &bsdf) {
+    return bsdf.NumComponents(BxDFType(BSDF_TRANSMISSION | BSDF_DIFFUSE |
+                                       BSDF_GLOSSY)) > 0;
+}
+
+// Returns an upper bound on the cosine of the angle between a direction in
+// the cone around _axis_ and any direction _d_ + _r_, where _r_ is shorter
+// than _radius_.
+static Float BoundCosine(const Vector3f &axis, Float cosTheta,
+                         const Vector3f &d, Float radius) {
+    Float dist = d.Length();
+    if (cosTheta <= -1 || dist <= radius) return 1;
+    // Find the cosine of the sum of the cone's angle and the angle that the
+    // sphere subtends, $\theta + \alpha$
+    Float sinTheta = SafeSqrt(1 - cosTheta * cosTheta);
+    Float sinAlpha = radius / dist, cosAlpha = SafeSqrt(1 - sinAlpha * sinAlpha);
+    Float cosSum = cosTheta * cosAlpha - sinTheta * sinAlpha;
+    Float sinSum = sinTheta * cosAlpha + cosTheta * sinAlpha;
+    // The bound is one if _d_ is within $\theta + \alpha$ of the axis
+    Float cosAngle = Dot(axis, d) / dist;
+    if (sinSum < 0 || cosAngle >= cosSum) return 1;
+    Float sinAngle = SafeSqrt(1 - cosAngle * cosAngle);
+    return std::max((Float)0, cosAngle * cosSum + sinAngle * sinSum);
+}
+
+// IGIIntegrator Method Definitions
+IGIIntegrator::IGIIntegrator(std::shared_ptr<const Camera> camera,
+                             std::shared_ptr<Sampler> sampler,
+                             const Bounds2i &pixelBounds, int maxDepth,
+                             int maxSpecularDepth, int nLightPaths,
+                             int nLightSets, Float gLimit, int nGatherSamples,
+                             bool lightcuts, Float lightcutError,
+                             int maxCutSize,
+                             const std::string &lightSampleStrategy)
+    : SamplerIntegrator(camera, sampler, pixelBounds),
+      maxDepth(maxDepth),
+      maxSpecularDepth(maxSpecularDepth),
+      nLightPaths(nLightPaths),
+      nLightSets(nLightSets),
+      gLimit(gLimit),
+      nGatherSamples(nGatherSamples),
+      lightcuts(lightcuts),
+      lightcutError(lightcutError),
+      maxCutSize(maxCutSize),
+      lightSampleStrategy(lightSampleStrategy) {}
+
+void IGIIntegrator::Preprocess(const Scene &scene, Sampler &sampler) {
+    lightDistribution =
+        CreateLightSampleDistribution(lightSampleStrategy, scene);
+    virtualLights.resize(nLightSets);
+    lightcutTrees.resize(nLightSets);
+    if (scene.lights.empty() || maxDepth < 2) return;
+
+    // Compute the light sampling distribution for light subpaths and the
+    // mapping from lights to their offsets in it
+    std::unique_ptr<Distribution1D> lightDistr =
+        ComputeLightPowerDistribution(scene);
+    std::unordered_map<const Light *, size_t> lightToIndex;
+    for (size_t i = 0; i < scene.lights.size(); ++i)
+        lightToIndex[scene.lights[i].get()] = i;
+
+    // Follow light subpaths in parallel and record their vertices; the
+    // subpaths' samples are taken from a Halton sequence so that the
+    // virtual lights are the same every time the scene is rendered
+    const int nPaths = nLightPaths * nLightSets;
+    const int chunkSize = 64;
+    const int nChunks = (nPaths + chunkSize - 1) / chunkSize;
+    HaltonSampler pathSampler(nPaths, Bounds2i(Point2i(0, 0), Point2i(1, 1)));
+    virtualLightArenas.resize(nChunks);
+    std::vector<std::vector<VirtualLight>> chunkLights(nChunks);
+    std::vector<std::vector<int>> chunkSets(nChunks);
+    ProgressReporter reporter(nChunks, "Virtual lights");
+    ParallelFor([&](int64_t chunk) {
+        // The light subpaths' BSDFs must outlive preprocessing, so each
+        // chunk gets its own arena
+        virtualLightArenas[chunk].reset(new MemoryArena);
+        MemoryArena &arena = *virtualLightArenas[chunk];
+        std::unique_ptr<Sampler> chunkSampler = pathSampler.Clone(chunk);
+        chunkSampler->StartPixel(Point2i(0, 0));
+        Vertex *path = arena.Alloc<Vertex>(maxDepth + 1);
+        int pathEnd = std::min(nPaths, int(chunk + 1) * chunkSize);
+        for (int i = chunk * chunkSize; i < pathEnd; ++i) {
+            chunkSampler->SetSampleNumber(i);
+            int nVertices = GenerateLightSubpath(
+                scene, *chunkSampler, arena, maxDepth, camera->shutterOpen,
+                *lightDistr, lightToIndex, path);
+            // Leave a virtual light at each nonspecular surface vertex;
+            // the vertex on the light is accounted for by direct lighting
+            for (int j = 1; j < nVertices; ++j) {
+                const Vertex &v = path[j];
+                if (v.type != VertexType::Surface || !v.IsConnectible() ||
+                    v.beta.IsBlack())
+                    continue;
+                VirtualLight vl;
+                vl.vertex = v;
+                vl.n = Faceforward(v.ns(), v.si.wo);
+                vl.twoSided = IsTwoSided(*v.si.bsdf);
+                vl.I = v.beta * BoundBSDF(v.si, vl.n, vl.twoSided);
+                chunkLights[chunk].push_back(vl);
+                chunkSets[chunk].push_back(i / nLightPaths);
+            }
+        }
+        reporter.Update();
+    }, nChunks);
+    reporter.Done();
+
+    // Distribute the virtual lights to their sets and build the sets'
+    // lightcut trees
+    for (int chunk = 0; chunk < nChunks; ++chunk)
+        for (size_t i = 0; i < chunkLights[chunk].size(); ++i)
+            virtualLights[chunkSets[chunk][i]].push_back(
+                chunkLights[chunk][i]);
+    for (int set = 0; set < nLightSets; ++set) {
+        nVirtualLights += virtualLights[set].size();
+        virtualLightBytes += virtualLights[set].size() * sizeof(VirtualLight);
+        if (lightcuts && !virtualLights[set].empty()) {
+            RNG rng(set);
+            BuildLightcutTree(virtualLights[set], 0, virtualLights[set].size(),
+                              rng, &lightcutTrees[set]);
+            virtualLightBytes +=
+                lightcutTrees[set].size() * sizeof(LightcutNode);
+        }
+    }
+    for (const auto &arena : virtualLightArenas)
+        virtualLightBytes += arena->TotalAllocated();
+}
+
+int IGIIntegrator::BuildLightcutTree(std::vector<VirtualLight> &lights,
+                                     int start, int end, RNG &rng,
+                                     std::vector<LightcutNode> *nodes) const {
+    int nodeIndex = nodes->size();
+    nodes->push_back(LightcutNode());
+
+    // Compute the bounds, normal cone and intensity of the lights
+    Bounds3f bounds;
+    Vector3f nSum(0, 0, 0);
+    bool twoSided = false;
+    Spectrum I(0.f);
+    for (int i = start; i < end; ++i) {
+        bounds = Union(bounds, lights[i].vertex.p());
+        nSum += Vector3f(lights[i].n);
+        twoSided |= lights[i].twoSided;
+        I += lights[i].I;
+    }
+    Vector3f axis(0, 0, 1);
+    Float cosTheta = -1;
+    if (!twoSided && nSum.LengthSquared() > 0) {
+        axis = Normalize(nSum);
+        cosTheta = 1;
+        for (int i = start; i < end; ++i)
+            cosTheta = std::min(cosTheta, Dot(axis, lights[i].n));
+    }
+
+    int representative = start, secondChild = -1;
+    if (end - start > 1) {
+        // Split the lights at the median along the bounds' largest extent
+        int dim = bounds.MaximumExtent();
+        int mid = (start + end) / 2;
+        std::nth_element(&lights[start], &lights[mid], &lights[end - 1] + 1,
+                         [dim](const VirtualLight &a, const VirtualLight &b) {
+                             return a.vertex.p()[dim] < b.vertex.p()[dim];
+                         });
+        BuildLightcutTree(lights, start, mid, rng, nodes);
+        secondChild = BuildLightcutTree(lights, mid, end, rng, nodes);
+
+        // Choose one of the children's representatives with probability
+        // proportional to their intensity
+        const LightcutNode &c0 = (*nodes)[nodeIndex + 1];
+        const LightcutNode &c1 = (*nodes)[secondChild];
+        Float I0 = c0.I.y(), I1 = c1.I.y();
+        Float p0 = (I0 + I1 > 0) ? I0 / (I0 + I1) : .5f;
+        representative =
+            rng.UniformFloat() < p0 ? c0.representative : c1.representative;
+    }
+    LightcutNode &node = (*nodes)[nodeIndex];
+    node.bounds = bounds;
+    node.axis = axis;
+    node.cosTheta = cosTheta;
+    node.I = I;
+    node.representative = representative;
+    node.secondChild = secondChild;
+    return nodeIndex;
+}
+
+Spectrum IGIIntegrator::Li(const RayDifferential &ray, const Scene &scene,
+                           Sampler &sampler, MemoryArena &arena,
+                           int depth) const {
+    ProfilePhase p(Prof::SamplerIntegratorLi);
+    Spectrum L(0.);
+    SurfaceInteraction isect;
+    if (!scene.Intersect(ray, &isect)) {
+        for (const auto &light : scene.infiniteLights) L += light->Le(ray);
+        return L;
+    }
+    isect.ComputeScatteringFunctions(ray, arena);
+    if (!isect.bsdf)
+        return Li(isect.SpawnRay(ray.d), scene, sampler, arena, depth);
+    L += isect.Le(isect.wo);
+
+    // Add direct lighting and indirect lighting from the virtual lights
+    if (isect.bsdf->NumComponents(BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) > 0) {
+        int set = std::min(int(sampler.Get1D() * nLightSets), nLightSets - 1);
+        L += UniformSampleOneLight(isect, scene, arena, sampler, false,
+                                   *lightDistribution);
+        L += VirtualLightLo(isect, scene, set);
+        if (nGatherSamples > 0)
+            L += GatherLo(isect, scene, sampler, arena, set);
+    }
+    if (depth + 1 < maxSpecularDepth) {
+        // Trace rays for specular reflection and refraction
+        L += SpecularReflect(ray, isect, scene, sampler, arena, depth);
+        L += SpecularTransmit(ray, isect, scene, sampler, arena, depth);
+    }
+    return L;
+}
+
+Spectrum IGIIntegrator::VirtualLightLo(const SurfaceInteraction &isect,
+                                       const Scene &scene, int set) const {
+    if (virtualLights[set].empty()) return 0.f;
+    Vertex v(isect, Spectrum(1.f));
+    if (lightcuts) return LightcutLo(v, scene, set);
+    Spectrum L(0.f);
+    for (const VirtualLight &vl : virtualLights[set])
+        L += VirtualLightContribution(v, vl, scene);
+    ReportValue(lightsPerLookup, virtualLights[set].size());
+    return L;
+}
+
+Spectrum IGIIntegrator::VirtualLightContribution(const Vertex &v,
+                                                 const VirtualLight &vl,
+                                                 const Scene &scene) const {
+    const Vertex &vv = vl.vertex;
+    Vector3f d = vv.p() - v.p();
+    Float dist2 = d.LengthSquared();
+    if (dist2 == 0) return 0.f;
+    Vector3f wi = d / std::sqrt(dist2);
+    // Clamp the geometric term, which is unbounded near the virtual light
+    Float G =
+        std::min(AbsDot(v.ns(), wi) * AbsDot(vv.ns(), wi) / dist2, gLimit);
+    Spectrum f =
+        v.f(vv, TransportMode::Radiance) * vv.f(v, TransportMode::Importance);
+    if (f.IsBlack() || G == 0) return 0.f;
+    if (!VisibilityTester(v.GetInteraction(), vv.GetInteraction())
+             .Unoccluded(scene))
+        return 0.f;
+    return f * G * vv.beta / nLightPaths;
+}
+
+Spectrum IGIIntegrator::LightcutLo(const Vertex &v, const Scene &scene,
+                                   int set) const {
+    const std::vector<LightcutNode> &nodes = lightcutTrees[set];
+    const std::vector<VirtualLight> &lights = virtualLights[set];
+    const SurfaceInteraction &isect = v.si;
+    Normal3f n = Faceforward(isect.shading.n, isect.wo);
+    bool twoSided = IsTwoSided(*isect.bsdf);
+    Float fBound = BoundBSDF(isect, n, twoSided).y();
+
+    // Bound the contribution of a cluster by bounding each of the factors
+    // of its lights' contributions
+    auto errorBound = [&](const LightcutNode &node) {
+        Point3f center;
+        Float radius;
+        node.bounds.BoundingSphere(&center, &radius);
+        Float cosReceiver =
+            twoSided ? 1 : BoundCosine(Vector3f(n), 1, center - v.p(), radius);
+        Float cosLight =
+            BoundCosine(node.axis, node.cosTheta, v.p() - center, radius);
+        Float dist2 = DistanceSquared(v.p(), node.bounds);
+        Float G = dist2 > 0 ? std::min(cosReceiver * cosLight / dist2, gLimit)
+                            : gLimit;
+        return fBound * G * node.I.y() / nLightPaths;
+    };
+    // Scale the representative's contribution to the whole cluster; a
+    // leaf's contribution is exact even if its intensity bound is zero
+    auto estimate = [&](const LightcutNode &node,
+                        const Spectrum &contrib) -> Spectrum {
+        if (node.secondChild == -1) return contrib;
+        Float Irep = lights[node.representative].I.y();
+        return Irep > 0 ? contrib * (node.I.y() / Irep) : Spectrum(0.f);
+    };
+
+    // Refine the cut, starting from the root, until the largest error
+    // bound is small relative to the total. With a zero error threshold
+    // the cut is refined down to the individual lights, since the bounds
+    // are only estimates for glossy surfaces.
+    struct CutNode {
+        int node;
+        Float error;
+        Spectrum L, contrib;
+        bool operator<(const CutNode &c) const { return error < c.error; }
+    };
+    std::priority_queue<CutNode> cut;
+    Spectrum contrib =
+        VirtualLightContribution(v, lights[nodes[0].representative], scene);
+    Spectrum L = estimate(nodes[0], contrib);
+    if (nodes[0].secondChild != -1)
+        cut.push({0, errorBound(nodes[0]), L, contrib});
+    int cutSize = 1;
+    while (!cut.empty() && cutSize < maxCutSize) {
+        CutNode c = cut.top();
+        if (lightcutError > 0 && c.error <= lightcutError * L.y()) break;
+        cut.pop();
+        L = L - c.L;
+        const LightcutNode &node = nodes[c.node];
+        for (int child : {c.node + 1, node.secondChild}) {
+            // One child shares its parent's representative and so needs no
+            // new shadow ray
+            const LightcutNode &childNode = nodes[child];
+            Spectrum childContrib =
+                childNode.representative == node.representative
+                    ? c.contrib
+                    : VirtualLightContribution(
+                          v, lights[childNode.representative], scene);
+            Spectrum childL = estimate(childNode, childContrib);
+            L += childL;
+            if (childNode.secondChild != -1)
+                cut.push({child, errorBound(childNode), childL, childContrib});
+        }
+        ++cutSize;
+    }
+    ReportValue(lightsPerLookup, cutSize);
+    return L.Clamp();
+}
+
+Spectrum IGIIntegrator::GatherLo(const SurfaceInteraction &isect,
+                                 const Scene &scene, Sampler &sampler,
+                                 MemoryArena &arena, int set) const {
+    // Recover the light lost to clamping the geometric term by sampling
+    // the BSDF and adding the reflected light from nearby points with the
+    // fraction of their geometric term that was clamped
+    Spectrum L(0.f);
+    for (int i = 0; i < nGatherSamples; ++i) {
+        Vector3f wi;
+        Float pdf;
+        Spectrum f =
+            isect.bsdf->Sample_f(isect.wo, &wi, sampler.Get2D(), &pdf,
+                                 BxDFType(BSDF_ALL & ~BSDF_SPECULAR));
+        if (f.IsBlack() || pdf == 0) continue;
+        RayDifferential ray = isect.SpawnRay(wi);
+        SurfaceInteraction gatherIsect;
+        if (!scene.Intersect(ray, &gatherIsect)) continue;
+        Float G = AbsDot(wi, isect.shading.n) *
+                  AbsDot(wi, gatherIsect.shading.n) /
+                  DistanceSquared(isect.p, gatherIsect.p);
+        if (G <= gLimit) continue;
+        gatherIsect.ComputeScatteringFunctions(ray, arena);
+        if (!gatherIsect.bsdf ||
+            gatherIsect.bsdf->NumComponents(
+                BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) == 0)
+            continue;
+        Spectrum Lo = UniformSampleOneLight(gatherIsect, scene, arena, sampler,
+                                            false, *lightDistribution) +
+                      VirtualLightLo(gatherIsect, scene, set);
+        L += f * Lo * AbsDot(wi, isect.shading.n) * (1 - gLimit / G) / pdf;
+    }
+    return L / nGatherSamples;
+}
+
+IGIIntegrator *CreateIGIIntegrator(const ParamSet &params,
+                                   std::shared_ptr<Sampler> sampler,
+                                   std::shared_ptr<const Camera> camera) {
+    int np;
+    const int *pb = params.FindInt("pixelbounds", &np);
+    Bounds2i pixelBounds = camera->film->GetSampleBounds();
+    if (pb) {
+        if (np != 4)
+            Error("Expected four values for \"pixelbounds\" parameter. Got %d.",
+                  np);
+        else {
+            pixelBounds = Intersect(pixelBounds,
+                                    Bounds2i{{pb[0], pb[2]}, {pb[1], pb[3]}});
+            if (pixelBounds.Area() == 0)
+                Error("Degenerate \"pixelbounds\" specified.");
+        }
+    }
+    int maxDepth = params.FindOneInt("maxdepth", 5);
+    int maxSpecularDepth = params.FindOneInt("maxspeculardepth", 5);
+    int nLightPaths = std::max(1, params.FindOneInt("nlights", 64));
+    int nLightSets = std::max(1, params.FindOneInt("nsets", 4));
+    Float gLimit = params.FindOneFloat("glimit", 10.f);
+    if (gLimit <= 0) {
+        Warning("\"glimit\" must be positive. Using 10.");
+        gLimit = 10.f;
+    }
+    int nGatherSamples = params.FindOneInt("gathersamples", 16);
+    bool lightcuts = params.FindOneBool("lightcuts", true);
+    Float lightcutError = params.FindOneFloat("lightcuterror", .02f);
+    int maxCutSize = std::max(1, params.FindOneInt("maxcutsize", 1000));
+    std::string lightStrategy =
+        params.FindOneString("lightsamplestrategy", "spatial");
+    return new IGIIntegrator(camera, sampler, pixelBounds, maxDepth,
+                             maxSpecularDepth, nLightPaths, nLightSets, gLimit,
+                             nGatherSamples, lightcuts, lightcutError,
+                             maxCutSize, lightStrategy);
+}
+
+}  // namespace pbrt
@@ -0,0 +1,141 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_INTEGRATORS_IGI_H
+#define PBRT_INTEGRATORS_IGI_H
+
+// integrators/igi.h*
+#include "pbrt.h"
+#include "integrator.h"
+#include "integrators/bdpt.h"
+#include "lightdistrib.h"
+
+namespace pbrt {
+
+// VirtualLight Declarations
+struct VirtualLight {
+    // Vertex on a light subpath that indirectly lights the scene
+    Vertex vertex;
+    // Normal on the side of the surface that light leaves from
+    Normal3f n;
+    // Bound on the light's intensity, used for building lightcuts
+    Spectrum I;
+    bool twoSided;
+};
+
+// LightcutNode stores a cluster of virtual lights; its representative
+// light's contribution, scaled by the ratio of the cluster's intensity to
+// the representative's, estimates the contribution of the whole cluster.
+struct LightcutNode {
+    Bounds3f bounds;
+    // Cone that bounds the lights' normals
+    Vector3f axis;
+    Float cosTheta;
+    Spectrum I;
+    int representative;
+    // The first child immediately follows its parent; leaves have
+    // _secondChild_ set to -1
+    int secondChild;
+};
+
+// IGIIntegrator Declarations
+
+// IGIIntegrator implements instant global illumination (Keller, "Instant
+// Radiosity"; Wald et al., "Interactive Global Illumination"). Before
+// rendering, it follows light subpaths in the same way as the
+// BDPTIntegrator and leaves a virtual point light at each of their
+// nonspecular vertices. Indirect lighting is found by connecting camera
+// ray intersections to the virtual lights; the geometric term is clamped
+// at _gLimit_, which removes the bright splotches near the virtual
+// lights, and the energy lost is optionally recovered by tracing
+// _nGatherSamples_ rays where it is significant. The lights are split into
+// _nLightSets_ sets that are used by different pixel samples. When
+// _lightcuts_ is true, each set is organized in a tree of clusters and the
+// lights used at each point are chosen with lightcuts (Walter et al.,
+// "Lightcuts: A Scalable Approach to Illumination"), so that the cost
+// grows sublinearly with the number of lights. Because the virtual lights
+// are generated from a deterministic sample sequence, the result is free
+// of noise in indirect lighting from frame to frame.
+class IGIIntegrator : public SamplerIntegrator {
+  public:
+    // IGIIntegrator Public Methods
+    IGIIntegrator(std::shared_ptr<const Camera> camera,
+                  std::shared_ptr<Sampler> sampler,
+                  const Bounds2i &pixelBounds, int maxDepth,
+                  int maxSpecularDepth, int nLightPaths, int nLightSets,
+                  Float gLimit, int nGatherSamples, bool lightcuts,
+                  Float lightcutError, int maxCutSize,
+                  const std::string &lightSampleStrategy);
+    void Preprocess(const Scene &scene, Sampler &sampler);
+    Spectrum Li(const RayDifferential &ray, const Scene &scene,
+                Sampler &sampler, MemoryArena &arena, int depth) const;
+
+  private:
+    // IGIIntegrator Private Methods
+    Spectrum VirtualLightLo(const SurfaceInteraction &isect,
+                            const Scene &scene, int set) const;
+    Spectrum VirtualLightContribution(const Vertex &v, const VirtualLight &vl,
+                                      const Scene &scene) const;
+    Spectrum LightcutLo(const Vertex &v, const Scene &scene, int set) const;
+    Spectrum GatherLo(const SurfaceInteraction &isect, const Scene &scene,
+                      Sampler &sampler, MemoryArena &arena, int set) const;
+    int BuildLightcutTree(std::vector<VirtualLight> &lights, int start,
+                          int end, RNG &rng,
+                          std::vector<LightcutNode> *nodes) const;
+
+    // IGIIntegrator Private Data
+    const int maxDepth, maxSpecularDepth;
+    const int nLightPaths, nLightSets;
+    const Float gLimit;
+    const int nGatherSamples;
+    const bool lightcuts;
+    const Float lightcutError;
+    const int maxCutSize;
+    const std::string lightSampleStrategy;
+    std::unique_ptr<LightDistribution> lightDistribution;
+    std::vector<std::unique_ptr<MemoryArena>> virtualLightArenas;
+    std::vector<std::vector<VirtualLight>> virtualLights;
+    std::vector<std::vector<LightcutNode>> lightcutTrees;
+};
+
+IGIIntegrator *CreateIGIIntegrator(const ParamSet &params,
+                                   std::shared_ptr<Sampler> sampler,
+                                   std::shared_ptr<const Camera> camera);
+
+}  // namespace pbrt
+
+#endif  // PBRT_INTEGRATORS_IGI_H
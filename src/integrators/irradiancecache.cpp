@@ -0,0 +1,567 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// integrators/irradiancecache.cpp*
+#include "integrators/irradiancecache.h"
+#include "camera.h"
+#include "film.h"
+#include "interaction.h"
+#include "paramset.h"
+#include "progressreporter.h"
+#include "reflection.h"
+#include "rng.h"
+#include "samplers/random.h"
+#include "sampling.h"
+#include "scene.h"
+#include "stats.h"
+#include <mutex>
+
+namespace pbrt {
+
+STAT_COUNTER("Integrator/Irradiance cache samples", nCacheSamples);
+STAT_PERCENT("Integrator/Irradiance cache misses", cacheMisses, cacheLookups);
+STAT_COUNTER("Integrator/Irradiance cache samples added while rendering",
+             nLazySamples);
+STAT_MEMORY_COUNTER("Memory/Irradiance cache", cacheBytes);
+
+// IrradianceSample Function Definitions
+IrradianceSample ComputeIrradianceSample(
+    const Point3f &p, const Normal3f &n, int nTheta, int nPhi, RNG &rng,
+    const std::function<Spectrum(const Vector3f &w, Float *dist)> &radiance) {
+    IrradianceSample sample;
+    sample.p = p;
+    sample.n = n;
+    Vector3f nz = Normalize(Vector3f(n)), s, t;
+    CoordinateSystem(nz, &s, &t);
+
+    // Find the radiance in each stratum; strata are uniform in $\sin^2
+    // \theta$ and $\phi$ so that they're equally weighted by the cosine
+    std::vector<Spectrum> L(nTheta * nPhi);
+    std::vector<Float> r(nTheta * nPhi);
+    Spectrum E(0.f), rotGrad[3];
+    Vector3f wSum(0, 0, 0);
+    Float invDistSum = 0;
+    for (int j = 0; j < nTheta; ++j)
+        for (int k = 0; k < nPhi; ++k) {
+            Float sin2Theta =
+                std::min((j + rng.UniformFloat()) / nTheta, OneMinusEpsilon);
+            Float cosTheta = SafeSqrt(1 - sin2Theta);
+            Float sinTheta = SafeSqrt(sin2Theta);
+            Float phi = 2 * Pi * (k + rng.UniformFloat()) / nPhi;
+            Vector3f u = std::cos(phi) * s + std::sin(phi) * t;
+            Vector3f w = sinTheta * u + cosTheta * nz;
+            int index = j * nPhi + k;
+            L[index] = radiance(w, &r[index]);
+            E += L[index];
+            wSum += L[index].y() * w;
+            invDistSum += 1 / r[index];
+            // The rotational gradient is the integral of $L (n \times
+            // \omega)$ over the hemisphere; following Ward and Heckbert,
+            // $\tan \theta$ is taken at the stratum's center to keep its
+            // variance bounded near the horizon
+            Float sin2ThetaCenter = (j + .5f) / nTheta;
+            Float tanThetaCenter =
+                std::sqrt(sin2ThetaCenter / (1 - sin2ThetaCenter));
+            Vector3f v = tanThetaCenter * Cross(nz, u);
+            for (int a = 0; a < 3; ++a) rotGrad[a] += v[a] * L[index];
+        }
+    Float scale = Pi / (nTheta * nPhi);
+    sample.E = E * scale;
+    for (int a = 0; a < 3; ++a) sample.rotGrad[a] = rotGrad[a] * scale;
+    sample.wAvg = wSum.LengthSquared() > 0 ? Normalize(wSum) : nz;
+    sample.maxDist = invDistSum > 0 ? nTheta * nPhi / invDistSum : Infinity;
+
+    // Compute the translational gradient from the changes in radiance
+    // across the strata's boundaries, assuming that they're due to the
+    // edges of the closer surface
+    Spectrum transGrad[3];
+    for (int k = 0; k < nPhi; ++k) {
+        Float phi = 2 * Pi * (k + .5f) / nPhi, phiMinus = 2 * Pi * k / nPhi;
+        Vector3f u = std::cos(phi) * s + std::sin(phi) * t;
+        Vector3f vMinus = -std::sin(phiMinus) * s + std::cos(phiMinus) * t;
+        int kPrev = (k + nPhi - 1) % nPhi;
+        Spectrum uSum(0.f), vSum(0.f);
+        for (int j = 0; j < nTheta; ++j) {
+            Float sin2ThetaMinus = Float(j) / nTheta;
+            Float cosThetaMinus = SafeSqrt(1 - sin2ThetaMinus);
+            Float cosThetaPlus = SafeSqrt(1 - Float(j + 1) / nTheta);
+            Float sinThetaCenter = SafeSqrt((j + .5f) / nTheta);
+            if (j > 0) {
+                Float rMin =
+                    std::min(r[j * nPhi + k], r[(j - 1) * nPhi + k]);
+                uSum += (std::sqrt(sin2ThetaMinus) * (1 - sin2ThetaMinus) /
+                         rMin) *
+                        (L[j * nPhi + k] - L[(j - 1) * nPhi + k]);
+            }
+            Float rMin = std::min(r[j * nPhi + k], r[j * nPhi + kPrev]);
+            vSum += ((cosThetaMinus - cosThetaPlus) / (sinThetaCenter * rMin)) *
+                    (L[j * nPhi + k] - L[j * nPhi + kPrev]);
+        }
+        for (int a = 0; a < 3; ++a)
+            transGrad[a] += (2 * Pi / nPhi * u[a]) * uSum + vMinus[a] * vSum;
+    }
+    for (int a = 0; a < 3; ++a) sample.transGrad[a] = transGrad[a];
+    return sample;
+}
+
+// IrradianceCache Method Definitions
+void IrradianceCache::Add(const std::vector<IrradianceSample> &newSamples) {
+    samples.insert(samples.end(), newSamples.begin(), newSamples.end());
+    if (samples.empty()) return;
+
+    // Choose a cell size that's larger than most samples' extent but that
+    // doesn't make the largest ones overlap too many cells
+    std::vector<Float> dists;
+    dists.reserve(samples.size());
+    for (const IrradianceSample &s : samples) dists.push_back(s.maxDist);
+    std::nth_element(dists.begin(), dists.begin() + dists.size() / 2,
+                     dists.end());
+    Float maxDist = *std::max_element(dists.begin(), dists.end());
+    cellSize = std::max(2 * dists[dists.size() / 2], maxDist / 8);
+
+    cells.clear();
+    for (size_t i = 0; i < samples.size(); ++i) AddToCells(int(i));
+}
+
+void IrradianceCache::Insert(IrradianceSample sample) {
+    // Limit the sample's extent as _Add()_ does when it chooses the cell
+    // size, or base the cell size on it if it's the first sample
+    if (cellSize == 0) cellSize = 2 * sample.maxDist;
+    sample.maxDist = std::min(sample.maxDist, 8 * cellSize);
+    samples.push_back(sample);
+    AddToCells(int(samples.size()) - 1);
+}
+
+void IrradianceCache::AddToCells(int index) {
+    // Add the sample to the cells its _maxDist_ sphere overlaps
+    const IrradianceSample &s = samples[index];
+    Vector3f r(s.maxDist, s.maxDist, s.maxDist);
+    Point3i c0(Floor((s.p - r) / cellSize));
+    Point3i c1(Floor((s.p + r) / cellSize));
+    for (int z = c0.z; z <= c1.z; ++z)
+        for (int y = c0.y; y <= c1.y; ++y)
+            for (int x = c0.x; x <= c1.x; ++x)
+                cells[CellKey(Point3i(x, y, z))].push_back(index);
+}
+
+bool IrradianceCache::Interpolate(const Point3f &p, const Normal3f &n,
+                                  Spectrum *E, Vector3f *wAvg,
+                                  bool extrapolate) const {
+    if (cells.empty()) return false;
+    auto cell = cells.find(CellKey(Point3i(Floor(p / cellSize))));
+    if (cell == cells.end()) return false;
+
+    Float sumWt = 0;
+    Spectrum sumE(0.f);
+    Vector3f sumW(0, 0, 0);
+    for (int i : cell->second) {
+        const IrradianceSample &s = samples[i];
+        // Compute the sample's weight from its distance and the difference
+        // in normals
+        Float cosAngle = Dot(n, s.n);
+        if (cosAngle < cosMaxAngleDifference) continue;
+        Vector3f d = p - s.p;
+        Float perr = d.Length() / s.maxDist;
+        Float nerr = std::sqrt((1 - cosAngle) / (1 - cosMaxAngleDifference));
+        Float err = std::max(perr, nerr);
+        if (err >= 1) continue;
+        // Skip samples in front of _p_, which see different surroundings
+        if (Dot(d, Vector3f(s.n + n)) < -.02f * s.maxDist) continue;
+
+        // Extrapolate the sample's irradiance to _p_ and _n_
+        Vector3f c = Cross(Vector3f(s.n), Vector3f(n));
+        Spectrum Ei = s.E;
+        for (int a = 0; a < 3; ++a)
+            Ei += c[a] * s.rotGrad[a] + d[a] * s.transGrad[a];
+        // The weight falls to zero at the sample's boundary so that
+        // interpolated values are continuous
+        Float wt = (1 - err) * (1 - err);
+        sumE += wt * Ei.Clamp();
+        sumW += wt * s.wAvg;
+        sumWt += wt;
+    }
+    if (sumWt == 0 || (!extrapolate && sumWt < minWeight)) return false;
+    *E = sumE / sumWt;
+    *wAvg = sumW.LengthSquared() > 0 ? Normalize(sumW) : Vector3f(n);
+    return true;
+}
+
+size_t IrradianceCache::Bytes() const {
+    size_t bytes = sizeof(*this) + samples.size() * sizeof(IrradianceSample);
+    for (const auto &cell : cells)
+        bytes += sizeof(cell) + cell.second.size() * sizeof(int);
+    return bytes;
+}
+
+uint64_t IrradianceCache::CellKey(const Point3i &c) const {
+    // Pack 21 bits of each coordinate
+    auto bits = [](int v) { return uint64_t(v + (1 << 20)) & ((1 << 21) - 1); };
+    return (bits(c.z) << 42) | (bits(c.y) << 21) | bits(c.x);
+}
+
+// IrradianceCacheIntegrator Method Definitions
+IrradianceCacheIntegrator::IrradianceCacheIntegrator(
+    std::shared_ptr<const Camera> camera, std::shared_ptr<Sampler> sampler,
+    const Bounds2i &pixelBounds, Float minWeight, Float minPixelSpacing,
+    Float maxPixelSpacing, Float maxAngleDifference, int maxSpecularDepth,
+    int maxIndirectDepth, int nSamples, int finalGatherSamples,
+    const std::string &lightSampleStrategy)
+    : SamplerIntegrator(camera, sampler, pixelBounds),
+      cacheBounds(pixelBounds),
+      minPixelSpacing(minPixelSpacing),
+      maxPixelSpacing(maxPixelSpacing),
+      maxSpecularDepth(maxSpecularDepth),
+      maxIndirectDepth(maxIndirectDepth),
+      nSamples(nSamples),
+      finalGatherSamples(finalGatherSamples),
+      lightSampleStrategy(lightSampleStrategy),
+      cache(new IrradianceCache(minWeight,
+                                std::cos(Radians(maxAngleDifference)))) {}
+
+void IrradianceCacheIntegrator::Preprocess(const Scene &scene,
+                                           Sampler &sampler) {
+    lightDistribution =
+        CreateLightSampleDistribution(lightSampleStrategy, scene);
+    Point3f sceneCenter;
+    scene.WorldBound().BoundingSphere(&sceneCenter, &sceneRadius);
+
+    // Find the pixel spacings of the passes that place samples
+    std::vector<int> strides;
+    for (int stride = 1; stride <= maxPixelSpacing; stride *= 2)
+        if (2 * stride > minPixelSpacing) strides.push_back(stride);
+    std::reverse(strides.begin(), strides.end());
+    Vector2i extent = cacheBounds.Diagonal();
+    int64_t nCandidates = 0;
+    for (int stride : strides)
+        nCandidates += int64_t((extent.x + stride - 1) / stride) *
+                       ((extent.y + stride - 1) / stride);
+    ProgressReporter reporter(nCandidates, "Irradiance cache");
+
+    for (size_t pass = 0; pass < strides.size(); ++pass) {
+        int stride = strides[pass];
+        Point2i nPoints((extent.x + stride - 1) / stride,
+                        (extent.y + stride - 1) / stride);
+        std::vector<IrradianceSample> newSamples;
+        std::mutex newSamplesMutex;
+        ThreadArenaPool arenas;
+        ParallelFor([&](int64_t y) {
+            MemoryArena &arena = arenas.Get();
+            int seed = int(pass * nPoints.y + y);
+            RNG rng(seed);
+            RandomSampler pathSampler(1, seed);
+            for (int x = 0; x < nPoints.x; ++x) {
+                Point2i pixel(cacheBounds.pMin.x + x * stride + stride / 2,
+                              cacheBounds.pMin.y + int(y) * stride + stride / 2);
+                if (!InsideExclusive(pixel, cacheBounds)) continue;
+                pathSampler.StartPixel(pixel);
+                CameraSample cameraSample;
+                cameraSample.pFilm = Point2f(pixel) + Vector2f(.5f, .5f);
+                cameraSample.pLens = Point2f(.5f, .5f);
+                cameraSample.time = .5f;
+                RayDifferential ray;
+                if (camera->GenerateRayDifferential(cameraSample, &ray) == 0)
+                    continue;
+                // The distance between pixels grows linearly along rays
+                // from the camera, starting at _footprint0_
+                Float footprint0 = 0, footprintSlope = 0;
+                if (ray.hasDifferentials) {
+                    footprint0 = Distance(ray.rxOrigin, ray.o);
+                    footprintSlope = (ray.rxDirection - ray.d).Length();
+                }
+
+                // Follow specular bounces to a surface with diffuse or glossy
+                // reflection and add a sample there if the cache doesn't
+                // cover it yet
+                Float t = 0;
+                for (int depth = 0; depth < maxSpecularDepth; ++depth) {
+                    SurfaceInteraction isect;
+                    if (!scene.Intersect(ray, &isect)) break;
+                    t += Distance(ray.o, isect.p);
+                    isect.ComputeScatteringFunctions(ray, arena);
+                    if (!isect.bsdf) {
+                        ray = isect.SpawnRay(ray.d);
+                        continue;
+                    }
+                    const BSDF &bsdf = *isect.bsdf;
+                    if (bsdf.NumComponents(BxDFType(BSDF_REFLECTION |
+                                                    BSDF_DIFFUSE |
+                                                    BSDF_GLOSSY)) > 0) {
+                        Normal3f n = Faceforward(isect.n, isect.wo);
+                        Spectrum E;
+                        Vector3f wAvg;
+                        if (cache->Interpolate(isect.p, n, &E, &wAvg)) break;
+                        IrradianceSample sample = ComputeSample(
+                            isect, n, footprint0 + t * footprintSlope, scene,
+                            rng, pathSampler, arena);
+                        std::lock_guard<std::mutex> lock(newSamplesMutex);
+                        newSamples.push_back(sample);
+                        break;
+                    }
+                    // Continue along perfect specular reflection or
+                    // transmission
+                    Vector3f wi;
+                    Float pdf;
+                    Spectrum f = bsdf.Sample_f(isect.wo, &wi, Point2f(.5f, .5f),
+                                               &pdf);
+                    if (f.IsBlack() || pdf == 0) break;
+                    ray = isect.SpawnRay(wi);
+                }
+                arena.Reset();
+            }
+            reporter.Update(nPoints.x);
+        }, nPoints.y);
+        cache->Add(newSamples);
+    }
+    reporter.Done();
+    nCacheSamples = cache->Size();
+    cacheBytes = cache->Bytes();
+}
+
+Spectrum IrradianceCacheIntegrator::Li(const RayDifferential &ray,
+                                       const Scene &scene, Sampler &sampler,
+                                       MemoryArena &arena, int depth) const {
+    ProfilePhase p(Prof::SamplerIntegratorLi);
+    Spectrum L(0.);
+    SurfaceInteraction isect;
+    if (!scene.Intersect(ray, &isect)) {
+        for (const auto &light : scene.infiniteLights) L += light->Le(ray);
+        return L;
+    }
+    isect.ComputeScatteringFunctions(ray, arena);
+    if (!isect.bsdf)
+        return Li(isect.SpawnRay(ray.d), scene, sampler, arena, depth);
+    L += isect.Le(isect.wo);
+
+    // Add direct lighting and cached or gathered indirect lighting
+    if (isect.bsdf->NumComponents(BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) > 0) {
+        L += UniformSampleOneLight(isect, scene, arena, sampler, false,
+                                   *lightDistribution);
+        L += finalGatherSamples > 0 ? IndirectLo(isect, scene, sampler, arena)
+                                    : CachedLo(isect, scene, arena);
+    }
+    if (depth + 1 < maxSpecularDepth) {
+        // Trace rays for specular reflection and refraction
+        L += SpecularReflect(ray, isect, scene, sampler, arena, depth);
+        L += SpecularTransmit(ray, isect, scene, sampler, arena, depth);
+    }
+    return L;
+}
+
+IrradianceSample IrradianceCacheIntegrator::ComputeSample(
+    const SurfaceInteraction &isect, const Normal3f &n, Float footprint,
+    const Scene &scene, RNG &rng, Sampler &sampler, MemoryArena &arena) const {
+    // Choose strata with $\phi$ divided about $\pi$ times as finely as
+    // $\theta$
+    int nTheta = std::max(2, int(std::round(std::sqrt(nSamples / Pi))));
+    int nPhi = std::max(3, int(std::round(nSamples / Float(nTheta))));
+    IrradianceSample sample = ComputeIrradianceSample(
+        isect.p, n, nTheta, nPhi, rng, [&](const Vector3f &w, Float *dist) {
+            return PathL(isect.SpawnRay(w), scene, sampler, arena, dist);
+        });
+
+    // Limit the sample's extent to the scene and, if the distance between
+    // pixels at it is known, to the range of pixel spacings
+    sample.maxDist = std::min(sample.maxDist, sceneRadius);
+    if (footprint > 0)
+        sample.maxDist = Clamp(sample.maxDist, minPixelSpacing * footprint,
+                               maxPixelSpacing * footprint);
+    return sample;
+}
+
+Spectrum IrradianceCacheIntegrator::CachedLo(const SurfaceInteraction &isect,
+                                             const Scene &scene,
+                                             MemoryArena &arena) const {
+    // Fall back to extrapolating from nearby samples if interpolation
+    // fails, and compute and add a sample at _isect_ if there are none
+    ++cacheLookups;
+    Normal3f n = Faceforward(isect.n, isect.wo);
+    Spectrum E;
+    Vector3f wi;
+    int seed;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (cache->Interpolate(isect.p, n, &E, &wi) ||
+            cache->Interpolate(isect.p, n, &E, &wi, true))
+            return isect.bsdf->f(isect.wo, wi,
+                                 BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) *
+                   E;
+        seed = int(cache->Size());
+    }
+    ++cacheMisses;
+    ++nLazySamples;
+    // Pixel spacings at _isect_ are only known for camera rays
+    Float footprint = std::max(isect.dpdx.Length(), isect.dpdy.Length());
+    RNG rng(seed);
+    RandomSampler pathSampler(1, seed);
+    pathSampler.StartPixel(Point2i(0, 0));
+    IrradianceSample sample =
+        ComputeSample(isect, n, footprint, scene, rng, pathSampler, arena);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        cache->Insert(sample);
+    }
+    return isect.bsdf->f(isect.wo, sample.wAvg,
+                         BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) *
+           sample.E;
+}
+
+Spectrum IrradianceCacheIntegrator::IndirectLo(const SurfaceInteraction &isect,
+                                               const Scene &scene,
+                                               Sampler &sampler,
+                                               MemoryArena &arena) const {
+    // Trace cosine-distributed rays and find the light reflected from where
+    // they hit, leaving out emission since direct lighting already
+    // accounts for it
+    Vector3f n = Vector3f(Faceforward(isect.n, isect.wo)), s, t;
+    CoordinateSystem(n, &s, &t);
+    Spectrum L(0.f);
+    for (int i = 0; i < finalGatherSamples; ++i) {
+        Vector3f w = CosineSampleHemisphere(sampler.Get2D());
+        Vector3f wi = w.x * s + w.y * t + w.z * n;
+        Float pdf = CosineHemispherePdf(w.z);
+        Spectrum f =
+            isect.bsdf->f(isect.wo, wi, BxDFType(BSDF_ALL & ~BSDF_SPECULAR));
+        if (f.IsBlack() || pdf == 0) continue;
+        RayDifferential ray = isect.SpawnRay(wi);
+        SurfaceInteraction gatherIsect;
+        if (!scene.Intersect(ray, &gatherIsect)) continue;
+        gatherIsect.ComputeScatteringFunctions(ray, arena);
+        if (!gatherIsect.bsdf ||
+            gatherIsect.bsdf->NumComponents(
+                BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) == 0)
+            continue;
+        Spectrum Lg = UniformSampleOneLight(gatherIsect, scene, arena, sampler,
+                                            false, *lightDistribution) +
+                      CachedLo(gatherIsect, scene, arena);
+        L += f * Lg * AbsDot(wi, isect.shading.n) / pdf;
+    }
+    return L / finalGatherSamples;
+}
+
+Spectrum IrradianceCacheIntegrator::PathL(const RayDifferential &r,
+                                          const Scene &scene, Sampler &sampler,
+                                          MemoryArena &arena,
+                                          Float *dist) const {
+    // Path trace the radiance along _r_, leaving out emission at the first
+    // intersection since it's direct lighting at the cache sample
+    Spectrum L(0.f), beta(1.f);
+    RayDifferential ray(r);
+    bool specularBounce = false;
+    *dist = Infinity;
+    for (int bounces = 0;; ++bounces) {
+        SurfaceInteraction isect;
+        bool foundIntersection = scene.Intersect(ray, &isect);
+        if (bounces == 0 && foundIntersection)
+            *dist = Distance(r.o, isect.p);
+        if (specularBounce) {
+            if (foundIntersection)
+                L += beta * isect.Le(-ray.d);
+            else
+                for (const auto &light : scene.infiniteLights)
+                    L += beta * light->Le(ray);
+        }
+        if (!foundIntersection) break;
+
+        isect.ComputeScatteringFunctions(ray, arena, true);
+        if (!isect.bsdf) {
+            ray = isect.SpawnRay(ray.d);
+            bounces--;
+            continue;
+        }
+        if (isect.bsdf->NumComponents(BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) > 0)
+            L += beta * UniformSampleOneLight(isect, scene, arena, sampler,
+                                              false, *lightDistribution);
+        if (bounces >= maxIndirectDepth) break;
+
+        // Sample BSDF to get new path direction
+        Vector3f wi;
+        Float pdf;
+        BxDFType flags;
+        Spectrum f = isect.bsdf->Sample_f(isect.wo, &wi, sampler.Get2D(), &pdf,
+                                          BSDF_ALL, &flags);
+        if (f.IsBlack() || pdf == 0) break;
+        beta *= f * AbsDot(wi, isect.shading.n) / pdf;
+        specularBounce = (flags & BSDF_SPECULAR) != 0;
+        ray = isect.SpawnRay(wi);
+
+        // Possibly terminate the path with Russian roulette
+        if (beta.MaxComponentValue() < 1 && bounces > 3) {
+            Float q = std::max((Float).05, 1 - beta.MaxComponentValue());
+            if (sampler.Get1D() < q) break;
+            beta /= 1 - q;
+        }
+    }
+    return L;
+}
+
+IrradianceCacheIntegrator *CreateIrradianceCacheIntegrator(
+    const ParamSet &params, std::shared_ptr<Sampler> sampler,
+    std::shared_ptr<const Camera> camera) {
+    int np;
+    const int *pb = params.FindInt("pixelbounds", &np);
+    Bounds2i pixelBounds = camera->film->GetSampleBounds();
+    if (pb) {
+        if (np != 4)
+            Error("Expected four values for \"pixelbounds\" parameter. Got %d.",
+                  np);
+        else {
+            pixelBounds = Intersect(pixelBounds,
+                                    Bounds2i{{pb[0], pb[2]}, {pb[1], pb[3]}});
+            if (pixelBounds.Area() == 0)
+                Error("Degenerate \"pixelbounds\" specified.");
+        }
+    }
+    Float minWeight = params.FindOneFloat("minweight", .5f);
+    Float minSpacing = params.FindOneFloat("minpixelspacing", 2.5f);
+    Float maxSpacing = params.FindOneFloat("maxpixelspacing", 15.f);
+    if (minSpacing < 1 || maxSpacing < minSpacing) {
+        Warning("Invalid \"minpixelspacing\" and \"maxpixelspacing\" values "
+                "%f and %f. Using 2.5 and 15.", minSpacing, maxSpacing);
+        minSpacing = 2.5f;
+        maxSpacing = 15.f;
+    }
+    Float maxAngle =
+        Clamp(params.FindOneFloat("maxangledifference", 10.f), 1, 90);
+    int maxSpecularDepth = params.FindOneInt("maxspeculardepth", 5);
+    int maxIndirectDepth = params.FindOneInt("maxindirectdepth", 3);
+    int nSamples = params.FindOneInt("nsamples", 512);
+    int finalGatherSamples = params.FindOneInt("finalgathersamples", 0);
+    std::string lightStrategy =
+        params.FindOneString("lightsamplestrategy", "spatial");
+    return new IrradianceCacheIntegrator(
+        camera, sampler, pixelBounds, minWeight, minSpacing, maxSpacing,
+        maxAngle, maxSpecularDepth, maxIndirectDepth, nSamples,
+        finalGatherSamples, lightStrategy);
+}
+
+}  // namespace pbrt
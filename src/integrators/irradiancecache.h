@@ -0,0 +1,166 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_INTEGRATORS_IRRADIANCECACHE_H
+#define PBRT_INTEGRATORS_IRRADIANCECACHE_H
+
+// integrators/irradiancecache.h*
+#include "pbrt.h"
+#include "integrator.h"
+#include "lightdistrib.h"
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace pbrt {
+
+// IrradianceSample stores the irradiance at a point along with its
+// gradients (Ward and Heckbert, "Irradiance Gradients"), which let it be
+// extrapolated to nearby points and normals.
+struct IrradianceSample {
+    Point3f p;
+    Normal3f n;
+    Spectrum E;
+    // Irradiance-weighted average incident direction
+    Vector3f wAvg;
+    // Harmonic mean distance to the surfaces seen from _p_, limited to
+    // the range where the sample may be used
+    Float maxDist;
+    // Changes in _E_ for rotations of _n_ about and translations of _p_
+    // along the x, y and z axes
+    Spectrum rotGrad[3], transGrad[3];
+};
+
+// Computes an IrradianceSample from _nTheta_ x _nPhi_ strata over the
+// hemisphere around _n_, finding the radiance along each direction and the
+// distance to the surface it came from with _radiance_.
+IrradianceSample ComputeIrradianceSample(
+    const Point3f &p, const Normal3f &n, int nTheta, int nPhi, RNG &rng,
+    const std::function<Spectrum(const Vector3f &w, Float *dist)> &radiance);
+
+// IrradianceCache interpolates the IrradianceSamples added to it, finding
+// the ones near a point with a hashed grid.
+class IrradianceCache {
+  public:
+    // IrradianceCache Public Methods
+    IrradianceCache(Float minWeight, Float cosMaxAngleDifference)
+        : minWeight(minWeight), cosMaxAngleDifference(cosMaxAngleDifference) {}
+    void Add(const std::vector<IrradianceSample> &samples);
+    // Adds a single sample without changing the grid's cell size; its
+    // _maxDist_ is limited so that it doesn't overlap too many cells.
+    void Insert(IrradianceSample sample);
+    // Returns false if the samples' total weight at _p_ and _n_ is less
+    // than _minWeight_; if _extrapolate_ is true, any sample within its
+    // _maxDist_ and the maximum angle difference is enough.
+    bool Interpolate(const Point3f &p, const Normal3f &n, Spectrum *E,
+                     Vector3f *wAvg, bool extrapolate = false) const;
+    size_t Size() const { return samples.size(); }
+    size_t Bytes() const;
+
+  private:
+    // IrradianceCache Private Methods
+    uint64_t CellKey(const Point3i &c) const;
+    void AddToCells(int index);
+
+    // IrradianceCache Private Data
+    const Float minWeight, cosMaxAngleDifference;
+    std::vector<IrradianceSample> samples;
+    Float cellSize = 0;
+    // Each cell lists the samples whose _maxDist_ sphere overlaps it
+    std::unordered_map<uint64_t, std::vector<int>> cells;
+};
+
+// IrradianceCacheIntegrator renders diffuse interreflection by
+// interpolating irradiance samples that are computed before rendering at
+// points seen from the camera; specular reflection and transmission are
+// followed as in the WhittedIntegrator. Samples are placed in passes over
+// the image at decreasing pixel spacings where the samples from the
+// previous ones don't cover the surface, computing each pass's samples in
+// parallel. The result is biased but smooth and fast to compute, which
+// makes it suitable for previews. With _finalGatherSamples_ > 0,
+// indirect lighting at camera ray intersections is instead found by
+// tracing rays that use the cache where they hit. Points that no sample
+// covers while rendering, such as most of those final gather rays hit,
+// get samples of their own that are added to the cache then.
+class IrradianceCacheIntegrator : public SamplerIntegrator {
+  public:
+    // IrradianceCacheIntegrator Public Methods
+    IrradianceCacheIntegrator(std::shared_ptr<const Camera> camera,
+                              std::shared_ptr<Sampler> sampler,
+                              const Bounds2i &pixelBounds, Float minWeight,
+                              Float minPixelSpacing, Float maxPixelSpacing,
+                              Float maxAngleDifference, int maxSpecularDepth,
+                              int maxIndirectDepth, int nSamples,
+                              int finalGatherSamples,
+                              const std::string &lightSampleStrategy);
+    void Preprocess(const Scene &scene, Sampler &sampler);
+    Spectrum Li(const RayDifferential &ray, const Scene &scene,
+                Sampler &sampler, MemoryArena &arena, int depth) const;
+
+  private:
+    // IrradianceCacheIntegrator Private Methods
+    Spectrum IndirectLo(const SurfaceInteraction &isect, const Scene &scene,
+                        Sampler &sampler, MemoryArena &arena) const;
+    Spectrum CachedLo(const SurfaceInteraction &isect, const Scene &scene,
+                      MemoryArena &arena) const;
+    IrradianceSample ComputeSample(const SurfaceInteraction &isect,
+                                   const Normal3f &n, Float footprint,
+                                   const Scene &scene, RNG &rng,
+                                   Sampler &sampler, MemoryArena &arena) const;
+    Spectrum PathL(const RayDifferential &ray, const Scene &scene,
+                   Sampler &sampler, MemoryArena &arena, Float *dist) const;
+
+    // IrradianceCacheIntegrator Private Data
+    const Bounds2i cacheBounds;
+    const Float minPixelSpacing, maxPixelSpacing;
+    const int maxSpecularDepth, maxIndirectDepth;
+    const int nSamples, finalGatherSamples;
+    const std::string lightSampleStrategy;
+    std::unique_ptr<LightDistribution> lightDistribution;
+    std::unique_ptr<IrradianceCache> cache;
+    // Protects _cache_ while samples are added during rendering
+    mutable std::mutex cacheMutex;
+    Float sceneRadius = 0;
+};
+
+IrradianceCacheIntegrator *CreateIrradianceCacheIntegrator(
+    const ParamSet &params, std::shared_ptr<Sampler> sampler,
+    std::shared_ptr<const Camera> camera);
+
+}  // namespace pbrt
+
+#endif  // PBRT_INTEGRATORS_IRRADIANCECACHE_H
@@ -144,6 +144,7 @@ Spectrum MLTIntegrator::L(const Scene &scene, MemoryArena &arena,
     Vertex *cameraVertices = arena.Alloc<Vertex>(t);
     Bounds2f sampleBounds = (Bounds2f)camera->film->GetSampleBounds();
     *pRaster = sampleBounds.Lerp(sampler.Get2D());
+    SampleWavelengths(sampler);
     if (GenerateCameraSubpath(scene, sampler, arena, t, *camera, *pRaster,
                               cameraVertices) != t)
         return Spectrum(0.f);
@@ -177,14 +178,14 @@ void MLTIntegrator::Render(const Scene &scene) {
     // Generate bootstrap samples and compute normalization constant $b$
     int nBootstrapSamples = nBootstrap * (maxDepth + 1);
     std::vector<Float> bootstrapWeights(nBootstrapSamples, 0);
+    ThreadArenaPool arenas;
     if (scene.lights.size() > 0) {
         ProgressReporter progress(nBootstrap / 256,
                                   "Generating bootstrap paths");
-        std::vector<MemoryArena> bootstrapThreadArenas(MaxThreadIndex());
         int chunkSize = Clamp(nBootstrap / 128, 1, 8192);
         ParallelFor([&](int i) {
             // Generate _i_th bootstrap sample
-            MemoryArena &arena = bootstrapThreadArenas[ThreadIndex];
+            MemoryArena &arena = arenas.Get();
             for (int depth = 0; depth <= maxDepth; ++depth) {
                 int rngIndex = i * (maxDepth + 1) + depth;
                 MLTSampler sampler(mutationsPerPixel, rngIndex, sigma,
@@ -214,7 +215,7 @@ void MLTIntegrator::Render(const Scene &scene) {
                 std::min((i + 1) * nTotalMutations / nChains, nTotalMutations) -
                 i * nTotalMutations / nChains;
             // Follow {i}th Markov chain for _nChainMutations_
-            MemoryArena arena;
+            MemoryArena &arena = arenas.Get();
 
             // Select initial state from the set of bootstrap samples
             RNG rng(i);
@@ -227,6 +228,12 @@ void MLTIntegrator::Render(const Scene &scene) {
             Point2f pCurrent;
             Spectrum LCurrent =
                 L(scene, arena, lightDistr, lightToIndex, sampler, depth, &pCurrent);
+            Float yCurrent = LCurrent.y();
+#ifdef PBRT_HERO_SPECTRUM
+            // Radiance values can only be converted at the wavelengths they
+            // were computed for, so keep track of the current state's
+            HeroWavelengths lambdaCurrent = heroWavelengths;
+#endif
 
             // Run the Markov chain for _nChainMutations_ steps
             for (int64_t j = 0; j < nChainMutations; ++j) {
@@ -234,19 +241,27 @@ void MLTIntegrator::Render(const Scene &scene) {
                 Point2f pProposed;
                 Spectrum LProposed =
                     L(scene, arena, lightDistr, lightToIndex, sampler, depth, &pProposed);
+                Float yProposed = LProposed.y();
                 // Compute acceptance probability for proposed sample
-                Float accept = std::min((Float)1, LProposed.y() / LCurrent.y());
+                Float accept = std::min((Float)1, yProposed / yCurrent);
 
                 // Splat both current and proposed samples to _film_
                 if (accept > 0)
-                    film.AddSplat(pProposed,
-                                  LProposed * accept / LProposed.y());
-                film.AddSplat(pCurrent, LCurrent * (1 - accept) / LCurrent.y());
+                    film.AddSplat(pProposed, LProposed * accept / yProposed);
+#ifdef PBRT_HERO_SPECTRUM
+                HeroWavelengths lambdaProposed = heroWavelengths;
+                heroWavelengths = lambdaCurrent;
+#endif
+                film.AddSplat(pCurrent, LCurrent * (1 - accept) / yCurrent);
 
                 // Accept or reject the proposal
                 if (rng.UniformFloat() < accept) {
                     pCurrent = pProposed;
                     LCurrent = LProposed;
+                    yCurrent = yProposed;
+#ifdef PBRT_HERO_SPECTRUM
+                    lambdaCurrent = lambdaProposed;
+#endif
                     sampler.Accept();
                     ++acceptedMutations;
                 } else
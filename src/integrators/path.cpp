@@ -66,15 +66,30 @@ namespace pbrt {
                                    std::shared_ptr<const Camera> camera,
                                    std::shared_ptr<Sampler> sampler,
                                    const Bounds2i &pixelBounds, Float rrThreshold,
-                                   const std::string &lightSampleStrategy)
+                                   const std::string &lightSampleStrategy,
+                                   bool lightWarmup,
+                                   const std::string &lightDistribFile)
             : SamplerIntegrator(camera, sampler, pixelBounds),
               maxDepth(maxDepth),
               rrThreshold(rrThreshold),
-              lightSampleStrategy(lightSampleStrategy) {}
+              lightSampleStrategy(lightSampleStrategy),
+              lightWarmup(lightWarmup),
+              lightDistribFile(lightDistribFile) {}
 
     void PathIntegrator::Preprocess(const Scene &scene, Sampler &sampler) {
         lightDistribution =
                 CreateLightSampleDistribution(lightSampleStrategy, scene);
+        if (!lightDistribFile.empty())
+            ReadLightDistribution(lightDistribution.get(), lightDistribFile);
+        if (lightWarmup)
+            PrecomputeLightDistribution(lightDistribution.get(), scene,
+                                        *camera, maxDepth);
+    }
+
+    void PathIntegrator::Render(const Scene &scene) {
+        SamplerIntegrator::Render(scene);
+        if (!lightDistribFile.empty())
+            WriteLightDistribution(lightDistribution.get(), lightDistribFile);
     }
 
     Spectrum PathIntegrator::Li(const RayDifferential &r, const Scene &scene,
@@ -474,15 +489,14 @@ namespace pbrt {
                 continue;
             }
 
-            const Distribution1D *distrib = lightDistribution->Lookup(isect.p);
-
             // Sample illumination from lights to find path contribution.
             // (But skip this for perfectly specular BSDFs.)
             if (isect.bsdf->NumComponents(BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) >
                 0) {
                 ++totalPaths;
                 Spectrum Ld = beta * UniformSampleOneLight(isect, scene, arena,
-                                                           sampler, false, distrib);
+                                                           sampler, false,
+                                                           *lightDistribution);
                 VLOG(2) << "Sampled direct lighting Ld = " << Ld;
                 if (Ld.IsBlack()) ++zeroRadiancePaths;
                 CHECK_GE(Ld.y(), 0.f);
@@ -523,7 +537,7 @@ namespace pbrt {
 
                 // Account for the direct subsurface scattering component
                 L += beta * UniformSampleOneLight(pi, scene, arena, sampler, false,
-                                                  lightDistribution->Lookup(pi.p));
+                                                  *lightDistribution);
 
                 // Account for the indirect subsurface scattering component
                 Spectrum f = pi.bsdf->Sample_f(pi.wo, &wi, sampler.Get2D(), &pdf,
@@ -571,8 +585,12 @@ namespace pbrt {
         Float rrThreshold = params.FindOneFloat("rrthreshold", 1.);
         std::string lightStrategy =
                 params.FindOneString("lightsamplestrategy", "spatial");
+        bool lightWarmup = params.FindOneBool("lightwarmup", false);
+        std::string lightDistribFile =
+                params.FindOneFilename("lightdistribfile", "");
         return new PathIntegrator(maxDepth, camera, sampler, pixelBounds,
-                                  rrThreshold, lightStrategy);
+                                  rrThreshold, lightStrategy, lightWarmup,
+                                  lightDistribFile);
     }
 
 }  // namespace pbrt
@@ -0,0 +1,297 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+// integrators/restir.cpp*
+#include "integrators/restir.h"
+#include "camera.h"
+#include "film.h"
+#include "interaction.h"
+#include "lightdistrib.h"
+#include "paramset.h"
+#include "parallel.h"
+#include "progressreporter.h"
+#include "reflection.h"
+#include "rng.h"
+#include "sampler.h"
+#include "sampling.h"
+#include "scene.h"
+#include "stats.h"
+
+namespace pbrt {
+
+STAT_PERCENT("Integrator/Spatial neighbors reused", nNeighborsReused,
+             nNeighbors);
+STAT_PERCENT("Integrator/Temporal reservoirs reused", nTemporalReused,
+             nTemporal);
+STAT_MEMORY_COUNTER("Memory/ReSTIR pixels", pixelMemoryBytes);
+
+// ReSTIR Local Declarations
+struct ReSTIRPixel {
+    // Visible point for the current pass
+    SurfaceInteraction isect;
+    Spectrum beta;
+    Float depth = 0;
+    bool valid = false;
+    LightReservoir reservoir;
+    // Reservoir and visible point from the previous pass
+    LightReservoir prevReservoir;
+    Normal3f prevN;
+    Float prevDepth = 0;
+    Spectrum L;
+};
+
+static bool SimilarPoints(const Normal3f &n0, Float depth0, const Normal3f &n1,
+                          Float depth1) {
+    return AbsDot(n0, n1) > .9f && std::abs(depth0 - depth1) < .1f * depth0;
+}
+
+static Float TargetPdf(const SurfaceInteraction &isect, const Scene &scene,
+                       const LightReservoir &r) {
+    if (r.lightIndex < 0) return 0;
+    VisibilityTester vis;
+    return std::max(
+        (Float)0,
+        LightSampleContribution(isect, scene, r.lightIndex, r.uLight, &vis)
+            .y());
+}
+
+// ReSTIRIntegrator Method Definitions
+void ReSTIRIntegrator::Render(const Scene &scene) {
+    ProfilePhase p(Prof::IntegratorRender);
+    std::unique_ptr<LightDistribution> lightDistribution =
+        CreateLightSampleDistribution(lightSampleStrategy, scene);
+    Bounds2i pixelBounds = camera->film->croppedPixelBounds;
+    int nPixels = pixelBounds.Area();
+    Vector2i pixelExtent = pixelBounds.Diagonal();
+    std::unique_ptr<ReSTIRPixel[]> pixels(new ReSTIRPixel[nPixels]);
+    pixelMemoryBytes = nPixels * sizeof(ReSTIRPixel);
+    const int nPasses = sampler->samplesPerPixel;
+    const Float invSqrtSPP = 1.f / std::sqrt(nPasses);
+
+    const int tileSize = 16;
+    Point2i nTiles((pixelExtent.x + tileSize - 1) / tileSize,
+                   (pixelExtent.y + tileSize - 1) / tileSize);
+    ProgressReporter reporter(nPasses, "Rendering");
+    ThreadArenaPool perThreadArenas;
+    for (int pass = 0; pass < nPasses; ++pass) {
+        // Find visible points and choose among candidate light samples
+        ParallelFor2D([&](Point2i tile) {
+            MemoryArena &arena = perThreadArenas.Get();
+            int tileIndex = tile.y * nTiles.x + tile.x;
+            std::unique_ptr<Sampler> tileSampler =
+                sampler->Clone(pass * nTiles.x * nTiles.y + tileIndex);
+            int x0 = pixelBounds.pMin.x + tile.x * tileSize;
+            int x1 = std::min(x0 + tileSize, pixelBounds.pMax.x);
+            int y0 = pixelBounds.pMin.y + tile.y * tileSize;
+            int y1 = std::min(y0 + tileSize, pixelBounds.pMax.y);
+            Bounds2i tileBounds(Point2i(x0, y0), Point2i(x1, y1));
+            for (Point2i pPixel : tileBounds) {
+                tileSampler->StartPixel(pPixel);
+                tileSampler->SetSampleNumber(pass);
+                Point2i pPixelO = Point2i(pPixel - pixelBounds.pMin);
+                ReSTIRPixel &pixel =
+                    pixels[pPixelO.x + pPixelO.y * pixelExtent.x];
+                pixel.valid = false;
+
+                // Generate camera ray for pixel
+                CameraSample cameraSample =
+                    tileSampler->GetCameraSample(pPixel);
+                RayDifferential ray;
+                Spectrum beta =
+                    camera->GenerateRayDifferential(cameraSample, &ray);
+                if (beta.IsBlack()) continue;
+                ray.ScaleDifferentials(invSqrtSPP);
+
+                // Follow the camera ray to the first nonspecular surface
+                Float depth = 0;
+                for (int bounces = 0; bounces < maxDepth; ++bounces) {
+                    SurfaceInteraction isect;
+                    if (!scene.Intersect(ray, &isect)) {
+                        for (const auto &light : scene.lights)
+                            pixel.L += beta * light->Le(ray);
+                        break;
+                    }
+                    depth += Distance(ray.o, isect.p);
+                    isect.ComputeScatteringFunctions(ray, arena, true);
+                    if (!isect.bsdf) {
+                        ray = isect.SpawnRay(ray.d);
+                        bounces--;
+                        continue;
+                    }
+                    pixel.L += beta * isect.Le(-ray.d);
+                    if (isect.bsdf->NumComponents(
+                            BxDFType(BSDF_ALL & ~BSDF_SPECULAR)) > 0) {
+                        // Record the visible point and resample candidate
+                        // light samples there
+                        pixel.isect = isect;
+                        pixel.beta = beta;
+                        pixel.depth = depth;
+                        pixel.valid = true;
+                        pixel.reservoir = LightReservoir();
+                        SampleLightCandidates(
+                            isect, scene, *tileSampler, nCandidates,
+                            lightDistribution->Lookup(isect.p),
+                            &pixel.reservoir);
+
+                        // Merge the reservoir from the previous pass
+                        if (temporalReuse && pixel.prevReservoir.M > 0) {
+                            ++nTemporal;
+                            if (SimilarPoints(isect.n, depth, pixel.prevN,
+                                              pixel.prevDepth)) {
+                                ++nTemporalReused;
+                                pixel.reservoir.Merge(
+                                    pixel.prevReservoir,
+                                    TargetPdf(isect, scene,
+                                              pixel.prevReservoir),
+                                    tileSampler->Get1D());
+                            }
+                        }
+                        break;
+                    }
+
+                    // Follow specular reflection or transmission
+                    Vector3f wi;
+                    Float pdf;
+                    Spectrum f = isect.bsdf->Sample_f(
+                        isect.wo, &wi, tileSampler->Get2D(), &pdf);
+                    if (f.IsBlack() || pdf == 0) break;
+                    beta *= f * AbsDot(wi, isect.shading.n) / pdf;
+                    ray = isect.SpawnRay(wi);
+                }
+            }
+        }, nTiles);
+
+        // Merge reservoirs from nearby pixels and add direct lighting
+        ParallelFor([&](int64_t y) {
+            std::vector<int> merged(nSpatialNeighbors);
+            for (int x = 0; x < pixelExtent.x; ++x) {
+                int offset = y * pixelExtent.x + x;
+                ReSTIRPixel &pixel = pixels[offset];
+                if (!pixel.valid) {
+                    pixel.prevReservoir = LightReservoir();
+                    continue;
+                }
+                LightReservoir r = pixel.reservoir;
+                RNG rng(uint64_t(pass) * nPixels + offset);
+                int nMerged = 0;
+                for (int i = 0; i < nSpatialNeighbors; ++i) {
+                    Point2f d = spatialRadius * ConcentricSampleDisk(Point2f(
+                                                    rng.UniformFloat(),
+                                                    rng.UniformFloat()));
+                    int nx = x + int(std::round(d.x));
+                    int ny = int(y) + int(std::round(d.y));
+                    if ((nx == x && ny == y) || nx < 0 ||
+                        nx >= pixelExtent.x || ny < 0 || ny >= pixelExtent.y)
+                        continue;
+                    ++nNeighbors;
+                    const ReSTIRPixel &neighbor =
+                        pixels[ny * pixelExtent.x + nx];
+                    if (!neighbor.valid || neighbor.reservoir.M == 0 ||
+                        !SimilarPoints(pixel.isect.n, pixel.depth,
+                                       neighbor.isect.n, neighbor.depth))
+                        continue;
+                    ++nNeighborsReused;
+                    r.Merge(neighbor.reservoir,
+                            TargetPdf(pixel.isect, scene, neighbor.reservoir),
+                            rng.UniformFloat());
+                    merged[nMerged++] = ny * pixelExtent.x + nx;
+                }
+
+                // Only count the samples of neighbors that could have
+                // chosen the final sample when normalizing the reservoir's
+                // weight; otherwise lights that some of them don't see are
+                // darkened. Their reservoirs were resampled without
+                // visibility, so visibility mustn't be considered here
+                // either, or shadowed neighbors would make the weight too
+                // large.
+                if (unbiased && nMerged > 0 && r.lightIndex >= 0) {
+                    int Z = pixel.reservoir.M;
+                    for (int i = 0; i < nMerged; ++i) {
+                        const ReSTIRPixel &neighbor = pixels[merged[i]];
+                        if (TargetPdf(neighbor.isect, scene, r) > 0)
+                            Z += neighbor.reservoir.M;
+                    }
+                    if (Z > 0) r.weightSum *= Float(r.M) / Z;
+                }
+
+                // Trace a single shadow ray for the chosen light sample
+                Float W = r.Weight();
+                if (W > 0) {
+                    VisibilityTester vis;
+                    Spectrum Ld = LightSampleContribution(
+                        pixel.isect, scene, r.lightIndex, r.uLight, &vis);
+                    if (!Ld.IsBlack() && vis.Unoccluded(scene))
+                        pixel.L += pixel.beta * Ld * W;
+                }
+
+                // Keep the reservoir for the next pass, limiting how much
+                // the past outweighs new candidates. It's stored before
+                // spatial reuse so that neighbors' samples don't feed back
+                // into it from pass to pass.
+                pixel.prevReservoir = pixel.reservoir;
+                pixel.prevReservoir.ClampHistory(maxHistory * nCandidates);
+                pixel.prevN = pixel.isect.n;
+                pixel.prevDepth = pixel.depth;
+            }
+        }, pixelExtent.y);
+        perThreadArenas.ResetAll();
+        reporter.Update();
+    }
+    reporter.Done();
+
+    // Store the average of the passes in the film and write the image
+    std::unique_ptr<Spectrum[]> image(new Spectrum[nPixels]);
+    for (int i = 0; i < nPixels; ++i) image[i] = pixels[i].L / nPasses;
+    camera->film->SetImage(image.get());
+    camera->film->WriteImage();
+}
+
+Integrator *CreateReSTIRIntegrator(const ParamSet &params,
+                                   std::shared_ptr<Sampler> sampler,
+                                   std::shared_ptr<const Camera> camera) {
+    int maxDepth = params.FindOneInt("maxdepth", 5);
+    int nCandidates = std::max(1, params.FindOneInt("lightcandidates", 32));
+    int nSpatialNeighbors =
+        std::max(0, params.FindOneInt("spatialneighbors", 5));
+    Float spatialRadius = params.FindOneFloat("spatialradius", 30.f);
+    bool temporalReuse = params.FindOneBool("temporalreuse", true);
+    int maxHistory = std::max(1, params.FindOneInt("maxhistory", 20));
+    bool unbiased = params.FindOneBool("unbiased", true);
+    std::string lightStrategy =
+        params.FindOneString("lightsamplestrategy", "power");
+    return new ReSTIRIntegrator(camera, sampler, maxDepth, nCandidates,
+                                nSpatialNeighbors, spatialRadius,
+                                temporalReuse, maxHistory, unbiased,
+                                lightStrategy);
+}
+
+}  // namespace pbrt
@@ -0,0 +1,106 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_INTEGRATORS_RESTIR_H
+#define PBRT_INTEGRATORS_RESTIR_H
+
+// integrators/restir.h*
+#include "pbrt.h"
+#include "integrator.h"
+
+namespace pbrt {
+
+// ReSTIRIntegrator Declarations
+
+// ReSTIRIntegrator renders direct lighting with reservoir-based
+// spatiotemporal importance resampling (Bitterli et al., "Spatiotemporal
+// Reservoir Resampling for Real-Time Ray Tracing with Dynamic Direct
+// Lighting"). The image is rendered in progressive passes that each take
+// one sample per pixel. In each pass, candidate light samples are drawn
+// at every pixel's visible point without tracing shadow rays. The
+// resulting reservoir is merged with the one the pixel finished the
+// previous pass with and then with those of nearby pixels whose visible
+// points are similar, and a single shadow ray is traced for the sample
+// that's chosen. When _unbiased_ is true, the chosen sample's weight is
+// normalized by the number of candidates from pixels whose visible points
+// it could contribute to, which takes an unshadowed evaluation of it per
+// reused neighbor; otherwise all of the candidates are counted, which is
+// cheaper but darkens lights that are behind some of the neighbors'
+// surfaces. Temporal reuse assumes that each pixel's visible point sees
+// the same lights from pass to pass. Reusing samples greatly reduces
+// noise in scenes with many lights.
+// Specular reflection and transmission from the camera are followed up to
+// _maxDepth_ bounces to find the visible points.
+class ReSTIRIntegrator : public Integrator {
+  public:
+    // ReSTIRIntegrator Public Methods
+    ReSTIRIntegrator(std::shared_ptr<const Camera> camera,
+                     std::shared_ptr<Sampler> sampler, int maxDepth,
+                     int nCandidates, int nSpatialNeighbors,
+                     Float spatialRadius, bool temporalReuse, int maxHistory,
+                     bool unbiased, const std::string &lightSampleStrategy)
+        : camera(camera),
+          sampler(sampler),
+          maxDepth(maxDepth),
+          nCandidates(nCandidates),
+          nSpatialNeighbors(nSpatialNeighbors),
+          spatialRadius(spatialRadius),
+          temporalReuse(temporalReuse),
+          maxHistory(maxHistory),
+          unbiased(unbiased),
+          lightSampleStrategy(lightSampleStrategy) {}
+    void Render(const Scene &scene);
+
+  private:
+    // ReSTIRIntegrator Private Data
+    std::shared_ptr<const Camera> camera;
+    std::shared_ptr<Sampler> sampler;
+    const int maxDepth, nCandidates, nSpatialNeighbors;
+    const Float spatialRadius;
+    const bool temporalReuse;
+    const int maxHistory;
+    const bool unbiased;
+    const std::string lightSampleStrategy;
+};
+
+Integrator *CreateReSTIRIntegrator(const ParamSet &params,
+                                   std::shared_ptr<Sampler> sampler,
+                                   std::shared_ptr<const Camera> camera);
+
+}  // namespace pbrt
+
+#endif  // PBRT_INTEGRATORS_RESTIR_H
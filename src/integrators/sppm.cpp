@@ -33,6 +33,7 @@
 
 // integrators/sppm.cpp*
 #include "integrators/sppm.h"
+#include "checkpoint.h"
 #include "parallel.h"
 #include "scene.h"
 #include "imageio.h"
@@ -108,6 +109,46 @@ inline unsigned int hash(const Point3i &p, int hashSize) {
 }
 
 // SPPM Method Definitions
+// SPPM checkpoints store the number of finished iterations followed by
+// each pixel's radius, $N$, $L_d$, and $\tau$; the other _SPPMPixel_
+// members are reset at the end of every iteration.
+static std::vector<char> SaveSPPMCheckpoint(const CheckpointWriter &writer,
+                                            int nFinished,
+                                            const SPPMPixel *pixels,
+                                            int nPixels) {
+    std::vector<char> data = writer.StartCheckpoint();
+    CheckpointAppend(&data, &nFinished);
+    for (int i = 0; i < nPixels; ++i) {
+        const SPPMPixel &p = pixels[i];
+        Float v[2 + 2 * Spectrum::nSamples];
+        v[0] = p.radius;
+        v[1] = p.N;
+        for (int j = 0; j < Spectrum::nSamples; ++j) {
+            v[2 + j] = p.Ld[j];
+            v[2 + Spectrum::nSamples + j] = p.tau[j];
+        }
+        CheckpointAppend(&data, v, 2 + 2 * Spectrum::nSamples);
+    }
+    return data;
+}
+
+static bool LoadSPPMCheckpoint(CheckpointReader &reader, int *nFinished,
+                               SPPMPixel *pixels, int nPixels) {
+    if (!reader.Read(nFinished)) return false;
+    for (int i = 0; i < nPixels; ++i) {
+        SPPMPixel &p = pixels[i];
+        Float v[2 + 2 * Spectrum::nSamples];
+        if (!reader.Read(v, 2 + 2 * Spectrum::nSamples)) return false;
+        p.radius = v[0];
+        p.N = v[1];
+        for (int j = 0; j < Spectrum::nSamples; ++j) {
+            p.Ld[j] = v[2 + j];
+            p.tau[j] = v[2 + Spectrum::nSamples + j];
+        }
+    }
+    return reader.AtEnd();
+}
+
 void SPPMIntegrator::Render(const Scene &scene) {
     ProfilePhase p(Prof::IntegratorRender);
     // Initialize _pixelBounds_ and _pixels_ array for SPPM
@@ -130,13 +171,48 @@ void SPPMIntegrator::Render(const Scene &scene) {
     Point2i nTiles((pixelExtent.x + tileSize - 1) / tileSize,
                    (pixelExtent.y + tileSize - 1) / tileSize);
     ProgressReporter progress(2 * nIterations, "Rendering");
-    std::vector<MemoryArena> perThreadArenas(MaxThreadIndex());
-    for (int iter = 0; iter < nIterations; ++iter) {
+
+    // Restore SPPM pixels from the last checkpoint when resuming
+    int firstIteration = 0;
+    std::unique_ptr<CheckpointWriter> checkpoint;
+    if (PbrtOptions.checkpointInterval > 0 || PbrtOptions.resume) {
+        std::string filename = CheckpointFilename(camera->film->filename);
+        std::string config = StringPrintf(
+            "sppm iterations %d photons %d maxdepth %d radius %f pixels %d %d "
+            "%d %d", nIterations, photonsPerIteration, maxDepth,
+            initialSearchRadius, pixelBounds.pMin.x, pixelBounds.pMin.y,
+            pixelBounds.pMax.x, pixelBounds.pMax.y);
+        CheckpointReader reader;
+        if (PbrtOptions.resume && reader.Open(filename, config)) {
+            if (LoadSPPMCheckpoint(reader, &firstIteration, pixels.get(),
+                                   nPixels)) {
+                LOG(INFO) << "Resuming SPPM from iteration " << firstIteration;
+                progress.Update(2 * firstIteration);
+            } else {
+                Warning("%s: truncated checkpoint; starting from the "
+                        "beginning", filename.c_str());
+                firstIteration = 0;
+                for (int i = 0; i < nPixels; ++i) {
+                    pixels[i].radius = initialSearchRadius;
+                    pixels[i].N = 0;
+                    pixels[i].Ld = pixels[i].tau = Spectrum(0.f);
+                }
+            }
+        }
+        checkpoint.reset(new CheckpointWriter(
+            filename, config, PbrtOptions.checkpointInterval));
+    }
+
+    // Visible point BSDFs and grid nodes live in _perThreadArenas_ until
+    // the end of each iteration; photon paths only need _photonArenas_
+    // until the next photon.
+    ThreadArenaPool perThreadArenas, photonArenas;
+    for (int iter = firstIteration; iter < nIterations; ++iter) {
         // Generate SPPM visible points
         {
             ProfilePhase _(Prof::SPPMCameraPass);
             ParallelFor2D([&](Point2i tile) {
-                MemoryArena &arena = perThreadArenas[ThreadIndex];
+                MemoryArena &arena = perThreadArenas.Get();
                 // Follow camera paths for _tile_ in image for SPPM
                 int tileIndex = tile.y * nTiles.x + tile.x;
                 std::unique_ptr<Sampler> tileSampler = sampler.Clone(tileIndex);
@@ -267,7 +343,7 @@ void SPPMIntegrator::Render(const Scene &scene) {
 
             // Add visible points to SPPM grid
             ParallelFor([&](int pixelIndex) {
-                MemoryArena &arena = perThreadArenas[ThreadIndex];
+                MemoryArena &arena = perThreadArenas.Get();
                 SPPMPixel &pixel = pixels[pixelIndex];
                 if (!pixel.vp.beta.IsBlack()) {
                     // Add pixel's visible point to applicable grid cells
@@ -303,9 +379,8 @@ void SPPMIntegrator::Render(const Scene &scene) {
         // Trace photons and accumulate contributions
         {
             ProfilePhase _(Prof::SPPMPhotonPass);
-            std::vector<MemoryArena> photonShootArenas(MaxThreadIndex());
             ParallelFor([&](int photonIndex) {
-                MemoryArena &arena = photonShootArenas[ThreadIndex];
+                MemoryArena &arena = photonArenas.Get();
                 // Follow photon path for _photonIndex_
                 uint64_t haltonIndex =
                     (uint64_t)iter * (uint64_t)photonsPerIteration +
@@ -496,11 +571,16 @@ void SPPMIntegrator::Render(const Scene &scene) {
             }
         }
 
+        // Hand SPPM pixel state to the checkpoint writer thread if it's time
+        if (checkpoint && checkpoint->Due() && iter + 1 < nIterations)
+            checkpoint->Write(SaveSPPMCheckpoint(*checkpoint, iter + 1,
+                                                 pixels.get(), nPixels));
+
         // Reset memory arenas
-        for (int i = 0; i < perThreadArenas.size(); ++i)
-            perThreadArenas[i].Reset();
+        perThreadArenas.ResetAll();
     }
     progress.Done();
+    if (checkpoint) checkpoint->Finish();
 }
 
 Integrator *CreateSPPMIntegrator(const ParamSet &params,
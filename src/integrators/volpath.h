@@ -52,12 +52,17 @@ class VolPathIntegrator : public SamplerIntegrator {
     VolPathIntegrator(int maxDepth, std::shared_ptr<const Camera> camera,
                       std::shared_ptr<Sampler> sampler,
                       const Bounds2i &pixelBounds, Float rrThreshold = 1,
-                      const std::string &lightSampleStrategy = "spatial")
+                      const std::string &lightSampleStrategy = "spatial",
+                      bool lightWarmup = false,
+                      const std::string &lightDistribFile = "")
         : SamplerIntegrator(camera, sampler, pixelBounds),
           maxDepth(maxDepth),
           rrThreshold(rrThreshold),
-          lightSampleStrategy(lightSampleStrategy) { }
+          lightSampleStrategy(lightSampleStrategy),
+          lightWarmup(lightWarmup),
+          lightDistribFile(lightDistribFile) { }
     void Preprocess(const Scene &scene, Sampler &sampler);
+    void Render(const Scene &scene);
     Spectrum Li(const RayDifferential &ray, const Scene &scene,
                 Sampler &sampler, MemoryArena &arena, int depth) const;
 
@@ -66,6 +71,11 @@ class VolPathIntegrator : public SamplerIntegrator {
     const int maxDepth;
     const Float rrThreshold;
     const std::string lightSampleStrategy;
+    // Light sampling distributions are computed before rendering if
+    // _lightWarmup_ is set; if _lightDistribFile_ is given, they're
+    // restored from it before rendering and saved to it afterward.
+    const bool lightWarmup;
+    const std::string lightDistribFile;
     std::unique_ptr<LightDistribution> lightDistribution;
 };
 
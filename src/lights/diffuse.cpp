@@ -42,7 +42,7 @@ namespace pbrt {
 // DiffuseAreaLight Method Definitions
 DiffuseAreaLight::DiffuseAreaLight(const Transform &LightToWorld,
                                    const MediumInterface &mediumInterface,
-                                   const Spectrum &Lemit, int nSamples,
+                                   const SceneSpectrum &Lemit, int nSamples,
                                    const std::shared_ptr<Shape> &shape,
                                    bool twoSided)
     : AreaLight(LightToWorld, mediumInterface, nSamples),
@@ -62,7 +62,15 @@ DiffuseAreaLight::DiffuseAreaLight(const Transform &LightToWorld,
 }
 
 Spectrum DiffuseAreaLight::Power() const {
-    return (twoSided ? 2 : 1) * Lemit * area * Pi;
+    return (twoSided ? 2 : 1) * Spectrum(Lemit) * area * Pi;
+}
+
+bool DiffuseAreaLight::Bounds(LightBounds *bounds) const {
+    Vector3f w;
+    Float cosTheta_o = shape->NormalBounds(&w);
+    *bounds = LightBounds(shape->WorldBound(), w, Power().y() / Pi,
+                          cosTheta_o, 0 /* cos(Pi / 2) */, twoSided);
+    return true;
 }
 
 Spectrum DiffuseAreaLight::Sample_Li(const Interaction &ref, const Point2f &u,
@@ -135,8 +143,8 @@ void DiffuseAreaLight::Pdf_Le(const Ray &ray, const Normal3f &n, Float *pdfPos,
 std::shared_ptr<AreaLight> CreateDiffuseAreaLight(
     const Transform &light2world, const Medium *medium,
     const ParamSet &paramSet, const std::shared_ptr<Shape> &shape) {
-    Spectrum L = paramSet.FindOneSpectrum("L", Spectrum(1.0));
-    Spectrum sc = paramSet.FindOneSpectrum("scale", Spectrum(1.0));
+    SceneSpectrum L = paramSet.FindOneSpectrum("L", SceneSpectrum(1.0));
+    SceneSpectrum sc = paramSet.FindOneSpectrum("scale", SceneSpectrum(1.0));
     int nSamples = paramSet.FindOneInt("samples",
                                        paramSet.FindOneInt("nsamples", 1));
     bool twoSided = paramSet.FindOneBool("twosided", false);
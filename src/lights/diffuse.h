@@ -50,11 +50,13 @@ class DiffuseAreaLight : public AreaLight {
   public:
     // DiffuseAreaLight Public Methods
     DiffuseAreaLight(const Transform &LightToWorld,
-                     const MediumInterface &mediumInterface, const Spectrum &Le,
-                     int nSamples, const std::shared_ptr<Shape> &shape,
+                     const MediumInterface &mediumInterface,
+                     const SceneSpectrum &Le, int nSamples,
+                     const std::shared_ptr<Shape> &shape,
                      bool twoSided = false);
     Spectrum L(const Interaction &intr, const Vector3f &w) const {
-        return (twoSided || Dot(intr.n, w) > 0) ? Lemit : Spectrum(0.f);
+        return (twoSided || Dot(intr.n, w) > 0) ? Spectrum(Lemit)
+                                                : Spectrum(0.f);
     }
     Spectrum Power() const;
     Spectrum Sample_Li(const Interaction &ref, const Point2f &u, Vector3f *wo,
@@ -65,10 +67,11 @@ class DiffuseAreaLight : public AreaLight {
                        Float *pdfDir) const;
     void Pdf_Le(const Ray &, const Normal3f &, Float *pdfPos,
                 Float *pdfDir) const;
+    bool Bounds(LightBounds *bounds) const;
 
   protected:
     // DiffuseAreaLight Protected Data
-    const Spectrum Lemit;
+    const SceneSpectrum Lemit;
     std::shared_ptr<Shape> shape;
     // Added after book publication: by default, DiffuseAreaLights still
     // only emit in the hemimsphere around the surface normal.  However,
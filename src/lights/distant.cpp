@@ -40,8 +40,8 @@
 namespace pbrt {
 
 // DistantLight Method Definitions
-DistantLight::DistantLight(const Transform &LightToWorld, const Spectrum &L,
-                           const Vector3f &wLight)
+DistantLight::DistantLight(const Transform &LightToWorld,
+                           const SceneSpectrum &L, const Vector3f &wLight)
     : Light((int)LightFlags::DeltaDirection, LightToWorld, MediumInterface()),
       L(L),
       wLight(Normalize(LightToWorld(wLight))) {}
@@ -55,11 +55,11 @@ Spectrum DistantLight::Sample_Li(const Interaction &ref, const Point2f &u,
     Point3f pOutside = ref.p + wLight * (2 * worldRadius);
     *vis =
         VisibilityTester(ref, Interaction(pOutside, ref.time, mediumInterface));
-    return L;
+    return Spectrum(L);
 }
 
 Spectrum DistantLight::Power() const {
-    return L * Pi * worldRadius * worldRadius;
+    return Spectrum(L) * Pi * worldRadius * worldRadius;
 }
 
 Float DistantLight::Pdf_Li(const Interaction &, const Vector3f &) const {
@@ -81,7 +81,7 @@ Spectrum DistantLight::Sample_Le(const Point2f &u1, const Point2f &u2,
     *nLight = (Normal3f)ray->d;
     *pdfPos = 1 / (Pi * worldRadius * worldRadius);
     *pdfDir = 1;
-    return L;
+    return Spectrum(L);
 }
 
 void DistantLight::Pdf_Le(const Ray &, const Normal3f &, Float *pdfPos,
@@ -93,8 +93,8 @@ void DistantLight::Pdf_Le(const Ray &, const Normal3f &, Float *pdfPos,
 
 std::shared_ptr<DistantLight> CreateDistantLight(const Transform &light2world,
                                                  const ParamSet &paramSet) {
-    Spectrum L = paramSet.FindOneSpectrum("L", Spectrum(1.0));
-    Spectrum sc = paramSet.FindOneSpectrum("scale", Spectrum(1.0));
+    SceneSpectrum L = paramSet.FindOneSpectrum("L", SceneSpectrum(1.0));
+    SceneSpectrum sc = paramSet.FindOneSpectrum("scale", SceneSpectrum(1.0));
     Point3f from = paramSet.FindOnePoint3f("from", Point3f(0, 0, 0));
     Point3f to = paramSet.FindOnePoint3f("to", Point3f(0, 0, 1));
     Vector3f dir = from - to;
@@ -50,7 +50,7 @@ namespace pbrt {
 class DistantLight : public Light {
   public:
     // DistantLight Public Methods
-    DistantLight(const Transform &LightToWorld, const Spectrum &L,
+    DistantLight(const Transform &LightToWorld, const SceneSpectrum &L,
                  const Vector3f &w);
     void Preprocess(const Scene &scene) {
         scene.WorldBound().BoundingSphere(&worldCenter, &worldRadius);
@@ -67,7 +67,7 @@ class DistantLight : public Light {
 
   private:
     // DistantLight Private Data
-    const Spectrum L;
+    const SceneSpectrum L;
     const Vector3f wLight;
     Point3f worldCenter;
     Float worldRadius;
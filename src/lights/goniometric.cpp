@@ -49,13 +49,20 @@ Spectrum GonioPhotometricLight::Sample_Li(const Interaction &ref,
     *pdf = 1.f;
     *vis =
         VisibilityTester(ref, Interaction(pLight, ref.time, mediumInterface));
-    return I * Scale(-*wi) / DistanceSquared(pLight, ref.p);
+    return Spectrum(I) * Scale(-*wi) / DistanceSquared(pLight, ref.p);
 }
 
 Spectrum GonioPhotometricLight::Power() const {
-    return 4 * Pi * I * Spectrum(mipmap ? mipmap->Lookup(Point2f(.5f, .5f), .5f)
-                                        : RGBSpectrum(1.f),
-                                 SpectrumType::Illuminant);
+    return 4 * Pi * Spectrum(I) *
+           Spectrum(mipmap ? mipmap->Lookup(Point2f(.5f, .5f), .5f)
+                           : RGBSpectrum(1.f),
+                    SpectrumType::Illuminant);
+}
+
+bool GonioPhotometricLight::Bounds(LightBounds *bounds) const {
+    *bounds = LightBounds(Bounds3f(pLight), Vector3f(0, 0, 1),
+                          Power().y() / (4 * Pi), -1, 0, false);
+    return true;
 }
 
 Float GonioPhotometricLight::Pdf_Li(const Interaction &,
@@ -73,7 +80,7 @@ Spectrum GonioPhotometricLight::Sample_Le(const Point2f &u1, const Point2f &u2,
     *nLight = (Normal3f)ray->d;
     *pdfPos = 1.f;
     *pdfDir = UniformSpherePdf();
-    return I * Scale(ray->d);
+    return Spectrum(I) * Scale(ray->d);
 }
 
 void GonioPhotometricLight::Pdf_Le(const Ray &, const Normal3f &, Float *pdfPos,
@@ -86,8 +93,8 @@ void GonioPhotometricLight::Pdf_Le(const Ray &, const Normal3f &, Float *pdfPos,
 std::shared_ptr<GonioPhotometricLight> CreateGoniometricLight(
     const Transform &light2world, const Medium *medium,
     const ParamSet &paramSet) {
-    Spectrum I = paramSet.FindOneSpectrum("I", Spectrum(1.0));
-    Spectrum sc = paramSet.FindOneSpectrum("scale", Spectrum(1.0));
+    SceneSpectrum I = paramSet.FindOneSpectrum("I", SceneSpectrum(1.0));
+    SceneSpectrum sc = paramSet.FindOneSpectrum("scale", SceneSpectrum(1.0));
     std::string texname = paramSet.FindOneFilename("mapname", "");
     return std::make_shared<GonioPhotometricLight>(light2world, medium, I * sc,
                                                    texname);
@@ -56,7 +56,7 @@ class GonioPhotometricLight : public Light {
                        Float *pdf, VisibilityTester *vis) const;
     GonioPhotometricLight(const Transform &LightToWorld,
                           const MediumInterface &mediumInterface,
-                          const Spectrum &I, const std::string &texname)
+                          const SceneSpectrum &I, const std::string &texname)
         : Light((int)LightFlags::DeltaPosition, LightToWorld, mediumInterface),
           pLight(LightToWorld(Point3f(0, 0, 0))),
           I(I) {
@@ -82,11 +82,12 @@ class GonioPhotometricLight : public Light {
                        Float *pdfDir) const;
     void Pdf_Le(const Ray &, const Normal3f &, Float *pdfPos,
                 Float *pdfDir) const;
+    bool Bounds(LightBounds *bounds) const;
 
   private:
     // GonioPhotometricLight Private Data
     const Point3f pLight;
-    const Spectrum I;
+    const SceneSpectrum I;
     std::unique_ptr<MIPMap<RGBSpectrum>> mipmap;
 };
 
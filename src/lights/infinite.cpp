@@ -34,17 +34,31 @@
 #include "lights/infinite.h"
 #include "imageio.h"
 #include "paramset.h"
+#include "parallel.h"
+#include "rng.h"
 #include "sampling.h"
 #include "stats.h"
 
 namespace pbrt {
 
+STAT_COUNTER("Lights/Infinite light guide voxels", nGuideVoxels);
+STAT_COUNTER("Lights/Infinite light guide rays", nGuideRays);
+
+// Number of shadow rays traced to each cell, and the smallest fraction of
+// a cell's sampling weight that's kept however occluded it appears, which
+// ensures that all directions with nonzero radiance can be sampled
+static PBRT_CONSTEXPR int GuideRaysPerCell = 4;
+static PBRT_CONSTEXPR Float MinGuideWeight = 0.05f;
+
 // InfiniteAreaLight Method Definitions
 InfiniteAreaLight::InfiniteAreaLight(const Transform &LightToWorld,
-                                     const Spectrum &L, int nSamples,
-                                     const std::string &texmap)
+                                     const SceneSpectrum &L, int nSamples,
+                                     const std::string &texmap,
+                                     bool hierarchical, int guideVoxels)
     : Light((int)LightFlags::Infinite, LightToWorld, MediumInterface(),
-            nSamples) {
+            nSamples),
+      hierarchical(hierarchical || guideVoxels > 0),
+      guideVoxels(guideVoxels) {
     // Read texel data from _texmap_ and initialize _Lmap_
     Point2i resolution;
     std::unique_ptr<RGBSpectrum[]> texels(nullptr);
@@ -64,8 +78,9 @@ InfiniteAreaLight::InfiniteAreaLight(const Transform &LightToWorld,
     // Initialize sampling PDFs for infinite area light
 
     // Compute scalar-valued image _img_ from environment map
-    int width = 2 * Lmap->Width(), height = 2 * Lmap->Height();
-    std::unique_ptr<Float[]> img(new Float[width * height]);
+    width = 2 * Lmap->Width();
+    height = 2 * Lmap->Height();
+    std::vector<Float> img(width * height);
     float fwidth = 0.5f / std::min(width, height);
     ParallelFor(
         [&](int64_t v) {
@@ -79,8 +94,178 @@ InfiniteAreaLight::InfiniteAreaLight(const Transform &LightToWorld,
         },
         height, 32);
 
-    // Compute sampling distributions for rows and columns of image
-    distribution.reset(new Distribution2D(img.get(), width, height));
+    if (!this->hierarchical) {
+        // Compute sampling distributions for rows and columns of image
+        distribution.reset(new Distribution2D(&img[0], width, height));
+        return;
+    }
+
+    // Divide the image into cells and compute the running sums used to
+    // sample inside them; _img_'s storage is reused for _rowSums_
+    nCells[0] = std::min(width, 32);
+    nCells[1] = std::min(height, 16);
+    ParallelFor(
+        [&](int64_t v) {
+            Float *row = &img[v * width];
+            for (int u = 1; u < width; ++u)
+                if (CellU(u) == CellU(u - 1)) row[u] += row[u - 1];
+        },
+        height, 32);
+    rowSums = std::move(img);
+    colSums.resize(nCells[0] * height);
+    cellSums.resize(nCells[0] * nCells[1]);
+    for (int cx = 0; cx < nCells[0]; ++cx) {
+        int u1 = (cx + 1) * width / nCells[0];
+        Float *col = &colSums[cx * height];
+        for (int v = 0; v < height; ++v) {
+            col[v] = rowSums[v * width + u1 - 1];
+            if (v > 0 && CellV(v) == CellV(v - 1)) col[v] += col[v - 1];
+            cellSums[CellV(v) * nCells[0] + cx] = col[v];
+        }
+    }
+    cellTable = AliasTable(&cellSums[0], nCells[0] * nCells[1]);
+}
+
+InfiniteAreaLight::~InfiniteAreaLight() {
+    if (guides)
+        for (int i = 0; i < nVoxels[0] * nVoxels[1] * nVoxels[2]; ++i)
+            delete guides[i].load();
+}
+
+void InfiniteAreaLight::Preprocess(const Scene &scene) {
+    scene.WorldBound().BoundingSphere(&worldCenter, &worldRadius);
+    if (guideVoxels == 0) return;
+
+    // Set up the voxel grid for visibility guiding; as with the
+    // _SpatialLightDistribution_, voxels are roughly cube shaped.
+    this->scene = &scene;
+    worldBound = scene.WorldBound();
+    Vector3f diag = worldBound.Diagonal();
+    Float bmax = diag[worldBound.MaximumExtent()];
+    for (int i = 0; i < 3; ++i)
+        nVoxels[i] =
+            std::max(1, int(std::round(diag[i] / bmax * guideVoxels)));
+    int n = nVoxels[0] * nVoxels[1] * nVoxels[2];
+    guides.reset(new std::atomic<AliasTable *>[n]);
+    for (int i = 0; i < n; ++i) guides[i].store(nullptr);
+}
+
+Point2f InfiniteAreaLight::SampleMap(const Interaction *ref, const Point2f &u,
+                                     Float *mapPdf) const {
+    if (!hierarchical) return distribution->SampleContinuous(u, mapPdf);
+    // Choose a cell with the first sample dimension and then a point inside
+    // it with the remapped first dimension and the second one
+    Float cellPmf, pointPdf, u0;
+    int cell = CellDistribution(ref).Sample(u[0], &cellPmf, &u0);
+    if (cellPmf == 0 || cellSums[cell] == 0) {
+        *mapPdf = 0;
+        return Point2f(0, 0);
+    }
+    Point2f uv = SampleCell(cell % nCells[0], cell / nCells[0],
+                            Point2f(u0, u[1]), &pointPdf);
+    *mapPdf = cellPmf * pointPdf;
+    return uv;
+}
+
+Point2f InfiniteAreaLight::SampleCell(int cx, int cy, const Point2f &u,
+                                      Float *pdf) const {
+    int u0 = cx * width / nCells[0], u1 = (cx + 1) * width / nCells[0];
+    int v0 = cy * height / nCells[1], v1 = (cy + 1) * height / nCells[1];
+    // Find the row and then the texel whose running sums bracket the
+    // samples and the offsets inside them
+    const Float *col = &colSums[cx * height];
+    Float tv = u[1] * col[v1 - 1];
+    int v = std::min(int(std::upper_bound(col + v0, col + v1, tv) - col),
+                     v1 - 1);
+    Float rowStart = v > v0 ? col[v - 1] : 0;
+    Float dv = col[v] > rowStart ? (tv - rowStart) / (col[v] - rowStart) : 0;
+
+    const Float *row = &rowSums[v * width];
+    Float tu = u[0] * row[u1 - 1];
+    int iu = std::min(int(std::upper_bound(row + u0, row + u1, tu) - row),
+                      u1 - 1);
+    Float texelStart = iu > u0 ? row[iu - 1] : 0;
+    Float du =
+        row[iu] > texelStart ? (tu - texelStart) / (row[iu] - texelStart) : 0;
+
+    // Compute the PDF with respect to the whole image given the cell
+    Float cellSum = cellSums[cy * nCells[0] + cx];
+    *pdf = (row[iu] - texelStart) * Float(width * height) / cellSum;
+    return Point2f(std::min((iu + Clamp(du, 0, 1)) / width, OneMinusEpsilon),
+                   std::min((v + Clamp(dv, 0, 1)) / height, OneMinusEpsilon));
+}
+
+Float InfiniteAreaLight::MapPdf(const Interaction *ref,
+                                const Point2f &uv) const {
+    if (!hierarchical) return distribution->Pdf(uv);
+    int iu = Clamp(int(uv[0] * width), 0, width - 1);
+    int iv = Clamp(int(uv[1] * height), 0, height - 1);
+    int cx = CellU(iu), cy = CellV(iv);
+    Float cellSum = cellSums[cy * nCells[0] + cx];
+    if (cellSum == 0) return 0;
+    Float cellPmf = CellDistribution(ref).PMF(cy * nCells[0] + cx);
+    return cellPmf * Texel(iu, iv) * Float(width * height) / cellSum;
+}
+
+const AliasTable &InfiniteAreaLight::CellDistribution(
+    const Interaction *ref) const {
+    if (!ref || !guides) return cellTable;
+    // Find the guide for the voxel containing the reference point,
+    // computing it if this is the first time it's been needed
+    Vector3f offset = worldBound.Offset(ref->p);
+    int pi[3];
+    for (int i = 0; i < 3; ++i)
+        pi[i] = Clamp(int(offset[i] * nVoxels[i]), 0, nVoxels[i] - 1);
+    int voxel = (pi[2] * nVoxels[1] + pi[1]) * nVoxels[0] + pi[0];
+    AliasTable *guide = guides[voxel].load(std::memory_order_acquire);
+    if (!guide) {
+        // Another thread may compute the same guide concurrently; only
+        // one of them is kept.
+        AliasTable *newGuide = ComputeGuide(voxel);
+        if (guides[voxel].compare_exchange_strong(guide, newGuide))
+            guide = newGuide;
+        else
+            delete newGuide;
+    }
+    return *guide;
+}
+
+AliasTable *InfiniteAreaLight::ComputeGuide(int voxel) const {
+    ++nGuideVoxels;
+    int vx = voxel % nVoxels[0], vy = (voxel / nVoxels[0]) % nVoxels[1];
+    int vz = voxel / (nVoxels[0] * nVoxels[1]);
+    Bounds3f voxelBounds(
+        worldBound.Lerp(Point3f(Float(vx) / nVoxels[0], Float(vy) / nVoxels[1],
+                                Float(vz) / nVoxels[2])),
+        worldBound.Lerp(Point3f(Float(vx + 1) / nVoxels[0],
+                                Float(vy + 1) / nVoxels[1],
+                                Float(vz + 1) / nVoxels[2])));
+
+    // Weight each cell by the fraction of shadow rays from random points in
+    // the voxel toward directions sampled in it that escape the scene
+    RNG rng(voxel);
+    std::vector<Float> weights(nCells[0] * nCells[1]);
+    for (int c = 0; c < int(weights.size()); ++c) {
+        if (cellSums[c] == 0) continue;
+        int unoccluded = 0;
+        for (int i = 0; i < GuideRaysPerCell; ++i) {
+            Point3f p = voxelBounds.Lerp(Point3f(
+                rng.UniformFloat(), rng.UniformFloat(), rng.UniformFloat()));
+            Float pdf;
+            Point2f uv = SampleCell(
+                c % nCells[0], c / nCells[0],
+                Point2f(rng.UniformFloat(), rng.UniformFloat()), &pdf);
+            Float theta = uv[1] * Pi, phi = uv[0] * 2 * Pi;
+            Vector3f w = LightToWorld(SphericalDirection(
+                std::sin(theta), std::cos(theta), phi));
+            if (!scene->IntersectP(Ray(p, w))) ++unoccluded;
+        }
+        nGuideRays += GuideRaysPerCell;
+        weights[c] = cellSums[c] *
+                     (MinGuideWeight + (1 - MinGuideWeight) * unoccluded /
+                                           GuideRaysPerCell);
+    }
+    return new AliasTable(&weights[0], int(weights.size()));
 }
 
 Spectrum InfiniteAreaLight::Power() const {
@@ -101,7 +286,7 @@ Spectrum InfiniteAreaLight::Sample_Li(const Interaction &ref, const Point2f &u,
     ProfilePhase _(Prof::LightSample);
     // Find $(u,v)$ sample coordinates in infinite light texture
     Float mapPdf;
-    Point2f uv = distribution->SampleContinuous(u, &mapPdf);
+    Point2f uv = SampleMap(&ref, u, &mapPdf);
     if (mapPdf == 0) return Spectrum(0.f);
 
     // Convert infinite light sample point to direction
@@ -121,13 +306,14 @@ Spectrum InfiniteAreaLight::Sample_Li(const Interaction &ref, const Point2f &u,
     return Spectrum(Lmap->Lookup(uv), SpectrumType::Illuminant);
 }
 
-Float InfiniteAreaLight::Pdf_Li(const Interaction &, const Vector3f &w) const {
+Float InfiniteAreaLight::Pdf_Li(const Interaction &ref,
+                                const Vector3f &w) const {
     ProfilePhase _(Prof::LightPdf);
     Vector3f wi = WorldToLight(w);
     Float theta = SphericalTheta(wi), phi = SphericalPhi(wi);
     Float sinTheta = std::sin(theta);
     if (sinTheta == 0) return 0;
-    return distribution->Pdf(Point2f(phi * Inv2Pi, theta * InvPi)) /
+    return MapPdf(&ref, Point2f(phi * Inv2Pi, theta * InvPi)) /
            (2 * Pi * Pi * sinTheta);
 }
 
@@ -140,7 +326,7 @@ Spectrum InfiniteAreaLight::Sample_Le(const Point2f &u1, const Point2f &u2,
 
     // Find $(u,v)$ sample coordinates in infinite light texture
     Float mapPdf;
-    Point2f uv = distribution->SampleContinuous(u, &mapPdf);
+    Point2f uv = SampleMap(nullptr, u, &mapPdf);
     if (mapPdf == 0) return Spectrum(0.f);
     Float theta = uv[1] * Pi, phi = uv[0] * 2.f * Pi;
     Float cosTheta = std::cos(theta), sinTheta = std::sin(theta);
@@ -168,21 +354,30 @@ void InfiniteAreaLight::Pdf_Le(const Ray &ray, const Normal3f &, Float *pdfPos,
     Vector3f d = -WorldToLight(ray.d);
     Float theta = SphericalTheta(d), phi = SphericalPhi(d);
     Point2f uv(phi * Inv2Pi, theta * InvPi);
-    Float mapPdf = distribution->Pdf(uv);
+    Float mapPdf = MapPdf(nullptr, uv);
     *pdfDir = mapPdf / (2 * Pi * Pi * std::sin(theta));
     *pdfPos = 1 / (Pi * worldRadius * worldRadius);
 }
 
 std::shared_ptr<InfiniteAreaLight> CreateInfiniteLight(
     const Transform &light2world, const ParamSet &paramSet) {
-    Spectrum L = paramSet.FindOneSpectrum("L", Spectrum(1.0));
-    Spectrum sc = paramSet.FindOneSpectrum("scale", Spectrum(1.0));
+    SceneSpectrum L = paramSet.FindOneSpectrum("L", SceneSpectrum(1.0));
+    SceneSpectrum sc = paramSet.FindOneSpectrum("scale", SceneSpectrum(1.0));
     std::string texmap = paramSet.FindOneFilename("mapname", "");
     int nSamples = paramSet.FindOneInt("samples",
                                        paramSet.FindOneInt("nsamples", 1));
     if (PbrtOptions.quickRender) nSamples = std::max(1, nSamples / 4);
+    std::string sampling = paramSet.FindOneString("sampling", "distribution");
+    if (sampling != "distribution" && sampling != "hierarchical") {
+        Warning("Infinite light sampling method \"%s\" unknown. Using "
+                "\"distribution\".", sampling.c_str());
+        sampling = "distribution";
+    }
+    int guideVoxels = paramSet.FindOneInt("guidevoxels", 0);
     return std::make_shared<InfiniteAreaLight>(light2world, L * sc, nSamples,
-                                               texmap);
+                                               texmap,
+                                               sampling == "hierarchical",
+                                               guideVoxels);
 }
 
 }  // namespace pbrt
@@ -45,6 +45,8 @@
 #include "shape.h"
 #include "scene.h"
 #include "mipmap.h"
+#include "sampling.h"
+#include <atomic>
 
 namespace pbrt {
 
@@ -52,11 +54,11 @@ namespace pbrt {
 class InfiniteAreaLight : public Light {
   public:
     // InfiniteAreaLight Public Methods
-    InfiniteAreaLight(const Transform &LightToWorld, const Spectrum &power,
-                      int nSamples, const std::string &texmap);
-    void Preprocess(const Scene &scene) {
-        scene.WorldBound().BoundingSphere(&worldCenter, &worldRadius);
-    }
+    InfiniteAreaLight(const Transform &LightToWorld, const SceneSpectrum &power,
+                      int nSamples, const std::string &texmap,
+                      bool hierarchical = false, int guideVoxels = 0);
+    ~InfiniteAreaLight();
+    void Preprocess(const Scene &scene);
     Spectrum Power() const;
     Spectrum Le(const RayDifferential &ray) const;
     Spectrum Sample_Li(const Interaction &ref, const Point2f &u, Vector3f *wi,
@@ -69,11 +71,49 @@ class InfiniteAreaLight : public Light {
                 Float *pdfDir) const;
 
   private:
+    // InfiniteAreaLight Private Methods
+    Point2f SampleMap(const Interaction *ref, const Point2f &u,
+                      Float *mapPdf) const;
+    Float MapPdf(const Interaction *ref, const Point2f &uv) const;
+    Point2f SampleCell(int cx, int cy, const Point2f &u, Float *pdf) const;
+    int CellU(int u) const { return ((u + 1) * nCells[0] - 1) / width; }
+    int CellV(int v) const { return ((v + 1) * nCells[1] - 1) / height; }
+    Float Texel(int u, int v) const {
+        int t = v * width + u;
+        bool cellStart = u == CellU(u) * width / nCells[0];
+        return cellStart ? rowSums[t] : rowSums[t] - rowSums[t - 1];
+    }
+    const AliasTable &CellDistribution(const Interaction *ref) const;
+    AliasTable *ComputeGuide(int voxel) const;
+
     // InfiniteAreaLight Private Data
     std::unique_ptr<MIPMap<RGBSpectrum>> Lmap;
     Point3f worldCenter;
     Float worldRadius;
     std::unique_ptr<Distribution2D> distribution;
+
+    // With hierarchical sampling, the sampling image is divided into a grid
+    // of cells. A cell is chosen in constant time with the _cellTable_
+    // alias table and the first sample dimension, and then a row and a
+    // texel inside it by searching running sums that restart at each cell
+    // boundary, which also give the image's values; _rowSums_ sums texels
+    // along rows and _colSums_ sums the rows' segments in each column of
+    // cells. Unlike with _distribution_, nearby samples may be mapped to
+    // distant cells, though they stay stratified inside each one.
+    const bool hierarchical;
+    int width, height, nCells[2];
+    std::vector<Float> rowSums, colSums, cellSums;
+    AliasTable cellTable;
+
+    // If _guideVoxels_ is nonzero, cells are instead chosen with
+    // distributions that are computed lazily for each voxel of a grid over
+    // the scene and that account for how much of each cell is occluded from
+    // the voxel.
+    const int guideVoxels;
+    const Scene *scene = nullptr;
+    Bounds3f worldBound;
+    int nVoxels[3];
+    mutable std::unique_ptr<std::atomic<AliasTable *>[]> guides;
 };
 
 std::shared_ptr<InfiniteAreaLight> CreateInfiniteLight(
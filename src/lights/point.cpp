@@ -49,15 +49,21 @@ Spectrum PointLight::Sample_Li(const Interaction &ref, const Point2f &u,
     *pdf = 1.f;
     *vis =
         VisibilityTester(ref, Interaction(pLight, ref.time, mediumInterface));
-    return I / DistanceSquared(pLight, ref.p);
+    return Spectrum(I) / DistanceSquared(pLight, ref.p);
 }
 
-Spectrum PointLight::Power() const { return 4 * Pi * I; }
+Spectrum PointLight::Power() const { return 4 * Pi * Spectrum(I); }
 
 Float PointLight::Pdf_Li(const Interaction &, const Vector3f &) const {
     return 0;
 }
 
+bool PointLight::Bounds(LightBounds *bounds) const {
+    *bounds = LightBounds(Bounds3f(pLight), Vector3f(0, 0, 1),
+                          Spectrum(I).y(), -1, 0, false);
+    return true;
+}
+
 Spectrum PointLight::Sample_Le(const Point2f &u1, const Point2f &u2, Float time,
                                Ray *ray, Normal3f *nLight, Float *pdfPos,
                                Float *pdfDir) const {
@@ -67,7 +73,7 @@ Spectrum PointLight::Sample_Le(const Point2f &u1, const Point2f &u2, Float time,
     *nLight = (Normal3f)ray->d;
     *pdfPos = 1;
     *pdfDir = UniformSpherePdf();
-    return I;
+    return Spectrum(I);
 }
 
 void PointLight::Pdf_Le(const Ray &, const Normal3f &, Float *pdfPos,
@@ -80,8 +86,8 @@ void PointLight::Pdf_Le(const Ray &, const Normal3f &, Float *pdfPos,
 std::shared_ptr<PointLight> CreatePointLight(const Transform &light2world,
                                              const Medium *medium,
                                              const ParamSet &paramSet) {
-    Spectrum I = paramSet.FindOneSpectrum("I", Spectrum(1.0));
-    Spectrum sc = paramSet.FindOneSpectrum("scale", Spectrum(1.0));
+    SceneSpectrum I = paramSet.FindOneSpectrum("I", SceneSpectrum(1.0));
+    SceneSpectrum sc = paramSet.FindOneSpectrum("scale", SceneSpectrum(1.0));
     Point3f P = paramSet.FindOnePoint3f("from", Point3f(0, 0, 0));
     Transform l2w = Translate(Vector3f(P.x, P.y, P.z)) * light2world;
     return std::make_shared<PointLight>(l2w, medium, I * sc);
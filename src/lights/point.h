@@ -50,7 +50,7 @@ class PointLight : public Light {
   public:
     // PointLight Public Methods
     PointLight(const Transform &LightToWorld,
-               const MediumInterface &mediumInterface, const Spectrum &I)
+               const MediumInterface &mediumInterface, const SceneSpectrum &I)
         : Light((int)LightFlags::DeltaPosition, LightToWorld, mediumInterface),
           pLight(LightToWorld(Point3f(0, 0, 0))),
           I(I) {}
@@ -63,11 +63,12 @@ class PointLight : public Light {
                        Float *pdfDir) const;
     void Pdf_Le(const Ray &, const Normal3f &, Float *pdfPos,
                 Float *pdfDir) const;
+    bool Bounds(LightBounds *bounds) const;
 
   private:
     // PointLight Private Data
     const Point3f pLight;
-    const Spectrum I;
+    const SceneSpectrum I;
 };
 
 std::shared_ptr<PointLight> CreatePointLight(const Transform &light2world,
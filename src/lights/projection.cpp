@@ -44,8 +44,8 @@ namespace pbrt {
 // ProjectionLight Method Definitions
 ProjectionLight::ProjectionLight(const Transform &LightToWorld,
                                  const MediumInterface &mediumInterface,
-                                 const Spectrum &I, const std::string &texname,
-                                 Float fov)
+                                 const SceneSpectrum &I,
+                                 const std::string &texname, Float fov)
     : Light((int)LightFlags::DeltaPosition, LightToWorld, mediumInterface),
       pLight(LightToWorld(Point3f(0, 0, 0))),
       I(I) {
@@ -81,7 +81,7 @@ Spectrum ProjectionLight::Sample_Li(const Interaction &ref, const Point2f &u,
     *pdf = 1;
     *vis =
         VisibilityTester(ref, Interaction(pLight, ref.time, mediumInterface));
-    return I * Projection(-*wi) / DistanceSquared(pLight, ref.p);
+    return Spectrum(I) * Projection(-*wi) / DistanceSquared(pLight, ref.p);
 }
 
 Spectrum ProjectionLight::Projection(const Vector3f &w) const {
@@ -102,7 +102,14 @@ Spectrum ProjectionLight::Power() const {
                 ? Spectrum(projectionMap->Lookup(Point2f(.5f, .5f), .5f),
                            SpectrumType::Illuminant)
                 : Spectrum(1.f)) *
-           I * 2 * Pi * (1.f - cosTotalWidth);
+           Spectrum(I) * 2 * Pi * (1.f - cosTotalWidth);
+}
+
+bool ProjectionLight::Bounds(LightBounds *bounds) const {
+    *bounds = LightBounds(Bounds3f(pLight), LightToWorld(Vector3f(0, 0, 1)),
+                          Power().y() / (2 * Pi * (1 - cosTotalWidth)),
+                          cosTotalWidth, 1, false);
+    return true;
 }
 
 Float ProjectionLight::Pdf_Li(const Interaction &, const Vector3f &) const {
@@ -118,7 +125,7 @@ Spectrum ProjectionLight::Sample_Le(const Point2f &u1, const Point2f &u2,
     *nLight = (Normal3f)ray->d;
     *pdfPos = 1.f;
     *pdfDir = UniformConePdf(cosTotalWidth);
-    return I * Projection(ray->d);
+    return Spectrum(I) * Projection(ray->d);
 }
 
 void ProjectionLight::Pdf_Le(const Ray &ray, const Normal3f &, Float *pdfPos,
@@ -133,8 +140,8 @@ void ProjectionLight::Pdf_Le(const Ray &ray, const Normal3f &, Float *pdfPos,
 std::shared_ptr<ProjectionLight> CreateProjectionLight(
     const Transform &light2world, const Medium *medium,
     const ParamSet &paramSet) {
-    Spectrum I = paramSet.FindOneSpectrum("I", Spectrum(1.0));
-    Spectrum sc = paramSet.FindOneSpectrum("scale", Spectrum(1.0));
+    SceneSpectrum I = paramSet.FindOneSpectrum("I", SceneSpectrum(1.0));
+    SceneSpectrum sc = paramSet.FindOneSpectrum("scale", SceneSpectrum(1.0));
     Float fov = paramSet.FindOneFloat("fov", 45.);
     std::string texname = paramSet.FindOneFilename("mapname", "");
     return std::make_shared<ProjectionLight>(light2world, medium, I * sc,
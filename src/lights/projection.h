@@ -51,7 +51,7 @@ class ProjectionLight : public Light {
   public:
     // ProjectionLight Public Methods
     ProjectionLight(const Transform &LightToWorld,
-                    const MediumInterface &medium, const Spectrum &I,
+                    const MediumInterface &medium, const SceneSpectrum &I,
                     const std::string &texname, Float fov);
     Spectrum Sample_Li(const Interaction &ref, const Point2f &u, Vector3f *wi,
                        Float *pdf, VisibilityTester *vis) const;
@@ -63,12 +63,13 @@ class ProjectionLight : public Light {
                        Float *pdfDir) const;
     void Pdf_Le(const Ray &, const Normal3f &, Float *pdfPos,
                 Float *pdfDir) const;
+    bool Bounds(LightBounds *bounds) const;
 
   private:
     // ProjectionLight Private Data
     std::unique_ptr<MIPMap<RGBSpectrum>> projectionMap;
     const Point3f pLight;
-    const Spectrum I;
+    const SceneSpectrum I;
     Transform lightProjection;
     Float hither, yon;
     Bounds2f screenBounds;
@@ -42,8 +42,9 @@ namespace pbrt {
 
 // SpotLight Method Definitions
 SpotLight::SpotLight(const Transform &LightToWorld,
-                     const MediumInterface &mediumInterface, const Spectrum &I,
-                     Float totalWidth, Float falloffStart)
+                     const MediumInterface &mediumInterface,
+                     const SceneSpectrum &I, Float totalWidth,
+                     Float falloffStart)
     : Light((int)LightFlags::DeltaPosition, LightToWorld, mediumInterface),
       pLight(LightToWorld(Point3f(0, 0, 0))),
       I(I),
@@ -58,7 +59,7 @@ Spectrum SpotLight::Sample_Li(const Interaction &ref, const Point2f &u,
     *pdf = 1.f;
     *vis =
         VisibilityTester(ref, Interaction(pLight, ref.time, mediumInterface));
-    return I * Falloff(-*wi) / DistanceSquared(pLight, ref.p);
+    return Spectrum(I) * Falloff(-*wi) / DistanceSquared(pLight, ref.p);
 }
 
 Float SpotLight::Falloff(const Vector3f &w) const {
@@ -73,7 +74,18 @@ Float SpotLight::Falloff(const Vector3f &w) const {
 }
 
 Spectrum SpotLight::Power() const {
-    return I * 2 * Pi * (1 - .5f * (cosFalloffStart + cosTotalWidth));
+    return Spectrum(I) * 2 * Pi * (1 - .5f * (cosFalloffStart + cosTotalWidth));
+}
+
+bool SpotLight::Bounds(LightBounds *bounds) const {
+    // Emission at full intensity is bounded by the falloff start cone and
+    // extends out to the total width
+    Float cosTheta_e = std::cos(std::acos(cosTotalWidth) -
+                                std::acos(cosFalloffStart));
+    *bounds = LightBounds(Bounds3f(pLight), LightToWorld(Vector3f(0, 0, 1)),
+                          Spectrum(I).y(), cosFalloffStart, cosTheta_e,
+                          false);
+    return true;
 }
 
 Float SpotLight::Pdf_Li(const Interaction &, const Vector3f &) const {
@@ -89,7 +101,7 @@ Spectrum SpotLight::Sample_Le(const Point2f &u1, const Point2f &u2, Float time,
     *nLight = (Normal3f)ray->d;
     *pdfPos = 1;
     *pdfDir = UniformConePdf(cosTotalWidth);
-    return I * Falloff(ray->d);
+    return Spectrum(I) * Falloff(ray->d);
 }
 
 void SpotLight::Pdf_Le(const Ray &ray, const Normal3f &, Float *pdfPos,
@@ -104,8 +116,8 @@ void SpotLight::Pdf_Le(const Ray &ray, const Normal3f &, Float *pdfPos,
 std::shared_ptr<SpotLight> CreateSpotLight(const Transform &l2w,
                                            const Medium *medium,
                                            const ParamSet &paramSet) {
-    Spectrum I = paramSet.FindOneSpectrum("I", Spectrum(1.0));
-    Spectrum sc = paramSet.FindOneSpectrum("scale", Spectrum(1.0));
+    SceneSpectrum I = paramSet.FindOneSpectrum("I", SceneSpectrum(1.0));
+    SceneSpectrum sc = paramSet.FindOneSpectrum("scale", SceneSpectrum(1.0));
     Float coneangle = paramSet.FindOneFloat("coneangle", 30.);
     Float conedelta = paramSet.FindOneFloat("conedeltaangle", 5.);
     // Compute spotlight world to light transformation
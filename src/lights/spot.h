@@ -50,7 +50,7 @@ class SpotLight : public Light {
   public:
     // SpotLight Public Methods
     SpotLight(const Transform &LightToWorld, const MediumInterface &m,
-              const Spectrum &I, Float totalWidth, Float falloffStart);
+              const SceneSpectrum &I, Float totalWidth, Float falloffStart);
     Spectrum Sample_Li(const Interaction &ref, const Point2f &u, Vector3f *wi,
                        Float *pdf, VisibilityTester *vis) const;
     Float Falloff(const Vector3f &w) const;
@@ -61,11 +61,12 @@ class SpotLight : public Light {
                        Float *pdfDir) const;
     void Pdf_Le(const Ray &, const Normal3f &, Float *pdfPos,
                 Float *pdfDir) const;
+    bool Bounds(LightBounds *bounds) const;
 
   private:
     // SpotLight Private Data
     const Point3f pLight;
-    const Spectrum I;
+    const SceneSpectrum I;
     const Float cosTotalWidth, cosFalloffStart;
 };
 
@@ -46,13 +46,33 @@ static void usage(const char *msg = nullptr) {
 
     fprintf(stderr, R"(usage: pbrt [<options>] <filename.pbrt...>
 Rendering options:
+  --aliassampling      Sample lights and other discrete distributions with
+                       alias tables, in constant time, rather than by
+                       searching their CDFs.
+  --checkpoint <sec>   Save render progress to <outfile>.checkpoint every
+                       <sec> seconds so that the render can be resumed.
   --cropwindow <x0,x1,y0,y1> Specify an image crop window.
   --help               Print this help text.
+  --hugepages          Back per-thread memory arenas with huge pages, if
+                       the operating system supports them.
+  --node <index>       Render only the <index>th of the tile ranges given by
+                       --nodecount and write raw film sums to
+                       <outfile>.<index>-of-<count>.film, to be combined with
+                       "imgtool merge". Default: 0
+  --nodecount <num>    Number of processes a distributed render is split
+                       across. Default: 1
   --nthreads <num>     Use specified number of threads for rendering.
   --outfile <filename> Write the final image to the given filename.
+  --ptexcache <MB>     Memory used to cache Ptex texture data. Default: 4096
+  --ptexfiles <num>    Maximum number of Ptex files kept open. Default: 100
   --quick              Automatically reduce a number of quality settings to
                        render more quickly.
   --quiet              Suppress all text output other than error messages.
+  --resume             Continue the render from its last checkpoint, if
+                       there is one.
+  --texturecache <MB>  Memory used to cache the tiles of tiled, MIP-mapped
+                       OpenEXR textures (see "imgtool makemipmap").
+                       Default: 512
 
 Logging options:
   --logdir <dir>       Specify directory that log files should be written to.
@@ -87,6 +107,55 @@ int main(int argc, char *argv[]) {
             options.nThreads = atoi(argv[++i]);
         } else if (!strncmp(argv[i], "--nthreads=", 11)) {
             options.nThreads = atoi(&argv[i][11]);
+        } else if (!strcmp(argv[i], "--checkpoint") ||
+                   !strcmp(argv[i], "-checkpoint")) {
+            if (i + 1 == argc)
+                usage("missing value after --checkpoint argument");
+            options.checkpointInterval = atof(argv[++i]);
+        } else if (!strncmp(argv[i], "--checkpoint=", 13)) {
+            options.checkpointInterval = atof(&argv[i][13]);
+        } else if (!strcmp(argv[i], "--resume") || !strcmp(argv[i], "-resume")) {
+            options.resume = true;
+        } else if (!strcmp(argv[i], "--hugepages") ||
+                   !strcmp(argv[i], "-hugepages")) {
+            options.hugePages = true;
+        } else if (!strcmp(argv[i], "--aliassampling") ||
+                   !strcmp(argv[i], "-aliassampling")) {
+            options.aliasSampling = true;
+        } else if (!strcmp(argv[i], "--node") || !strcmp(argv[i], "-node")) {
+            if (i + 1 == argc)
+                usage("missing value after --node argument");
+            options.nodeIndex = atoi(argv[++i]);
+        } else if (!strncmp(argv[i], "--node=", 7)) {
+            options.nodeIndex = atoi(&argv[i][7]);
+        } else if (!strcmp(argv[i], "--nodecount") ||
+                   !strcmp(argv[i], "-nodecount")) {
+            if (i + 1 == argc)
+                usage("missing value after --nodecount argument");
+            options.nodeCount = atoi(argv[++i]);
+        } else if (!strncmp(argv[i], "--nodecount=", 12)) {
+            options.nodeCount = atoi(&argv[i][12]);
+        } else if (!strcmp(argv[i], "--texturecache") ||
+                   !strcmp(argv[i], "-texturecache")) {
+            if (i + 1 == argc)
+                usage("missing value after --texturecache argument");
+            options.textureCacheMB = atoi(argv[++i]);
+        } else if (!strncmp(argv[i], "--texturecache=", 15)) {
+            options.textureCacheMB = atoi(&argv[i][15]);
+        } else if (!strcmp(argv[i], "--ptexcache") ||
+                   !strcmp(argv[i], "-ptexcache")) {
+            if (i + 1 == argc)
+                usage("missing value after --ptexcache argument");
+            options.ptexCacheMB = atoi(argv[++i]);
+        } else if (!strncmp(argv[i], "--ptexcache=", 12)) {
+            options.ptexCacheMB = atoi(&argv[i][12]);
+        } else if (!strcmp(argv[i], "--ptexfiles") ||
+                   !strcmp(argv[i], "-ptexfiles")) {
+            if (i + 1 == argc)
+                usage("missing value after --ptexfiles argument");
+            options.ptexMaxFiles = atoi(argv[++i]);
+        } else if (!strncmp(argv[i], "--ptexfiles=", 12)) {
+            options.ptexMaxFiles = atoi(&argv[i][12]);
         } else if (!strcmp(argv[i], "--outfile") || !strcmp(argv[i], "-outfile")) {
             if (i + 1 == argc)
                 usage("missing value after --outfile argument");
@@ -138,6 +207,18 @@ int main(int argc, char *argv[]) {
             filenames.push_back(argv[i]);
     }
 
+    if (options.nodeCount < 1 || options.nodeIndex < 0 ||
+        options.nodeIndex >= options.nodeCount)
+        usage("--node must be between 0 and --nodecount - 1");
+    if (options.checkpointInterval < 0)
+        usage("--checkpoint interval must not be negative");
+    if (options.textureCacheMB <= 0)
+        usage("--texturecache size must be positive");
+    if (options.ptexCacheMB <= 0)
+        usage("--ptexcache size must be positive");
+    if (options.ptexMaxFiles <= 0)
+        usage("--ptexfiles count must be positive");
+
     // Print welcome banner
     if (!options.quiet && !options.cat && !options.toPly) {
         if (sizeof(void *) == 4)
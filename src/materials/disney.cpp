@@ -588,7 +588,7 @@ void DisneyMaterial::ComputeScatteringFunctions(SurfaceInteraction *si,
 
 DisneyMaterial *CreateDisneyMaterial(const TextureParams &mp) {
     std::shared_ptr<Texture<Spectrum>> color =
-        mp.GetSpectrumTexture("color", Spectrum(0.5f));
+        mp.GetSpectrumTexture("color", SceneSpectrum(0.5f));
     std::shared_ptr<Texture<Float>> metallic =
         mp.GetFloatTexture("metallic", 0.f);
     std::shared_ptr<Texture<Float>> eta = mp.GetFloatTexture("eta", 1.5f);
@@ -608,7 +608,7 @@ DisneyMaterial *CreateDisneyMaterial(const TextureParams &mp) {
     std::shared_ptr<Texture<Float>> specTrans =
         mp.GetFloatTexture("spectrans", 0.f);
     std::shared_ptr<Texture<Spectrum>> scatterDistance =
-        mp.GetSpectrumTexture("scatterdistance", Spectrum(0.));
+        mp.GetSpectrumTexture("scatterdistance", SceneSpectrum(0.));
     bool thin = mp.FindBool("thin", false);
     std::shared_ptr<Texture<Float>> flatness =
         mp.GetFloatTexture("flatness", 0.f);
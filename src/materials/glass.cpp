@@ -93,9 +93,9 @@ void GlassMaterial::ComputeScatteringFunctions(SurfaceInteraction *si,
 
 GlassMaterial *CreateGlassMaterial(const TextureParams &mp) {
     std::shared_ptr<Texture<Spectrum>> Kr =
-        mp.GetSpectrumTexture("Kr", Spectrum(1.f));
+        mp.GetSpectrumTexture("Kr", SceneSpectrum(1.f));
     std::shared_ptr<Texture<Spectrum>> Kt =
-        mp.GetSpectrumTexture("Kt", Spectrum(1.f));
+        mp.GetSpectrumTexture("Kt", SceneSpectrum(1.f));
     std::shared_ptr<Texture<Float>> eta = mp.GetFloatTextureOrNull("eta");
     if (!eta) eta = mp.GetFloatTexture("index", 1.5f);
     std::shared_ptr<Texture<Float>> roughu =
@@ -210,8 +210,7 @@ HairMaterial *CreateHairMaterial(const TextureParams &mp) {
                 "\"eumelanin\"/\"pheomelanin\" was provided.");
     } else {
         // Default: brown-ish hair.
-        sigma_a = std::make_shared<ConstantTexture<Spectrum>>(
-            HairBSDF::SigmaAFromConcentration(1.3, 0.));
+        eumelanin = std::make_shared<ConstantTexture<Float>>(1.3f);
     }
 
     std::shared_ptr<Texture<Float>> eta = mp.GetFloatTexture("eta", 1.55f);
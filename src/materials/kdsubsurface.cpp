@@ -100,13 +100,13 @@ void KdSubsurfaceMaterial::ComputeScatteringFunctions(
 KdSubsurfaceMaterial *CreateKdSubsurfaceMaterial(const TextureParams &mp) {
     Float Kd[3] = {.5, .5, .5};
     std::shared_ptr<Texture<Spectrum>> kd =
-        mp.GetSpectrumTexture("Kd", Spectrum::FromRGB(Kd));
+        mp.GetSpectrumTexture("Kd", SceneSpectrum::FromRGB(Kd));
     std::shared_ptr<Texture<Spectrum>> mfp =
-        mp.GetSpectrumTexture("mfp", Spectrum(1.f));
+        mp.GetSpectrumTexture("mfp", SceneSpectrum(1.f));
     std::shared_ptr<Texture<Spectrum>> kr =
-        mp.GetSpectrumTexture("Kr", Spectrum(1.f));
+        mp.GetSpectrumTexture("Kr", SceneSpectrum(1.f));
     std::shared_ptr<Texture<Spectrum>> kt =
-        mp.GetSpectrumTexture("Kt", Spectrum(1.f));
+        mp.GetSpectrumTexture("Kt", SceneSpectrum(1.f));
     std::shared_ptr<Texture<Float>> roughu =
         mp.GetFloatTexture("uroughness", 0.f);
     std::shared_ptr<Texture<Float>> roughv =
@@ -63,7 +63,7 @@ void MatteMaterial::ComputeScatteringFunctions(SurfaceInteraction *si,
 
 MatteMaterial *CreateMatteMaterial(const TextureParams &mp) {
     std::shared_ptr<Texture<Spectrum>> Kd =
-        mp.GetSpectrumTexture("Kd", Spectrum(0.5f));
+        mp.GetSpectrumTexture("Kd", SceneSpectrum(0.5f));
     std::shared_ptr<Texture<Float>> sigma = mp.GetFloatTexture("sigma", 0.f);
     std::shared_ptr<Texture<Float>> bumpMap =
         mp.GetFloatTextureOrNull("bumpmap");
@@ -57,7 +57,7 @@ void MirrorMaterial::ComputeScatteringFunctions(SurfaceInteraction *si,
 
 MirrorMaterial *CreateMirrorMaterial(const TextureParams &mp) {
     std::shared_ptr<Texture<Spectrum>> Kr =
-        mp.GetSpectrumTexture("Kr", Spectrum(0.9f));
+        mp.GetSpectrumTexture("Kr", SceneSpectrum(0.9f));
     std::shared_ptr<Texture<Float>> bumpMap =
         mp.GetFloatTextureOrNull("bumpmap");
     return new MirrorMaterial(Kr, bumpMap);
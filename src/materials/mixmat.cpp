@@ -67,7 +67,7 @@ MixMaterial *CreateMixMaterial(const TextureParams &mp,
                                const std::shared_ptr<Material> &m1,
                                const std::shared_ptr<Material> &m2) {
     std::shared_ptr<Texture<Spectrum>> scale =
-        mp.GetSpectrumTexture("amount", Spectrum(0.5f));
+        mp.GetSpectrumTexture("amount", SceneSpectrum(0.5f));
     return new MixMaterial(m1, m2, scale);
 }
 
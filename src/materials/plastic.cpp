@@ -71,9 +71,9 @@ void PlasticMaterial::ComputeScatteringFunctions(
 
 PlasticMaterial *CreatePlasticMaterial(const TextureParams &mp) {
     std::shared_ptr<Texture<Spectrum>> Kd =
-        mp.GetSpectrumTexture("Kd", Spectrum(0.25f));
+        mp.GetSpectrumTexture("Kd", SceneSpectrum(0.25f));
     std::shared_ptr<Texture<Spectrum>> Ks =
-        mp.GetSpectrumTexture("Ks", Spectrum(0.25f));
+        mp.GetSpectrumTexture("Ks", SceneSpectrum(0.25f));
     std::shared_ptr<Texture<Float>> roughness =
         mp.GetFloatTexture("roughness", .1f);
     std::shared_ptr<Texture<Float>> bumpMap =
@@ -66,9 +66,9 @@ void SubstrateMaterial::ComputeScatteringFunctions(
 
 SubstrateMaterial *CreateSubstrateMaterial(const TextureParams &mp) {
     std::shared_ptr<Texture<Spectrum>> Kd =
-        mp.GetSpectrumTexture("Kd", Spectrum(.5f));
+        mp.GetSpectrumTexture("Kd", SceneSpectrum(.5f));
     std::shared_ptr<Texture<Spectrum>> Ks =
-        mp.GetSpectrumTexture("Ks", Spectrum(.5f));
+        mp.GetSpectrumTexture("Ks", SceneSpectrum(.5f));
     std::shared_ptr<Texture<Float>> uroughness =
         mp.GetFloatTexture("uroughness", .1f);
     std::shared_ptr<Texture<Float>> vroughness =
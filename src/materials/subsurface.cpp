@@ -100,8 +100,8 @@ void SubsurfaceMaterial::ComputeScatteringFunctions(
 SubsurfaceMaterial *CreateSubsurfaceMaterial(const TextureParams &mp) {
     Float sig_a_rgb[3] = {.0011f, .0024f, .014f},
           sig_s_rgb[3] = {2.55f, 3.21f, 3.77f};
-    Spectrum sig_a = Spectrum::FromRGB(sig_a_rgb),
-             sig_s = Spectrum::FromRGB(sig_s_rgb);
+    SceneSpectrum sig_a = SceneSpectrum::FromRGB(sig_a_rgb),
+                  sig_s = SceneSpectrum::FromRGB(sig_s_rgb);
     std::string name = mp.FindString("name");
     bool found = GetMediumScatteringProperties(name, &sig_a, &sig_s);
     Float g = mp.FindFloat("g", 0.0f);
@@ -120,9 +120,9 @@ SubsurfaceMaterial *CreateSubsurfaceMaterial(const TextureParams &mp) {
     sigma_a = mp.GetSpectrumTexture("sigma_a", sig_a);
     sigma_s = mp.GetSpectrumTexture("sigma_s", sig_s);
     std::shared_ptr<Texture<Spectrum>> Kr =
-        mp.GetSpectrumTexture("Kr", Spectrum(1.f));
+        mp.GetSpectrumTexture("Kr", SceneSpectrum(1.f));
     std::shared_ptr<Texture<Spectrum>> Kt =
-        mp.GetSpectrumTexture("Kt", Spectrum(1.f));
+        mp.GetSpectrumTexture("Kt", SceneSpectrum(1.f));
     std::shared_ptr<Texture<Float>> roughu =
         mp.GetFloatTexture("uroughness", 0.f);
     std::shared_ptr<Texture<Float>> roughv =
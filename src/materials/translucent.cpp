@@ -81,13 +81,13 @@ void TranslucentMaterial::ComputeScatteringFunctions(
 
 TranslucentMaterial *CreateTranslucentMaterial(const TextureParams &mp) {
     std::shared_ptr<Texture<Spectrum>> Kd =
-        mp.GetSpectrumTexture("Kd", Spectrum(0.25f));
+        mp.GetSpectrumTexture("Kd", SceneSpectrum(0.25f));
     std::shared_ptr<Texture<Spectrum>> Ks =
-        mp.GetSpectrumTexture("Ks", Spectrum(0.25f));
+        mp.GetSpectrumTexture("Ks", SceneSpectrum(0.25f));
     std::shared_ptr<Texture<Spectrum>> reflect =
-        mp.GetSpectrumTexture("reflect", Spectrum(0.5f));
+        mp.GetSpectrumTexture("reflect", SceneSpectrum(0.5f));
     std::shared_ptr<Texture<Spectrum>> transmit =
-        mp.GetSpectrumTexture("transmit", Spectrum(0.5f));
+        mp.GetSpectrumTexture("transmit", SceneSpectrum(0.5f));
     std::shared_ptr<Texture<Float>> roughness =
         mp.GetFloatTexture("roughness", .1f);
     std::shared_ptr<Texture<Float>> bumpMap =
@@ -102,13 +102,13 @@ void UberMaterial::ComputeScatteringFunctions(SurfaceInteraction *si,
 
 UberMaterial *CreateUberMaterial(const TextureParams &mp) {
     std::shared_ptr<Texture<Spectrum>> Kd =
-        mp.GetSpectrumTexture("Kd", Spectrum(0.25f));
+        mp.GetSpectrumTexture("Kd", SceneSpectrum(0.25f));
     std::shared_ptr<Texture<Spectrum>> Ks =
-        mp.GetSpectrumTexture("Ks", Spectrum(0.25f));
+        mp.GetSpectrumTexture("Ks", SceneSpectrum(0.25f));
     std::shared_ptr<Texture<Spectrum>> Kr =
-        mp.GetSpectrumTexture("Kr", Spectrum(0.f));
+        mp.GetSpectrumTexture("Kr", SceneSpectrum(0.f));
     std::shared_ptr<Texture<Spectrum>> Kt =
-        mp.GetSpectrumTexture("Kt", Spectrum(0.f));
+        mp.GetSpectrumTexture("Kt", SceneSpectrum(0.f));
     std::shared_ptr<Texture<Float>> roughness =
         mp.GetFloatTexture("roughness", .1f);
     std::shared_ptr<Texture<Float>> uroughness =
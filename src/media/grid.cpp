@@ -80,7 +80,7 @@ Spectrum GridDensityMedium::Sample(const Ray &rWorld, Sampler &sampler,
             PhaseFunction *phase = ARENA_ALLOC(arena, HenyeyGreenstein)(g);
             *mi = MediumInteraction(rWorld(t), -rWorld.d, rWorld.time, this,
                                     phase);
-            return sigma_s / sigma_t;
+            return Spectrum(sigma_s) / sigma_t;
         }
     }
     return Spectrum(1.f);
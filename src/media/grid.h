@@ -51,9 +51,9 @@ STAT_MEMORY_COUNTER("Memory/Volume density grid", densityBytes);
 class GridDensityMedium : public Medium {
   public:
     // GridDensityMedium Public Methods
-    GridDensityMedium(const Spectrum &sigma_a, const Spectrum &sigma_s, Float g,
-                      int nx, int ny, int nz, const Transform &mediumToWorld,
-                      const Float *d)
+    GridDensityMedium(const SceneSpectrum &sigma_a,
+                      const SceneSpectrum &sigma_s, Float g, int nx, int ny,
+                      int nz, const Transform &mediumToWorld, const Float *d)
         : sigma_a(sigma_a),
           sigma_s(sigma_s),
           g(g),
@@ -66,7 +66,7 @@ class GridDensityMedium : public Medium {
         memcpy((Float *)density.get(), d, sizeof(Float) * nx * ny * nz);
         // Precompute values for Monte Carlo sampling of _GridDensityMedium_
         sigma_t = (sigma_a + sigma_s)[0];
-        if (Spectrum(sigma_t) != sigma_a + sigma_s)
+        if (SceneSpectrum(sigma_t) != sigma_a + sigma_s)
             Error(
                 "GridDensityMedium requires a spectrally uniform attenuation "
                 "coefficient!");
@@ -88,7 +88,7 @@ class GridDensityMedium : public Medium {
 
   private:
     // GridDensityMedium Private Data
-    const Spectrum sigma_a, sigma_s;
+    const SceneSpectrum sigma_a, sigma_s;
     const Float g;
     const int nx, ny, nz;
     const Transform WorldToMedium;
@@ -43,17 +43,19 @@ namespace pbrt {
 // HomogeneousMedium Method Definitions
 Spectrum HomogeneousMedium::Tr(const Ray &ray, Sampler &sampler) const {
     ProfilePhase _(Prof::MediumTr);
-    return Exp(-sigma_t * std::min(ray.tMax * ray.d.Length(), MaxFloat));
+    return Exp(-Spectrum(sigma_t) *
+               std::min(ray.tMax * ray.d.Length(), MaxFloat));
 }
 
 Spectrum HomogeneousMedium::Sample(const Ray &ray, Sampler &sampler,
                                    MemoryArena &arena,
                                    MediumInteraction *mi) const {
     ProfilePhase _(Prof::MediumSample);
+    Spectrum sig_t(sigma_t);
     // Sample a channel and distance along the ray
     int channel = std::min((int)(sampler.Get1D() * Spectrum::nSamples),
                            Spectrum::nSamples - 1);
-    Float dist = -std::log(1 - sampler.Get1D()) / sigma_t[channel];
+    Float dist = -std::log(1 - sampler.Get1D()) / sig_t[channel];
     Float t = std::min(dist / ray.d.Length(), ray.tMax);
     bool sampledMedium = t < ray.tMax;
     if (sampledMedium)
@@ -61,10 +63,10 @@ Spectrum HomogeneousMedium::Sample(const Ray &ray, Sampler &sampler,
                                 ARENA_ALLOC(arena, HenyeyGreenstein)(g));
 
     // Compute the transmittance and sampling density
-    Spectrum Tr = Exp(-sigma_t * std::min(t, MaxFloat) * ray.d.Length());
+    Spectrum Tr = Exp(-sig_t * std::min(t, MaxFloat) * ray.d.Length());
 
     // Return weighting factor for scattering from homogeneous medium
-    Spectrum density = sampledMedium ? (sigma_t * Tr) : Tr;
+    Spectrum density = sampledMedium ? (sig_t * Tr) : Tr;
     Float pdf = 0;
     for (int i = 0; i < Spectrum::nSamples; ++i) pdf += density[i];
     pdf *= 1 / (Float)Spectrum::nSamples;
@@ -72,7 +74,7 @@ Spectrum HomogeneousMedium::Sample(const Ray &ray, Sampler &sampler,
         CHECK(Tr.IsBlack());
         pdf = 1;
     }
-    return sampledMedium ? (Tr * sigma_s / pdf) : (Tr / pdf);
+    return sampledMedium ? (Tr * Spectrum(sigma_s) / pdf) : (Tr / pdf);
 }
 
 }  // namespace pbrt
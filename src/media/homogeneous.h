@@ -47,7 +47,8 @@ namespace pbrt {
 class HomogeneousMedium : public Medium {
   public:
     // HomogeneousMedium Public Methods
-    HomogeneousMedium(const Spectrum &sigma_a, const Spectrum &sigma_s, Float g)
+    HomogeneousMedium(const SceneSpectrum &sigma_a,
+                      const SceneSpectrum &sigma_s, Float g)
         : sigma_a(sigma_a),
           sigma_s(sigma_s),
           sigma_t(sigma_s + sigma_a),
@@ -58,7 +59,7 @@ class HomogeneousMedium : public Medium {
 
   private:
     // HomogeneousMedium Private Data
-    const Spectrum sigma_a, sigma_s, sigma_t;
+    const SceneSpectrum sigma_a, sigma_s, sigma_t;
     const Float g;
 };
 
@@ -0,0 +1,254 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// samplers/bluenoise.cpp*
+#include "samplers/bluenoise.h"
+#include "paramset.h"
+#include "rng.h"
+#include "stats.h"
+
+namespace pbrt {
+
+// BlueNoiseSampler Local Definitions
+static PBRT_CONSTEXPR int maskResolution = 64;
+static PBRT_CONSTEXPR int maskSize = maskResolution * maskResolution;
+
+// Computes a dither mask that ranks the pixels of a toroidal grid so that
+// the pixels with ranks below any threshold form a blue-noise pattern,
+// using Ulichney's void-and-cluster method.
+static std::unique_ptr<uint16_t[]> GenerateBlueNoiseMask() {
+    const int n = maskResolution;
+    // Tabulate the Gaussian filter for each toroidal pixel offset
+    std::vector<float> filter(maskSize);
+    const float sigma = 1.5f;
+    for (int y = 0; y < n; ++y)
+        for (int x = 0; x < n; ++x) {
+            int dx = std::min(x, n - x), dy = std::min(y, n - y);
+            filter[y * n + x] =
+                std::exp(-(dx * dx + dy * dy) / (2 * sigma * sigma));
+        }
+
+    // _energy_ is the filtered density of the pattern's set pixels
+    std::vector<bool> pattern(maskSize, false);
+    std::vector<float> energy(maskSize, 0.f);
+    auto toggle = [&](int p) {
+        pattern[p] = !pattern[p];
+        float sign = pattern[p] ? 1 : -1;
+        int px = p % n, py = p / n;
+        for (int y = 0; y < n; ++y) {
+            const float *row = &filter[((y - py + n) % n) * n];
+            for (int x = 0; x < n; ++x)
+                energy[y * n + x] += sign * row[(x - px + n) % n];
+        }
+    };
+    // Returns the set pixel with the most energy (the tightest cluster) or
+    // the unset pixel with the least (the largest void)
+    auto tightestCluster = [&]() {
+        int best = -1;
+        for (int p = 0; p < maskSize; ++p)
+            if (pattern[p] && (best == -1 || energy[p] > energy[best]))
+                best = p;
+        return best;
+    };
+    auto largestVoid = [&]() {
+        int best = -1;
+        for (int p = 0; p < maskSize; ++p)
+            if (!pattern[p] && (best == -1 || energy[p] < energy[best]))
+                best = p;
+        return best;
+    };
+
+    // Start from random pixels and move clusters into voids until stable
+    RNG rng;
+    int nInitial = maskSize / 10;
+    for (int i = 0; i < nInitial;) {
+        int p = rng.UniformUInt32(maskSize);
+        if (!pattern[p]) {
+            toggle(p);
+            ++i;
+        }
+    }
+    while (true) {
+        int cluster = tightestCluster();
+        toggle(cluster);
+        int voidPixel = largestVoid();
+        if (voidPixel == cluster) {
+            toggle(cluster);
+            break;
+        }
+        toggle(voidPixel);
+    }
+    std::vector<bool> initialPattern = pattern;
+    std::vector<float> initialEnergy = energy;
+
+    // Rank the initial pattern's pixels by removing the tightest clusters
+    std::unique_ptr<uint16_t[]> ranks(new uint16_t[maskSize]);
+    for (int rank = nInitial - 1; rank >= 0; --rank) {
+        int p = tightestCluster();
+        toggle(p);
+        ranks[p] = rank;
+    }
+
+    // Rank the remaining pixels by filling the largest voids; an unset
+    // pixel's energy with respect to the unset pixels is a constant minus
+    // its energy with respect to the set ones, so this also finds the
+    // tightest clusters of unset pixels once more than half are set
+    pattern = initialPattern;
+    energy = initialEnergy;
+    for (int rank = nInitial; rank < maskSize; ++rank) {
+        int p = largestVoid();
+        toggle(p);
+        ranks[p] = rank;
+    }
+    return ranks;
+}
+
+static const uint16_t *BlueNoiseMask() {
+    static std::unique_ptr<uint16_t[]> mask = GenerateBlueNoiseMask();
+    return mask.get();
+}
+
+// BlueNoiseSampler Method Definitions
+BlueNoiseSampler::BlueNoiseSampler(int64_t samplesPerPixel, int seed)
+    : Sampler(RoundUpPow2(samplesPerPixel)), seed(seed), mask(BlueNoiseMask()) {
+    if (!IsPowerOf2(samplesPerPixel))
+        Warning("Non power-of-two sample count rounded up to %" PRId64
+                " for BlueNoiseSampler.",
+                this->samplesPerPixel);
+}
+
+Point2f BlueNoiseSampler::DitherShift(uint32_t dim) const {
+    // Look up the mask at the current pixel, offsetting the mask
+    // differently for each dimension to decorrelate them
+    uint64_t hash = MixBits(DimensionHash(dim));
+    int x = (currentPixel.x + (int)(hash & (maskResolution - 1))) &
+            (maskResolution - 1);
+    int y = (currentPixel.y + (int)((hash >> 32) & (maskResolution - 1))) &
+            (maskResolution - 1);
+    Float rank = mask[y * maskResolution + x] + 0.5f;
+
+    // Map the rank to a point of a Fibonacci-like lattice, so that the 2D
+    // shifts of neighboring pixels are as well separated as their ranks
+    const Float invPhi = 0.6180339887498949f;
+    Float sy = rank * invPhi;
+    return Point2f(rank / maskSize, sy - std::floor(sy));
+}
+
+static Float Shift(Float v, Float shift) {
+    v += shift;
+    return std::min(v >= 1 ? v - 1 : v, OneMinusEpsilon);
+}
+
+static Float ScrambledSobol1D(uint32_t index, uint32_t scramble) {
+    return SobolToFloat(ReverseBits32(OwenScrambleReversed(index, scramble)));
+}
+
+static Point2f ScrambledSobol2D(uint32_t index, uint64_t scramble) {
+    uint32_t y = MultiplyGenerator(&SobolMatrices32[SobolMatrixSize], index);
+    return Point2f(ScrambledSobol1D(index, (uint32_t)scramble),
+                   ScrambledSobol1D(ReverseBits32(y), scramble >> 32));
+}
+
+void BlueNoiseSampler::StartPixel(const Point2i &p) {
+    ProfilePhase _(Prof::StartPixel);
+    Sampler::StartPixel(p);
+    dimension = 0;
+
+    // Generate arrays of dithered samples for the pixel
+    for (size_t i = 0; i < sampleArray1D.size(); ++i) {
+        uint32_t dim = ArrayDimensionBase + i;
+        uint32_t scramble = DimensionHash(dim);
+        Float shift = DitherShift(dim).x;
+        for (size_t j = 0; j < sampleArray1D[i].size(); ++j)
+            sampleArray1D[i][j] = Shift(ScrambledSobol1D(j, scramble), shift);
+    }
+    for (size_t i = 0; i < sampleArray2D.size(); ++i) {
+        uint32_t dim = ArrayDimensionBase + sampleArray1D.size() + 2 * i;
+        uint64_t scramble = MixBits(DimensionHash(dim));
+        Point2f shift = DitherShift(dim);
+        for (size_t j = 0; j < sampleArray2D[i].size(); ++j) {
+            Point2f u = ScrambledSobol2D(j, scramble);
+            sampleArray2D[i][j] =
+                Point2f(Shift(u.x, shift.x), Shift(u.y, shift.y));
+        }
+    }
+}
+
+bool BlueNoiseSampler::StartNextSample() {
+    dimension = 0;
+    return Sampler::StartNextSample();
+}
+
+bool BlueNoiseSampler::SetSampleNumber(int64_t sampleNum) {
+    dimension = 0;
+    return Sampler::SetSampleNumber(sampleNum);
+}
+
+Float BlueNoiseSampler::Get1D() {
+    ProfilePhase _(Prof::GetSample);
+    CHECK_LT(currentPixelSampleIndex, samplesPerPixel);
+    // All pixels share the permutation and scrambling of each dimension;
+    // only the dither shift differs
+    uint32_t dim = dimension++;
+    uint64_t hash = DimensionHash(dim);
+    uint32_t index = PermutationElement(currentPixelSampleIndex,
+                                        samplesPerPixel, (uint32_t)hash);
+    return Shift(ScrambledSobol1D(index, hash >> 32), DitherShift(dim).x);
+}
+
+Point2f BlueNoiseSampler::Get2D() {
+    ProfilePhase _(Prof::GetSample);
+    CHECK_LT(currentPixelSampleIndex, samplesPerPixel);
+    uint32_t dim = dimension;
+    dimension += 2;
+    uint64_t hash = DimensionHash(dim);
+    uint32_t index = PermutationElement(currentPixelSampleIndex,
+                                        samplesPerPixel, (uint32_t)hash);
+    Point2f u = ScrambledSobol2D(index, MixBits(hash));
+    Point2f shift = DitherShift(dim);
+    return Point2f(Shift(u.x, shift.x), Shift(u.y, shift.y));
+}
+
+std::unique_ptr<Sampler> BlueNoiseSampler::Clone(int seed) {
+    // The dither pattern must be shared by all tiles, so _seed_ is unused
+    return std::unique_ptr<Sampler>(new BlueNoiseSampler(*this));
+}
+
+BlueNoiseSampler *CreateBlueNoiseSampler(const ParamSet &params) {
+    int nsamp = params.FindOneInt("pixelsamples", 4);
+    int seed = params.FindOneInt("seed", 0);
+    if (PbrtOptions.quickRender) nsamp = 1;
+    return new BlueNoiseSampler(nsamp, seed);
+}
+
+}  // namespace pbrt
@@ -126,6 +126,12 @@ Float HaltonSampler::SampleDimension(int64_t index, int dim) const {
                                        PermutationForDimension(dim));
 }
 
+void HaltonSampler::SampleDimensions(int64_t index, int dim, int n,
+                                     Float *u) const {
+    for (int i = 0; i < n; ++i)
+        u[i] = HaltonSampler::SampleDimension(index, dim + i);
+}
+
 std::unique_ptr<Sampler> HaltonSampler::Clone(int seed) {
     return std::unique_ptr<Sampler>(new HaltonSampler(*this));
 }
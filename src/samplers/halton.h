@@ -52,6 +52,8 @@ class HaltonSampler : public GlobalSampler {
                   bool sampleAtCenter = false);
     int64_t GetIndexForSample(int64_t sampleNum) const;
     Float SampleDimension(int64_t index, int dimension) const;
+    void SampleDimensions(int64_t index, int dimension, int n,
+                          Float *u) const;
     std::unique_ptr<Sampler> Clone(int seed);
 
   private:
@@ -0,0 +1,137 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+
+// samplers/paddedsobol.cpp*
+#include "samplers/paddedsobol.h"
+#include "paramset.h"
+#include "stats.h"
+
+namespace pbrt {
+
+// PaddedSobolSampler Method Definitions
+PaddedSobolSampler::PaddedSobolSampler(int64_t samplesPerPixel, int seed)
+    : Sampler(RoundUpPow2(samplesPerPixel)),
+      seed(seed),
+      log2SamplesPerPixel(Log2Int(this->samplesPerPixel)) {
+    for (int i = 0; i < 32; ++i)
+        reversedC1[i] = ReverseBits32(SobolMatrices32[SobolMatrixSize + i]);
+    if (!IsPowerOf2(samplesPerPixel))
+        Warning("Non power-of-two sample count rounded up to %" PRId64
+                " for PaddedSobolSampler.",
+                this->samplesPerPixel);
+}
+
+Point2f PaddedSobolSampler::Sample2D(uint32_t index, int nIndexBits,
+                                     uint64_t hash) const {
+    // Evaluate and scramble the first two Sobol$'$ dimensions with bits
+    // reversed: the first is the van der Corput sequence, which is _index_
+    // itself reversed, and the second is the product of _index_'s
+    // _nIndexBits_ low bits with the generator matrix, computed without
+    // data-dependent branches
+    uint32_t y = 0;
+    for (int i = 0; i < nIndexBits; ++i)
+        y ^= reversedC1[i] & (0u - ((index >> i) & 1));
+    uint32_t x = OwenScrambleReversed(index, (uint32_t)hash);
+    y = OwenScrambleReversed(y, (uint32_t)(hash >> 32));
+    return Point2f(SobolToFloat(ReverseBits32(x)),
+                   SobolToFloat(ReverseBits32(y)));
+}
+
+void PaddedSobolSampler::StartPixel(const Point2i &p) {
+    ProfilePhase _(Prof::StartPixel);
+    pixelHash = MixBits(((uint64_t)(uint32_t)p.x << 32) | (uint32_t)p.y);
+    dimension = 0;
+
+    // Generate arrays of samples for the pixel; each sample's values are
+    // consecutive points of a scrambled Sobol$'$ sequence
+    for (size_t i = 0; i < sampleArray1D.size(); ++i) {
+        uint32_t scramble = DimensionHash(ArrayDimensionBase + i);
+        for (size_t j = 0; j < sampleArray1D[i].size(); ++j)
+            sampleArray1D[i][j] =
+                SobolToFloat(ReverseBits32(OwenScrambleReversed(j, scramble)));
+    }
+    for (size_t i = 0; i < sampleArray2D.size(); ++i) {
+        uint64_t hash =
+            DimensionHash(ArrayDimensionBase + sampleArray1D.size() + i);
+        int nIndexBits = Log2Int((uint64_t)sampleArray2D[i].size());
+        for (size_t j = 0; j < sampleArray2D[i].size(); ++j)
+            sampleArray2D[i][j] = Sample2D(j, nIndexBits, hash);
+    }
+    Sampler::StartPixel(p);
+}
+
+bool PaddedSobolSampler::StartNextSample() {
+    dimension = 0;
+    return Sampler::StartNextSample();
+}
+
+bool PaddedSobolSampler::SetSampleNumber(int64_t sampleNum) {
+    dimension = 0;
+    return Sampler::SetSampleNumber(sampleNum);
+}
+
+Float PaddedSobolSampler::Get1D() {
+    ProfilePhase _(Prof::GetSample);
+    CHECK_LT(currentPixelSampleIndex, samplesPerPixel);
+    // Randomly permute the pixel's samples for this dimension and return
+    // the scrambled van der Corput point for the permuted index
+    uint64_t hash = DimensionHash(dimension++);
+    uint32_t index = PermutationElement(currentPixelSampleIndex,
+                                        samplesPerPixel, (uint32_t)hash);
+    return SobolToFloat(
+        ReverseBits32(OwenScrambleReversed(index, hash >> 32)));
+}
+
+Point2f PaddedSobolSampler::Get2D() {
+    ProfilePhase _(Prof::GetSample);
+    CHECK_LT(currentPixelSampleIndex, samplesPerPixel);
+    uint64_t hash = DimensionHash(dimension);
+    dimension += 2;
+    uint32_t index = PermutationElement(currentPixelSampleIndex,
+                                        samplesPerPixel, (uint32_t)hash);
+    return Sample2D(index, log2SamplesPerPixel, MixBits(hash));
+}
+
+std::unique_ptr<Sampler> PaddedSobolSampler::Clone(int seed) {
+    // Samples only depend on the pixel, so tiles can share the same seed
+    return std::unique_ptr<Sampler>(new PaddedSobolSampler(*this));
+}
+
+PaddedSobolSampler *CreatePaddedSobolSampler(const ParamSet &params) {
+    int nsamp = params.FindOneInt("pixelsamples", 16);
+    int seed = params.FindOneInt("seed", 0);
+    if (PbrtOptions.quickRender) nsamp = 1;
+    return new PaddedSobolSampler(nsamp, seed);
+}
+
+}  // namespace pbrt
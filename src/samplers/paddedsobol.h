@@ -0,0 +1,85 @@
+
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */
+
+#if defined(_MSC_VER)
+#define NOMINMAX
+#pragma once
+#endif
+
+#ifndef PBRT_SAMPLERS_PADDEDSOBOL_H
+#define PBRT_SAMPLERS_PADDEDSOBOL_H
+
+// samplers/paddedsobol.h*
+#include "sampler.h"
+#include "lowdiscrepancy.h"
+
+namespace pbrt {
+
+// PaddedSobolSampler Declarations
+// PaddedSobolSampler generates each dimension (or pair of dimensions) from
+// the first two Sobol$'$ dimensions, with the pixel's samples randomly
+// permuted and Owen scrambled using a hash of the pixel and dimension.
+// Unlike _SobolSampler_, no global sample index is computed, and each
+// dimension costs a constant number of integer operations.
+class PaddedSobolSampler : public Sampler {
+  public:
+    // PaddedSobolSampler Public Methods
+    PaddedSobolSampler(int64_t samplesPerPixel, int seed = 0);
+    void StartPixel(const Point2i &p);
+    bool StartNextSample();
+    bool SetSampleNumber(int64_t sampleNum);
+    Float Get1D();
+    Point2f Get2D();
+    int RoundCount(int count) const { return RoundUpPow2(count); }
+    std::unique_ptr<Sampler> Clone(int seed);
+
+  private:
+    // PaddedSobolSampler Private Methods
+    Point2f Sample2D(uint32_t index, int nIndexBits, uint64_t hash) const;
+    uint64_t DimensionHash(uint32_t dim) const {
+        return MixBits(pixelHash ^ (((uint64_t)dim << 32) | (uint32_t)seed));
+    }
+
+    // PaddedSobolSampler Private Data
+    const int seed;
+    // Bit-reversed generator matrix for the second Sobol$'$ dimension
+    uint32_t reversedC1[32];
+    int log2SamplesPerPixel;
+    uint64_t pixelHash = 0;
+    int dimension = 0;
+};
+
+PaddedSobolSampler *CreatePaddedSobolSampler(const ParamSet &params);
+
+}  // namespace pbrt
+
+#endif  // PBRT_SAMPLERS_PADDEDSOBOL_H
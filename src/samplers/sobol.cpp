@@ -58,6 +58,20 @@ Float SobolSampler::SampleDimension(int64_t index, int dim) const {
     return s;
 }
 
+void SobolSampler::SampleDimensions(int64_t index, int dim, int n,
+                                    Float *u) const {
+    if (dim + n > NumSobolDimensions)
+        LOG(FATAL) << StringPrintf("SobolSampler can only sample up to %d "
+                                   "dimensions! Exiting.",
+                                   NumSobolDimensions);
+    SobolSampleDimensions(index, dim, n, u);
+    // Remap Sobol$'$ dimensions used for pixel samples
+    for (int d = dim; d < std::min(dim + n, 2); ++d) {
+        Float s = u[d - dim] * resolution + sampleBounds.pMin[d];
+        u[d - dim] = Clamp(s - currentPixel[d], (Float)0, OneMinusEpsilon);
+    }
+}
+
 std::unique_ptr<Sampler> SobolSampler::Clone(int seed) {
     return std::unique_ptr<Sampler>(new SobolSampler(*this));
 }
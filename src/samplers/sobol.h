@@ -62,6 +62,8 @@ class SobolSampler : public GlobalSampler {
     }
     int64_t GetIndexForSample(int64_t sampleNum) const;
     Float SampleDimension(int64_t index, int dimension) const;
+    void SampleDimensions(int64_t index, int dimension, int n,
+                          Float *u) const;
 
   private:
     // SobolSampler Private Data
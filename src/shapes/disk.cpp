@@ -136,6 +136,12 @@ Interaction Disk::Sample(const Point2f &u, Float *pdf) const {
     return it;
 }
 
+Float Disk::NormalBounds(Vector3f *w) const {
+    *w = Vector3f(Normalize((*ObjectToWorld)(Normal3f(0, 0, 1))));
+    if (reverseOrientation) *w *= -1;
+    return 1;
+}
+
 std::shared_ptr<Disk> CreateDiskShape(const Transform *o2w,
                                       const Transform *w2o,
                                       bool reverseOrientation,
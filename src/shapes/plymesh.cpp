@@ -286,7 +286,7 @@ std::vector<std::shared_ptr<Shape>> CreatePLYMesh(
                               context.indexCtr / 3, context.indices,
                               vertexCount, context.p, nullptr, context.n,
                               context.uv, alphaTex, shadowAlphaTex,
-                              context.faceIndices);
+                              context.faceIndices, GetTriangleSampling(params));
 }
 
 }  // namespace pbrt
@@ -58,12 +58,13 @@ namespace pbrt {
             int nVertices, const Point3f *P, const Vector3f *S, const Normal3f *N,
             const Point2f *UV, const std::shared_ptr<Texture<Float>> &alphaMask,
             const std::shared_ptr<Texture<Float>> &shadowAlphaMask,
-            const int *fIndices)
+            const int *fIndices, TriangleSampling sampling)
             : nTriangles(nTriangles),
               nVertices(nVertices),
               vertexIndices(vertexIndices, vertexIndices + 3 * nTriangles),
               alphaMask(alphaMask),
-              shadowAlphaMask(shadowAlphaMask) {
+              shadowAlphaMask(shadowAlphaMask),
+              sampling(sampling) {
         ++nMeshes;
         nTris += nTriangles;
         triMeshBytes += sizeof(*this) + this->vertexIndices.size() * sizeof(int) +
@@ -99,10 +100,10 @@ namespace pbrt {
             int nVertices, const Point3f *p, const Vector3f *s, const Normal3f *n,
             const Point2f *uv, const std::shared_ptr<Texture<Float>> &alphaMask,
             const std::shared_ptr<Texture<Float>> &shadowAlphaMask,
-            const int *faceIndices) {
+            const int *faceIndices, TriangleSampling sampling) {
         std::shared_ptr<TriangleMesh> mesh = std::make_shared<TriangleMesh>(
                 *ObjectToWorld, nTriangles, vertexIndices, nVertices, p, s, n, uv,
-                alphaMask, shadowAlphaMask, faceIndices);
+                alphaMask, shadowAlphaMask, faceIndices, sampling);
         std::vector<std::shared_ptr<Shape>> tris;
         tris.reserve(nTriangles);
         Shape::parent_counter++;
@@ -610,6 +611,121 @@ namespace pbrt {
         return it;
     }
 
+    // Triangles that subtend smaller solid angles than this are sampled by
+    // area, since spherical triangle sampling loses accuracy for them, as
+    // are ones that subtend nearly a hemisphere.
+    static PBRT_CONSTEXPR Float MinSphericalSampleArea = 3e-4f;
+    static PBRT_CONSTEXPR Float MaxSphericalSampleArea = 6.22f;
+
+    Interaction Triangle::Sample(const Interaction &ref, const Point2f &u,
+                                 Float *pdf) const {
+        Float solidAngle = SolidAngle(ref.p);
+        if (mesh->sampling == TriangleSampling::Area ||
+            !(solidAngle >= MinSphericalSampleArea &&
+              solidAngle <= MaxSphericalSampleArea))
+            return Shape::Sample(ref, u, pdf);
+
+        // Warp the sample toward directions with larger cosines at the
+        // reference point if it's on a surface
+        Point2f uWarped = u;
+        Float warpPdf = 1;
+        if (mesh->sampling == TriangleSampling::ProjectedSolidAngle &&
+            ref.n != Normal3f(0, 0, 0)) {
+            Float w[4];
+            CosineWeights(ref, w);
+            uWarped = SampleBilinear(u, w);
+            warpPdf = BilinearPdf(uWarped, w);
+        }
+
+        // Sample the spherical triangle and find the point on the triangle
+        const Point3f &p0 = mesh->p[v[0]];
+        const Point3f &p1 = mesh->p[v[1]];
+        const Point3f &p2 = mesh->p[v[2]];
+        Float triPdf;
+        std::array<Float, 3> b =
+            SampleSphericalTriangle({{p0, p1, p2}}, ref.p, uWarped, &triPdf);
+        if (triPdf == 0) {
+            *pdf = 0;
+            return Interaction();
+        }
+        // Use the same solid angle as Pdf() so the two match exactly
+        *pdf = warpPdf / solidAngle;
+        Interaction it;
+        it.p = b[0] * p0 + b[1] * p1 + b[2] * p2;
+        it.n = Normalize(Normal3f(Cross(p1 - p0, p2 - p0)));
+        if (mesh->n) {
+            Normal3f ns(b[0] * mesh->n[v[0]] + b[1] * mesh->n[v[1]] +
+                        b[2] * mesh->n[v[2]]);
+            it.n = Faceforward(it.n, ns);
+        } else if (reverseOrientation ^ transformSwapsHandedness)
+            it.n *= -1;
+        Point3f pAbsSum = Abs(b[0] * p0) + Abs(b[1] * p1) + Abs(b[2] * p2);
+        it.pError = gamma(6) * Vector3f(pAbsSum.x, pAbsSum.y, pAbsSum.z);
+        return it;
+    }
+
+    Float Triangle::Pdf(const Interaction &ref, const Vector3f &wi) const {
+        Float solidAngle = SolidAngle(ref.p);
+        if (mesh->sampling == TriangleSampling::Area ||
+            !(solidAngle >= MinSphericalSampleArea &&
+              solidAngle <= MaxSphericalSampleArea))
+            return Shape::Pdf(ref, wi);
+        if (!IntersectP(ref.SpawnRay(wi), false)) return 0;
+
+        Float pdf = 1 / solidAngle;
+        if (mesh->sampling == TriangleSampling::ProjectedSolidAngle &&
+            ref.n != Normal3f(0, 0, 0)) {
+            // Account for the warp by finding the sample that gives _wi_
+            Float w[4];
+            CosineWeights(ref, w);
+            Point2f u = InvertSphericalTriangleSample(
+                {{mesh->p[v[0]], mesh->p[v[1]], mesh->p[v[2]]}}, ref.p,
+                Normalize(wi));
+            pdf *= BilinearPdf(u, w);
+        }
+        return pdf;
+    }
+
+    void Triangle::CosineWeights(const Interaction &ref, Float w[4]) const {
+        // Solid angle samples with u[1] = 0 map to the second vertex and
+        // ones with u[1] = 1 to the edge from the first vertex to the third
+        Vector3f wi[3] = {Normalize(mesh->p[v[0]] - ref.p),
+                          Normalize(mesh->p[v[1]] - ref.p),
+                          Normalize(mesh->p[v[2]] - ref.p)};
+        w[0] = w[1] = std::max<Float>(0.01f, AbsDot(ref.n, wi[1]));
+        w[2] = std::max<Float>(0.01f, AbsDot(ref.n, wi[0]));
+        w[3] = std::max<Float>(0.01f, AbsDot(ref.n, wi[2]));
+    }
+
+    Float Triangle::NormalBounds(Vector3f *w) const {
+        const Point3f &p0 = mesh->p[v[0]];
+        const Point3f &p1 = mesh->p[v[1]];
+        const Point3f &p2 = mesh->p[v[2]];
+        Normal3f n(Cross(p1 - p0, p2 - p0));
+        if (n.LengthSquared() == 0) {
+            *w = Vector3f(0, 0, 1);
+            return -1;
+        }
+        n = Normalize(n);
+        // Orient the normal as Sample() does; if the shading normals at
+        // the vertices lie on both sides of the triangle, sampled normals
+        // may point either way
+        if (mesh->n) {
+            Normal3f ns = mesh->n[v[0]] + mesh->n[v[1]] + mesh->n[v[2]];
+            bool positive[3];
+            for (int i = 0; i < 3; ++i)
+                positive[i] = Dot(n, mesh->n[v[i]]) > 0;
+            if (positive[0] != positive[1] || positive[1] != positive[2]) {
+                *w = Vector3f(n);
+                return -1;
+            }
+            n = Faceforward(n, ns);
+        } else if (reverseOrientation ^ transformSwapsHandedness)
+            n *= -1;
+        *w = Vector3f(n);
+        return 1;
+    }
+
     Float Triangle::SolidAngle(const Point3f &p, int nSamples) const {
         // Project the vertices into the unit sphere around p.
         std::array<Vector3f, 3> pSphere = {
@@ -743,7 +859,20 @@ namespace pbrt {
             shadowAlphaTex.reset(new ConstantTexture<Float>(0.f));
 
         return CreateTriangleMesh(o2w, w2o, reverseOrientation, nvi / 3, vi, npi, P,
-                                  S, N, uvs, alphaTex, shadowAlphaTex, faceIndices);
+                                  S, N, uvs, alphaTex, shadowAlphaTex, faceIndices,
+                                  GetTriangleSampling(params));
+    }
+
+    TriangleSampling GetTriangleSampling(const ParamSet &params) {
+        std::string sampling = params.FindOneString("sampling", "solidangle");
+        if (sampling == "area")
+            return TriangleSampling::Area;
+        else if (sampling == "projectedsolidangle")
+            return TriangleSampling::ProjectedSolidAngle;
+        else if (sampling != "solidangle")
+            Warning("Triangle sampling method \"%s\" unknown. Using "
+                    "\"solidangle\".", sampling.c_str());
+        return TriangleSampling::SolidAngle;
     }
 
 }  // namespace pbrt
@@ -48,6 +48,12 @@ namespace pbrt {
     STAT_MEMORY_COUNTER("Memory/Triangle meshes", triMeshBytes);
 
 // Triangle Declarations
+    // How Triangle::Sample() chooses points given a reference point: by
+    // area, uniformly in the solid angle the triangle subtends, or with a
+    // bilinear warp of the solid angle samples that approximates the cosine
+    // factor at the reference point.
+    enum class TriangleSampling { Area, SolidAngle, ProjectedSolidAngle };
+
     struct TriangleMesh {
         // TriangleMesh Public Methods
         TriangleMesh(const Transform &ObjectToWorld, int nTriangles,
@@ -55,7 +61,8 @@ namespace pbrt {
                      const Vector3f *S, const Normal3f *N, const Point2f *uv,
                      const std::shared_ptr<Texture<Float>> &alphaMask,
                      const std::shared_ptr<Texture<Float>> &shadowAlphaMask,
-                     const int *faceIndices);
+                     const int *faceIndices,
+                     TriangleSampling sampling = TriangleSampling::SolidAngle);
 
         // TriangleMesh Data
         const int nTriangles, nVertices;
@@ -66,6 +73,7 @@ namespace pbrt {
         std::unique_ptr<Point2f[]> uv;
         std::shared_ptr<Texture<Float>> alphaMask, shadowAlphaMask;
         std::vector<int> faceIndices;
+        const TriangleSampling sampling;
     };
 
     class Triangle : public Shape {
@@ -85,17 +93,27 @@ namespace pbrt {
         bool Intersect(const Ray &ray, Float *tHit, SurfaceInteraction *isect,
                        bool testAlphaTexture = true) const;
         bool IntersectP(const Ray &ray, bool testAlphaTexture = true) const;
+        bool HasAlphaMask() const {
+            return mesh->alphaMask || mesh->shadowAlphaMask;
+        }
         Float Area() const;
 
-        using Shape::Sample;  // Bring in the other Sample() overload.
         Interaction Sample(const Point2f &u, Float *pdf) const;
+        using Shape::Pdf;
+        Interaction Sample(const Interaction &ref, const Point2f &u,
+                           Float *pdf) const;
+        Float Pdf(const Interaction &ref, const Vector3f &wi) const;
 
         // Returns the solid angle subtended by the triangle w.r.t. the given
         // reference point p.
         Float SolidAngle(const Point3f &p, int nSamples = 0) const;
+        Float NormalBounds(Vector3f *w) const;
 
     private:
         // Triangle Private Methods
+        // Computes the weights at the corners of the sample domain for
+        // warping solid angle samples toward the cosine factor at |ref|.
+        void CosineWeights(const Interaction &ref, Float w[4]) const;
         void GetUVs(Point2f uv[3]) const {
             if (mesh->uv) {
                 uv[0] = mesh->uv[v[0]];
@@ -121,7 +139,10 @@ namespace pbrt {
             const Vector3f *s, const Normal3f *n, const Point2f *uv,
             const std::shared_ptr<Texture<Float>> &alphaTexture,
             const std::shared_ptr<Texture<Float>> &shadowAlphaTexture,
-            const int *faceIndices = nullptr);
+            const int *faceIndices = nullptr,
+            TriangleSampling sampling = TriangleSampling::SolidAngle);
+    // Returns the sampling method given by a mesh's "sampling" parameter.
+    TriangleSampling GetTriangleSampling(const ParamSet &params);
     std::vector<std::shared_ptr<Shape>> CreateTriangleMeshShape(
             const Transform *o2w, const Transform *w2o, bool reverseOrientation,
             const ParamSet &params,
@@ -0,0 +1,76 @@
+#include "tests/gtest/gtest.h"
+#include "pbrt.h"
+
+#include "accelerators/bvh.h"
+#include "accelerators/kdtreeaccel.h"
+#include "rng.h"
+#include "scene.h"
+#include "shapes/triangle.h"
+#include "textures/constant.h"
+
+using namespace pbrt;
+
+// Random triangles, a third of which are fully transparent through their
+// alpha texture and a third of which have an alpha texture that keeps
+// them opaque.
+static std::vector<std::shared_ptr<Primitive>> RandomTriangles(RNG &rng,
+                                                               int count) {
+    static Transform identity;
+    std::shared_ptr<Texture<Float>> transparent =
+        std::make_shared<ConstantTexture<Float>>(0.f);
+    std::shared_ptr<Texture<Float>> opaque =
+        std::make_shared<ConstantTexture<Float>>(1.f);
+    std::vector<std::shared_ptr<Primitive>> prims;
+    for (int i = 0; i < count; ++i) {
+        Point3f p[3];
+        for (int j = 0; j < 3; ++j)
+            for (int c = 0; c < 3; ++c)
+                p[j][c] = Lerp(rng.UniformFloat(), -5.f, 5.f);
+        int indices[3] = {0, 1, 2};
+        std::shared_ptr<Texture<Float>> alpha =
+            (i % 3 == 0) ? transparent : ((i % 3 == 1) ? opaque : nullptr);
+        std::vector<std::shared_ptr<Shape>> tris =
+            CreateTriangleMesh(&identity, &identity, false, 1, indices, 3, p,
+                               nullptr, nullptr, nullptr, alpha, nullptr);
+        prims.push_back(std::make_shared<GeometricPrimitive>(
+            tris[0], nullptr, nullptr, MediumInterface()));
+    }
+    return prims;
+}
+
+// Shadow rays must give the same answer whichever accelerator traces them
+// and whether or not the scene's occluder cache or the BVH's deferred alpha
+// tests find the occluder.
+TEST(Accelerators, ShadowRays) {
+    RNG rng;
+    std::vector<std::shared_ptr<Primitive>> prims = RandomTriangles(rng, 300);
+    std::shared_ptr<BVHAccel> bvh = std::make_shared<BVHAccel>(prims, 4);
+    KdTreeAccel kdtree(prims);
+    EXPECT_TRUE(bvh->HasAlphaMask());
+    EXPECT_TRUE(kdtree.HasAlphaMask());
+    Scene scene(bvh, {});
+
+    int nOccluded = 0;
+    for (int i = 0; i < 20000; ++i) {
+        Point3f p0, p1;
+        for (int c = 0; c < 3; ++c) {
+            p0[c] = Lerp(rng.UniformFloat(), -6.f, 6.f);
+            p1[c] = Lerp(rng.UniformFloat(), -6.f, 6.f);
+        }
+        Ray ray(p0, p1 - p0, 1.f);
+
+        bool expected = false;
+        for (const std::shared_ptr<Primitive> &prim : prims)
+            expected |= prim->IntersectP(ray);
+        nOccluded += expected;
+
+        const Primitive *occluder = bvh->Occluder(ray);
+        EXPECT_EQ(expected, occluder != nullptr);
+        if (occluder) EXPECT_TRUE(occluder->IntersectP(ray));
+        EXPECT_EQ(expected, kdtree.IntersectP(ray));
+        EXPECT_EQ(expected, scene.IntersectP(ray));
+    }
+    // Make sure that both outcomes were exercised.
+    EXPECT_GT(nOccluded, 1000);
+    EXPECT_LT(nOccluded, 19000);
+}
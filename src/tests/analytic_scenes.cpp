@@ -76,7 +76,7 @@ std::vector<TestScene> GetScenes() {
             &id, &id, true /* reverse orientation */, 1, -1, 1, 360);
 
         std::shared_ptr<Texture<Spectrum>> Kd =
-            std::make_shared<ConstantTexture<Spectrum>>(Spectrum(0.5));
+            std::make_shared<ConstantTexture<Spectrum>>(SceneSpectrum(0.5));
         std::shared_ptr<Texture<Float>> sigma =
             std::make_shared<ConstantTexture<Float>>(0.);
         std::shared_ptr<Material> material =
@@ -89,8 +89,8 @@ std::vector<TestScene> GetScenes() {
         std::shared_ptr<BVHAccel> bvh = std::make_shared<BVHAccel>(prims);
 
         std::vector<std::shared_ptr<Light>> lights;
-        lights.push_back(
-            std::make_shared<PointLight>(Transform(), nullptr, Spectrum(Pi)));
+        lights.push_back(std::make_shared<PointLight>(Transform(), nullptr,
+                                                      SceneSpectrum(Pi)));
 
         std::unique_ptr<Scene> scene(new Scene(bvh, lights));
 
@@ -105,7 +105,7 @@ std::vector<TestScene> GetScenes() {
             &id, &id, true /* reverse orientation */, 1, -1, 1, 360);
 
         std::shared_ptr<Texture<Spectrum>> Kd =
-            std::make_shared<ConstantTexture<Spectrum>>(Spectrum(0.5));
+            std::make_shared<ConstantTexture<Spectrum>>(SceneSpectrum(0.5));
         std::shared_ptr<Texture<Float>> sigma =
             std::make_shared<ConstantTexture<Float>>(0.);
         std::shared_ptr<Material> material =
@@ -119,13 +119,13 @@ std::vector<TestScene> GetScenes() {
 
         std::vector<std::shared_ptr<Light>> lights;
         lights.push_back(std::make_shared<PointLight>(Transform(), nullptr,
-                                                      Spectrum(Pi / 4)));
+                                                      SceneSpectrum(Pi / 4)));
         lights.push_back(std::make_shared<PointLight>(Transform(), nullptr,
-                                                      Spectrum(Pi / 4)));
+                                                      SceneSpectrum(Pi / 4)));
         lights.push_back(std::make_shared<PointLight>(Transform(), nullptr,
-                                                      Spectrum(Pi / 4)));
+                                                      SceneSpectrum(Pi / 4)));
         lights.push_back(std::make_shared<PointLight>(Transform(), nullptr,
-                                                      Spectrum(Pi / 4)));
+                                                      SceneSpectrum(Pi / 4)));
 
         std::unique_ptr<Scene> scene(new Scene(bvh, lights));
 
@@ -140,7 +140,7 @@ std::vector<TestScene> GetScenes() {
             &id, &id, true /* reverse orientation */, 1, -1, 1, 360);
 
         std::shared_ptr<Texture<Spectrum>> Kd =
-            std::make_shared<ConstantTexture<Spectrum>>(Spectrum(0.5));
+            std::make_shared<ConstantTexture<Spectrum>>(SceneSpectrum(0.5));
         std::shared_ptr<Texture<Float>> sigma =
             std::make_shared<ConstantTexture<Float>>(0.);
         std::shared_ptr<Material> material =
@@ -148,7 +148,7 @@ std::vector<TestScene> GetScenes() {
 
         std::shared_ptr<AreaLight> areaLight =
             std::make_shared<DiffuseAreaLight>(Transform(), nullptr,
-                                               Spectrum(0.5), 1, sphere);
+                                               SceneSpectrum(0.5), 1, sphere);
 
         std::vector<std::shared_ptr<Light>> lights;
         lights.push_back(areaLight);
@@ -172,9 +172,9 @@ std::vector<TestScene> GetScenes() {
             &id, &id, true /* reverse orientation */, 1, -1, 1, 360);
 
         std::shared_ptr<Texture<Spectrum>> Kd =
-            std::make_shared<ConstantTexture<Spectrum>>(Spectrum(0.25));
+            std::make_shared<ConstantTexture<Spectrum>>(SceneSpectrum(0.25));
         std::shared_ptr<Texture<Spectrum>> Kr =
-            std::make_shared<ConstantTexture<Spectrum>>(Spectrum(0.5));
+            std::make_shared<ConstantTexture<Spectrum>>(SceneSpectrum(0.5));
         std::shared_ptr<Texture<Spectrum>> black =
             std::make_shared<ConstantTexture<Spectrum>>(0.);
         std::shared_ptr<Texture<Spectrum>> white =
@@ -194,7 +194,7 @@ std::vector<TestScene> GetScenes() {
 
         std::vector<std::shared_ptr<Light>> lights;
         lights.push_back(std::make_shared<PointLight>(Transform(), nullptr,
-                                                      Spectrum(3. * Pi)));
+                                                      SceneSpectrum(3. * Pi)));
 
         std::unique_ptr<Scene> scene(new Scene(bvh, lights));
 
@@ -211,9 +211,9 @@ std::vector<TestScene> GetScenes() {
         &id, &id, true /* reverse orientation */, 1, -1, 1, 360);
 
     std::shared_ptr<Texture<Spectrum>> Kd =
-        std::make_shared<ConstantTexture<Spectrum>>(Spectrum(0.25));
+        std::make_shared<ConstantTexture<Spectrum>>(SceneSpectrum(0.25));
     std::shared_ptr<Texture<Spectrum>> Kr =
-        std::make_shared<ConstantTexture<Spectrum>>(Spectrum(0.5));
+        std::make_shared<ConstantTexture<Spectrum>>(SceneSpectrum(0.5));
     std::shared_ptr<Texture<Spectrum>> black =
         std::make_shared<ConstantTexture<Spectrum>>(0.);
     std::shared_ptr<Texture<Spectrum>> white =
@@ -226,7 +226,7 @@ std::vector<TestScene> GetScenes() {
         Kd, black, Kr, black, zero, zero, zero, white, one, nullptr, false);
 
     std::shared_ptr<AreaLight> areaLight = std::make_shared<DiffuseAreaLight>(
-        Transform(), nullptr, Spectrum(0.587), 8, sphere);
+        Transform(), nullptr, SceneSpectrum(0.587), 8, sphere);
 
     MediumInterface mediumInterface;
     std::vector<std::shared_ptr<Primitive>> prims;
@@ -313,6 +313,39 @@ std::vector<TestIntegrator> GetIntegrators() {
                                    scene});
         }
 
+        // Path tracing integrators with light BVH sampling
+        for (int vol = 0; vol < 2; ++vol) {
+            auto sampler =
+                GetSamplers(Bounds2i(Point2i(0, 0), resolution))[0];
+            {
+                std::unique_ptr<Filter> filter(
+                    new BoxFilter(Vector2f(0.5, 0.5)));
+                Film *film = new Film(
+                    resolution, Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+                    std::move(filter), 1., inTestDir("test.exr"), 1.);
+                std::shared_ptr<Camera> camera =
+                    std::make_shared<PerspectiveCamera>(
+                        identity, Bounds2f(Point2f(-1, -1), Point2f(1, 1)),
+                        0., 1., 0., 10., 45, film, nullptr);
+
+                Integrator *integrator;
+                if (vol)
+                    integrator = new VolPathIntegrator(
+                        8, camera, sampler.first, film->croppedPixelBounds, 1,
+                        "bvh");
+                else
+                    integrator = new PathIntegrator(
+                        8, camera, sampler.first, film->croppedPixelBounds, 1,
+                        "bvh");
+                integrators.push_back(
+                    {integrator, film,
+                     std::string(vol ? "VolPath" : "Path") +
+                         ", depth 8, Perspective, BVH light sampling, " +
+                         sampler.second + ", " + scene.description,
+                     scene});
+            }
+        }
+
         // Volume path tracing integrators
         for (auto sampler : GetSamplers(Bounds2i(Point2i(0, 0), resolution))) {
             std::unique_ptr<Filter> filter(new BoxFilter(Vector2f(0.5, 0.5)));
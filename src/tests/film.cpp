@@ -0,0 +1,110 @@
+#include "tests/gtest/gtest.h"
+#include "pbrt.h"
+#include "film.h"
+#include "imageio.h"
+#include "parallel.h"
+#include "rng.h"
+#include "filters/box.h"
+
+using namespace pbrt;
+
+static std::unique_ptr<RGBSpectrum[]> RenderSplats(bool threadSplats,
+                                                   const char *filename) {
+    Point2i res(37, 23);
+    Film film(res, Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+              std::unique_ptr<Filter>(new BoxFilter(Vector2f(0.5f, 0.5f))),
+              35.f, filename, 1.f, Infinity, threadSplats);
+
+    // Splat from multiple threads and merge overlapping tiles concurrently.
+    ParallelFor([&](int64_t chunk) {
+        RNG rng(chunk);
+        for (int i = 0; i < 1000; ++i) {
+            Point2f p(rng.UniformFloat() * res.x, rng.UniformFloat() * res.y);
+            film.AddSplat(p, Spectrum(0.25f));
+        }
+        Point2i p0(rng.UniformUInt32(res.x), rng.UniformUInt32(res.y));
+        Bounds2i tileBounds(p0, p0 + Vector2i(16, 16));
+        std::unique_ptr<FilmTile> tile = film.GetFilmTile(tileBounds);
+        for (Point2i p : tileBounds)
+            tile->AddSample(Point2f(p) + Vector2f(0.5f, 0.5f), Spectrum(1.f));
+        film.MergeFilmTile(std::move(tile));
+    }, 64);
+    film.WriteImage();
+
+    Point2i readRes;
+    std::unique_ptr<RGBSpectrum[]> image = ReadImage(filename, &readRes);
+    EXPECT_EQ(res, readRes);
+    remove(filename);
+    return image;
+}
+
+TEST(Film, ThreadSplatsMatchAtomicSplats) {
+    ParallelInit();
+    std::unique_ptr<RGBSpectrum[]> atomicImage =
+        RenderSplats(false, "film_atomic.pfm");
+    std::unique_ptr<RGBSpectrum[]> threadImage =
+        RenderSplats(true, "film_thread.pfm");
+    ParallelCleanup();
+
+    ASSERT_TRUE(atomicImage.get() != nullptr);
+    ASSERT_TRUE(threadImage.get() != nullptr);
+    for (int i = 0; i < 37 * 23; ++i) {
+        Float a[3], t[3];
+        atomicImage[i].ToRGB(a);
+        threadImage[i].ToRGB(t);
+        for (int c = 0; c < 3; ++c)
+            EXPECT_LT(std::abs(a[c] - t[c]), 1e-3f * std::max((Float)1, a[c]))
+                << "pixel " << i << ", channel " << c;
+    }
+}
+
+// Writes the partial film for the given node of a distributed render.
+static void WritePartialFilm(int nodeIndex, int nodeCount) {
+    PbrtOptions.nodeIndex = nodeIndex;
+    PbrtOptions.nodeCount = nodeCount;
+    Point2i res(8, 4);
+    Film film(res, Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+              std::unique_ptr<Filter>(new BoxFilter(Vector2f(0.5f, 0.5f))),
+              35.f, "film_merge.pfm", 1.f);
+    std::unique_ptr<FilmTile> tile =
+        film.GetFilmTile(Bounds2i(Point2i(0, 0), res));
+    for (Point2i p : Bounds2i(Point2i(0, 0), res))
+        tile->AddSample(Point2f(p) + Vector2f(0.5f, 0.5f),
+                        Spectrum(Float(nodeIndex + 1)));
+    film.MergeFilmTile(std::move(tile));
+    film.WriteImage();
+    PbrtOptions.nodeIndex = 0;
+    PbrtOptions.nodeCount = 1;
+}
+
+TEST(Film, MergePartialFilmsChecksNodes) {
+    WritePartialFilm(0, 3);
+    WritePartialFilm(1, 3);
+    WritePartialFilm(2, 3);
+    WritePartialFilm(1, 2);
+    std::string node0 = "film_merge.pfm.0-of-3.film";
+    std::string node1 = "film_merge.pfm.1-of-3.film";
+    std::string node2 = "film_merge.pfm.2-of-3.film";
+    std::string other = "film_merge.pfm.1-of-2.film";
+
+    // Nodes missing, given twice or from a differently split render
+    EXPECT_FALSE(MergePartialFilms({node0, node1}, "film_merged.pfm"));
+    EXPECT_FALSE(MergePartialFilms({node0, node1, node1}, "film_merged.pfm"));
+    EXPECT_FALSE(MergePartialFilms({node0, node1, other}, "film_merged.pfm"));
+
+    // All of the nodes, in any order, give the average of their samples
+    ASSERT_TRUE(MergePartialFilms({node2, node0, node1}, "film_merged.pfm"));
+    Point2i res;
+    std::unique_ptr<RGBSpectrum[]> image = ReadImage("film_merged.pfm", &res);
+    ASSERT_TRUE(image.get() != nullptr);
+    ASSERT_EQ(Point2i(8, 4), res);
+    for (int i = 0; i < res.x * res.y; ++i) {
+        Float rgb[3];
+        image[i].ToRGB(rgb);
+        for (int c = 0; c < 3; ++c) EXPECT_NEAR(2, rgb[c], 1e-3f);
+    }
+
+    for (const std::string &name : {node0, node1, node2, other})
+        remove(name.c_str());
+    remove("film_merged.pfm");
+}
@@ -77,6 +77,29 @@ TEST(FloatingPoint, FloatBits) {
     }
 }
 
+TEST(FloatingPoint, Half) {
+    EXPECT_EQ(0x3c00, FloatToHalf(1.f));
+    EXPECT_EQ(0x8000, FloatToHalf(-0.f));
+    EXPECT_EQ(0x7c00, FloatToHalf(65520.f));
+    EXPECT_EQ(0x7bff, FloatToHalf(65519.f));
+    EXPECT_EQ(0x0001, FloatToHalf(5.9604645e-8f));
+
+    // Every half other than a NaN round-trips exactly
+    for (int h = 0; h < 65536; ++h) {
+        float f = HalfToFloat(h);
+        if (std::isnan(f)) continue;
+        EXPECT_EQ(h, FloatToHalf(f));
+    }
+
+    // Rounding is to the nearest half
+    RNG rng(7);
+    for (int i = 0; i < 100000; ++i) {
+        float f = Lerp(rng.UniformFloat(), -60000.f, 60000.f);
+        float r = HalfToFloat(FloatToHalf(f));
+        EXPECT_LE(std::abs(r - f), std::abs(f) * 4.8828125e-4f) << f;
+    }
+}
+
 TEST(FloatingPoint, DoubleBits) {
     RNG rng(2);
     for (int i = 0; i < 100000; ++i) {
@@ -0,0 +1,66 @@
+#include "tests/gtest/gtest.h"
+#include "pbrt.h"
+
+#include "integrators/guidedpath.h"
+#include "lowdiscrepancy.h"
+#include "rng.h"
+#include "sampling.h"
+
+using namespace pbrt;
+
+// Builds a directional tree from radiance concentrated around _peak_ over
+// a few rounds of recording and refinement.
+static DTree TrainedDTree(const Vector3f &peak, RNG &rng) {
+    DTree tree;
+    for (int round = 0; round < 4; ++round) {
+        DTree building = tree.Refined(.01f, 20);
+        for (int i = 0; i < 10000; ++i) {
+            Vector3f w = UniformSampleSphere(
+                Point2f(rng.UniformFloat(), rng.UniformFloat()));
+            Float radiance =
+                1 + 100 * std::pow(std::max<Float>(0, Dot(w, peak)), 20);
+            building.Record(w, radiance / UniformSpherePdf());
+        }
+        building.Build();
+        tree = building;
+    }
+    return tree;
+}
+
+TEST(DTree, SampleMatchesPdf) {
+    RNG rng;
+    Vector3f peak = Normalize(Vector3f(1, -2, .5f));
+    DTree tree = TrainedDTree(peak, rng);
+    ASSERT_GT(tree.Total(), 0);
+
+    int nearPeak = 0;
+    for (int i = 0; i < 10000; ++i) {
+        Float pdf;
+        Vector3f w =
+            tree.Sample(Point2f(rng.UniformFloat(), rng.UniformFloat()), &pdf);
+        EXPECT_NEAR(1, w.Length(), 1e-4f);
+        EXPECT_GT(pdf, 0);
+        EXPECT_NEAR(pdf, tree.Pdf(w), 1e-3f * pdf) << w;
+        if (Dot(w, peak) > .9f) ++nearPeak;
+    }
+    // Directions near the peak should be sampled much more often than
+    // uniform sampling would, which puts 5% of them there
+    EXPECT_GT(nearPeak, 2000);
+}
+
+TEST(DTree, PdfIntegratesToOne) {
+    RNG rng;
+    DTree tree = TrainedDTree(Normalize(Vector3f(0, .3f, 1)), rng);
+    const int count = 256 * 1024;
+    double sum = 0;
+    for (int i = 0; i < count; ++i) {
+        Vector3f w = UniformSampleSphere(Point2f(RadicalInverse(0, i),
+                                                 RadicalInverse(1, i)));
+        sum += tree.Pdf(w) / (count * UniformSpherePdf());
+    }
+    EXPECT_NEAR(1, sum, .01);
+
+    // An empty tree samples uniformly
+    DTree empty;
+    EXPECT_FLOAT_EQ(UniformSpherePdf(), empty.Pdf(Vector3f(0, 0, 1)));
+}
@@ -0,0 +1,87 @@
+#include "tests/gtest/gtest.h"
+#include "pbrt.h"
+
+#include "accelerators/bvh.h"
+#include "api.h"
+#include "cameras/perspective.h"
+#include "film.h"
+#include "filters/box.h"
+#include "imageio.h"
+#include "integrators/igi.h"
+#include "lights/point.h"
+#include "materials/matte.h"
+#include "materials/plastic.h"
+#include "samplers/halton.h"
+#include "scene.h"
+#include "shapes/sphere.h"
+#include "textures/constant.h"
+
+using namespace pbrt;
+
+// Renders the inside of a diffuse sphere that holds a glossy sphere and a
+// point light with the IGIIntegrator and returns the image.
+static std::unique_ptr<RGBSpectrum[]> RenderIGI(const Scene &scene,
+                                                bool lightcuts,
+                                                Point2i *resolution) {
+    *resolution = Point2i(16, 16);
+    AnimatedTransform identity(new Transform, 0, new Transform, 1);
+    std::unique_ptr<Filter> filter(new BoxFilter(Vector2f(0.5, 0.5)));
+    Film *film = new Film(*resolution, Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+                          std::move(filter), 1., "igi_test.exr", 1.);
+    std::shared_ptr<Camera> camera = std::make_shared<PerspectiveCamera>(
+        identity, Bounds2f(Point2f(-1, -1), Point2f(1, 1)), 0., 1., 0., 10.,
+        60, film, nullptr);
+    std::shared_ptr<Sampler> sampler = std::make_shared<HaltonSampler>(
+        4, Bounds2i(Point2i(0, 0), *resolution));
+    std::unique_ptr<Integrator> integrator(new IGIIntegrator(
+        camera, sampler, film->croppedPixelBounds, 5, 5, 64, 1, 10.f, 0,
+        lightcuts, 0.f, 1 << 20, "power"));
+    integrator->Render(scene);
+    std::unique_ptr<RGBSpectrum[]> image =
+        ReadImage("igi_test.exr", resolution);
+    EXPECT_EQ(0, remove("igi_test.exr"));
+    return image;
+}
+
+// With a zero error threshold, lightcuts must refine down to every virtual
+// light and so match connecting to each one of them directly.
+TEST(IGI, LightcutsMatchAllLights) {
+    Options options;
+    options.quiet = true;
+    pbrtInit(options);
+
+    static Transform id, inner = Translate(Vector3f(0, 0, .5f)),
+                         innerInv = Inverse(inner);
+    std::shared_ptr<Texture<Float>> zero =
+        std::make_shared<ConstantTexture<Float>>(0.f);
+    std::shared_ptr<Material> matte = std::make_shared<MatteMaterial>(
+        std::make_shared<ConstantTexture<Spectrum>>(SceneSpectrum(.5f)), zero,
+        nullptr);
+    std::shared_ptr<Material> plastic = std::make_shared<PlasticMaterial>(
+        std::make_shared<ConstantTexture<Spectrum>>(SceneSpectrum(.1f)),
+        std::make_shared<ConstantTexture<Spectrum>>(SceneSpectrum(.8f)),
+        std::make_shared<ConstantTexture<Float>>(.05f), nullptr, true);
+    std::vector<std::shared_ptr<Primitive>> prims;
+    prims.push_back(std::make_shared<GeometricPrimitive>(
+        std::make_shared<Sphere>(&id, &id, true, 1, -1, 1, 360), matte,
+        nullptr, MediumInterface()));
+    prims.push_back(std::make_shared<GeometricPrimitive>(
+        std::make_shared<Sphere>(&inner, &innerInv, false, .2f, -.2f, .2f,
+                                 360),
+        plastic, nullptr, MediumInterface()));
+    std::vector<std::shared_ptr<Light>> lights;
+    lights.push_back(std::make_shared<PointLight>(
+        Translate(Vector3f(.3f, .3f, 0)), nullptr, SceneSpectrum(1.f)));
+    Scene scene(std::make_shared<BVHAccel>(prims), lights);
+
+    Point2i resolution;
+    std::unique_ptr<RGBSpectrum[]> cut = RenderIGI(scene, true, &resolution);
+    std::unique_ptr<RGBSpectrum[]> all = RenderIGI(scene, false, &resolution);
+    ASSERT_TRUE(cut && all);
+    for (int i = 0; i < resolution.x * resolution.y; ++i)
+        for (int c = 0; c < 3; ++c)
+            EXPECT_NEAR(all[i][c], cut[i][c], 1e-3f * all[i][c] + 1e-6f)
+                << "pixel " << i;
+
+    pbrtCleanup();
+}
@@ -0,0 +1,125 @@
+#include "tests/gtest/gtest.h"
+#include "pbrt.h"
+
+#include "integrators/irradiancecache.h"
+#include "rng.h"
+#include "transform.h"
+
+using namespace pbrt;
+
+// Radiance from a plane at z = 1 with a bright square over [0,1]^2.
+static Spectrum PlaneRadiance(const Point3f &p, const Vector3f &w,
+                              Float *dist) {
+    if (w.z <= 0) {
+        *dist = Infinity;
+        return Spectrum(0.f);
+    }
+    *dist = (1 - p.z) / w.z;
+    Point3f ph = p + *dist * w;
+    bool inside = ph.x >= 0 && ph.x <= 1 && ph.y >= 0 && ph.y <= 1;
+    return Spectrum(inside ? 1.f : .2f);
+}
+
+static IrradianceSample SampleAt(const Point3f &p, const Normal3f &n,
+                                 int nTheta = 64) {
+    RNG rng;
+    return ComputeIrradianceSample(
+        p, n, nTheta, 3 * nTheta, rng, [&](const Vector3f &w, Float *dist) {
+            return PlaneRadiance(p, w, dist);
+        });
+}
+
+TEST(IrradianceCache, TranslationalGradient) {
+    Point3f p(.2f, .3f, 0);
+    Normal3f n(0, 0, 1);
+    IrradianceSample s = SampleAt(p, n);
+    EXPECT_GT(s.E.y(), .2f * Pi);
+    EXPECT_LT(s.E.y(), Pi);
+    EXPECT_NEAR(1.f, s.wAvg.Length(), 1e-4f);
+
+    const Float delta = .05f;
+    for (int axis = 0; axis < 2; ++axis) {
+        Vector3f d(0, 0, 0);
+        d[axis] = delta;
+        Float fd = (SampleAt(p + d, n).E.y() - SampleAt(p - d, n).E.y()) /
+                   (2 * delta);
+        Float grad = s.transGrad[axis].y();
+        EXPECT_NEAR(fd, grad, .2f * std::abs(fd) + .01f) << "axis " << axis;
+    }
+}
+
+TEST(IrradianceCache, RotationalGradient) {
+    Point3f p(.2f, .3f, 0);
+    Normal3f n(0, 0, 1);
+    // Rotating the normal changes which strata are used, so more of them
+    // are needed for the finite differences to converge
+    IrradianceSample s = SampleAt(p, n, 256);
+
+    const Float delta = .05f;
+    for (int axis = 0; axis < 2; ++axis) {
+        // Rotate the normal about the x or y axis
+        Vector3f a(0, 0, 0);
+        a[axis] = 1;
+        Normal3f nPlus(Rotate(Degrees(delta), a)(n));
+        Normal3f nMinus(Rotate(Degrees(-delta), a)(n));
+        Float fd =
+            (SampleAt(p, nPlus, 256).E.y() - SampleAt(p, nMinus, 256).E.y()) /
+            (2 * delta);
+        Float grad = s.rotGrad[axis].y();
+        EXPECT_NEAR(fd, grad, .2f * std::abs(fd) + .01f) << "axis " << axis;
+    }
+}
+
+TEST(IrradianceCache, Interpolate) {
+    IrradianceCache cache(.5f, std::cos(Radians(10.f)));
+    Point3f p(.2f, .3f, 0);
+    Normal3f n(0, 0, 1);
+    IrradianceSample s = SampleAt(p, n);
+    s.maxDist = .5f;
+    cache.Add({s});
+
+    // The gradients should improve the estimate at a nearby point
+    Point3f pNear(.3f, .35f, 0);
+    Spectrum E;
+    Vector3f wAvg;
+    ASSERT_TRUE(cache.Interpolate(pNear, n, &E, &wAvg));
+    Float exact = SampleAt(pNear, n).E.y();
+    EXPECT_LT(std::abs(E.y() - exact), std::abs(s.E.y() - exact));
+
+    // Far away points and ones with different normals aren't covered
+    EXPECT_FALSE(cache.Interpolate(Point3f(2, 2, 0), n, &E, &wAvg));
+    EXPECT_FALSE(cache.Interpolate(p, Normal3f(0, 1, 0), &E, &wAvg));
+    // Points that are beyond the interpolation limit but within the
+    // sample's radius can be extrapolated to
+    Point3f pFar(.6f, .3f, 0);
+    EXPECT_FALSE(cache.Interpolate(pFar, n, &E, &wAvg));
+    EXPECT_TRUE(cache.Interpolate(pFar, n, &E, &wAvg, true));
+}
+
+TEST(IrradianceCache, Insert) {
+    // Samples inserted one at a time, into an empty cache or one with a
+    // grid, should be found like added ones
+    IrradianceCache cache(.5f, std::cos(Radians(10.f)));
+    Normal3f n(0, 0, 1);
+    IrradianceSample s = SampleAt(Point3f(.2f, .3f, 0), n);
+    s.maxDist = .5f;
+    cache.Insert(s);
+    Spectrum E;
+    Vector3f wAvg;
+    EXPECT_TRUE(cache.Interpolate(Point3f(.25f, .3f, 0), n, &E, &wAvg));
+    EXPECT_FALSE(cache.Interpolate(Point3f(2, 2, 0), n, &E, &wAvg));
+
+    IrradianceSample far = SampleAt(Point3f(2, 2, 0), n);
+    far.maxDist = .5f;
+    cache.Insert(far);
+    EXPECT_EQ(2, cache.Size());
+    EXPECT_TRUE(cache.Interpolate(Point3f(2, 2.05f, 0), n, &E, &wAvg));
+    EXPECT_TRUE(cache.Interpolate(Point3f(.25f, .3f, 0), n, &E, &wAvg));
+
+    // A sample much larger than the grid's cells is limited in extent
+    IrradianceSample large = SampleAt(Point3f(-5, 0, 0), n);
+    large.maxDist = 1000;
+    cache.Insert(large);
+    EXPECT_TRUE(cache.Interpolate(Point3f(-5, .1f, 0), n, &E, &wAvg));
+    EXPECT_FALSE(cache.Interpolate(Point3f(-5, 100, 0), n, &E, &wAvg, true));
+}
@@ -0,0 +1,220 @@
+#include "tests/gtest/gtest.h"
+#include "pbrt.h"
+
+#include "accelerators/bvh.h"
+#include "lightdistrib.h"
+#include "lights/diffuse.h"
+#include "lights/distant.h"
+#include "lights/point.h"
+#include "lights/spot.h"
+#include "parallel.h"
+#include "primitive.h"
+#include "rng.h"
+#include "scene.h"
+#include "shapes/triangle.h"
+
+using namespace pbrt;
+
+static Point3f RandomPoint(RNG &rng, Float scale) {
+    return Point3f(scale * (2 * rng.UniformFloat() - 1),
+                   scale * (2 * rng.UniformFloat() - 1),
+                   scale * (2 * rng.UniformFloat() - 1));
+}
+
+TEST(LightDistribution, BVHSampleMatchesPMF) {
+    RNG rng;
+    static Transform identity;
+    MediumInterface mediumInterface;
+    std::vector<std::shared_ptr<Primitive>> prims;
+    std::vector<std::shared_ptr<Light>> lights;
+
+    // Randomly placed and oriented emissive triangles of varying power
+    for (int i = 0; i < 300; ++i) {
+        Point3f pc = RandomPoint(rng, 10);
+        Point3f p[3] = {pc + Vector3f(RandomPoint(rng, 0.5f)),
+                        pc + Vector3f(RandomPoint(rng, 0.5f)),
+                        pc + Vector3f(RandomPoint(rng, 0.5f))};
+        int indices[3] = {0, 1, 2};
+        std::shared_ptr<Shape> tri =
+            CreateTriangleMesh(&identity, &identity, false, 1, indices, 3, p,
+                               nullptr, nullptr, nullptr, nullptr, nullptr)[0];
+        std::shared_ptr<AreaLight> area = std::make_shared<DiffuseAreaLight>(
+            identity, mediumInterface, SceneSpectrum(1 + 10 * rng.UniformFloat()),
+            1, tri, (i % 5) == 0);
+        prims.push_back(std::make_shared<GeometricPrimitive>(
+            tri, nullptr, area, mediumInterface));
+        lights.push_back(area);
+    }
+    // Point and spot lights and a light that can't be bounded
+    for (int i = 0; i < 5; ++i)
+        lights.push_back(std::make_shared<PointLight>(
+            Translate(Vector3f(RandomPoint(rng, 10))), nullptr,
+            SceneSpectrum(5)));
+    lights.push_back(std::make_shared<SpotLight>(
+        Translate(Vector3f(1, 2, 3)), nullptr, SceneSpectrum(20), 30, 20));
+    lights.push_back(std::make_shared<DistantLight>(
+        identity, SceneSpectrum(1), Vector3f(0, 0, 1)));
+    Scene scene(std::make_shared<BVHAccel>(prims), lights);
+    BVHLightDistribution distrib(scene);
+
+    for (int i = 0; i < 100; ++i) {
+        // Points inside and outside of the lights' bounds, on surfaces and
+        // in media
+        Point3f p = RandomPoint(rng, 15);
+        Normal3f n(0, 0, 0);
+        if (i & 1)
+            n = Normalize(Normal3f(Vector3f(RandomPoint(rng, 1))));
+
+        Float sum = 0;
+        for (size_t j = 0; j < lights.size(); ++j) {
+            Float pmf = distrib.PMF(p, n, int(j));
+            EXPECT_GE(pmf, 0);
+            sum += pmf;
+        }
+        EXPECT_LE(sum, 1.0001f);
+        // The distant light is always chosen with probability 1/2
+        EXPECT_FLOAT_EQ(0.5f, distrib.PMF(p, n, int(lights.size() - 1)));
+
+        for (int j = 0; j < 100; ++j) {
+            Float pmf;
+            int lightIndex = distrib.Sample(p, n, rng.UniformFloat(), &pmf);
+            if (lightIndex < 0) continue;
+            EXPECT_GT(pmf, 0);
+            EXPECT_NEAR(pmf, distrib.PMF(p, n, lightIndex), 1e-4f * pmf)
+                << "light " << lightIndex << ", p " << p << ", n " << n;
+        }
+    }
+}
+
+TEST(LightDistribution, BVHSkipsBackfacingLights) {
+    // Two one-sided quads facing +z and -z; points above the first
+    // should only sample it
+    static Transform identity;
+    MediumInterface mediumInterface;
+    std::vector<std::shared_ptr<Primitive>> prims;
+    std::vector<std::shared_ptr<Light>> lights;
+    for (int side = 0; side < 2; ++side) {
+        Float z = side == 0 ? 0 : -1;
+        Point3f p[4] = {Point3f(0, 0, z), Point3f(1, 0, z), Point3f(1, 1, z),
+                        Point3f(0, 1, z)};
+        int indices[6] = {0, 1, 2, 0, 2, 3};
+        for (const std::shared_ptr<Shape> &tri : CreateTriangleMesh(
+                 &identity, &identity, side == 1, 2, indices, 4, p, nullptr,
+                 nullptr, nullptr, nullptr, nullptr)) {
+            std::shared_ptr<AreaLight> area =
+                std::make_shared<DiffuseAreaLight>(
+                    identity, mediumInterface, SceneSpectrum(1), 1, tri);
+            prims.push_back(std::make_shared<GeometricPrimitive>(
+                tri, nullptr, area, mediumInterface));
+            lights.push_back(area);
+        }
+    }
+    Scene scene(std::make_shared<BVHAccel>(prims), lights);
+    BVHLightDistribution distrib(scene);
+
+    Point3f p(0.5, 0.5, 2);
+    EXPECT_FLOAT_EQ(1, distrib.PMF(p, Normal3f(0, 0, 0), 0) +
+                           distrib.PMF(p, Normal3f(0, 0, 0), 1));
+    EXPECT_EQ(0, distrib.PMF(p, Normal3f(0, 0, 0), 2));
+    EXPECT_EQ(0, distrib.PMF(p, Normal3f(0, 0, 0), 3));
+    // Below both, only the second quad's lights can be chosen
+    Point3f q(0.5, 0.5, -3);
+    EXPECT_EQ(0, distrib.PMF(q, Normal3f(0, 0, 1), 0));
+    EXPECT_FLOAT_EQ(1, distrib.PMF(q, Normal3f(0, 0, 1), 2) +
+                           distrib.PMF(q, Normal3f(0, 0, 1), 3));
+}
+
+TEST(LightDistribution, SpatialReadWrite) {
+    ParallelInit();
+    RNG rng;
+    std::vector<std::shared_ptr<Light>> lights;
+    for (int i = 0; i < 20; ++i)
+        lights.push_back(std::make_shared<PointLight>(
+            Translate(Vector3f(RandomPoint(rng, 10))), nullptr,
+            SceneSpectrum(1 + 10 * rng.UniformFloat())));
+    // A floor to give the scene its extent
+    static Transform identity;
+    MediumInterface mediumInterface;
+    std::vector<std::shared_ptr<Primitive>> prims;
+    Point3f p[4] = {Point3f(-10, -10, -10), Point3f(10, -10, -10),
+                    Point3f(10, 10, 10), Point3f(-10, 10, 10)};
+    int indices[6] = {0, 1, 2, 0, 2, 3};
+    for (const std::shared_ptr<Shape> &tri :
+         CreateTriangleMesh(&identity, &identity, false, 2, indices, 4, p,
+                            nullptr, nullptr, nullptr, nullptr, nullptr))
+        prims.push_back(std::make_shared<GeometricPrimitive>(
+            tri, nullptr, nullptr, mediumInterface));
+    std::shared_ptr<Primitive> bvh = std::make_shared<BVHAccel>(prims);
+    Scene scene(bvh, lights);
+    std::vector<Point3f> points;
+    for (int i = 0; i < 50; ++i) points.push_back(RandomPoint(rng, 10));
+
+    SpatialLightDistribution distrib(scene, 16);
+    distrib.Precompute(points);
+    ASSERT_TRUE(distrib.Write("lightdistrib.bin"));
+
+    // Distributions read back should match the computed ones exactly
+    SpatialLightDistribution readDistrib(scene, 16);
+    ASSERT_TRUE(readDistrib.Read("lightdistrib.bin"));
+    for (const Point3f &p : points) {
+        const Distribution1D *a = distrib.Lookup(p), *b = readDistrib.Lookup(p);
+        ASSERT_EQ(a->Count(), b->Count());
+        for (int i = 0; i < a->Count(); ++i) EXPECT_EQ(a->func[i], b->func[i]);
+    }
+
+    // Distributions for a different voxel grid can't be used
+    SpatialLightDistribution otherDistrib(scene, 8);
+    EXPECT_FALSE(otherDistrib.Read("lightdistrib.bin"));
+
+    // Nor can they be used if a light is aimed differently, though its
+    // position and power are the same
+    std::vector<std::shared_ptr<Light>> spots[2];
+    for (int i = 0; i < 2; ++i) {
+        Transform aim = Translate(Vector3f(1, 2, 3)) *
+                        RotateX(i == 0 ? 30 : 60);
+        spots[i].push_back(std::make_shared<SpotLight>(
+            aim, mediumInterface, SceneSpectrum(10), 30, 25));
+    }
+    Scene spotScene(bvh, spots[0]);
+    Scene aimedScene(bvh, spots[1]);
+    SpatialLightDistribution spotDistrib(spotScene, 16);
+    spotDistrib.Precompute(points);
+    ASSERT_TRUE(spotDistrib.Write("lightdistrib.bin"));
+    SpatialLightDistribution aimedDistrib(aimedScene, 16);
+    EXPECT_FALSE(aimedDistrib.Read("lightdistrib.bin"));
+
+    // Writes go through a temporary file that doesn't outlive them
+    FILE *f = fopen("lightdistrib.bin.tmp", "rb");
+    EXPECT_EQ(nullptr, f);
+    if (f) fclose(f);
+    remove("lightdistrib.bin");
+    ParallelCleanup();
+}
+
+TEST(LightDistribution, SpatialSurfacePoints) {
+    // Two parallel quads; each of the rays along z through the voxel grid
+    // should hit both of them, and the rays along x and y neither
+    static Transform identity;
+    MediumInterface mediumInterface;
+    std::vector<std::shared_ptr<Primitive>> prims;
+    for (Float z : {0.f, 4.f}) {
+        Point3f p[4] = {Point3f(-10, -10, z), Point3f(10, -10, z),
+                        Point3f(10, 10, z), Point3f(-10, 10, z)};
+        int indices[6] = {0, 1, 2, 0, 2, 3};
+        for (const std::shared_ptr<Shape> &tri :
+             CreateTriangleMesh(&identity, &identity, false, 2, indices, 4, p,
+                                nullptr, nullptr, nullptr, nullptr, nullptr))
+            prims.push_back(std::make_shared<GeometricPrimitive>(
+                tri, nullptr, nullptr, mediumInterface));
+    }
+    std::vector<std::shared_ptr<Light>> lights;
+    lights.push_back(std::make_shared<PointLight>(
+        Translate(Vector3f(0, 0, 2)), nullptr, SceneSpectrum(1)));
+    Scene scene(std::make_shared<BVHAccel>(prims), lights);
+
+    SpatialLightDistribution distrib(scene, 16);
+    std::vector<Point3f> points = distrib.SurfacePoints();
+    EXPECT_EQ(2 * 16 * 16, points.size());
+    for (const Point3f &p : points)
+        EXPECT_TRUE(std::abs(p.z) < 1e-3f || std::abs(p.z - 4) < 1e-3f) << p;
+}
@@ -0,0 +1,95 @@
+#include "tests/gtest/gtest.h"
+#include "pbrt.h"
+
+#include "accelerators/bvh.h"
+#include "imageio.h"
+#include "lights/infinite.h"
+#include "parallel.h"
+#include "primitive.h"
+#include "rng.h"
+#include "scene.h"
+#include "shapes/triangle.h"
+
+using namespace pbrt;
+
+TEST(InfiniteAreaLight, HierarchicalSampling) {
+    ParallelInit();
+    // A random environment map with a bright spot
+    RNG rng;
+    Point2i res(64, 32);
+    std::vector<Float> rgb(3 * res.x * res.y);
+    for (size_t i = 0; i < rgb.size(); ++i) rgb[i] = rng.UniformFloat();
+    for (int c = 0; c < 3; ++c) rgb[3 * (10 * res.x + 20) + c] = 1000;
+    WriteImage("infinite.exr", &rgb[0], Bounds2i({0, 0}, res), res);
+
+    // A quad that occludes part of the sky for guiding
+    static Transform identity;
+    MediumInterface mediumInterface;
+    std::vector<std::shared_ptr<Primitive>> prims;
+    Point3f p[4] = {Point3f(-1, -1, 1), Point3f(1, -1, 1), Point3f(1, 1, 1),
+                    Point3f(-1, 1, 1)};
+    int indices[6] = {0, 1, 2, 0, 2, 3};
+    for (const std::shared_ptr<Shape> &tri :
+         CreateTriangleMesh(&identity, &identity, false, 2, indices, 4, p,
+                            nullptr, nullptr, nullptr, nullptr, nullptr))
+        prims.push_back(std::make_shared<GeometricPrimitive>(
+            tri, nullptr, nullptr, mediumInterface));
+
+    std::vector<std::shared_ptr<Light>> lights;
+    lights.push_back(std::make_shared<InfiniteAreaLight>(
+        identity, SceneSpectrum(1), 1, "infinite.exr"));
+    lights.push_back(std::make_shared<InfiniteAreaLight>(
+        identity, SceneSpectrum(1), 1, "infinite.exr", true));
+    lights.push_back(std::make_shared<InfiniteAreaLight>(
+        identity, SceneSpectrum(1), 1, "infinite.exr", true, 4));
+    Scene scene(std::make_shared<BVHAccel>(prims), lights);
+
+    // Sampled PDFs should match Pdf_Li(), other than for the occasional
+    // direction that round-off moves into a neighboring texel, and all
+    // methods should give the same estimate of the incident radiance
+    Float estimate[3] = {0, 0, 0};
+    int mismatches[3] = {0, 0, 0};
+    const int n = 20000;
+    for (int i = 0; i < n; ++i) {
+        Interaction ref(Point3f(2 * rng.UniformFloat() - 1,
+                                2 * rng.UniformFloat() - 1, rng.UniformFloat()),
+                        0, MediumInterface());
+        Point2f u(rng.UniformFloat(), rng.UniformFloat());
+        for (size_t l = 0; l < lights.size(); ++l) {
+            Vector3f wi;
+            Float pdf;
+            VisibilityTester vis;
+            Spectrum Li = lights[l]->Sample_Li(ref, u, &wi, &pdf, &vis);
+            if (pdf == 0) continue;
+            if (std::abs(pdf - lights[l]->Pdf_Li(ref, wi)) > 1e-2f * pdf)
+                ++mismatches[l];
+            estimate[l] += Li.y() / (pdf * n);
+        }
+    }
+    for (int l = 0; l < 3; ++l) EXPECT_LT(mismatches[l], n / 1000);
+    EXPECT_NEAR(estimate[0], estimate[1], 0.02f * estimate[0]);
+    EXPECT_NEAR(estimate[0], estimate[2], 0.02f * estimate[0]);
+
+    // Sampling the whole image's distribution should preserve the samples'
+    // stratification: for a given second dimension, the sampled direction's
+    // $\phi$ must increase with the first one. Hierarchical sampling
+    // chooses cells with an alias table, which doesn't.
+    Interaction ref(Point3f(0, 0, 0), 0, MediumInterface());
+    for (int l = 0; l < 1; ++l)
+        for (int j = 0; j < 16; ++j) {
+            Float prevPhi = 0;
+            for (int i = 0; i < 256; ++i) {
+                Vector3f wi;
+                Float pdf;
+                VisibilityTester vis;
+                lights[l]->Sample_Li(
+                    ref, Point2f((i + .5f) / 256, (j + .5f) / 16), &wi, &pdf,
+                    &vis);
+                Float phi = SphericalPhi(wi);
+                EXPECT_GE(phi, prevPhi - 1e-4f) << "light " << l;
+                prevPhi = phi;
+            }
+        }
+    remove("infinite.exr");
+    ParallelCleanup();
+}
@@ -0,0 +1,172 @@
+#include "tests/gtest/gtest.h"
+#include "pbrt.h"
+#include "mipmap.h"
+#include "imageio.h"
+#include "parallel.h"
+#include "texcache.h"
+#include "rng.h"
+
+using namespace pbrt;
+
+// Returns the largest and average per-component differences between all
+// texels of two MIP maps of the same image.
+template <typename T>
+static void CompareTexels(const MIPMap<T> &a, const MIPMap<T> &b,
+                          Float *maxErr, Float *avgErr) {
+    EXPECT_EQ(a.Levels(), b.Levels());
+    *maxErr = *avgErr = 0;
+    int count = 0;
+    for (int level = 0; level < a.Levels(); ++level) {
+        int res = std::max(a.Width(), a.Height()) >> level;
+        for (int t = 0; t < std::max(1, res); ++t)
+            for (int s = 0; s < std::max(1, res); ++s) {
+                T va = a.Texel(level, s, t), vb = b.Texel(level, s, t);
+                for (int c = 0; c < TexelChannels<T>::n; ++c) {
+                    Float err = std::abs(TexelChannels<T>::Get(va, c) -
+                                         TexelChannels<T>::Get(vb, c));
+                    *maxErr = std::max(*maxErr, err);
+                    *avgErr += err;
+                    ++count;
+                }
+            }
+    }
+    *avgErr /= count;
+}
+
+TEST(MIPMap, TexelFormats) {
+    ParallelInit();
+    Point2i res(64, 64);
+    std::vector<RGBSpectrum> rgb(res.x * res.y);
+    std::vector<Float> gray(res.x * res.y);
+    for (int y = 0; y < res.y; ++y)
+        for (int x = 0; x < res.x; ++x) {
+            Float v[3] = {Float(x) / res.x, Float(y) / res.y,
+                          0.5f + 0.4f * std::sin(0.1f * (x + y))};
+            rgb[y * res.x + x] = RGBSpectrum::FromRGB(v);
+            gray[y * res.x + x] = v[2];
+        }
+
+    MIPMap<RGBSpectrum> rgbRef(res, &rgb[0]);
+    MIPMap<Float> grayRef(res, &gray[0]);
+    struct {
+        TexelFormat format;
+        Float maxErr, avgErr;
+    } tests[] = {{TexelFormat::Half, 1e-3f, 2e-4f},
+                 {TexelFormat::SRGB8, 5e-3f, 2e-3f},
+                 {TexelFormat::BC, 0.15f, 0.02f}};
+    for (const auto &test : tests) {
+        Float maxErr, avgErr;
+        MIPMap<RGBSpectrum> rgbMap(res, &rgb[0], false, 8.f,
+                                   ImageWrap::Repeat, test.format);
+        EXPECT_EQ(test.format, rgbMap.Format());
+        CompareTexels(rgbRef, rgbMap, &maxErr, &avgErr);
+        EXPECT_LT(maxErr, test.maxErr) << int(test.format);
+        EXPECT_LT(avgErr, test.avgErr) << int(test.format);
+
+        MIPMap<Float> grayMap(res, &gray[0], false, 8.f, ImageWrap::Repeat,
+                              test.format);
+        CompareTexels(grayRef, grayMap, &maxErr, &avgErr);
+        EXPECT_LT(maxErr, test.maxErr) << int(test.format);
+        EXPECT_LT(avgErr, test.avgErr) << int(test.format);
+    }
+
+    // Texels greater than one can't be stored as 8-bit sRGB
+    Float bright = 4;
+    MIPMap<Float> brightMap(Point2i(1, 1), &bright, false, 8.f,
+                            ImageWrap::Repeat, TexelFormat::SRGB8);
+    EXPECT_EQ(TexelFormat::Half, brightMap.Format());
+    EXPECT_EQ(bright, brightMap.Texel(0, 0, 0));
+    ParallelCleanup();
+}
+
+TEST(MIPMap, TextureCache) {
+    ParallelInit();
+    Point2i res(200, 150);
+    std::vector<Float> rgb(3 * res.x * res.y);
+    for (int i = 0; i < res.x * res.y; ++i) {
+        int x = i % res.x, y = i / res.x;
+        rgb[3 * i] = Float(x) / res.x;
+        rgb[3 * i + 1] = Float(y) / res.y;
+        rgb[3 * i + 2] = (x ^ y) & 1;
+    }
+    WriteImage("texcache.exr", &rgb[0], Bounds2i({0, 0}, res), res);
+    ASSERT_TRUE(WriteTiledMIPMap("texcache.exr", "texcache_tiled.exr"));
+    EXPECT_TRUE(TextureCache::IsTiledTexture("texcache_tiled.exr"));
+    EXPECT_FALSE(TextureCache::IsTiledTexture("texcache.exr"));
+
+    // Compare with a MIP map of the y-flipped image, as image textures use
+    // for untiled files; the cache can only hold a few tiles at once
+    Point2i readRes;
+    std::unique_ptr<RGBSpectrum[]> image = ReadImage("texcache.exr", &readRes);
+    ASSERT_TRUE(image.get() != nullptr);
+    for (int y = 0; y < res.y / 2; ++y)
+        for (int x = 0; x < res.x; ++x)
+            std::swap(image[y * res.x + x], image[(res.y - 1 - y) * res.x + x]);
+    MIPMap<RGBSpectrum> mipmap(res, image.get());
+    TextureCache cache(0);
+    int texture = cache.AddTexture("texcache_tiled.exr");
+    ASSERT_EQ(0, texture);
+    MIPMap<RGBSpectrum> cached(
+        &cache, texture, [](const RGBSpectrum &v) { return v; });
+    ASSERT_EQ(mipmap.Levels(), cached.Levels());
+    for (int level = 0; level < mipmap.Levels(); ++level) {
+        int width = std::max(1, mipmap.Width() >> level);
+        int height = std::max(1, mipmap.Height() >> level);
+        for (int t = 0; t < height; ++t)
+            for (int s = 0; s < width; ++s) {
+                RGBSpectrum a = mipmap.Texel(level, s, t);
+                RGBSpectrum b = cached.Texel(level, s, t);
+                for (int c = 0; c < 3; ++c)
+                    EXPECT_LT(std::abs(a[c] - b[c]),
+                              1e-3f * std::max<Float>(1, a[c]))
+                        << level << " " << s << " " << t;
+            }
+    }
+    remove("texcache.exr");
+    remove("texcache_tiled.exr");
+    ParallelCleanup();
+}
+
+TEST(MIPMap, EWA) {
+    ParallelInit();
+    // Linear ramps in each channel, which symmetric filters preserve
+    Point2i res(64, 64);
+    std::vector<RGBSpectrum> rgb(res.x * res.y);
+    std::vector<Float> gray(res.x * res.y);
+    for (int y = 0; y < res.y; ++y)
+        for (int x = 0; x < res.x; ++x) {
+            Float v[3] = {Float(x) / res.x, Float(y) / res.y,
+                          1 - Float(x) / res.x};
+            rgb[y * res.x + x] = RGBSpectrum::FromRGB(v);
+            gray[y * res.x + x] = v[1];
+        }
+    MIPMap<RGBSpectrum> rgbMap(res, &rgb[0]);
+    MIPMap<Float> grayMap(res, &gray[0]);
+    // Texels of half-float maps aren't read directly
+    MIPMap<RGBSpectrum> halfMap(res, &rgb[0], false, 8.f, ImageWrap::Repeat,
+                                TexelFormat::Half);
+
+    RNG rng;
+    for (int i = 0; i < 100; ++i) {
+        // Anisotropic footprints of a few texels, well inside the image
+        Point2f st(.3f + .4f * rng.UniformFloat(),
+                   .3f + .4f * rng.UniformFloat());
+        Float phi = 2 * Pi * rng.UniformFloat();
+        Float major = (1 + 4 * rng.UniformFloat()) / res.x;
+        Float minor = major * (.2f + .8f * rng.UniformFloat());
+        Vector2f dst0(major * std::cos(phi), major * std::sin(phi));
+        Vector2f dst1(-minor * std::sin(phi), minor * std::cos(phi));
+
+        Float s = st[0] - .5f / res.x, t = st[1] - .5f / res.y;
+        Float expected[3] = {s, t, 1 - s};
+        Float tolerance = 1.f / res.x;
+        RGBSpectrum v = rgbMap.Lookup(st, dst0, dst1);
+        RGBSpectrum h = halfMap.Lookup(st, dst0, dst1);
+        for (int c = 0; c < 3; ++c) {
+            EXPECT_NEAR(expected[c], v[c], tolerance) << "channel " << c;
+            EXPECT_NEAR(h[c], v[c], 2e-3f) << "channel " << c;
+        }
+        EXPECT_NEAR(v[1], grayMap.Lookup(st, dst0, dst1), 1e-5f);
+    }
+    ParallelCleanup();
+}
@@ -0,0 +1,195 @@
+#include "tests/gtest/gtest.h"
+#include "pbrt.h"
+
+#include "accelerators/bvh.h"
+#include "api.h"
+#include "cameras/orthographic.h"
+#include "film.h"
+#include "filters/box.h"
+#include "imageio.h"
+#include "integrators/directlighting.h"
+#include "integrators/restir.h"
+#include "lights/point.h"
+#include "materials/matte.h"
+#include "rng.h"
+#include "samplers/halton.h"
+#include "scene.h"
+#include "shapes/triangle.h"
+#include "textures/constant.h"
+
+using namespace pbrt;
+
+TEST(LightReservoir, ChoosesInProportionToWeight) {
+    // Streaming candidates through a reservoir, directly or by merging
+    // two reservoirs of half of them each, should choose each one in
+    // proportion to its weight
+    const Float weights[4] = {1, 2, 3, 4};
+    int counts[2][4] = {{0, 0, 0, 0}, {0, 0, 0, 0}};
+    RNG rng;
+    const int n = 100000;
+    for (int i = 0; i < n; ++i) {
+        LightReservoir r;
+        for (int j = 0; j < 4; ++j)
+            r.Add(j, Point2f(0, 0), weights[j], weights[j], rng.UniformFloat());
+        ASSERT_GE(r.lightIndex, 0);
+        ++counts[0][r.lightIndex];
+        EXPECT_EQ(4, r.M);
+        EXPECT_FLOAT_EQ(10.f / (4 * weights[r.lightIndex]), r.Weight());
+
+        LightReservoir a, b;
+        for (int j = 0; j < 2; ++j)
+            a.Add(j, Point2f(0, 0), weights[j], weights[j], rng.UniformFloat());
+        for (int j = 2; j < 4; ++j)
+            b.Add(j, Point2f(0, 0), weights[j], weights[j], rng.UniformFloat());
+        a.Merge(b, b.targetPdf, rng.UniformFloat());
+        ++counts[1][a.lightIndex];
+        EXPECT_EQ(4, a.M);
+        EXPECT_FLOAT_EQ(10, a.weightSum);
+    }
+    for (int k = 0; k < 2; ++k)
+        for (int j = 0; j < 4; ++j)
+            EXPECT_NEAR(weights[j] / 10, Float(counts[k][j]) / n, .01f)
+                << "light " << j;
+}
+
+// Renders a diffuse plane lit by point lights through an orthographic
+// camera, using either the DirectLightingIntegrator with the given
+// strategy or the ReSTIRIntegrator, and returns the image.
+static std::unique_ptr<RGBSpectrum[]> RenderPlane(const Scene &scene,
+                                                  const std::string &method,
+                                                  int spp,
+                                                  Point2i *resolution) {
+    *resolution = Point2i(16, 16);
+    AnimatedTransform identity(new Transform, 0, new Transform, 1);
+    std::unique_ptr<Filter> filter(new BoxFilter(Vector2f(0.5, 0.5)));
+    Film *film = new Film(*resolution, Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+                          std::move(filter), 1., "restir_test.exr", 1.);
+    std::shared_ptr<Camera> camera = std::make_shared<OrthographicCamera>(
+        identity, Bounds2f(Point2f(-1, -1), Point2f(1, 1)), 0., 1., 0., 10.,
+        film, nullptr);
+    std::shared_ptr<Sampler> sampler = std::make_shared<HaltonSampler>(
+        spp, Bounds2i(Point2i(0, 0), *resolution));
+    std::unique_ptr<Integrator> integrator;
+    if (method == "restir")
+        integrator.reset(new ReSTIRIntegrator(camera, sampler, 5, 4, 5, 4.f,
+                                              true, 20, true, "power"));
+    else
+        integrator.reset(new DirectLightingIntegrator(
+            method == "resample" ? LightStrategy::ResampleOne
+                                 : LightStrategy::UniformSampleAll,
+            5, camera, sampler, film->croppedPixelBounds, 4));
+    integrator->Render(scene);
+    std::unique_ptr<RGBSpectrum[]> image =
+        ReadImage("restir_test.exr", resolution);
+    EXPECT_EQ(0, remove("restir_test.exr"));
+    return image;
+}
+
+// Returns a scene with a diffuse plane at z = 2, facing the camera at the
+// origin, and the given point lights. The plane is shadowed from the
+// first light for x < -0.5 by an invisible quad.
+static std::unique_ptr<Scene> PlaneScene(
+    const std::vector<std::shared_ptr<Light>> &lights) {
+    static Transform identity;
+    MediumInterface mediumInterface;
+    std::shared_ptr<Material> matte = std::make_shared<MatteMaterial>(
+        std::make_shared<ConstantTexture<Spectrum>>(SceneSpectrum(.5f)),
+        std::make_shared<ConstantTexture<Float>>(0.f), nullptr);
+    std::vector<std::shared_ptr<Primitive>> prims;
+    int indices[6] = {0, 1, 2, 0, 2, 3};
+    Point3f plane[4] = {Point3f(-10, -10, 2), Point3f(10, -10, 2),
+                        Point3f(10, 10, 2), Point3f(-10, 10, 2)};
+    for (const std::shared_ptr<Shape> &tri :
+         CreateTriangleMesh(&identity, &identity, false, 2, indices, 4, plane,
+                            nullptr, nullptr, nullptr, nullptr, nullptr))
+        prims.push_back(std::make_shared<GeometricPrimitive>(
+            tri, matte, nullptr, mediumInterface));
+    Point3f occluder[4] = {Point3f(-10, -10, 1.5f), Point3f(-.5f, -10, 1.5f),
+                           Point3f(-.5f, 10, 1.5f), Point3f(-10, 10, 1.5f)};
+    for (const std::shared_ptr<Shape> &tri :
+         CreateTriangleMesh(&identity, &identity, false, 2, indices, 4,
+                            occluder, nullptr, nullptr, nullptr, nullptr,
+                            nullptr))
+        prims.push_back(std::make_shared<GeometricPrimitive>(
+            tri, nullptr, nullptr, mediumInterface));
+    return std::unique_ptr<Scene>(
+        new Scene(std::make_shared<BVHAccel>(prims), lights));
+}
+
+// With a single light, every candidate is a sample of it with the same
+// weight, so both resampling methods should match the exact result at
+// every pixel. Pixels next to the shadow's edge reuse samples from
+// shadowed neighbors, which must still be counted when normalizing.
+// The ReSTIRIntegrator doesn't filter its samples, so its pixels differ
+// slightly from the others' where samples lie on their edges.
+TEST(ReSTIR, SingleLightIsExact) {
+    Options options;
+    options.quiet = true;
+    pbrtInit(options);
+
+    std::vector<std::shared_ptr<Light>> lights;
+    lights.push_back(std::make_shared<PointLight>(
+        Translate(Vector3f(-.5f, 0, 1)), nullptr, SceneSpectrum(1.f)));
+    std::unique_ptr<Scene> scene = PlaneScene(lights);
+
+    Point2i res;
+    std::unique_ptr<RGBSpectrum[]> ref = RenderPlane(*scene, "all", 16, &res);
+    std::unique_ptr<RGBSpectrum[]> resample =
+        RenderPlane(*scene, "resample", 16, &res);
+    std::unique_ptr<RGBSpectrum[]> restir =
+        RenderPlane(*scene, "restir", 16, &res);
+    ASSERT_TRUE(ref && resample && restir);
+    int nShadowed = 0;
+    for (int i = 0; i < res.x * res.y; ++i) {
+        if (ref[i].y() == 0) ++nShadowed;
+        for (int c = 0; c < 3; ++c) {
+            EXPECT_NEAR(ref[i][c], resample[i][c], 1e-3f * ref[i][c])
+                << "pixel " << i;
+            EXPECT_NEAR(ref[i][c], restir[i][c], .02f * ref[i][c])
+                << "pixel " << i;
+        }
+    }
+    // Make sure that the shadow is in the image
+    EXPECT_GT(nShadowed, res.x);
+    EXPECT_LT(nShadowed, res.x * res.y / 2);
+
+    pbrtCleanup();
+}
+
+// With several lights, both resampling methods should be unbiased; the
+// reused samples are correlated, so enough passes are needed for the
+// ReSTIRIntegrator's image to converge.
+TEST(ReSTIR, ManyLightsMatchReference) {
+    Options options;
+    options.quiet = true;
+    pbrtInit(options);
+
+    std::vector<std::shared_ptr<Light>> lights;
+    lights.push_back(std::make_shared<PointLight>(
+        Translate(Vector3f(-.5f, 0, 1)), nullptr, SceneSpectrum(1.f)));
+    RNG rng;
+    for (int i = 0; i < 7; ++i)
+        lights.push_back(std::make_shared<PointLight>(
+            Translate(Vector3f(2 * rng.UniformFloat() - 1,
+                               2 * rng.UniformFloat() - 1, 1.75f)),
+            nullptr, SceneSpectrum(.05f + .1f * rng.UniformFloat())));
+    std::unique_ptr<Scene> scene = PlaneScene(lights);
+
+    Point2i res;
+    std::unique_ptr<RGBSpectrum[]> ref = RenderPlane(*scene, "all", 64, &res);
+    std::unique_ptr<RGBSpectrum[]> resample =
+        RenderPlane(*scene, "resample", 64, &res);
+    std::unique_ptr<RGBSpectrum[]> restir =
+        RenderPlane(*scene, "restir", 64, &res);
+    ASSERT_TRUE(ref && resample && restir);
+    Float sumRef = 0, sumResample = 0, sumReSTIR = 0;
+    for (int i = 0; i < res.x * res.y; ++i) {
+        sumRef += ref[i].y();
+        sumResample += resample[i].y();
+        sumReSTIR += restir[i].y();
+    }
+    EXPECT_NEAR(sumRef, sumResample, .02f * sumRef);
+    EXPECT_NEAR(sumRef, sumReSTIR, .02f * sumRef);
+
+    pbrtCleanup();
+}
@@ -3,10 +3,15 @@
 #include <stdint.h>
 #include <algorithm>
 #include "pbrt.h"
+#include "camera.h"
 #include "rng.h"
 #include "sampling.h"
 #include "lowdiscrepancy.h"
+#include "parallel.h"
+#include "samplers/bluenoise.h"
+#include "samplers/halton.h"
 #include "samplers/maxmin.h"
+#include "samplers/paddedsobol.h"
 #include "samplers/sobol.h"
 #include "samplers/zerotwosequence.h"
 
@@ -184,6 +189,136 @@ TEST(LowDiscrepancy, ElementaryIntervals) {
                                   1 << logSamples,
                                   Bounds2i(Point2i(0, 0), Point2i(10, 10)))),
                      logSamples);
+        checkSampler("PaddedSobol", std::unique_ptr<Sampler>(
+                                        new PaddedSobolSampler(1 << logSamples)),
+                     logSamples);
+    }
+}
+
+// The blue-noise sampler toroidally shifts Owen-scrambled Sobol$'$ points,
+// which have one point in each elementary interval. Shifted by less than
+// an interval in each dimension, every one of them overlaps at most two
+// (1D) or four (2D) of the original intervals, so no interval can hold
+// more points than that. The same holds for sample arrays, which use
+// separate dimension numbers.
+TEST(BlueNoiseSampler, ShiftedStratification) {
+    const int logSamples = 6, n = 1 << logSamples;
+    BlueNoiseSampler sampler(n);
+    sampler.Request1DArray(n);
+    sampler.Request2DArray(n);
+    auto check1D = [&](const std::vector<Float> &u, const char *what) {
+        std::vector<int> count(n, 0);
+        for (Float v : u) {
+            ASSERT_TRUE(v >= 0 && v < 1);
+            EXPECT_LE(++count[int(v * n)], 2) << what;
+        }
+    };
+    auto check2D = [&](const std::vector<Point2f> &u, const char *what) {
+        for (int i = 0; i <= logSamples; ++i) {
+            int nx = 1 << i, ny = 1 << (logSamples - i);
+            std::vector<int> count(n, 0);
+            for (const Point2f &v : u) {
+                ASSERT_TRUE(v.x >= 0 && v.x < 1 && v.y >= 0 && v.y < 1);
+                int index = int(v.y * ny) * nx + int(v.x * nx);
+                EXPECT_LE(++count[index], 4)
+                    << what << ", intervals " << nx << " x " << ny;
+            }
+        }
+    };
+    for (Point2i p : {Point2i(0, 0), Point2i(17, 5), Point2i(63, 64)}) {
+        sampler.StartPixel(p);
+        std::vector<Float> u1[3];
+        std::vector<Point2f> u2[3];
+        const Float *array1D = sampler.Get1DArray(n);
+        const Point2f *array2D = sampler.Get2DArray(n);
+        do {
+            for (int d = 0; d < 3; ++d) {
+                u1[d].push_back(sampler.Get1D());
+                u2[d].push_back(sampler.Get2D());
+            }
+        } while (sampler.StartNextSample());
+        for (int d = 0; d < 3; ++d) {
+            check1D(u1[d], "Get1D()");
+            check2D(u2[d], "Get2D()");
+        }
+        check1D(std::vector<Float>(array1D, array1D + n), "1D array");
+        check2D(std::vector<Point2f>(array2D, array2D + n), "2D array");
+    }
+}
+
+TEST(Sampler, Batch) {
+    // Batched sample generation must match individual _Get1D()_ and
+    // _Get2D()_ calls, including skipping over array dimensions.
+    Bounds2i bounds(Point2i(0, 0), Point2i(16, 16));
+    auto makeSamplers = [&](int nArrays) {
+        std::vector<std::unique_ptr<Sampler>> samplers;
+        samplers.push_back(std::unique_ptr<Sampler>(new HaltonSampler(16, bounds)));
+        samplers.push_back(std::unique_ptr<Sampler>(new SobolSampler(16, bounds)));
+        samplers.push_back(
+            std::unique_ptr<Sampler>(new ZeroTwoSequenceSampler(16, 8)));
+        for (auto &sampler : samplers) {
+            for (int i = 0; i < nArrays; ++i) {
+                sampler->Request1DArray(4);
+                sampler->Request2DArray(4);
+            }
+        }
+        return samplers;
+    };
+    for (int nArrays = 0; nArrays < 2; ++nArrays) {
+        auto single = makeSamplers(nArrays), batch = makeSamplers(nArrays);
+        for (size_t s = 0; s < single.size(); ++s) {
+            for (Point2i p : {Point2i(0, 0), Point2i(7, 3)}) {
+                single[s]->StartPixel(p);
+                batch[s]->StartPixel(p);
+                int sampleIndex = 0;
+                do {
+                    // Every other sample starts with batches at dimension
+                    // zero, so that 2D batches reach the dimension before
+                    // the camera sample ends
+                    if (sampleIndex++ % 2 == 0) {
+                        Point2f u2[3];
+                        batch[s]->Get2DBatch(3, u2);
+                        for (int i = 0; i < 3; ++i)
+                            EXPECT_EQ(single[s]->Get2D(), u2[i]);
+                    } else {
+                        CameraSample cs0 =
+                            single[s]->Sampler::GetCameraSample(p);
+                        CameraSample cs1 = batch[s]->GetCameraSample(p);
+                        EXPECT_EQ(cs0.pFilm, cs1.pFilm);
+                        EXPECT_EQ(cs0.time, cs1.time);
+                        EXPECT_EQ(cs0.pLens, cs1.pLens);
+                    }
+
+                    Float u[3];
+                    Point2f u2[5];
+                    batch[s]->Get1DBatch(3, u);
+                    for (int i = 0; i < 3; ++i)
+                        EXPECT_EQ(single[s]->Get1D(), u[i]);
+                    batch[s]->Get2DBatch(5, u2);
+                    for (int i = 0; i < 5; ++i)
+                        EXPECT_EQ(single[s]->Get2D(), u2[i]);
+                    batch[s]->Get1DBatch(3, u);
+                    for (int i = 0; i < 3; ++i)
+                        EXPECT_EQ(single[s]->Get1D(), u[i]);
+                    batch[s]->StartNextSample();
+                } while (single[s]->StartNextSample());
+            }
+        }
+    }
+}
+
+TEST(LowDiscrepancy, PermutationElement) {
+    for (int n : {1, 2, 5, 16, 100, 1024}) {
+        for (uint32_t seed : {0u, 1u, 0xdeadbeefu}) {
+            std::vector<bool> seen(n, false);
+            for (int i = 0; i < n; ++i) {
+                int p = PermutationElement(i, n, seed);
+                ASSERT_GE(p, 0);
+                ASSERT_LT(p, n);
+                EXPECT_FALSE(seen[p]) << "n " << n << ", seed " << seed;
+                seen[p] = true;
+            }
+        }
     }
 }
 
@@ -301,3 +436,92 @@ TEST(Distribution1D, Continuous) {
     EXPECT_FLOAT_EQ(0., dist.SampleContinuous(0., &pdf));
     EXPECT_FLOAT_EQ(1., dist.SampleContinuous(1., &pdf));
 }
+
+TEST(Distribution1D, Alias) {
+    Float func[] = {1, 0, 2, 4, 8, 0, 1};
+    int n = sizeof(func) / sizeof(func[0]);
+    Distribution1D cdf(func, n, false), alias(func, n, true);
+    EXPECT_EQ(0, cdf.alias.Count());
+    EXPECT_EQ(n, alias.alias.Count());
+
+    // Both should choose values with the same probabilities
+    int counts[2][7] = {{0}};
+    const int nSamples = 70000;
+    for (int i = 0; i < nSamples; ++i) {
+        Float u = (i + 0.5f) / nSamples;
+        for (int d = 0; d < 2; ++d) {
+            const Distribution1D &dist = d == 0 ? cdf : alias;
+            Float pdf, uRemapped;
+            int offset = dist.SampleDiscrete(u, &pdf, &uRemapped);
+            EXPECT_EQ(dist.DiscretePDF(offset), pdf);
+            EXPECT_TRUE(uRemapped >= 0 && uRemapped <= 1);
+            ++counts[d][offset];
+
+            int continuousOffset;
+            Float x = dist.SampleContinuous(u, &pdf, &continuousOffset);
+            EXPECT_EQ(continuousOffset, int(x * n));
+            EXPECT_FLOAT_EQ(n * dist.DiscretePDF(continuousOffset), pdf);
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        if (func[i] == 0) EXPECT_EQ(0, counts[1][i]);
+        EXPECT_NEAR(counts[0][i], counts[1][i], 2);
+    }
+}
+
+TEST(Distribution1D, ParallelBuild) {
+    // Large distributions built in parallel should match ones built
+    // serially, up to floating-point round-off
+    ParallelInit();
+    RNG rng;
+    const int n = 1000000;
+    std::vector<Float> func(n);
+    for (Float &f : func) f = rng.UniformFloat() < 0.1f ? 0 : rng.UniformFloat();
+    Distribution1D dist(&func[0], n, true, true);
+    double sum = 0;
+    for (int i = 0; i < n; ++i) {
+        sum += func[i];
+        EXPECT_NEAR(sum / n, dist.cdf[i + 1] * dist.funcInt, 1e-4)
+            << "at " << i;
+        EXPECT_FLOAT_EQ(func[i] / (dist.funcInt * n), dist.alias.PMF(i));
+        if (HasFailure()) break;
+    }
+    EXPECT_EQ(1, dist.cdf[n]);
+
+    // Unless a parallel build is requested, the CDF is summed in order
+    Distribution1D serial(&func[0], n, false);
+    Float fsum = 0;
+    for (int i = 0; i < n; ++i) {
+        fsum += func[i] / n;
+        EXPECT_EQ(fsum / serial.funcInt, serial.cdf[i + 1]) << "at " << i;
+        if (HasFailure()) break;
+    }
+    ParallelCleanup();
+}
+
+TEST(AliasTable, Basics) {
+    Float weights[] = {0, 1, 0, 3, 4};
+    AliasTable table(weights, sizeof(weights) / sizeof(weights[0]));
+    EXPECT_EQ(5, table.Count());
+    for (int i = 0; i < 5; ++i) EXPECT_FLOAT_EQ(weights[i] / 8, table.PMF(i));
+
+    // Sample frequencies should match the PMF and remapped values should
+    // be uniformly distributed for each value
+    int counts[5] = {0};
+    Float remappedSum[5] = {0};
+    const int n = 100000;
+    for (int i = 0; i < n; ++i) {
+        Float pmf, uRemapped;
+        int index = table.Sample((i + 0.5f) / n, &pmf, &uRemapped);
+        ASSERT_TRUE(index >= 0 && index < 5);
+        EXPECT_EQ(table.PMF(index), pmf);
+        EXPECT_TRUE(uRemapped >= 0 && uRemapped < 1);
+        ++counts[index];
+        remappedSum[index] += uRemapped;
+    }
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_NEAR(table.PMF(i), Float(counts[i]) / n, 1e-3);
+        if (counts[i] > 0)
+            EXPECT_NEAR(0.5, remappedSum[i] / counts[i], 1e-2);
+    }
+}
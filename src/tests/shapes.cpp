@@ -1,5 +1,6 @@
 
 #include "tests/gtest/gtest.h"
+#include <array>
 #include <cmath>
 #include <functional>
 #include "pbrt.h"
@@ -128,7 +129,9 @@ TEST(Triangle, Watertight) {
     }
 }
 
-std::shared_ptr<Triangle> GetRandomTriangle(std::function<Float()> value) {
+std::shared_ptr<Triangle> GetRandomTriangle(
+    std::function<Float()> value,
+    TriangleSampling sampling = TriangleSampling::SolidAngle) {
     // Triangle vertices
     Point3f v[3];
     for (int j = 0; j < 3; ++j)
@@ -143,7 +146,8 @@ std::shared_ptr<Triangle> GetRandomTriangle(std::function<Float()> value) {
     int indices[3] = {0, 1, 2};
     std::vector<std::shared_ptr<Shape>> triVec =
         CreateTriangleMesh(&identity, &identity, false, 1, indices, 3, v,
-                           nullptr, nullptr, nullptr, nullptr, nullptr);
+                           nullptr, nullptr, nullptr, nullptr, nullptr,
+                           nullptr, sampling);
     EXPECT_EQ(1, triVec.size());
     std::shared_ptr<Triangle> tri =
         std::dynamic_pointer_cast<Triangle>(triVec[0]);
@@ -275,8 +279,10 @@ TEST(Triangle, SolidAngle) {
         const Float range = 10;
         RNG rng(100 +
                 i);  // Use different triangles than the Triangle/Sample test.
-        std::shared_ptr<Triangle> tri =
-            GetRandomTriangle([&]() { return pUnif(rng, range); });
+        // Sample by area so that the estimate doesn't depend on the solid
+        // angle being checked.
+        std::shared_ptr<Triangle> tri = GetRandomTriangle(
+            [&]() { return pUnif(rng, range); }, TriangleSampling::Area);
         if (!tri) continue;
 
         // Ensure that the reference point isn't too close to the
@@ -316,6 +322,73 @@ TEST(Triangle, SolidAngle) {
     }
 }
 
+// Checks that the solid angle and projected solid angle sampling methods
+// return pdfs that match Pdf() and give the same estimate of the projected
+// solid angle as area sampling.
+TEST(Triangle, SolidAngleSampling) {
+    for (int i = 0; i < 30; ++i) {
+        const Float range = 10;
+        RNG rng(200 + i);
+        std::array<Point3f, 3> v;
+        for (int j = 0; j < 3; ++j)
+            for (int k = 0; k < 3; ++k) v[j][k] = pUnif(rng, range);
+        Point3f pc{pUnif(rng, range), pUnif(rng, range), pUnif(rng, range)};
+        pc[rng.UniformUInt32() % 3] =
+            rng.UniformFloat() > .5 ? (-range - 3) : (range + 3);
+        Normal3f n = Normalize(Normal3f(Vector3f(
+            pUnif(rng, 1), pUnif(rng, 1), pUnif(rng, 1))));
+        Interaction ref(pc, n, Vector3f(), Vector3f(0, 0, 1), 0,
+                        MediumInterface{});
+
+        // Sampled points should be found again by the inverse mapping
+        for (int j = 0; j < 16; ++j) {
+            Point2f u(rng.UniformFloat(), rng.UniformFloat());
+            Float pdf;
+            std::array<Float, 3> b = SampleSphericalTriangle(v, pc, u, &pdf);
+            if (pdf == 0) continue;
+            Point3f p = b[0] * v[0] + b[1] * v[1] + b[2] * v[2];
+            Point2f uInv =
+                InvertSphericalTriangleSample(v, pc, Normalize(p - pc));
+            EXPECT_NEAR(u[0], uInv[0], 1e-2f) << u << " " << uInv;
+            EXPECT_NEAR(u[1], uInv[1], 1e-2f) << u << " " << uInv;
+        }
+
+        const int count = 64 * 1024;
+        Float estimate[3];
+        TriangleSampling modes[3] = {TriangleSampling::Area,
+                                     TriangleSampling::SolidAngle,
+                                     TriangleSampling::ProjectedSolidAngle};
+        for (int m = 0; m < 3; ++m) {
+            static Transform identity;
+            int indices[3] = {0, 1, 2};
+            std::shared_ptr<Shape> tri = CreateTriangleMesh(
+                &identity, &identity, false, 1, indices, 3, v.data(), nullptr,
+                nullptr, nullptr, nullptr, nullptr, nullptr, modes[m])[0];
+            double sum = 0;
+            int pdfMismatches = 0;
+            for (int j = 0; j < count; ++j) {
+                Point2f u{RadicalInverse(0, j), RadicalInverse(1, j)};
+                Float pdf;
+                Interaction it = tri->Sample(ref, u, &pdf);
+                if (pdf == 0) continue;
+                Vector3f wi = Normalize(it.p - pc);
+                Float triPdf = tri->Pdf(ref, wi);
+                if (std::abs(triPdf - pdf) > 1e-2f * pdf) ++pdfMismatches;
+                sum += AbsDot(n, wi) / pdf;
+            }
+            // Directions right at the triangle's edges may miss it when
+            // Pdf() traces a ray
+            EXPECT_LT(pdfMismatches, count / 1000) << "mode " << m;
+            estimate[m] = sum / count;
+        }
+        for (int m = 1; m < 3; ++m)
+            EXPECT_LT(std::abs(estimate[m] - estimate[0]),
+                      std::max<Float>(1e-4f, .02f * estimate[0]))
+                << "mode " << m << ": " << estimate[m]
+                << ", area sampling: " << estimate[0] << ", tri index " << i;
+    }
+}
+
 // Use Quasi Monte Carlo with uniform sphere sampling to esimate the solid
 // angle subtended by the given shape from the given point.
 static Float mcSolidAngle(const Point3f &p, const Shape &shape, int nSamples) {
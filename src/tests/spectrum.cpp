@@ -230,3 +230,60 @@ TEST(Spectrum, LinearDownsampleIrreg) {
         EXPECT_LT(std::abs(lambda * lambda - newVal[i]), .8);
     }
 }
+
+TEST(Spectrum, VectorizedOperations) {
+    // Compare _SampledSpectrum_'s operations, which process four values at
+    // a time, to the same operations applied to each value.
+    RNG rng;
+    for (int trial = 0; trial < 100; ++trial) {
+        SampledSpectrum s, t;
+        for (int i = 0; i < nSpectralSamples; ++i) {
+            s[i] = -20 + 40 * rng.UniformFloat();
+            t[i] = 0.01f + rng.UniformFloat();
+        }
+        if (trial == 0) s[7] = -Infinity;
+
+        SampledSpectrum e = Exp(s), r = Sqrt(t), q = s / t,
+                        c = s.Clamp(-1, 2);
+        Float maxValue = -Infinity;
+        for (int i = 0; i < nSpectralSamples; ++i) {
+            EXPECT_NEAR(e[i], std::exp(s[i]), 2e-7f * std::exp(s[i]));
+            EXPECT_EQ(r[i], std::sqrt(t[i]));
+            EXPECT_EQ(q[i], s[i] / t[i]);
+            EXPECT_EQ(c[i], Clamp(s[i], -1, 2));
+            maxValue = std::max(maxValue, s[i]);
+        }
+        EXPECT_EQ(maxValue, s.MaxComponentValue());
+        EXPECT_FALSE(s.IsBlack());
+    }
+    SampledSpectrum black(0.f);
+    EXPECT_TRUE(black.IsBlack());
+    black[nSpectralSamples - 1] = 1;
+    EXPECT_FALSE(black.IsBlack());
+}
+
+TEST(Spectrum, RGBRoundTrip) {
+    // Check that RGB colors converted to smooth spectra convert back to the
+    // same colors, and that reflectances stay in $[0,1]$.
+    SampledSpectrum::Init();
+    Float one[3] = {1, 1, 1};
+    SampledSpectrum white =
+        SampledSpectrum::FromRGB(one, SpectrumType::Illuminant);
+    RNG rng;
+    for (int trial = 0; trial < 1000; ++trial) {
+        Float rgb[3], out[3];
+        for (int c = 0; c < 3; ++c) rgb[c] = 0.8f * rng.UniformFloat();
+        SampledSpectrum r =
+            SampledSpectrum::FromRGB(rgb, SpectrumType::Reflectance);
+        for (int i = 0; i < nSpectralSamples; ++i) {
+            EXPECT_GE(r[i], 0);
+            EXPECT_LE(r[i], 1);
+        }
+        SampledSpectrum(r * white).ToRGB(out);
+        for (int c = 0; c < 3; ++c) EXPECT_NEAR(rgb[c], out[c], 0.015f);
+
+        for (int c = 0; c < 3; ++c) rgb[c] = 10 * rng.UniformFloat();
+        SampledSpectrum::FromRGB(rgb, SpectrumType::Illuminant).ToRGB(out);
+        for (int c = 0; c < 3; ++c) EXPECT_NEAR(rgb[c], out[c], 0.1f);
+    }
+}
@@ -45,7 +45,7 @@ ConstantTexture<Float> *CreateConstantFloatTexture(const Transform &tex2world,
 ConstantTexture<Spectrum> *CreateConstantSpectrumTexture(
     const Transform &tex2world, const TextureParams &tp) {
     return new ConstantTexture<Spectrum>(
-        tp.FindSpectrum("value", Spectrum(1.f)));
+        tp.FindSpectrum("value", SceneSpectrum(1.f)));
 }
 
 }  // namespace pbrt
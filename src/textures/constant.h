@@ -50,11 +50,12 @@ template <typename T>
 class ConstantTexture : public Texture<T> {
   public:
     // ConstantTexture Public Methods
-    ConstantTexture(const T &value) : value(value) {}
-    T Evaluate(const SurfaceInteraction &) const { return value; }
+    ConstantTexture(const typename SceneValue<T>::type &value)
+        : value(value) {}
+    T Evaluate(const SurfaceInteraction &) const { return T(value); }
 
   private:
-    T value;
+    typename SceneValue<T>::type value;
 };
 
 ConstantTexture<Float> *CreateConstantFloatTexture(const Transform &tex2world,
@@ -35,31 +35,59 @@
 #include "textures/imagemap.h"
 #include "imageio.h"
 #include "stats.h"
+#include "texcache.h"
 
 namespace pbrt {
 
+// ImageTexture Local Definitions
+static TextureCache *GetTextureCache() {
+    static std::unique_ptr<TextureCache> cache(
+        new TextureCache(size_t(PbrtOptions.textureCacheMB) << 20));
+    return cache.get();
+}
+
 // ImageTexture Method Definitions
 template <typename Tmemory, typename Treturn>
 ImageTexture<Tmemory, Treturn>::ImageTexture(
     std::unique_ptr<TextureMapping2D> mapping, const std::string &filename,
     bool doTrilinear, Float maxAniso, ImageWrap wrapMode, Float scale,
-    bool gamma)
+    bool gamma, TexelFormat format)
     : mapping(std::move(mapping)) {
-    mipmap =
-        GetTexture(filename, doTrilinear, maxAniso, wrapMode, scale, gamma);
+    mipmap = GetTexture(filename, doTrilinear, maxAniso, wrapMode, scale,
+                        gamma, format);
 }
 
 template <typename Tmemory, typename Treturn>
 MIPMap<Tmemory> *ImageTexture<Tmemory, Treturn>::GetTexture(
     const std::string &filename, bool doTrilinear, Float maxAniso,
-    ImageWrap wrap, Float scale, bool gamma) {
+    ImageWrap wrap, Float scale, bool gamma, TexelFormat format) {
     // Return _MIPMap_ from texture cache if present
-    TexInfo texInfo(filename, doTrilinear, maxAniso, wrap, scale, gamma);
+    TexInfo texInfo(filename, doTrilinear, maxAniso, wrap, scale, gamma,
+                    format);
     if (textures.find(texInfo) != textures.end())
         return textures[texInfo].get();
 
     // Create _MIPMap_ for _filename_
     ProfilePhase _(Prof::TextureLoading);
+    if (TextureCache::IsTiledTexture(filename)) {
+        // Page in the texels of tiled, MIP-mapped files on demand
+        TextureCache *cache = GetTextureCache();
+        int texture = cache->AddTexture(filename);
+        if (texture >= 0) {
+            if (format != TexelFormat::Float)
+                Warning("Ignoring texel storage format for tiled texture "
+                        "\"%s\".", filename.c_str());
+            auto convert = [scale, gamma](const RGBSpectrum &rgb) {
+                Tmemory v;
+                convertIn(rgb, &v, scale, gamma);
+                return v;
+            };
+            MIPMap<Tmemory> *mipmap = new MIPMap<Tmemory>(
+                cache, texture, convert, doTrilinear, maxAniso, wrap);
+            textures[texInfo].reset(mipmap);
+            return mipmap;
+        }
+    }
     Point2i resolution;
     std::unique_ptr<RGBSpectrum[]> texels = ReadImage(filename, &resolution);
     if (!texels) {
@@ -88,7 +116,7 @@ MIPMap<Tmemory> *ImageTexture<Tmemory, Treturn>::GetTexture(
         for (int i = 0; i < resolution.x * resolution.y; ++i)
             convertIn(texels[i], &convertedTexels[i], scale, gamma);
         mipmap = new MIPMap<Tmemory>(resolution, convertedTexels.get(),
-                                     doTrilinear, maxAniso, wrap);
+                                     doTrilinear, maxAniso, wrap, format);
     } else {
         // Create one-valued _MIPMap_
         Tmemory oneVal = scale;
@@ -101,6 +129,22 @@ MIPMap<Tmemory> *ImageTexture<Tmemory, Treturn>::GetTexture(
 template <typename Tmemory, typename Treturn>
 std::map<TexInfo, std::unique_ptr<MIPMap<Tmemory>>>
     ImageTexture<Tmemory, Treturn>::textures;
+
+static TexelFormat GetTexelFormat(const TextureParams &tp) {
+    std::string storage = tp.FindString("storage", "float");
+    if (storage == "float")
+        return TexelFormat::Float;
+    else if (storage == "half")
+        return TexelFormat::Half;
+    else if (storage == "srgb8")
+        return TexelFormat::SRGB8;
+    else if (storage == "bc")
+        return TexelFormat::BC;
+    Error("Texel storage format \"%s\" unknown. Using \"float\".",
+          storage.c_str());
+    return TexelFormat::Float;
+}
+
 ImageTexture<Float, Float> *CreateImageFloatTexture(const Transform &tex2world,
                                                     const TextureParams &tp) {
     // Initialize 2D texture mapping _map_ from _tp_
@@ -140,7 +184,8 @@ ImageTexture<Float, Float> *CreateImageFloatTexture(const Transform &tex2world,
     bool gamma = tp.FindBool("gamma", HasExtension(filename, ".tga") ||
                                           HasExtension(filename, ".png"));
     return new ImageTexture<Float, Float>(std::move(map), filename, trilerp,
-                                          maxAniso, wrapMode, scale, gamma);
+                                          maxAniso, wrapMode, scale, gamma,
+                                          GetTexelFormat(tp));
 }
 
 ImageTexture<RGBSpectrum, Spectrum> *CreateImageSpectrumTexture(
@@ -182,7 +227,8 @@ ImageTexture<RGBSpectrum, Spectrum> *CreateImageSpectrumTexture(
     bool gamma = tp.FindBool("gamma", HasExtension(filename, ".tga") ||
                                           HasExtension(filename, ".png"));
     return new ImageTexture<RGBSpectrum, Spectrum>(
-        std::move(map), filename, trilerp, maxAniso, wrapMode, scale, gamma);
+        std::move(map), filename, trilerp, maxAniso, wrapMode, scale, gamma,
+        GetTexelFormat(tp));
 }
 
 template class ImageTexture<Float, Float>;
@@ -35,10 +35,14 @@
 
 #include "error.h"
 #include "interaction.h"
+#include "parallel.h"
 #include "paramset.h"
 #include "stats.h"
 
 #include <Ptexture.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 
 namespace pbrt {
 
@@ -49,32 +53,75 @@ namespace {
 int nActiveTextures;
 Ptex::PtexCache *cache;
 
-STAT_COUNTER("Texture/Ptex lookups", nLookups);
+STAT_PERCENT("Texture/Ptex lookups reusing a held filter", nFilterReuses,
+             nLookups);
 STAT_COUNTER("Texture/Ptex files accessed", nFilesAccessed);
+STAT_COUNTER("Texture/Ptex file reopens", nFileReopens);
 STAT_COUNTER("Texture/Ptex block reads", nBlockReads);
 STAT_MEMORY_COUNTER("Memory/Ptex peak memory used", peakMemoryUsed);
+STAT_MEMORY_COUNTER("Memory/Ptex file data read", bytesRead);
+
+// Number of lookups a thread performs with a texture handle and filter
+// before returning them to the cache, which only accounts for and frees
+// the memory of files that no thread currently holds.
+static PBRT_CONSTEXPR int MaxHeldLookups = 256;
 
 struct : public PtexErrorHandler {
     void reportError(const char *error) override { Error("%s", error); }
 } errorHandler;
 
+// Reads Ptex files with stdio, recording how many bytes are read
+struct : public PtexInputHandler {
+    Handle open(const char *path) override { return fopen(path, "rb"); }
+    void seek(Handle handle, int64_t pos) override {
+#ifdef _MSC_VER
+        _fseeki64((FILE *)handle, pos, SEEK_SET);
+#else
+        fseeko((FILE *)handle, pos, SEEK_SET);
+#endif
+    }
+    size_t read(void *buffer, size_t size, Handle handle) override {
+        size_t n = fread(buffer, 1, size, (FILE *)handle);
+        bytesRead += n;
+        return n;
+    }
+    bool close(Handle handle) override { return fclose((FILE *)handle) == 0; }
+    const char *lastError() override { return strerror(errno); }
+} inputHandler;
+
 }  // anonymous namespace
 
+template <typename T>
+struct PtexTexture<T>::ThreadFilter {
+    void Release() {
+        if (filter) filter->release();
+        if (texture) texture->release();
+        filter = nullptr;
+        texture = nullptr;
+        nLookups = 0;
+    }
+    Ptex::PtexTexture *texture = nullptr;
+    Ptex::PtexFilter *filter = nullptr;
+    int nLookups = 0;
+};
+
 // PtexTexture Method Definitions
 template <typename T>
 PtexTexture<T>::PtexTexture(const std::string &filename, Float gamma)
     : filename(filename), gamma(gamma) {
     if (!cache) {
         CHECK_EQ(nActiveTextures, 0);
-        int maxFiles = 100;
-        size_t maxMem = 1ull << 32;  // 4GB
+        int maxFiles = PbrtOptions.ptexMaxFiles;
+        size_t maxMem = size_t(PbrtOptions.ptexCacheMB) << 20;
         bool premultiply = true;
 
-        cache = Ptex::PtexCache::create(maxFiles, maxMem, premultiply, nullptr,
-                                        &errorHandler);
+        cache = Ptex::PtexCache::create(maxFiles, maxMem, premultiply,
+                                        &inputHandler, &errorHandler);
         // TODO? cache->setSearchPath(...);
     }
     ++nActiveTextures;
+    nThreadFilters = MaxThreadIndex();
+    threadFilters.reset(new ThreadFilter[nThreadFilters]);
 
     // Issue an error if the texture doesn't exist or has an unsupported
     // number of channels.
@@ -97,11 +144,13 @@ PtexTexture<T>::PtexTexture(const std::string &filename, Float gamma)
 
 template <typename T>
 PtexTexture<T>::~PtexTexture() {
+    for (int i = 0; i < nThreadFilters; ++i) threadFilters[i].Release();
     if (--nActiveTextures == 0) {
         LOG(INFO) << "Releasing ptex cache";
         Ptex::PtexCache::Stats stats;
         cache->getStats(stats);
         nFilesAccessed += stats.filesAccessed;
+        nFileReopens += stats.fileReopens;
         nBlockReads += stats.blockReads;
         peakMemoryUsed = stats.peakMemUsed;
 
@@ -140,20 +189,27 @@ T PtexTexture<T>::Evaluate(const SurfaceInteraction &si) const {
     if (!valid) return T{};
 
     ++nLookups;
-    Ptex::String error;
-    Ptex::PtexTexture *texture = cache->get(filename.c_str(), error);
-    CHECK(texture != nullptr);
-    // TODO: make the filter an option?
-    Ptex::PtexFilter::Options opts(Ptex::PtexFilter::FilterType::f_bspline);
-    Ptex::PtexFilter *filter = Ptex::PtexFilter::getFilter(texture, opts);
-    int nc = texture->numChannels();
+    // Get this thread's texture handle and filter, acquiring them if needed
+    CHECK_LT(ThreadIndex, nThreadFilters);
+    ThreadFilter &tf = threadFilters[ThreadIndex];
+    if (tf.filter)
+        ++nFilterReuses;
+    else {
+        Ptex::String error;
+        tf.texture = cache->get(filename.c_str(), error);
+        CHECK(tf.texture != nullptr);
+        // TODO: make the filter an option?
+        Ptex::PtexFilter::Options opts(
+            Ptex::PtexFilter::FilterType::f_bspline);
+        tf.filter = Ptex::PtexFilter::getFilter(tf.texture, opts);
+    }
+    int nc = tf.texture->numChannels();
 
     float result[3];
     int firstChan = 0;
-    filter->eval(result, firstChan, nc, si.faceIndex, si.uv[0],
-                 si.uv[1], si.dudx, si.dvdx, si.dudy, si.dvdy);
-    filter->release();
-    texture->release();
+    tf.filter->eval(result, firstChan, nc, si.faceIndex, si.uv[0],
+                    si.uv[1], si.dudx, si.dvdx, si.dudy, si.dvdy);
+    if (++tf.nLookups == MaxHeldLookups) tf.Release();
 
     if (gamma != 1)
         for (int i = 0; i < nc; ++i)
@@ -42,6 +42,7 @@
 #include "pbrt.h"
 #include "texture.h"
 
+#include <memory>
 #include <string>
 
 namespace pbrt {
@@ -56,9 +57,15 @@ class PtexTexture : public Texture<T> {
     T Evaluate(const SurfaceInteraction &) const;
 
   private:
+    // PtexTexture Private Data
     bool valid;
     const std::string filename;
     const Float gamma;
+    // Each thread holds on to its own texture handle and filter across
+    // lookups; they are defined in ptex.cpp
+    struct ThreadFilter;
+    std::unique_ptr<ThreadFilter[]> threadFilters;
+    int nThreadFilters;
 };
 
 PtexTexture<Float> *CreatePtexFloatTexture(const Transform &tex2world,
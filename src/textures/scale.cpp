@@ -46,8 +46,8 @@ ScaleTexture<Float, Float> *CreateScaleFloatTexture(const Transform &tex2world,
 ScaleTexture<Spectrum, Spectrum> *CreateScaleSpectrumTexture(
     const Transform &tex2world, const TextureParams &tp) {
     return new ScaleTexture<Spectrum, Spectrum>(
-        tp.GetSpectrumTexture("tex1", Spectrum(1.f)),
-        tp.GetSpectrumTexture("tex2", Spectrum(1.f)));
+        tp.GetSpectrumTexture("tex1", SceneSpectrum(1.f)),
+        tp.GetSpectrumTexture("tex2", SceneSpectrum(1.f)));
 }
 
 }  // namespace pbrt
@@ -10,10 +10,12 @@
 #include <stdlib.h>
 #include <algorithm>
 #include "fileutil.h"
+#include "film.h"
 #include "imageio.h"
 #include "pbrt.h"
 #include "spectrum.h"
 #include "parallel.h"
+#include "texcache.h"
 extern "C" {
 #include "ext/ArHosekSkyModel.h"
 }
@@ -31,7 +33,7 @@ static void usage(const char *msg = nullptr, ...) {
     }
     fprintf(stderr, R"(usage: imgtool <command> [options] <filenames...>
 
-commands: assemble, cat, convert, diff, info, makesky
+commands: assemble, cat, convert, diff, info, makemipmap, makesky, merge
 
 assemble option:
     --outfile          Output image filename.
@@ -70,6 +72,12 @@ diff options:
     --outfile <name>   Filename to use for saving an image that encodes the
                        absolute value of per-pixel differences.
 
+makemipmap usage:
+    imgtool makemipmap <infile> <outfile.exr>
+                       Write a tiled, MIP-mapped OpenEXR file that pbrt pages
+                       texels in from on demand when it's used as an image
+                       texture.
+
 makesky options:
     --albedo <a>       Albedo of ground-plane (range 0-1). Default: 0.5
     --elevation <e>    Elevation of the sun in degrees (range 0-90). Default: 10
@@ -80,10 +88,25 @@ makesky options:
                        (Horizontal resolution is twice this value.)
                        Default: 2048
 
+merge option:
+    --outfile <name>   Filename for the image computed from the partial films
+                       written by the nodes of a distributed render (pbrt
+                       --nodecount). Default: the render's output filename.
+
 )");
     exit(1);
 }
 
+int makemipmap(int argc, char *argv[]) {
+    if (argc != 2) usage("\"makemipmap\" requires input and output filenames");
+    if (!HasExtension(argv[1], ".exr"))
+        usage("%s: tiled MIP maps must be written to OpenEXR files", argv[1]);
+    ParallelInit();
+    bool ok = WriteTiledMIPMap(argv[0], argv[1]);
+    ParallelCleanup();
+    return ok ? 0 : 1;
+}
+
 int makesky(int argc, char *argv[]) {
     const char *outfile = "sky.exr";
     float albedo = 0.5;
@@ -284,6 +307,24 @@ int assemble(int argc, char *argv[]) {
     return 0;
 }
 
+int merge(int argc, char *argv[]) {
+    if (argc == 0) usage("no filenames provided to \"merge\"?");
+    std::string outfile;
+    std::vector<std::string> infiles;
+    for (int i = 0; i < argc; ++i) {
+        if (!strcmp(argv[i], "--outfile") || !strcmp(argv[i], "-outfile")) {
+            if (i + 1 == argc)
+                usage("missing filename for %s parameter", argv[i]);
+            outfile = argv[++i];
+        } else if (!strncmp(argv[i], "--outfile=", 10)) {
+            outfile = &argv[i][10];
+        } else
+            infiles.push_back(argv[i]);
+    }
+
+    return MergePartialFilms(infiles, outfile) ? 0 : 1;
+}
+
 int cat(int argc, char *argv[]) {
     if (argc == 0) usage("no filenames provided to \"cat\"?");
     bool sort = false;
@@ -777,8 +818,12 @@ int main(int argc, char *argv[]) {
         return diff(argc - 2, argv + 2);
     else if (!strcmp(argv[1], "info"))
         return info(argc - 2, argv + 2);
+    else if (!strcmp(argv[1], "makemipmap"))
+        return makemipmap(argc - 2, argv + 2);
     else if (!strcmp(argv[1], "makesky"))
         return makesky(argc - 2, argv + 2);
+    else if (!strcmp(argv[1], "merge"))
+        return merge(argc - 2, argv + 2);
     else
         usage("unknown command \"%s\"", argv[1]);
 
@@ -0,0 +1,639 @@
+//
+// pbrtbench.cpp
+//
+// Microbenchmarks for performance-sensitive parts of the renderer.
+//
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "pbrt.h"
+#include "camera.h"
+#include "film.h"
+#include "imageio.h"
+#include "mipmap.h"
+#include "parallel.h"
+#include "rng.h"
+#include "sampling.h"
+#include "scene.h"
+#include "spectrum.h"
+#include "accelerators/bvh.h"
+#include "filters/box.h"
+#include "lights/infinite.h"
+#include "samplers/halton.h"
+#include "samplers/paddedsobol.h"
+#include "samplers/random.h"
+#include "samplers/sobol.h"
+#include "samplers/stratified.h"
+#include "samplers/zerotwosequence.h"
+#include "shapes/sphere.h"
+#include <glog/logging.h>
+
+using namespace pbrt;
+
+static void usage(const char *msg = nullptr, ...) {
+    if (msg) {
+        va_list args;
+        va_start(args, msg);
+        fprintf(stderr, "pbrtbench: ");
+        vfprintf(stderr, msg, args);
+        fprintf(stderr, "\n");
+    }
+    fprintf(stderr, R"(usage: pbrtbench <command> [options]
+
+commands: distrib envlight samplers spectrum splat texture
+
+distrib options:
+    --maxcount <n>     Largest number of values; counts are multiplied by
+                       10 starting from 10. Default: 10000000
+    --samples <n>      Number of samples timed per distribution.
+                       Default: 16777216
+
+envlight options: [<image>]
+    --resolution <r>   Resolution of the generated environment map
+                       (2r x r) that's used if no image is given.
+                       Default: 2048
+    --samples <n>      Number of samples and PDF evaluations timed per
+                       sampling method. Default: 4194304
+
+samplers options:
+    --maxspp <n>       Largest pixel sample count; counts are multiplied by 4
+                       starting from 1. Default: 1024
+    --pixels <n>       Number of pixels, each giving an independent
+                       estimate, is n x n. Default: 64
+
+spectrum options:
+    --ops <n>          Number of operations per measurement. Default: 16777216
+
+splat options:
+    --maxthreads <n>   Largest thread count to measure; counts are doubled
+                       starting from 1. Default: number of system cores
+    --resolution <r>   Film resolution (r x r). Default: 512
+    --splats <n>       Number of splats per measurement. Default: 16777216
+
+texture options: [<image>...]
+    --lookups <n>      Number of filtered lookups timed per filter.
+                       Default: 1048576
+    --resolution <r>   Resolution of the generated checkerboard and noise
+                       textures (r x r) that are used if no images are
+                       given. Default: 1024
+
+)");
+    exit(1);
+}
+
+// Parses "--name value" and "--name=value" flags; returns false if _argv[i]_
+// isn't _name_.
+static bool parseIntArg(int argc, char *argv[], int &i, const char *name,
+                        int64_t *value) {
+    const char *ptr = argv[i];
+    if (*ptr != '-') return false;
+    ++ptr;
+    if (*ptr == '-') ++ptr;
+    size_t len = strlen(name);
+    if (strncmp(ptr, name, len) != 0) return false;
+    if (ptr[len] == '=') {
+        *value = atoll(ptr + len + 1);
+        return true;
+    } else if (ptr[len] != '\0')
+        return false;
+    if (i + 1 == argc) usage("missing value after %s flag", argv[i]);
+    *value = atoll(argv[++i]);
+    return true;
+}
+
+static double ElapsedSeconds(
+    std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// Sampler Convergence Benchmark
+static const char *benchSamplers[] = {"random",  "stratified", "halton",
+                                      "sobol",   "02sequence", "paddedsobol"};
+
+static std::unique_ptr<Sampler> CreateBenchSampler(const std::string &name,
+                                                   int spp,
+                                                   const Bounds2i &bounds) {
+    Sampler *sampler = nullptr;
+    if (name == "random")
+        sampler = new RandomSampler(spp);
+    else if (name == "stratified") {
+        int n = std::sqrt((Float)spp);
+        sampler = new StratifiedSampler(n, spp / n, true, 4);
+    } else if (name == "halton")
+        sampler = new HaltonSampler(spp, bounds);
+    else if (name == "sobol")
+        sampler = new SobolSampler(spp, bounds);
+    else if (name == "02sequence")
+        sampler = new ZeroTwoSequenceSampler(spp, 4);
+    else if (name == "paddedsobol")
+        sampler = new PaddedSobolSampler(spp);
+    CHECK(sampler != nullptr);
+    return std::unique_ptr<Sampler>(sampler);
+}
+
+// Returns the RMS error of the per-pixel estimates of the integral of
+// _f_ over the 2D sample dimensions that follow the camera sample.
+template <typename F>
+static double EstimateRMSE(Sampler &sampler, int nPixels, F f,
+                           double reference) {
+    double sumSqError = 0;
+    for (int y = 0; y < nPixels; ++y)
+        for (int x = 0; x < nPixels; ++x) {
+            Point2i p(x, y);
+            sampler.StartPixel(p);
+            double sum = 0;
+            do {
+                sampler.GetCameraSample(p);
+                sum += f(sampler.Get2D());
+            } while (sampler.StartNextSample());
+            double error = sum / sampler.samplesPerPixel - reference;
+            sumSqError += error * error;
+        }
+    return std::sqrt(sumSqError / (nPixels * nPixels));
+}
+
+static int samplers(int argc, char *argv[]) {
+    int64_t maxSpp = 1024, nPixels = 64;
+    for (int i = 0; i < argc; ++i) {
+        if (!parseIntArg(argc, argv, i, "maxspp", &maxSpp) &&
+            !parseIntArg(argc, argv, i, "pixels", &nPixels))
+            usage("unknown samplers option \"%s\"", argv[i]);
+    }
+    if (maxSpp < 1 || nPixels < 1) usage("samplers options must be positive");
+    Bounds2i bounds(Point2i(0, 0), Point2i(nPixels, nPixels));
+
+    // Integrands with known values: a discontinuous quarter disk and a
+    // smooth Gaussian
+    auto disk = [](Point2f u) { return u.x * u.x + u.y * u.y < 1 ? 1. : 0.; };
+    auto gaussian = [](Point2f u) {
+        return std::exp(-(double)u.x * u.x - (double)u.y * u.y);
+    };
+    double gaussianIntegral = std::sqrt(Pi) / 2 * std::erf(1.);
+    gaussianIntegral *= gaussianIntegral;
+
+    const int nSamplers = sizeof(benchSamplers) / sizeof(benchSamplers[0]);
+    for (int integrand = 0; integrand < 2; ++integrand) {
+        printf("RMS error, %s integrand\n%6s",
+               integrand == 0 ? "quarter disk" : "Gaussian", "spp");
+        for (int s = 0; s < nSamplers; ++s) printf(" %12s", benchSamplers[s]);
+        printf("\n");
+        for (int spp = 1; spp <= maxSpp; spp *= 4) {
+            printf("%6d", spp);
+            for (int s = 0; s < nSamplers; ++s) {
+                std::unique_ptr<Sampler> sampler =
+                    CreateBenchSampler(benchSamplers[s], spp, bounds);
+                double rmse =
+                    integrand == 0
+                        ? EstimateRMSE(*sampler, nPixels, disk, Pi / 4)
+                        : EstimateRMSE(*sampler, nPixels, gaussian,
+                                       gaussianIntegral);
+                printf(" %12.3e", rmse);
+            }
+            printf("\n");
+        }
+        printf("\n");
+    }
+
+    // Measure sample generation throughput for paths of eight bounces
+    printf("Generation rate, %d spp, camera sample + 16 2D samples\n%6s",
+           (int)maxSpp, "");
+    for (int s = 0; s < nSamplers; ++s) printf(" %12s", benchSamplers[s]);
+    printf("\n%6s", "Msamp/s");
+    for (int s = 0; s < nSamplers; ++s) {
+        std::unique_ptr<Sampler> sampler =
+            CreateBenchSampler(benchSamplers[s], maxSpp, bounds);
+        Float sum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (Point2i p : bounds) {
+            sampler->StartPixel(p);
+            do {
+                sum += sampler->GetCameraSample(p).time;
+                for (int i = 0; i < 16; ++i) sum += sampler->Get2D().x;
+            } while (sampler->StartNextSample());
+        }
+        double seconds = ElapsedSeconds(start);
+        printf(" %12.2f", 1e-6 * bounds.Area() * sampler->samplesPerPixel /
+                              seconds);
+        // Keep the compiler from optimizing the loop away
+        if (sum < 0) printf("!");
+    }
+    printf("\n");
+    return 0;
+}
+
+// Spectrum Arithmetic Benchmark
+// Returns the average time in nanoseconds that _op_ takes on spectra with
+// random values; _op_ returns a value that's summed so that the compiler
+// can't skip computing it. Few enough spectra are used that they stay in
+// the L1 cache.
+template <typename S, typename Op>
+static double TimeSpectrumOp(int64_t nOps, Op op) {
+    const int n = 32;
+    std::vector<S> a(n), b(n), r(n);
+    RNG rng;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < S::nSamples; ++j) {
+            a[i][j] = 0.1f + rng.UniformFloat();
+            b[i][j] = 0.1f + rng.UniformFloat();
+        }
+
+    Float sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t k = 0; k < nOps; k += n)
+        for (int i = 0; i < n; ++i) sum += op(a[i], b[i], &r[i]);
+    double seconds = ElapsedSeconds(start);
+    for (int i = 0; i < n; ++i) sum += r[i][0];
+    if (sum == Infinity) printf("!");
+    return 1e9 * seconds / (n * ((nOps + n - 1) / n));
+}
+
+template <typename S>
+static void TimeSpectrumOps(const char *name, int64_t nOps) {
+    printf("%16s", name);
+    printf(" %8.2f", TimeSpectrumOp<S>(nOps, [](const S &a, const S &b, S *r) {
+        *r = a * b * Float(0.5) / Float(0.75);
+        return Float(0);
+    }));
+    printf(" %8.2f", TimeSpectrumOp<S>(nOps, [](const S &a, const S &b, S *r) {
+        *r += a * b;
+        return Float(0);
+    }));
+    printf(" %8.2f", TimeSpectrumOp<S>(nOps, [](const S &a, const S &b, S *r) {
+        *r = a / b;
+        return Float(0);
+    }));
+    printf(" %8.2f", TimeSpectrumOp<S>(nOps, [](const S &a, const S &b, S *r) {
+        *r = Exp(-a * Float(2));
+        return Float(0);
+    }));
+    printf(" %8.2f", TimeSpectrumOp<S>(nOps, [](const S &a, const S &b, S *r) {
+        *r = Sqrt(a);
+        return Float(0);
+    }));
+    printf(" %8.2f", TimeSpectrumOp<S>(nOps, [](const S &a, const S &b, S *r) {
+        *r = a.Clamp(0.25f, 0.75f);
+        return Float(0);
+    }));
+    printf(" %8.2f", TimeSpectrumOp<S>(nOps, [](const S &a, const S &b, S *r) {
+        return Float(a.IsBlack() ? 1 : 0);
+    }));
+    printf(" %8.2f", TimeSpectrumOp<S>(nOps, [](const S &a, const S &b, S *r) {
+        return a.MaxComponentValue();
+    }));
+    printf(" %8.2f", TimeSpectrumOp<S>(nOps, [](const S &a, const S &b, S *r) {
+        return a.y();
+    }));
+    printf(" %8.2f", TimeSpectrumOp<S>(nOps, [](const S &a, const S &b, S *r) {
+        Float xyz[3];
+        a.ToXYZ(xyz);
+        return xyz[0] + xyz[1] + xyz[2];
+    }));
+    printf(" %8.2f\n", TimeSpectrumOp<S>(nOps, [](const S &a, const S &b, S *r) {
+        Float rgb[3] = {a[0] - 0.1f, a[1] - 0.1f, b[0] - 0.1f};
+        *r = S::FromRGB(rgb, SpectrumType::Reflectance);
+        return Float(0);
+    }));
+}
+
+static int spectrum(int argc, char *argv[]) {
+    int64_t nOps = 1 << 24;
+    for (int i = 0; i < argc; ++i) {
+        if (!parseIntArg(argc, argv, i, "ops", &nOps))
+            usage("unknown spectrum option \"%s\"", argv[i]);
+    }
+    if (nOps < 1) usage("spectrum options must be positive");
+    SampledSpectrum::Init();
+
+    printf("Time per operation (ns)\n");
+    printf("%16s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s\n", "",
+           "a*b*s/t", "r+=a*b", "a/b", "Exp", "Sqrt", "Clamp", "IsBlack", "Max",
+           "y", "ToXYZ", "FromRGB");
+    TimeSpectrumOps<RGBSpectrum>("RGBSpectrum", nOps);
+    TimeSpectrumOps<SampledSpectrum>("SampledSpectrum", nOps);
+#ifdef PBRT_HERO_SPECTRUM
+    TimeSpectrumOps<HeroSpectrum>("HeroSpectrum", nOps);
+#endif
+    return 0;
+}
+
+// Splat Benchmark
+static double TimeSplats(int nThreads, bool threadSplats, int resolution,
+                         int64_t nSplats) {
+    PbrtOptions.nThreads = nThreads;
+    ParallelInit();
+    Film film(Point2i(resolution, resolution),
+              Bounds2f(Point2f(0, 0), Point2f(1, 1)),
+              std::unique_ptr<Filter>(new BoxFilter(Vector2f(0.5f, 0.5f))),
+              35.f, "pbrtbench.exr", 1.f, Infinity, threadSplats);
+
+    const int64_t chunkSize = 65536;
+    int64_t nChunks = (nSplats + chunkSize - 1) / chunkSize;
+    auto start = std::chrono::steady_clock::now();
+    ParallelFor([&](int64_t chunk) {
+        RNG rng(chunk);
+        int64_t end = std::min(nSplats, (chunk + 1) * chunkSize);
+        for (int64_t i = chunk * chunkSize; i < end; ++i) {
+            Point2f p(rng.UniformFloat() * resolution,
+                      rng.UniformFloat() * resolution);
+            film.AddSplat(p, Spectrum(rng.UniformFloat()));
+        }
+    }, nChunks);
+    // The reduction is part of the cost of per-thread splat buffers.
+    film.MergeSplats();
+    double seconds = ElapsedSeconds(start);
+
+    ParallelCleanup();
+    return seconds;
+}
+
+static int splat(int argc, char *argv[]) {
+    int64_t maxThreads = NumSystemCores(), resolution = 512,
+            nSplats = 1 << 24;
+    for (int i = 0; i < argc; ++i) {
+        if (!parseIntArg(argc, argv, i, "maxthreads", &maxThreads) &&
+            !parseIntArg(argc, argv, i, "resolution", &resolution) &&
+            !parseIntArg(argc, argv, i, "splats", &nSplats))
+            usage("unknown splat option \"%s\"", argv[i]);
+    }
+    if (maxThreads < 1 || resolution < 1 || nSplats < 1)
+        usage("splat options must be positive");
+
+    printf("%8s %18s %18s\n", "threads", "atomic Msplat/s",
+           "per-thread Msplat/s");
+    for (int nThreads = 1; nThreads <= maxThreads; nThreads *= 2) {
+        double atomicTime = TimeSplats(nThreads, false, resolution, nSplats);
+        double threadTime = TimeSplats(nThreads, true, resolution, nSplats);
+        printf("%8d %18.2f %18.2f\n", nThreads, 1e-6 * nSplats / atomicTime,
+               1e-6 * nSplats / threadTime);
+    }
+    return 0;
+}
+
+// Texture Filtering Benchmark
+struct TextureLookup {
+    Point2f st;
+    Vector2f dst0, dst1;
+};
+
+// Returns lookups at random points with elliptical footprints of random
+// orientation, size and eccentricity, like those of pixels seeing
+// textured surfaces at grazing angles.
+static std::vector<TextureLookup> RandomLookups(int n, int resolution) {
+    std::vector<TextureLookup> lookups(n);
+    RNG rng;
+    for (TextureLookup &l : lookups) {
+        l.st = Point2f(rng.UniformFloat(), rng.UniformFloat());
+        Float major = std::pow(64.f, rng.UniformFloat()) / resolution;
+        Float minor = major / std::pow(16.f, rng.UniformFloat());
+        Float phi = 2 * Pi * rng.UniformFloat();
+        l.dst0 = major * Vector2f(std::cos(phi), std::sin(phi));
+        l.dst1 = minor * Vector2f(-std::sin(phi), std::cos(phi));
+    }
+    return lookups;
+}
+
+// Returns the Gaussian-weighted average of the finest level over the
+// lookup's ellipse, which is the filter EWA approximates.
+static RGBSpectrum ReferenceLookup(const MIPMap<RGBSpectrum> &mipmap,
+                                   const TextureLookup &l) {
+    const int n = 32;
+    RGBSpectrum sum(0.f);
+    Float sumWts = 0;
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            Float u = 2 * (i + .5f) / n - 1, v = 2 * (j + .5f) / n - 1;
+            Float r2 = u * u + v * v;
+            if (r2 >= 1) continue;
+            Float weight = std::exp(-2 * r2) - std::exp(-2.f);
+            sum += weight * mipmap.Lookup(l.st + u * l.dst0 + v * l.dst1, 0);
+            sumWts += weight;
+        }
+    return sum / sumWts;
+}
+
+static void BenchTexture(const char *name, const Point2i &res,
+                         const RGBSpectrum *image, int64_t nLookups) {
+    const int nQualityLookups = 4096;
+    std::vector<TextureLookup> lookups =
+        RandomLookups(std::min<int64_t>(nLookups, 1 << 20),
+                      std::max(res.x, res.y));
+    std::vector<RGBSpectrum> reference(nQualityLookups);
+    for (bool trilinear : {true, false}) {
+        MIPMap<RGBSpectrum> mipmap(res, image, trilinear);
+        if (trilinear)
+            for (int i = 0; i < nQualityLookups; ++i)
+                reference[i] = ReferenceLookup(mipmap, lookups[i]);
+
+        // Time filtered lookups
+        RGBSpectrum sum(0.f);
+        auto start = std::chrono::steady_clock::now();
+        for (int64_t i = 0; i < nLookups; ++i) {
+            const TextureLookup &l = lookups[i % lookups.size()];
+            sum += mipmap.Lookup(l.st, l.dst0, l.dst1);
+        }
+        double seconds = ElapsedSeconds(start);
+        if (sum[0] == Infinity) printf("!");
+
+        // Measure error with respect to the reference
+        double sumSqError = 0;
+        for (int i = 0; i < nQualityLookups; ++i) {
+            const TextureLookup &l = lookups[i];
+            RGBSpectrum e = mipmap.Lookup(l.st, l.dst0, l.dst1) - reference[i];
+            sumSqError += RGBSpectrum(e * e).y();
+        }
+        printf("%24s %10s %10.3f %10.4f\n", name,
+               trilinear ? "trilinear" : "EWA", 1e-6 * nLookups / seconds,
+               std::sqrt(sumSqError / nQualityLookups));
+    }
+}
+
+static int texture(int argc, char *argv[]) {
+    int64_t nLookups = 1 << 20, resolution = 1024;
+    std::vector<std::string> filenames;
+    for (int i = 0; i < argc; ++i) {
+        if (argv[i][0] != '-')
+            filenames.push_back(argv[i]);
+        else if (!parseIntArg(argc, argv, i, "lookups", &nLookups) &&
+                 !parseIntArg(argc, argv, i, "resolution", &resolution))
+            usage("unknown texture option \"%s\"", argv[i]);
+    }
+    if (nLookups < 1 || resolution < 1)
+        usage("texture options must be positive");
+    PbrtOptions.nThreads = 1;
+    ParallelInit();
+
+    printf("%24s %10s %10s %10s\n", "texture", "filter", "Mlookup/s",
+           "RMS error");
+    if (filenames.empty()) {
+        // Use a checkerboard, which aliases readily, and smooth noise
+        Point2i res(resolution, resolution);
+        std::vector<RGBSpectrum> checks(res.x * res.y), noise(res.x * res.y);
+        for (int y = 0; y < res.y; ++y)
+            for (int x = 0; x < res.x; ++x) {
+                Float check = ((x / 4) ^ (y / 4)) & 1;
+                Float rgb[3] = {check, 0.5f * check, 1 - check};
+                checks[y * res.x + x] = RGBSpectrum::FromRGB(rgb);
+                Point3f p(16.f * x / res.x, 16.f * y / res.y, 0.5f);
+                Float n = 0.5f + 0.5f * Turbulence(p, Vector3f(0, 0, 0),
+                                                   Vector3f(0, 0, 0), 0.5f, 4);
+                noise[y * res.x + x] = RGBSpectrum(n);
+            }
+        BenchTexture("checkerboard", res, &checks[0], nLookups);
+        BenchTexture("noise", res, &noise[0], nLookups);
+    }
+    for (const std::string &filename : filenames) {
+        Point2i res;
+        std::unique_ptr<RGBSpectrum[]> image = ReadImage(filename, &res);
+        if (image) BenchTexture(filename.c_str(), res, image.get(), nLookups);
+    }
+    ParallelCleanup();
+    return 0;
+}
+
+static int distrib(int argc, char *argv[]) {
+    int64_t maxCount = 10000000, nSamples = 1 << 24;
+    for (int i = 0; i < argc; ++i)
+        if (!parseIntArg(argc, argv, i, "maxcount", &maxCount) &&
+            !parseIntArg(argc, argv, i, "samples", &nSamples))
+            usage("unknown distrib option \"%s\"", argv[i]);
+    if (maxCount < 1 || nSamples < 1 || maxCount > (1ll << 30))
+        usage("distrib options must be positive and counts less than 2^30");
+    ParallelInit();
+
+    // Sample values are precomputed so that the RNG isn't timed
+    RNG rng;
+    std::vector<Float> u(1 << 20);
+    for (Float &v : u) v = rng.UniformFloat();
+
+    printf("%10s %10s %12s %12s\n", "count", "method", "build (ms)",
+           "ns/sample");
+    for (int64_t count = 10; count <= maxCount; count *= 10) {
+        // Weights spanning a few orders of magnitude, like light powers
+        std::vector<Float> weights(count);
+        for (Float &w : weights) w = std::exp(8 * rng.UniformFloat());
+        for (bool useAlias : {false, true}) {
+            auto start = std::chrono::steady_clock::now();
+            Distribution1D distrib(&weights[0], int(count), useAlias, true);
+            double buildSeconds = ElapsedSeconds(start);
+
+            int64_t sum = 0;
+            start = std::chrono::steady_clock::now();
+            for (int64_t i = 0; i < nSamples; ++i) {
+                Float pdf;
+                sum += distrib.SampleDiscrete(u[i & (u.size() - 1)], &pdf);
+            }
+            double sampleSeconds = ElapsedSeconds(start);
+            if (sum == -1) printf("!");
+            printf("%10lld %10s %12.3f %12.2f\n", (long long)count,
+                   useAlias ? "alias" : "cdf", 1e3 * buildSeconds,
+                   1e9 * sampleSeconds / nSamples);
+        }
+    }
+    ParallelCleanup();
+    return 0;
+}
+
+static int envlight(int argc, char *argv[]) {
+    int64_t nSamples = 1 << 22, resolution = 2048;
+    std::string filename;
+    for (int i = 0; i < argc; ++i) {
+        if (argv[i][0] != '-')
+            filename = argv[i];
+        else if (!parseIntArg(argc, argv, i, "resolution", &resolution) &&
+                 !parseIntArg(argc, argv, i, "samples", &nSamples))
+            usage("unknown envlight option \"%s\"", argv[i]);
+    }
+    if (nSamples < 1 || resolution < 1)
+        usage("envlight options must be positive");
+    PbrtOptions.nThreads = 1;
+    ParallelInit();
+
+    if (filename.empty()) {
+        // Generate a sky with a small, bright sun
+        Point2i res(2 * resolution, resolution);
+        std::vector<Float> rgb(3 * res.x * res.y);
+        for (int y = 0; y < res.y; ++y)
+            for (int x = 0; x < res.x; ++x) {
+                Float theta = Pi * (y + 0.5f) / res.y;
+                Float sky = 0.2f + std::max<Float>(0, std::cos(theta));
+                bool sun = DistanceSquared(Point2f(x, y),
+                                           Point2f(res.x / 3, res.y / 4)) <
+                           res.y * res.y / 10000.f;
+                for (int c = 0; c < 3; ++c)
+                    rgb[3 * (y * res.x + x) + c] = sun ? 1e4f : (c + 1) * sky;
+            }
+        filename = "pbrtbench_envlight.exr";
+        WriteImage(filename, &rgb[0], Bounds2i(Point2i(0, 0), res), res);
+    }
+
+    printf("%14s %14s %14s %12s\n", "sampling", "Msample_Li/s", "MPdf_Li/s",
+           "setup (s)");
+    static Transform identity;
+    for (bool hierarchical : {false, true}) {
+        auto start = std::chrono::steady_clock::now();
+        std::shared_ptr<Light> light = std::make_shared<InfiniteAreaLight>(
+            identity, SceneSpectrum(1), 1, filename, hierarchical);
+        double setupSeconds = ElapsedSeconds(start);
+        std::vector<std::shared_ptr<Primitive>> prims;
+        prims.push_back(std::make_shared<GeometricPrimitive>(
+            std::make_shared<Sphere>(&identity, &identity, false, 1, -1, 1,
+                                     360),
+            nullptr, nullptr, MediumInterface()));
+        Scene scene(std::make_shared<BVHAccel>(prims), {light});
+        Interaction ref(Point3f(0, 0, 0), 0, MediumInterface());
+
+        // Time sampling and then PDF evaluation for the sampled directions
+        RNG rng;
+        std::vector<Vector3f> wis(std::min<int64_t>(nSamples, 1 << 20));
+        Float sum = 0;
+        start = std::chrono::steady_clock::now();
+        for (int64_t i = 0; i < nSamples; ++i) {
+            Point2f u(rng.UniformFloat(), rng.UniformFloat());
+            Vector3f &wi = wis[i % wis.size()];
+            Float pdf;
+            VisibilityTester vis;
+            sum += light->Sample_Li(ref, u, &wi, &pdf, &vis)[0] + pdf;
+        }
+        double sampleSeconds = ElapsedSeconds(start);
+        start = std::chrono::steady_clock::now();
+        for (int64_t i = 0; i < nSamples; ++i)
+            sum += light->Pdf_Li(ref, wis[i % wis.size()]);
+        double pdfSeconds = ElapsedSeconds(start);
+        if (sum == Infinity) printf("!");
+        printf("%14s %14.3f %14.3f %12.3f\n",
+               hierarchical ? "hierarchical" : "distribution",
+               1e-6 * nSamples / sampleSeconds, 1e-6 * nSamples / pdfSeconds,
+               setupSeconds);
+    }
+    if (filename == "pbrtbench_envlight.exr") remove(filename.c_str());
+    ParallelCleanup();
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    google::InitGoogleLogging(argv[0]);
+    FLAGS_stderrthreshold = 1; // Warning and above.
+
+    if (argc < 2) usage();
+
+    if (!strcmp(argv[1], "distrib"))
+        return distrib(argc - 2, argv + 2);
+    else if (!strcmp(argv[1], "envlight"))
+        return envlight(argc - 2, argv + 2);
+    else if (!strcmp(argv[1], "samplers"))
+        return samplers(argc - 2, argv + 2);
+    else if (!strcmp(argv[1], "spectrum"))
+        return spectrum(argc - 2, argv + 2);
+    else if (!strcmp(argv[1], "splat"))
+        return splat(argc - 2, argv + 2);
+    else if (!strcmp(argv[1], "texture"))
+        return texture(argc - 2, argv + 2);
+    else
+        usage("unknown command \"%s\"", argv[1]);
+
+    return 0;
+}
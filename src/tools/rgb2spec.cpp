@@ -0,0 +1,243 @@
+//
+// rgb2spec.cpp
+//
+// Fits the table of sigmoid-polynomial coefficients that pbrt uses to
+// convert RGB colors to spectra and writes it out as C++ source for
+// src/core/rgbtospectrum.cpp. It only needs to be rerun if the spectral
+// sampling or the RGB color space changes.
+//
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include "pbrt.h"
+#include "spectrum.h"
+
+#include <glog/logging.h>
+
+using namespace pbrt;
+
+static void usage(const char *msg = nullptr, ...) {
+    if (msg) {
+        va_list args;
+        va_start(args, msg);
+        fprintf(stderr, "rgb2spec: ");
+        vfprintf(stderr, msg, args);
+        fprintf(stderr, "\n");
+    }
+    fprintf(stderr, "usage: rgb2spec <output.cpp>\n");
+    exit(1);
+}
+
+// Refines the coefficients _c_ with Gauss-Newton iterations so that the
+// spectrum's color is _rgb_, given each sample's contribution to the color
+// in _weight_
+static void FitSigmoidPolynomial(const double rgb[3],
+                                 const double weight[3][nSpectralSamples],
+                                 const Float t[nSpectralSamples],
+                                 double c[3]) {
+    double prevErr = Infinity;
+    for (int iter = 0; iter < 15; ++iter) {
+        // Compute the color residual and its Jacobian
+        double r[3] = {-rgb[0], -rgb[1], -rgb[2]}, J[3][3] = {};
+        for (int i = 0; i < nSpectralSamples; ++i) {
+            double x = (c[0] * t[i] + c[1]) * t[i] + c[2];
+            double sq = std::sqrt(1 + x * x);
+            double s = .5 + x / (2 * sq), ds = .5 / (sq * (1 + x * x));
+            for (int k = 0; k < 3; ++k) {
+                r[k] += weight[k][i] * s;
+                double dr = weight[k][i] * ds;
+                J[k][0] += dr * t[i] * t[i];
+                J[k][1] += dr * t[i];
+                J[k][2] += dr;
+            }
+        }
+        // Stop once the color matches or, for colors outside the gamut
+        // of reflectances, the fit stops improving
+        double err = r[0] * r[0] + r[1] * r[1] + r[2] * r[2];
+        if (err < 1e-12 || err > .9 * prevErr) return;
+        prevErr = err;
+
+        // Solve $\mat{J} \Delta = r$ with Cramer's rule and take the step
+        auto det3 = [](const double m[3][3]) {
+            return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+                   m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+                   m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+        };
+        double det = det3(J);
+        if (std::abs(det) < 1e-30) return;
+        for (int j = 0; j < 3; ++j) {
+            double Jj[3][3];
+            for (int k = 0; k < 3; ++k)
+                for (int m = 0; m < 3; ++m) Jj[k][m] = m == j ? r[k] : J[k][m];
+            c[j] -= det3(Jj) / det;
+        }
+
+        // Keep the coefficients bounded for colors at the gamut boundary
+        double maxc = std::max({std::abs(c[0]), std::abs(c[1]), std::abs(c[2])});
+        if (maxc > 200)
+            for (int j = 0; j < 3; ++j) c[j] *= 200 / maxc;
+    }
+}
+
+// Fits the whole table; see _RGBToSpectrumTable_ in core/spectrum.h for
+// its layout
+static void FitRGBToSpectrumTable(RGBToSpectrumTable *table) {
+    // Compute the white illuminant, normalized to unit luminance so that
+    // RGB white round-trips, and each sample's contribution to the color of
+    // a reflectance spectrum under it
+    double weight[3][nSpectralSamples], Ywhite = 0;
+    for (int i = 0; i < nSpectralSamples; ++i) {
+        Float wl0 = Lerp(Float(i) / Float(nSpectralSamples),
+                         sampledLambdaStart, sampledLambdaEnd);
+        Float wl1 = Lerp(Float(i + 1) / Float(nSpectralSamples),
+                         sampledLambdaStart, sampledLambdaEnd);
+        table->t[i] = (i + .5f) / nSpectralSamples;
+        table->white[i] =
+            AverageSpectrumSamples(RGB2SpectLambda, RGBIllum2SpectWhite,
+                                   nRGB2SpectSamples, wl0, wl1);
+        SampledSpectrum s(0.f);
+        s[i] = table->white[i];
+        Float rgb[3];
+        s.ToRGB(rgb);
+        for (int k = 0; k < 3; ++k) weight[k][i] = rgb[k];
+        Ywhite += s.y();
+    }
+    for (int i = 0; i < nSpectralSamples; ++i) {
+        table->white[i] /= Ywhite;
+        for (int k = 0; k < 3; ++k) weight[k][i] /= Ywhite;
+    }
+
+    // Space the brightness levels more densely near black and white
+    const int res = rgbToSpectrumRes;
+    auto smoothStep = [](double x) { return x * x * (3 - 2 * x); };
+    for (int k = 0; k < res; ++k)
+        table->zNodes[k] = smoothStep(smoothStep(double(k) / (res - 1)));
+    for (int k = 0; k < res - 1; ++k)
+        table->invZSpacing[k] = 1 / (table->zNodes[k + 1] - table->zNodes[k]);
+    for (int i = 0, k = 0; i < rgbToSpectrumZStartRes; ++i) {
+        while (k < res - 2 &&
+               table->zNodes[k + 1] <= Float(i) / rgbToSpectrumZStartRes)
+            ++k;
+        table->zStart[i] = k;
+    }
+
+    // Fit the coefficients at the grid points, starting each run of
+    // brightness levels from a mid-gray level and using the previous fit
+    // as the initial guess for the next one
+    const int kStart = res / 5;
+    double cStart[3] = {0, 0, 0};
+    for (int l = 0; l < 3; ++l)
+        for (int yi = 0; yi < res; ++yi)
+            for (int xi = 0; xi < res; ++xi) {
+                double x = double(xi) / (res - 1);
+                double y = double(yi) / (res - 1);
+                auto fit = [&](int k, double c[3]) {
+                    double rgb[3];
+                    rgb[l] = table->zNodes[k];
+                    rgb[(l + 1) % 3] = x * table->zNodes[k];
+                    rgb[(l + 2) % 3] = y * table->zNodes[k];
+                    FitSigmoidPolynomial(rgb, weight, table->t, c);
+                    Float *coeffs =
+                        &table->coeffs[3 * (((l * res + k) * res + yi) * res +
+                                            xi)];
+                    for (int j = 0; j < 3; ++j) coeffs[j] = c[j];
+                };
+                fit(kStart, cStart);
+                double c[3] = {cStart[0], cStart[1], cStart[2]};
+                for (int k = kStart + 1; k < res; ++k) fit(k, c);
+                std::copy(cStart, cStart + 3, c);
+                for (int k = kStart - 1; k >= 0; --k) fit(k, c);
+            }
+    table->coeffs[sizeof(table->coeffs) / sizeof(Float) - 1] = 0;
+}
+
+// The license the generated file is distributed under, which is pbrt's
+static const char *license = R"(
+/*
+    pbrt source code is Copyright(c) 1998-2016
+                        Matt Pharr, Greg Humphreys, and Wenzel Jakob.
+
+    This file is part of pbrt.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are
+    met:
+
+    - Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    - Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+    IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+    TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+    PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ */)";
+
+static void WriteValues(FILE *f, const char *comment, const Float *v, int n) {
+    // Seven significant digits are plenty given the error of the fit and of
+    // interpolating it, and keep the generated file smaller
+    fprintf(f, "    // %s\n    {\n       ", comment);
+    int column = 7;
+    for (int i = 0; i < n; ++i) {
+        char value[32];
+        int len = snprintf(value, sizeof(value), "%.7g%s", v[i],
+                           (i + 1 < n) ? "," : "},\n");
+        if (column + 1 + len > 80) {
+            fprintf(f, "\n       ");
+            column = 7;
+        }
+        fprintf(f, " %s", value);
+        column += 1 + len;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    google::InitGoogleLogging(argv[0]);
+    FLAGS_stderrthreshold = 1;  // Warning and above.
+    if (argc != 2) usage("expected an output filename");
+
+    SampledSpectrum::Init();
+    std::unique_ptr<RGBToSpectrumTable> table(new RGBToSpectrumTable);
+    FitRGBToSpectrumTable(table.get());
+
+    FILE *f = fopen(argv[1], "w");
+    if (!f) usage("%s: %s", argv[1], strerror(errno));
+    fprintf(f, "%s", license);
+    fprintf(f,
+            "\n\n\n// core/rgbtospectrum.cpp*\n"
+            "// This file was generated by the rgb2spec tool; rerun it rather "
+            "than editing\n// the values here.\n"
+            "#include \"spectrum.h\"\n\nnamespace pbrt {\n\n"
+            "// RGB to Spectrum Table Definition\n"
+            "const RGBToSpectrumTable rgbToSpectrumTable = {\n");
+    WriteValues(f, "t", table->t, nSpectralSamples);
+    WriteValues(f, "white", table->white, nSpectralSamples);
+    WriteValues(f, "zNodes", table->zNodes, rgbToSpectrumRes);
+    WriteValues(f, "invZSpacing", table->invZSpacing, rgbToSpectrumRes - 1);
+    fprintf(f, "    // zStart\n    {");
+    for (int i = 0; i < rgbToSpectrumZStartRes; ++i)
+        fprintf(f, "%s%d%s", (i % 16 == 0) ? "\n        " : " ",
+                table->zStart[i],
+                (i + 1 < rgbToSpectrumZStartRes) ? "," : "},\n");
+    WriteValues(f, "coeffs", table->coeffs,
+                sizeof(table->coeffs) / sizeof(Float));
+    fprintf(f, "};\n\n}  // namespace pbrt\n");
+    if (fclose(f) != 0) usage("%s: %s", argv[1], strerror(errno));
+    return 0;
+}